@@ -22,6 +22,9 @@
 /* Compile support for GTP communication over TCP/IP channel. */
 #define ENABLE_SOCKET_SUPPORT 0
 
+/* Engine state per thread. Disabled by default. */
+#define ENGINE_THREADS 0
+
 /* Connection module. Default experimental. */
 #define EXPERIMENTAL_CONNECTIONS 1
 
@@ -38,6 +41,9 @@
 /* Define to 1 if you have the <curses.h> header file. */
 #define HAVE_CURSES_H 0
 
+/* Define to 1 if you have the `fork' function. */
+#define HAVE_FORK 1
+
 /* Define to 1 if you have the `gettimeofday' function. */
 #define HAVE_GETTIMEOFDAY 1
 
@@ -22,6 +22,9 @@
 /* Compile support for GTP communication over TCP/IP channel. */
 #undef ENABLE_SOCKET_SUPPORT
 
+/* Engine state per thread. Disabled by default. */
+#cmakedefine ENGINE_THREADS 1
+
 /* GAIN/LOSS codes. Disabled by default. */
 #define EXPERIMENTAL_OWL_EXT 0
 
@@ -53,6 +56,9 @@
 /* Define to 1 if you have the <curses.h> header file. */
 #cmakedefine HAVE_CURSES_H 1
 
+/* Define to 1 if you have the `fork' function. */
+#cmakedefine HAVE_FORK 1
+
 /* Define to 1 if you have the `gettimeofday' function. */
 #cmakedefine HAVE_GETTIMEOFDAY 1
 
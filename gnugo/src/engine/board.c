@@ -135,28 +135,28 @@ struct vertex_stack_entry {
 
 
 /* Main array of string information. */
-static struct string_data string[MAX_STRINGS];
-static struct string_liberties_data string_libs[MAX_STRINGS];
-static struct string_neighbors_data string_neighbors[MAX_STRINGS];
+static THREAD_LOCAL struct string_data string[MAX_STRINGS];
+static THREAD_LOCAL struct string_liberties_data string_libs[MAX_STRINGS];
+static THREAD_LOCAL struct string_neighbors_data string_neighbors[MAX_STRINGS];
 
 /* Stacks and stack pointers. */
-static struct change_stack_entry change_stack[STACK_SIZE];
-static struct change_stack_entry *change_stack_pointer;
+static THREAD_LOCAL struct change_stack_entry change_stack[STACK_SIZE];
+static THREAD_LOCAL struct change_stack_entry *change_stack_pointer;
 
-static struct vertex_stack_entry vertex_stack[STACK_SIZE];
-static struct vertex_stack_entry *vertex_stack_pointer;
+static THREAD_LOCAL struct vertex_stack_entry vertex_stack[STACK_SIZE];
+static THREAD_LOCAL struct vertex_stack_entry *vertex_stack_pointer;
 
 
 /* Index into list of strings. The index is only valid if there is a
  * stone at the vertex.
  */
-static int string_number[BOARDMAX];
+static THREAD_LOCAL int string_number[BOARDMAX];
 
 
 /* The stones in a string are linked together in a cyclic list. 
  * These are the coordinates to the next stone in the string.
  */
-static int next_stone[BOARDMAX];
+static THREAD_LOCAL int next_stone[BOARDMAX];
 
 
 /* ---------------------------------------------------------------- */
@@ -291,13 +291,13 @@ static int next_stone[BOARDMAX];
 
 
 /* Number of the next free string. */
-static int next_string;
+static THREAD_LOCAL int next_string;
 
 
 /* For marking purposes. */
-static int ml[BOARDMAX];
-static int liberty_mark;
-static int string_mark;
+static THREAD_LOCAL int ml[BOARDMAX];
+static THREAD_LOCAL int liberty_mark;
+static THREAD_LOCAL int string_mark;
 
 
 /* Forward declarations. */
@@ -318,11 +318,11 @@ static int do_remove_string(int s);
 static void do_commit_suicide(int pos, int color);
 static void do_play_move(int pos, int color);
 
-static int komaster, kom_pos;
+static THREAD_LOCAL int komaster, kom_pos;
 
 
 /* Statistics. */
-static int trymove_counter = 0;
+static THREAD_LOCAL int trymove_counter = 0;
 
 /* Coordinates for the eight directions, ordered
  * south, west, north, east, southwest, northwest, northeast, southeast.
@@ -479,10 +479,10 @@ test_gray_border(void)
  * position and which color made them. Perhaps 
  * this should be one array of a structure 
  */
-static int stack[MAXSTACK];
-static int move_color[MAXSTACK];
+static THREAD_LOCAL int stack[MAXSTACK];
+static THREAD_LOCAL int move_color[MAXSTACK];
 
-static Hash_data board_hash_stack[MAXSTACK];
+static THREAD_LOCAL Hash_data board_hash_stack[MAXSTACK];
 
 /*
  * trymove pushes the position onto the stack, and makes a move
@@ -1779,7 +1779,7 @@ struct board_cache_entry {
 
 
 /* approxlib() cache. */
-static struct board_cache_entry approxlib_cache[BOARDMAX][2];
+static THREAD_LOCAL struct board_cache_entry approxlib_cache[BOARDMAX][2];
 
 
 /* Clears approxlib() cache. This function should be called only once
@@ -2071,7 +2071,7 @@ slow_approxlib(int pos, int color, int maxlib, int *libs)
 
 
 /* accuratelib() cache. */
-static struct board_cache_entry accuratelib_cache[BOARDMAX][2];
+static THREAD_LOCAL struct board_cache_entry accuratelib_cache[BOARDMAX][2];
 
 
 /* Clears accuratelib() cache. This function should be called only once
@@ -3235,9 +3235,9 @@ get_move_from_stack(int k, int *move, int *color)
 int
 stones_on_board(int color)
 {
-  static int stone_count_for_position = -1;
-  static int white_stones = 0;
-  static int black_stones = 0;
+  static THREAD_LOCAL int stone_count_for_position = -1;
+  static THREAD_LOCAL int white_stones = 0;
+  static THREAD_LOCAL int black_stones = 0;
 
   gg_assert(stackp == 0);
 
@@ -3279,6 +3279,14 @@ get_trymove_counter()
 }
 
 
+/* Add moves counted elsewhere, e.g. in a worker process. */
+void
+add_trymove_counter(int count)
+{
+  trymove_counter += count;
+}
+
+
 /* ================================================================ */
 /*                      Lower level functions                       */
 /* ================================================================ */
@@ -26,6 +26,7 @@
 
 #include <stdarg.h>
 #include "config.h"
+#include "gg_utils.h"
 #include "sgftree.h"
 #include "winsocket.h"
 
@@ -184,26 +185,26 @@ const char *color_to_string(int color);
 /* ================================================================ */
 
 /* The board and the other parameters deciding the current position. */
-extern int          board_size;             /* board size (usually 19) */
-extern Intersection board[BOARDSIZE];       /* go board */
-extern int          board_ko_pos;
-extern int          black_captured;   /* num. of black stones captured */
-extern int          white_captured;
-
-extern Intersection initial_board[BOARDSIZE];
-extern int          initial_board_ko_pos;
-extern int          initial_white_captured;
-extern int          initial_black_captured;
-extern int          move_history_color[MAX_MOVE_HISTORY];
-extern int          move_history_pos[MAX_MOVE_HISTORY];
-extern Hash_data    move_history_hash[MAX_MOVE_HISTORY];
-extern int          move_history_pointer;
-
-extern float        komi;
-extern int          handicap;     /* used internally in chinese scoring */
-extern int          movenum;      /* movenumber - used for debug output */
+extern THREAD_LOCAL int          board_size;             /* board size (usually 19) */
+extern THREAD_LOCAL Intersection board[BOARDSIZE];       /* go board */
+extern THREAD_LOCAL int          board_ko_pos;
+extern THREAD_LOCAL int          black_captured;   /* num. of black stones captured */
+extern THREAD_LOCAL int          white_captured;
+
+extern THREAD_LOCAL Intersection initial_board[BOARDSIZE];
+extern THREAD_LOCAL int          initial_board_ko_pos;
+extern THREAD_LOCAL int          initial_white_captured;
+extern THREAD_LOCAL int          initial_black_captured;
+extern THREAD_LOCAL int          move_history_color[MAX_MOVE_HISTORY];
+extern THREAD_LOCAL int          move_history_pos[MAX_MOVE_HISTORY];
+extern THREAD_LOCAL Hash_data    move_history_hash[MAX_MOVE_HISTORY];
+extern THREAD_LOCAL int          move_history_pointer;
+
+extern THREAD_LOCAL float        komi;
+extern THREAD_LOCAL int          handicap;     /* used internally in chinese scoring */
+extern THREAD_LOCAL int          movenum;      /* movenumber - used for debug output */
 		    
-extern signed char  shadow[BOARDMAX];      /* reading tree shadow */
+extern THREAD_LOCAL signed char  shadow[BOARDMAX];      /* reading tree shadow */
 
 enum suicide_rules {
   FORBIDDEN,
@@ -221,9 +222,9 @@ enum ko_rules {
 extern enum ko_rules ko_rule;
 
 
-extern int stackp;                /* stack pointer */
-extern int count_variations;      /* count (decidestring) */
-extern SGFTree *sgf_dumptree;
+extern THREAD_LOCAL int stackp;                /* stack pointer */
+extern THREAD_LOCAL int count_variations;      /* count (decidestring) */
+extern THREAD_LOCAL SGFTree *sgf_dumptree;
 
 
 /* This struct holds the internal board state. */
@@ -252,7 +253,7 @@ struct board_state {
 /* This is increased by one anytime a move is (permanently) played or
  * the board is cleared.
  */
-extern int position_number;
+extern THREAD_LOCAL int position_number;
 
 /* ================================================================ */
 /*                        board.c functions                         */
@@ -295,6 +296,7 @@ void do_dump_stack(void);
 
 void reset_trymove_counter(void);
 int get_trymove_counter(void);
+void add_trymove_counter(int count);
 
 /* move properties */
 int is_pass(int pos);
@@ -412,7 +414,7 @@ struct stats_data {
                                  /* with sufficient remaining depth. */
 };
 
-extern struct stats_data stats;
+extern THREAD_LOCAL struct stats_data stats;
 
 
 /* printutils.c */
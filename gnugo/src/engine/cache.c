@@ -30,6 +30,10 @@
 #include <limits.h>
 #include <string.h>
 
+#if ENGINE_THREADS
+#include <pthread.h>
+#endif
+
 #include "liberty.h"
 #include "cache.h"
 #include "sgftree.h"
@@ -43,7 +47,18 @@ static void tt_init(Transposition_table *table, int memsize);
 static void tt_clear(Transposition_table *table);
 
 /* The transposition table itself. */
-Transposition_table ttable;
+THREAD_LOCAL Transposition_table ttable;
+
+/* Statistics per reading routine, see reading_cache_show_stats(). */
+struct tt_routine_stats {
+  int lookups;      /* Calls to tt_get(). */
+  int hits;         /* Lookups which found the position. */
+  int stores;       /* Calls to tt_update(). */
+  int overwrites;   /* Stores replacing a result for the same position. */
+  int collisions;   /* Stores evicting the result of another position. */
+};
+
+static THREAD_LOCAL struct tt_routine_stats tt_stats[NUM_CACHE_ROUTINES];
 
 
 /* Arrays with random numbers for Zobrist hashing of input data (other
@@ -85,54 +100,184 @@ calculate_hashval_for_tt(Hash_data *hashdata, int routine, int target1,
 
 
 /* Initialize the transposition table. Non-positive memsize means use
- * the default size of DEFAULT_NUMBER_OF_CACHE_ENTRIES entries.
+ * the default size of DEFAULT_NUMBER_OF_CACHE_BUCKETS buckets.
  */
 
 static void
 tt_init(Transposition_table *table, int memsize)
 {
-  int num_entries;
+  int num_buckets;
+  size_t alignment = sizeof(Hashbucket);
  
   /* Make sure the hash system is initialized. */
   hash_init();
   keyhash_init();
 
   if (memsize > 0)
-    num_entries = memsize / sizeof(table->entries[0]);
+    num_buckets = memsize / sizeof(table->buckets[0]);
   else
-    num_entries = DEFAULT_NUMBER_OF_CACHE_ENTRIES;
+    num_buckets = DEFAULT_NUMBER_OF_CACHE_BUCKETS;
 
-  table->num_entries = num_entries;
-  table->entries     = malloc(num_entries * sizeof(table->entries[0]));
+  /* Align the buckets to their size, so that each bucket lies within
+   * one cache line.
+   */
+  table->num_buckets = num_buckets;
+  table->memory      = malloc(num_buckets * sizeof(table->buckets[0])
+			      + alignment);
 
-  if (table->entries == NULL) {
+  if (table->memory == NULL) {
     perror("Couldn't allocate memory for transposition table. \n");
     exit(1);
   }
 
+  table->buckets = (Hashbucket *) ((char *) table->memory + alignment
+				   - (size_t) table->memory % alignment);
+  table->owner = table;
+  table->is_shared = 0;
+  table->generation = 0;
   table->is_clean = 0;
   tt_clear(table);
 }
 
 
-/* Clear the transposition table. */
+/* Clear the transposition table. A shared table is only wiped when
+ * its generation number wraps around. Until then other threads may
+ * keep using it, and its results stay in place as an older
+ * generation.
+ */
 
 static void
 tt_clear(Transposition_table *table)
 {
+  if (table->owner != table)
+    return;
+
+  if (table->is_shared) {
+    table->generation = (table->generation + 1) & HN_MAX_GENERATION;
+    if (table->generation != 0)
+      return;
+    table->is_clean = 0;
+  }
+
   if (!table->is_clean) {
-    memset(table->entries, 0, table->num_entries * sizeof(table->entries[0]));
+    memset(table->buckets, 0, table->num_buckets * sizeof(table->buckets[0]));
     table->is_clean = 1;
   }
 }
  
  
-/* Free the transposition table. */
+/* Free the transposition table, or detach it from the table it
+ * shares.
+ */
 
 void
 tt_free(Transposition_table *table)
 {
-  free(table->entries);
+  if (table->owner == table)
+    free(table->memory);
+  table->memory = NULL;
+  table->buckets = NULL;
+  table->num_buckets = 0;
+  table->owner = NULL;
+}
+
+
+/* Attach table to the buckets of shared, freeing its own. Several
+ * threads can attach to the same table and then see each other's
+ * results. The owner of shared must not free it until all of them
+ * are done, and only the owner's thread may clear it.
+ */
+
+void
+tt_share(Transposition_table *table, Transposition_table *shared)
+{
+  gg_assert(shared->owner == shared);
+  if (table == shared)
+    return;
+
+  tt_free(table);
+  table->num_buckets = shared->num_buckets;
+  table->buckets = shared->buckets;
+  table->owner = shared;
+  table->is_clean = 0;
+  shared->is_shared = 1;
+  shared->is_clean = 0;
+}
+
+
+/* Find the node for hashval from the current generation in a bucket.
+ * Return its data in *data, or NULL if it's not there.
+ *
+ * Other threads may be writing the bucket, so every field is read
+ * once, and a node whose key words do not all match its data is
+ * ignored.
+ */
+
+static Hashnode *
+tt_find_node(Transposition_table *table, Hashbucket *bucket,
+	     Hash_data *hashval, unsigned int *data)
+{
+  unsigned int generation = table->owner->generation;
+  int k;
+  int i;
+
+  for (k = 0; k < HN_PER_BUCKET; k++) {
+    volatile Hashnode *node = &bucket->nodes[k];
+    unsigned int node_data = node->data;
+
+    for (i = 0; i < NUM_HASHVALUES; i++)
+      if ((node->key.hashval[i] ^ node_data) != hashval->hashval[i])
+	break;
+    if (i == NUM_HASHVALUES
+	&& hn_get_generation(node_data) == generation) {
+      *data = node_data;
+      return (Hashnode *) node;
+    }
+  }
+
+  return NULL;
+}
+
+
+/* Store data for hashval in a node. */
+
+static void
+tt_store_node(Hashnode *node, Hash_data *hashval, unsigned int data)
+{
+  volatile Hashnode *volatile_node = node;
+  int i;
+
+  volatile_node->data = data;
+  for (i = 0; i < NUM_HASHVALUES; i++)
+    volatile_node->key.hashval[i] = hashval->hashval[i] ^ data;
+}
+
+
+/* How valuable the result in a node is. Free nodes come first, then
+ * results from older generations, and within a generation results
+ * which are cheap to recompute, i.e. from tactical reading or with
+ * little remaining depth.
+ */
+
+static int
+tt_node_value(Transposition_table *table, Hashnode *node)
+{
+  volatile Hashnode *volatile_node = node;
+  unsigned int data = volatile_node->data;
+  int k;
+
+  if (data == 0) {
+    for (k = 0; k < NUM_HASHVALUES; k++)
+      if (volatile_node->key.hashval[k] != 0)
+	break;
+    if (k == NUM_HASHVALUES)
+      return -1;
+  }
+
+  if (hn_get_generation(data) != table->owner->generation)
+    return (int) hn_get_total_cost(data);
+
+  return (int) hn_get_total_cost(data) + 512;
 }
 
 
@@ -151,8 +296,8 @@ tt_get(Transposition_table *table,
        int *value1, int *value2, int *move)
 {
   Hash_data hashval;
-  Hashentry *entry;
-  Hashnode *node;
+  Hashbucket *bucket;
+  unsigned int data;
  
   /* Sanity check. */
   if (remaining_depth < 0 || remaining_depth > HN_MAX_REMAINING_DEPTH)
@@ -161,28 +306,29 @@ tt_get(Transposition_table *table,
   /* Get the combined hash value. */
   calculate_hashval_for_tt(&hashval, routine, target1, target2, extra_hash);
 
-  /* Get the correct entry and node. */
-  entry = &table->entries[hashdata_remainder(hashval, table->num_entries)];
-  if (hashdata_is_equal(hashval, entry->deepest.key))
-    node = &entry->deepest;
-  else if (hashdata_is_equal(hashval, entry->newest.key))
-    node = &entry->newest;
-  else
+  /* Get the correct bucket and node. */
+  tt_stats[routine].lookups++;
+  bucket = &table->buckets[hashdata_remainder(hashval, table->num_buckets)];
+  if (tt_find_node(table, bucket, &hashval, &data) == NULL) {
+    profile_cache_lookup(routine, 0, 0);
     return 0;
+  }
 
+  profile_cache_lookup(routine, 0, 1);
   stats.read_result_hits++;
+  tt_stats[routine].hits++;
 
   /* Return data.  Only set the result if remaining depth in the table
    * is big enough to be trusted.  The move can always be used for move
    * ordering if nothing else.
    */
   if (move)
-    *move = hn_get_move(node->data);
-  if (remaining_depth <= (int) hn_get_remaining_depth(node->data)) {
+    *move = hn_get_move(data);
+  if (remaining_depth <= (int) hn_get_remaining_depth(data)) {
     if (value1)
-      *value1 = hn_get_value1(node->data);
+      *value1 = hn_get_value1(data);
     if (value2)
-      *value2 = hn_get_value2(node->data);
+      *value2 = hn_get_value2(data);
     stats.trusted_read_result_hits++;
     return 2;
   }
@@ -191,7 +337,10 @@ tt_get(Transposition_table *table,
 }
 
 
-/* Update a transposition table entry.
+/* Update a transposition table entry. A result for the same position
+ * is only overwritten if the new one has been read at least as deep.
+ * Otherwise the least valuable node of the bucket is replaced, see
+ * tt_node_value().
  */
 
 void
@@ -201,10 +350,11 @@ tt_update(Transposition_table *table,
 	  int value1, int value2, int move)
 {
   Hash_data hashval;
-  Hashentry *entry;
-  Hashnode *deepest;
-  Hashnode *newest;
+  Hashbucket *bucket;
+  Hashnode *node;
   unsigned int data;
+  unsigned int old_data;
+  int k;
   /* Get routine costs definitions from liberty.h. */
   static const int routine_costs[] = { ROUTINE_COSTS };
   gg_assert(routine_costs[NUM_CACHE_ROUTINES] == -1);
@@ -216,51 +366,36 @@ tt_update(Transposition_table *table,
   /* Get the combined hash value. */
   calculate_hashval_for_tt(&hashval, routine, target1, target2, extra_hash);
 
-  data = hn_create_data(remaining_depth, value1, value2, move,
-      		        routine_costs[routine]);
+  data = hn_create_data(table->owner->generation, remaining_depth,
+			value1, value2, move, routine_costs[routine]);
 
-  /* Get the entry and nodes. */ 
-  entry = &table->entries[hashdata_remainder(hashval, table->num_entries)];
-  deepest = &entry->deepest;
-  newest  = &entry->newest;
+  tt_stats[routine].stores++;
+  bucket = &table->buckets[hashdata_remainder(hashval, table->num_buckets)];
  
   /* See if we found an already existing node. */
-  if (hashdata_is_equal(hashval, deepest->key)
-      && remaining_depth >= (int) hn_get_remaining_depth(deepest->data)) {
-
-    /* Found deepest */
-    deepest->data = data;
-
-  }
-  else if (hashdata_is_equal(hashval, newest->key)
-           && remaining_depth >= (int) hn_get_remaining_depth(newest->data)) {
-
-    /* Found newest */
-    newest->data = data;
-
-    /* If newest has become deeper than deepest, then switch them. */
-    if (hn_get_remaining_depth(newest->data)
-	> hn_get_remaining_depth(deepest->data)) {
-      Hashnode temp;
-
-      temp = *deepest;
-      *deepest = *newest;
-      *newest = temp;
-    }
-
+  node = tt_find_node(table, bucket, &hashval, &old_data);
+  if (node != NULL) {
+    if (remaining_depth < (int) hn_get_remaining_depth(old_data))
+      return;
+    tt_stats[routine].overwrites++;
   }
-  else if (hn_get_total_cost(data) > hn_get_total_cost(deepest->data)) {
-    if (hn_get_total_cost(newest->data) < hn_get_total_cost(deepest->data))
-      *newest = *deepest;
-    deepest->key  = hashval;
-    deepest->data = data;
-  } 
   else {
-    /* Replace newest. */
-    newest->key  = hashval;
-    newest->data = data;
+    /* Replace the least valuable node. */
+    int value;
+    int least_value = INT_MAX;
+    for (k = 0; k < HN_PER_BUCKET; k++) {
+      value = tt_node_value(table, &bucket->nodes[k]);
+      if (value < least_value) {
+	least_value = value;
+	node = &bucket->nodes[k];
+      }
+    }
+    if (least_value >= 0)
+      tt_stats[routine].collisions++;
   }
 
+  tt_store_node(node, &hashval, data);
+
   stats.read_result_entered++;
   table->is_clean = 0;
 }
@@ -290,6 +425,76 @@ reading_cache_init(int bytes)
 }
 
 
+/* Reset the statistics of the cache for read results. */
+void
+reading_cache_clear_stats()
+{
+  memset(tt_stats, 0, sizeof(tt_stats));
+}
+
+
+/* Write the statistics of the cache for read results to (outfile),
+ * to be added by reading_cache_merge_stats() in another process.
+ */
+void
+reading_cache_save_stats(FILE *outfile)
+{
+  fwrite(tt_stats, sizeof(tt_stats), 1, outfile);
+}
+
+
+/* Add the statistics written by reading_cache_save_stats(). Return 0
+ * if the input is truncated.
+ */
+int
+reading_cache_merge_stats(FILE *infile)
+{
+  struct tt_routine_stats other[NUM_CACHE_ROUTINES];
+  int k;
+
+  if (fread(other, sizeof(other), 1, infile) != 1)
+    return 0;
+
+  for (k = 0; k < NUM_CACHE_ROUTINES; k++) {
+    tt_stats[k].lookups += other[k].lookups;
+    tt_stats[k].hits += other[k].hits;
+    tt_stats[k].stores += other[k].stores;
+    tt_stats[k].overwrites += other[k].overwrites;
+    tt_stats[k].collisions += other[k].collisions;
+  }
+
+  return 1;
+}
+
+
+/* Print the statistics of the cache for read results, for each
+ * routine which has used it.
+ */
+void
+reading_cache_show_stats()
+{
+  int k;
+
+  fprintf(stderr, "%-24s %9s %9s %9s %9s %9s\n", "Read results by routine:",
+	  "lookups", "hits", "stores", "overwrite", "collision");
+  for (k = 0; k < NUM_CACHE_ROUTINES; k++) {
+    if (tt_stats[k].lookups == 0 && tt_stats[k].stores == 0)
+      continue;
+    fprintf(stderr, "  %-22s %9d %9d %9d %9d %9d\n", routine_names[k],
+	    tt_stats[k].lookups, tt_stats[k].hits, tt_stats[k].stores,
+	    tt_stats[k].overwrites, tt_stats[k].collisions);
+  }
+}
+
+
+/* Free the cache for read results. */
+void
+reading_cache_free()
+{
+  tt_free(&ttable);
+}
+
+
 /* Clear the cache for read results. */
 void
 reading_cache_clear()
@@ -300,10 +505,182 @@ reading_cache_clear()
 float
 reading_cache_default_size()
 {
-  return DEFAULT_NUMBER_OF_CACHE_ENTRIES * sizeof(Hashentry) / 1024.0 / 1024.0;
+  return DEFAULT_NUMBER_OF_CACHE_BUCKETS * sizeof(Hashbucket) / 1024.0 / 1024.0;
+}
+
+
+/* Size in megabytes of the cache for read results of this thread. */
+float
+reading_cache_size()
+{
+  return ttable.num_buckets * sizeof(Hashbucket) / 1024.0 / 1024.0;
 }
 
 
+#if ENGINE_THREADS
+
+/* The made-up results of reading_cache_threads_check() are stored for
+ * TT_CHECK_KEYS keys in a table of only TT_CHECK_BUCKETS buckets, so
+ * that the threads keep overwriting each other's nodes.
+ */
+#define TT_CHECK_KEYS       8192
+#define TT_CHECK_BUCKETS    64
+#define TT_CHECK_ROUNDS     40
+#define TT_CHECK_DEPTH      5
+#define MAX_TT_CHECK_THREADS 64
+
+/* A thread of reading_cache_threads_check(). */
+struct tt_check_job {
+  Transposition_table *shared;
+  int num_threads;
+  int thread_number;
+  int num_stores;
+  unsigned int seed;
+  int last_key;      /* Last key stored in the previous round, or -1. */
+  int lookups;
+  int hits;
+  int stale;
+  int mismatches;
+  pthread_t thread;
+};
+
+/* The position and the made-up result for key. */
+static void
+tt_check_key(int key, enum routine_id *routine, int *target1, int *target2,
+	     int *value1, int *value2, int *move)
+{
+  unsigned int mix = (unsigned int) key * 2654435761U;
+
+  *routine = key % NUM_CACHE_ROUTINES;
+  *target1 = (key / NUM_CACHE_ROUTINES) % (BOARDMAX);
+  *target2 = key / (NUM_CACHE_ROUTINES * (BOARDMAX)) + 1;
+  *value1 = (mix >> 28) & 0x0f;
+  *value2 = (mix >> 24) & 0x0f;
+  *move = (mix >> 14) & 0x3ff;
+}
+
+/* A key which only this thread uses. */
+static int
+tt_check_next_key(struct tt_check_job *job)
+{
+  job->seed = job->seed * 1103515245U + 12345U;
+  return ((job->seed >> 16) % (TT_CHECK_KEYS / job->num_threads)
+	  * job->num_threads + job->thread_number);
+}
+
+static void *
+tt_check_main(void *data)
+{
+  struct tt_check_job *job = data;
+  enum routine_id routine;
+  int target1, target2;
+  int value1, value2, move;
+  int found1, found2, found_move;
+  int key;
+  int k;
+
+  tt_share(&ttable, job->shared);
+
+  /* The table has been cleared since the last round. */
+  if (job->last_key >= 0) {
+    tt_check_key(job->last_key, &routine, &target1, &target2,
+		 &value1, &value2, &move);
+    if (tt_get(&ttable, routine, target1, target2, TT_CHECK_DEPTH, NULL,
+	       NULL, NULL, NULL) != 0)
+      job->stale++;
+  }
+
+  for (k = 0; k < job->num_stores; k++) {
+    key = tt_check_next_key(job);
+    tt_check_key(key, &routine, &target1, &target2, &value1, &value2, &move);
+    tt_update(&ttable, routine, target1, target2, TT_CHECK_DEPTH, NULL,
+	      value1, value2, move);
+    job->last_key = key;
+
+    key = tt_check_next_key(job);
+    tt_check_key(key, &routine, &target1, &target2, &value1, &value2, &move);
+    job->lookups++;
+    if (tt_get(&ttable, routine, target1, target2, TT_CHECK_DEPTH, NULL,
+	       &found1, &found2, &found_move) == 2) {
+      job->hits++;
+      if (found1 != value1 || found2 != value2 || found_move != move)
+	job->mismatches++;
+    }
+  }
+
+  tt_free(&ttable);
+  return NULL;
+}
+
+
+/* Check that num_threads threads can share a transposition table.
+ * Each of them stores and looks up made-up results, num_stores of
+ * each per round, in one small table. The table is cleared between
+ * rounds, often enough for its generation number to wrap around.
+ *
+ * Return the number of lookups which found a wrong result, which
+ * should always be 0, or -1 if a thread could not be started. The
+ * number of lookups and hits is returned in *lookups and *hits, and
+ * the number of results found again after the table was cleared in
+ * *stale, which should also be 0.
+ */
+int
+reading_cache_threads_check(int num_threads, int num_stores,
+			    int *lookups, int *hits, int *stale)
+{
+  Transposition_table shared;
+  struct tt_check_job jobs[MAX_TT_CHECK_THREADS];
+  int mismatches = 0;
+  int round;
+  int k;
+
+  if (num_threads < 1)
+    num_threads = 1;
+  if (num_threads > MAX_TT_CHECK_THREADS)
+    num_threads = MAX_TT_CHECK_THREADS;
+
+  tt_init(&shared, TT_CHECK_BUCKETS * sizeof(Hashbucket));
+  memset(jobs, 0, sizeof(jobs));
+  for (k = 0; k < num_threads; k++) {
+    jobs[k].shared = &shared;
+    jobs[k].num_threads = num_threads;
+    jobs[k].thread_number = k;
+    jobs[k].num_stores = num_stores;
+    jobs[k].seed = k + 1;
+    jobs[k].last_key = -1;
+  }
+
+  for (round = 0; round < TT_CHECK_ROUNDS; round++) {
+    for (k = 0; k < num_threads; k++)
+      if (pthread_create(&jobs[k].thread, NULL, tt_check_main,
+			 &jobs[k]) != 0) {
+	while (--k >= 0)
+	  pthread_join(jobs[k].thread, NULL);
+	tt_free(&shared);
+	return -1;
+      }
+    for (k = 0; k < num_threads; k++)
+      pthread_join(jobs[k].thread, NULL);
+    tt_clear(&shared);
+  }
+
+  *lookups = 0;
+  *hits = 0;
+  *stale = 0;
+  for (k = 0; k < num_threads; k++) {
+    *lookups += jobs[k].lookups;
+    *hits += jobs[k].hits;
+    *stale += jobs[k].stale;
+    mismatches += jobs[k].mismatches;
+  }
+
+  tt_free(&shared);
+  return mismatches;
+}
+
+#endif
+
+
 /* Write reading trace data to an SGF file. Normally called through the
  * macro SGFTRACE in cache.h.
  */
@@ -48,7 +48,7 @@
  * The data field packs into 32 bits the following
  * fields:
  *
- *   RESERVED       :  5 bits
+ *   generation     :  5 bits
  *   value1         :  4 bits
  *   value2         :  4 bits
  *   move           : 10 bits
@@ -56,6 +56,10 @@
  *   remaining_depth:  5 bits (depth - stackp)  NOTE: HN_MAX_REMAINING_DEPTH
  *
  *   The last 9 bits together give an index for the total costs.
+ *
+ * Every word of the key is stored xored with the data. A node which
+ * another thread has only half written therefore fails to match, so
+ * several threads can share a table without locking.
  */
 typedef struct {
   Hash_data key;
@@ -63,16 +67,20 @@ typedef struct {
 } Hashnode;
 
 #define HN_MAX_REMAINING_DEPTH 31
+#define HN_MAX_GENERATION      31
 
 
-/* Hashentry: an entry, with two nodes of the hash_table
+/* Hashbucket: the nodes which share one hash index. With 64 bit hash
+ * values a bucket fills one 64 byte cache line.
  */
+#define HN_PER_BUCKET 4
+
 typedef struct {
-  Hashnode deepest;
-  Hashnode newest;
-} Hashentry;
+  Hashnode nodes[HN_PER_BUCKET];
+} Hashbucket;
 
 /* Hn is for hash node. */
+#define hn_get_generation(hn)       ((hn >> 27) & 0x1f)
 #define hn_get_value1(hn)           ((hn >> 23) & 0x0f)
 #define hn_get_value2(hn)           ((hn >> 19) & 0x0f)
 #define hn_get_move(hn)             ((hn >>  9) & 0x3ff)
@@ -80,29 +88,44 @@ typedef struct {
 #define hn_get_remaining_depth(hn)  ((hn >>  0) & 0x1f)
 #define hn_get_total_cost(hn)       ((hn >>  0) & 0x1ff)
 
-#define hn_create_data(remaining_depth, value1, value2, move, cost) \
-    ((((value1)         & 0x0f)  << 23) \
+#define hn_create_data(generation, remaining_depth, value1, value2, \
+		       move, cost) \
+    ((((generation)     & 0x1f)  << 27) \
+   | (((value1)         & 0x0f)  << 23) \
    | (((value2)         & 0x0f)  << 19) \
    | (((move)           & 0x3ff) <<  9) \
    | (((cost)           & 0x0f)  <<  5) \
    | (((remaining_depth & 0x1f)  <<  0)))
 
 
-/* Transposition_table: transposition table used for caching. */
-typedef struct {
-  unsigned int num_entries;
-  Hashentry *entries;
+/* Transposition_table: transposition table used for caching.
+ *
+ * A table is either owned, when its buckets were allocated by
+ * tt_init(), or attached to the buckets of another table with
+ * tt_share(). Only the owner clears and frees the buckets. Once it is
+ * shared, clearing it starts a new generation instead of wiping it.
+ * Results from older generations are not found again and are the
+ * first to be replaced.
+ */
+typedef struct transposition_table {
+  unsigned int num_buckets;
+  Hashbucket *buckets;
+  void *memory;          /* Allocation holding the aligned buckets. */
+  struct transposition_table *owner; /* The table itself if it's the owner. */
+  int is_shared;
   int is_clean;
+  volatile unsigned int generation; /* Only used in the owner. */
 } Transposition_table;
 
-extern Transposition_table ttable;
+extern THREAD_LOCAL Transposition_table ttable;
 
-/* Number of cache entries to use by default if no cache memory usage
+/* Number of cache buckets to use by default if no cache memory usage
  * has been set explicitly.
  */
-#define DEFAULT_NUMBER_OF_CACHE_ENTRIES 350000
+#define DEFAULT_NUMBER_OF_CACHE_BUCKETS 175000
 
 void tt_free(Transposition_table *table);
+void tt_share(Transposition_table *table, Transposition_table *shared);
 int  tt_get(Transposition_table *table, enum routine_id routine,
 	    int target1, int target2, int remaining_depth,
 	    Hash_data *extra_hash,
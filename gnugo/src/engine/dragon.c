@@ -48,6 +48,12 @@
 #include <string.h>
 #include <ctype.h>
 
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "liberty.h"
 #include "gg_utils.h"
 
@@ -72,16 +78,21 @@ static enum dragon_status compute_crude_status(int pos);
 static int compute_escape(int pos, int dragon_status_known);
 static void compute_surrounding_moyo_sizes(const struct influence_data *q);
 static void clear_cut_list(void);
+static void compute_owl_status(int str);
+#ifdef HAVE_FORK
+static void read_owl_status(int str, FILE *output);
+static void compute_owl_status_in_parallel(int dragons[], int num_dragons);
+#endif
 
-static int dragon2_initialized;
-static int lively_white_dragons;
-static int lively_black_dragons;
+static THREAD_LOCAL int dragon2_initialized;
+static THREAD_LOCAL int lively_white_dragons;
+static THREAD_LOCAL int lively_black_dragons;
 
 /* This is a private array to obtain a list of worms belonging to each
  * dragon. Public access is via first_worm_in_dragon() and
  * next_worm_in_dragon().
  */
-static int next_worm_list[BOARDMAX];
+static THREAD_LOCAL int next_worm_list[BOARDMAX];
 
 /* Alternative for DRAGON2 macro with asserts. */
 struct dragon_data2 *
@@ -107,6 +118,9 @@ make_dragons(int stop_before_owl)
 {
   int str;
   int d;
+  int k;
+  int owl_dragons[BOARDMAX];
+  int num_owl_dragons = 0;
 
   dragon2_initialized = 0;
   initialize_dragon_data();
@@ -195,8 +209,6 @@ make_dragons(int stop_before_owl)
   start_timer(2);
   for (str = BOARDMIN; str < BOARDMAX; str++)
     if (ON_BOARD(str)) {
-      int attack_point = NO_MOVE;
-      int defense_point = NO_MOVE;
       struct eyevalue no_eyes;
       set_eyevalue(&no_eyes, 0, 0, 0, 0);
       
@@ -213,83 +225,20 @@ make_dragons(int stop_before_owl)
 	DRAGON2(str).owl_attack_point  = NO_MOVE;
 	DRAGON2(str).owl_defense_point = NO_MOVE;
       }
-      else {
-	int acode = 0;
-	int dcode = 0;
-	int kworm = NO_MOVE;
-	int owl_nodes_before = get_owl_node_counter();
-	start_timer(3);
-	acode = owl_attack(str, &attack_point, 
-			   &DRAGON2(str).owl_attack_certain, &kworm);
-	DRAGON2(str).owl_attack_node_count
-	  = get_owl_node_counter() - owl_nodes_before;
-	if (acode != 0) {
-	  DRAGON2(str).owl_attack_point = attack_point;
-	  DRAGON2(str).owl_attack_code = acode;
-	  DRAGON2(str).owl_attack_kworm = kworm;
-	  if (attack_point != NO_MOVE) {
-	    kworm = NO_MOVE;
-	    dcode = owl_defend(str, &defense_point,
-			       &DRAGON2(str).owl_defense_certain, &kworm);
-	    if (dcode != 0) {
-	      if (defense_point != NO_MOVE) {
-		DRAGON2(str).owl_status = (acode == GAIN ? ALIVE : CRITICAL);
-		DRAGON2(str).owl_defense_point = defense_point;
-		DRAGON2(str).owl_defense_code = dcode;
-		DRAGON2(str).owl_defense_kworm = kworm;
-	      }
-	      else {
-		/* Due to irregularities in the owl code, it may
-		 * occasionally happen that a dragon is found to be
-		 * attackable but also alive as it stands. In this case
-		 * we still choose to say that the owl_status is
-		 * CRITICAL, although we don't have any defense move to
-		 * propose. Having the status right is important e.g.
-		 * for connection moves to be properly valued.
-		 */
-		DRAGON2(str).owl_status = (acode == GAIN ? ALIVE : CRITICAL);
-		DEBUG(DEBUG_OWL_PERFORMANCE,
-		      "Inconsistent owl attack and defense results for %1m.\n", 
-		      str);
-		/* Let's see whether the attacking move might be the right
-		 * defense:
-		 */
-		dcode = owl_does_defend(DRAGON2(str).owl_attack_point,
-					str, NULL);
-		if (dcode != 0) {
-		  DRAGON2(str).owl_defense_point
-		    = DRAGON2(str).owl_attack_point;
-		  DRAGON2(str).owl_defense_code = dcode;
-		}
-	      }
-	    }
-	  }
-	  if (dcode == 0) {
-	    DRAGON2(str).owl_status = DEAD; 
-	    DRAGON2(str).owl_defense_point = NO_MOVE;
-	    DRAGON2(str).owl_defense_code = 0;
-	  }
-	}
-	else {
-	  if (!DRAGON2(str).owl_attack_certain) {
-	    kworm = NO_MOVE;
-	    dcode = owl_defend(str, &defense_point, 
-			       &DRAGON2(str).owl_defense_certain, &kworm);
-	    if (dcode != 0) {
-	      /* If the result of owl_attack was not certain, we may
-	       * still want the result of owl_defend */
-	      DRAGON2(str).owl_defense_point = defense_point;
-	      DRAGON2(str).owl_defense_code = dcode;
-	      DRAGON2(str).owl_defense_kworm = kworm;
-	    }
-	  }
-	  DRAGON2(str).owl_status = ALIVE;
-	  DRAGON2(str).owl_attack_point = NO_MOVE;
-	  DRAGON2(str).owl_attack_code = 0;
-	  
-	}
-      }
+      else
+	owl_dragons[num_owl_dragons++] = str;
     }
+
+#ifdef HAVE_FORK
+  /* The reading trees of the workers cannot be merged into the sgf
+   * trace, so it is made sequentially.
+   */
+  if (reading_jobs > 1 && num_owl_dragons > 1 && sgf_dumptree == NULL)
+    compute_owl_status_in_parallel(owl_dragons, num_owl_dragons);
+  else
+#endif
+    for (k = 0; k < num_owl_dragons; k++)
+      compute_owl_status(owl_dragons[k]);
   time_report(2, "  owl reading", NO_MOVE, 1.0);
   
   /* Compute the status to be used by the matcher. We most trust the
@@ -435,6 +384,299 @@ make_dragons(int stop_before_owl)
 }
 
 
+/* Determine the owl status of the dragon at (str), with owl attack
+ * and defense points.
+ */
+static void
+compute_owl_status(int str)
+{
+  int attack_point = NO_MOVE;
+  int defense_point = NO_MOVE;
+  int acode = 0;
+  int dcode = 0;
+  int kworm = NO_MOVE;
+  int owl_nodes_before = get_owl_node_counter();
+  start_timer(3);
+  acode = owl_attack(str, &attack_point, 
+		     &DRAGON2(str).owl_attack_certain, &kworm);
+  DRAGON2(str).owl_attack_node_count
+    = get_owl_node_counter() - owl_nodes_before;
+  if (acode != 0) {
+    DRAGON2(str).owl_attack_point = attack_point;
+    DRAGON2(str).owl_attack_code = acode;
+    DRAGON2(str).owl_attack_kworm = kworm;
+    if (attack_point != NO_MOVE) {
+      kworm = NO_MOVE;
+      dcode = owl_defend(str, &defense_point,
+			 &DRAGON2(str).owl_defense_certain, &kworm);
+      if (dcode != 0) {
+	if (defense_point != NO_MOVE) {
+	  DRAGON2(str).owl_status = (acode == GAIN ? ALIVE : CRITICAL);
+	  DRAGON2(str).owl_defense_point = defense_point;
+	  DRAGON2(str).owl_defense_code = dcode;
+	  DRAGON2(str).owl_defense_kworm = kworm;
+	}
+	else {
+	  /* Due to irregularities in the owl code, it may
+	   * occasionally happen that a dragon is found to be
+	   * attackable but also alive as it stands. In this case
+	   * we still choose to say that the owl_status is
+	   * CRITICAL, although we don't have any defense move to
+	   * propose. Having the status right is important e.g.
+	   * for connection moves to be properly valued.
+	   */
+	  DRAGON2(str).owl_status = (acode == GAIN ? ALIVE : CRITICAL);
+	  DEBUG(DEBUG_OWL_PERFORMANCE,
+		"Inconsistent owl attack and defense results for %1m.\n", 
+		str);
+	  /* Let's see whether the attacking move might be the right
+	   * defense:
+	   */
+	  dcode = owl_does_defend(DRAGON2(str).owl_attack_point,
+				  str, NULL);
+	  if (dcode != 0) {
+	    DRAGON2(str).owl_defense_point
+	      = DRAGON2(str).owl_attack_point;
+	    DRAGON2(str).owl_defense_code = dcode;
+	  }
+	}
+      }
+    }
+    if (dcode == 0) {
+      DRAGON2(str).owl_status = DEAD; 
+      DRAGON2(str).owl_defense_point = NO_MOVE;
+      DRAGON2(str).owl_defense_code = 0;
+    }
+  }
+  else {
+    if (!DRAGON2(str).owl_attack_certain) {
+      kworm = NO_MOVE;
+      dcode = owl_defend(str, &defense_point, 
+			 &DRAGON2(str).owl_defense_certain, &kworm);
+      if (dcode != 0) {
+	/* If the result of owl_attack was not certain, we may
+	 * still want the result of owl_defend */
+	DRAGON2(str).owl_defense_point = defense_point;
+	DRAGON2(str).owl_defense_code = dcode;
+	DRAGON2(str).owl_defense_kworm = kworm;
+      }
+    }
+    DRAGON2(str).owl_status = ALIVE;
+    DRAGON2(str).owl_attack_point = NO_MOVE;
+    DRAGON2(str).owl_attack_code = 0;
+
+  }
+}
+
+
+#ifdef HAVE_FORK
+
+/* Compute the owl status of the dragon at (str), starting from empty
+ * reading caches and the persistent caches of
+ * checkpoint_persistent_caches(). If (output) is not NULL, the dragon
+ * data and the new persistent cache entries are written to it.
+ * Otherwise the new entries are kept for commit_persistent_caches().
+ */
+static void
+read_owl_status(int str, FILE *output)
+{
+  reading_cache_clear();
+  clear_safe_move_cache();
+  compute_owl_status(str);
+  if (output)
+    fwrite(&DRAGON2(str), sizeof(struct dragon_data2), 1, output);
+  rollback_persistent_caches(output);
+}
+
+/* A worker process for compute_owl_status_in_parallel(). */
+struct owl_worker {
+  pid_t pid;
+  FILE *output;  /* Results written by the worker. */
+  int failed;
+  int next;      /* Index of the next result in output, or -1. */
+};
+
+/* Node counters of the worker, in this order. */
+#define NUM_OWL_WORKER_COUNTERS 4
+
+
+/* Take indices into (dragons) from the queue until it is empty and
+ * read the owl status of those dragons. For each dragon, the index,
+ * the dragon data and the new persistent cache entries are written
+ * to (output). It ends with the index -1, the node counters and the
+ * statistics of the worker.
+ */
+static void
+run_owl_worker(int dragons[], int queue, FILE *output)
+{
+  int counters[NUM_OWL_WORKER_COUNTERS];
+  int k;
+
+  reset_owl_node_counter();
+  reset_reading_node_counter();
+  reset_connection_node_counter();
+  reset_trymove_counter();
+  clearstats();
+  profile_clear();
+
+  while (read(queue, &k, sizeof(k)) == sizeof(k)) {
+    fwrite(&k, sizeof(k), 1, output);
+    read_owl_status(dragons[k], output);
+  }
+
+  k = -1;
+  fwrite(&k, sizeof(k), 1, output);
+  counters[0] = get_owl_node_counter();
+  counters[1] = get_reading_node_counter();
+  counters[2] = get_connection_node_counter();
+  counters[3] = get_trymove_counter();
+  fwrite(counters, sizeof(counters), 1, output);
+  save_stats(output);
+}
+
+
+/* Read the index of the next result of a worker. After the last one,
+ * add the node counters and statistics of the worker to ours.
+ */
+static void
+next_owl_worker_result(struct owl_worker *worker)
+{
+  int counters[NUM_OWL_WORKER_COUNTERS];
+
+  if (fread(&worker->next, sizeof(worker->next), 1, worker->output) != 1) {
+    worker->next = -1;
+    return;
+  }
+
+  if (worker->next == -1
+      && fread(counters, sizeof(counters), 1, worker->output) == 1) {
+    add_owl_node_counter(counters[0]);
+    add_reading_node_counter(counters[1]);
+    add_connection_node_counter(counters[2]);
+    add_trymove_counter(counters[3]);
+    merge_stats(worker->output);
+  }
+}
+
+
+/* Read the owl status of the dragons in (dragons) in up to
+ * reading_jobs worker processes, which take the dragons from a
+ * queue. Every dragon is read by read_owl_status() from the same
+ * caches, so the results do not depend on how many workers share the
+ * reading. The results are merged in the order of (dragons). A dragon
+ * whose worker failed is read here instead.
+ */
+static void
+compute_owl_status_in_parallel(int dragons[], int num_dragons)
+{
+  int num_workers = gg_min(reading_jobs, num_dragons);
+  struct owl_worker *workers;
+  int queue[2];
+  int running = 0;
+  int k;
+  int w;
+
+  workers = malloc(num_workers * sizeof(*workers));
+  if (!workers || pipe(queue) < 0) {
+    free(workers);
+    for (k = 0; k < num_dragons; k++)
+      compute_owl_status(dragons[k]);
+    return;
+  }
+
+  checkpoint_persistent_caches();
+
+  /* The queue is small enough to be filled at once, and is closed here
+   * so that the workers see its end.
+   */
+  for (k = 0; k < num_dragons; k++)
+    if (write(queue[1], &k, sizeof(k)) != sizeof(k))
+      break;
+  close(queue[1]);
+
+  /* Nothing buffered here may be written twice. */
+  fflush(NULL);
+
+  for (w = 0; w < num_workers; w++) {
+    struct owl_worker *worker = &workers[w];
+    worker->failed = 1;
+    worker->next = -1;
+    worker->pid = -1;
+    worker->output = tmpfile();
+    if (!worker->output)
+      continue;
+
+    worker->pid = fork();
+    if (worker->pid == 0) {
+      run_owl_worker(dragons, queue[0], worker->output);
+      _exit(fflush(worker->output) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    if (worker->pid > 0)
+      running++;
+  }
+  close(queue[0]);
+
+  while (running > 0) {
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0)
+      break;
+    for (w = 0; w < num_workers; w++)
+      if (workers[w].pid == pid) {
+	workers[w].pid = -1;
+	workers[w].failed = (!WIFEXITED(status)
+			     || WEXITSTATUS(status) != EXIT_SUCCESS);
+	running--;
+	break;
+      }
+  }
+
+  for (w = 0; w < num_workers; w++)
+    if (workers[w].output && !workers[w].failed) {
+      rewind(workers[w].output);
+      next_owl_worker_result(&workers[w]);
+    }
+
+  /* Each worker took the dragons in increasing order, so the next
+   * result of one of them is for dragon k.
+   */
+  for (k = 0; k < num_dragons; k++) {
+    int str = dragons[k];
+    struct owl_worker *worker = NULL;
+    struct dragon_data2 result;
+
+    for (w = 0; w < num_workers; w++)
+      if (workers[w].next == k)
+	worker = &workers[w];
+
+    if (worker
+	&& fread(&result, sizeof(result), 1, worker->output) == 1
+	&& read_persistent_cache_changes(worker->output)) {
+      DRAGON2(str) = result;
+      next_owl_worker_result(worker);
+    }
+    else {
+      if (worker)
+	worker->next = -1;
+      DEBUG(DEBUG_OWL_PERFORMANCE,
+	    "Owl reading of %1m failed in a worker process.\n", str);
+      read_owl_status(str, NULL);
+    }
+  }
+
+  for (w = 0; w < num_workers; w++)
+    if (workers[w].output)
+      fclose(workers[w].output);
+  free(workers);
+
+  commit_persistent_caches();
+  reading_cache_clear();
+  clear_safe_move_cache();
+}
+
+#endif /* HAVE_FORK */
+
+
 /* Find capturable worms adjacent to each dragon. */
 static void
 find_lunches()
@@ -1600,7 +1842,7 @@ show_dragons(void)
 }
 
 
-static int new_dragon_origins[BOARDMAX];
+static THREAD_LOCAL int new_dragon_origins[BOARDMAX];
 
 /* Compute new dragons, e.g. after having made a move. This will not
  * affect any global state.
@@ -1839,8 +2081,8 @@ dragon_escape(signed char goal[BOARDMAX], int color,
 {
   int ii;
   int k;
-  static int mx[BOARDMAX];
-  static int mx_initialized = 0;
+  static THREAD_LOCAL int mx[BOARDMAX];
+  static THREAD_LOCAL int mx_initialized = 0;
   int queue[MAX_BOARD * MAX_BOARD];
   int queue_start = 0;
   int queue_end = 0;
@@ -2439,8 +2681,8 @@ struct cut_data {
   int move;
 };
 
-static int num_cuts = 0;
-static struct cut_data cut_list[MAX_CUTS];
+static THREAD_LOCAL int num_cuts = 0;
+static THREAD_LOCAL struct cut_data cut_list[MAX_CUTS];
 
 static void
 clear_cut_list()
@@ -363,8 +363,8 @@ fill_liberty(int *move, int color)
  * like backfilling for J5 at F9 in filllib:45. With F9 marked as
  * forbidden the correct move at G9 is found.
  */
-static int adjs[MAXCHAIN];
-static int libs[MAXLIBS];
+static THREAD_LOCAL int adjs[MAXCHAIN];
+static THREAD_LOCAL int libs[MAXLIBS];
 
 static int
 find_backfilling_move(int move, int color, int *backfill_move,
@@ -33,34 +33,34 @@
  * Define all global variables used within the engine.
  */
 
-int thrashing_dragon = NO_MOVE; /* Dead opponent's dragon trying to live. */
-signed char thrashing_stone[BOARDMAX]; /* All thrashing stones. */
+THREAD_LOCAL int thrashing_dragon = NO_MOVE; /* Dead opponent's dragon trying to live. */
+THREAD_LOCAL signed char thrashing_stone[BOARDMAX]; /* All thrashing stones. */
 
-float potential_moves[BOARDMAX];
+THREAD_LOCAL float potential_moves[BOARDMAX];
 
 /* Used by reading. */
-int depth;              /* deep reading cut off */
-int backfill_depth;     /* deep reading cut off */
-int backfill2_depth;    /* deep reading cut off */
-int break_chain_depth;  /* deep reading cut off */
-int superstring_depth;  /* deep reading cut off */
-int fourlib_depth;      /* deep reading cut off */
-int ko_depth;           /* deep reading cut off */
-int branch_depth;       /* deep reading cut off */
-int aa_depth;
-int depth_offset;       /* keeps track of temporary depth changes */
-int owl_distrust_depth;   /* below this owl trusts the optics code */
-int owl_branch_depth;     /* below this owl tries only one variation */
-int owl_reading_depth;    /* owl does not read below this depth */
-int owl_node_limit;       /* maximum number of nodes considered */
-int semeai_branch_depth;
-int semeai_branch_depth2;
-int semeai_node_limit;
-int connect_depth;	/* Used by Tristan Cazenave's connection reader. */
-int connect_depth2;     /* Used by alternater connection reader. */
-int connection_node_limit; 
-int breakin_node_limit; /* Reading limits for break_in/block_off reading */
-int breakin_depth;    
+THREAD_LOCAL int depth;              /* deep reading cut off */
+THREAD_LOCAL int backfill_depth;     /* deep reading cut off */
+THREAD_LOCAL int backfill2_depth;    /* deep reading cut off */
+THREAD_LOCAL int break_chain_depth;  /* deep reading cut off */
+THREAD_LOCAL int superstring_depth;  /* deep reading cut off */
+THREAD_LOCAL int fourlib_depth;      /* deep reading cut off */
+THREAD_LOCAL int ko_depth;           /* deep reading cut off */
+THREAD_LOCAL int branch_depth;       /* deep reading cut off */
+THREAD_LOCAL int aa_depth;
+THREAD_LOCAL int depth_offset;       /* keeps track of temporary depth changes */
+THREAD_LOCAL int owl_distrust_depth;   /* below this owl trusts the optics code */
+THREAD_LOCAL int owl_branch_depth;     /* below this owl tries only one variation */
+THREAD_LOCAL int owl_reading_depth;    /* owl does not read below this depth */
+THREAD_LOCAL int owl_node_limit;       /* maximum number of nodes considered */
+THREAD_LOCAL int semeai_branch_depth;
+THREAD_LOCAL int semeai_branch_depth2;
+THREAD_LOCAL int semeai_node_limit;
+THREAD_LOCAL int connect_depth;	/* Used by Tristan Cazenave's connection reader. */
+THREAD_LOCAL int connect_depth2;     /* Used by alternater connection reader. */
+THREAD_LOCAL int connection_node_limit; 
+THREAD_LOCAL int breakin_node_limit; /* Reading limits for break_in/block_off reading */
+THREAD_LOCAL int breakin_depth;    
 /* Mandated values for deep reading cutoffs. */
 int mandated_depth = -1;   
 int mandated_backfill_depth = -1;
@@ -82,6 +82,7 @@ int mandated_semeai_node_limit = -1;
 int quiet             = 0;  /* minimal output */
 int showstatistics    = 0;  /* print statistics */
 int profile_patterns  = 0;  /* print statistics of pattern usage */
+int profile_engine    = 0;  /* account nodes and time per routine */
 int allpats           = 0;  /* generate all patterns, even small ones */
 int printworms        = 0;  /* print full data on each string */
 int printmoyo         = 0;  /* print moyo board each move */
@@ -135,35 +136,51 @@ int mc_games_per_level = 8000;  /* By default, use 8000 times the current
 				 * for each mmove when Monte Carlo
 				 * move generation is enabled.
 				 */
+int mc_threads = 1;             /* Threads sharing the Monte Carlo search
+				 * tree. Needs ENGINE_THREADS.
+				 */
+int mc_bitboards = 0;           /* Track strings in Monte Carlo
+				 * simulations with bitboards instead
+				 * of liberty lists.
+				 */
+int incremental_matching = 1;   /* Reuse DFA scans of anchors whose
+				 * surroundings have not changed.
+				 */
+int incremental_influence = 1;  /* Reuse influence pattern matches
+				 * away from the move just tried.
+				 */
+int reading_jobs = 1;           /* Worker processes reading the owl
+				 * status of the dragons. Needs fork().
+				 */
 
-float best_move_values[10];
-int   best_moves[10];
-float white_score;
-float black_score;
-
-int close_worms[BOARDMAX][4];
-int number_close_worms[BOARDMAX];
-int close_black_worms[BOARDMAX][4];
-int number_close_black_worms[BOARDMAX];
-int close_white_worms[BOARDMAX][4];
-int number_close_white_worms[BOARDMAX];
-
-int false_eye_territory[BOARDMAX];
-int forced_backfilling_moves[BOARDMAX];
-
-struct worm_data      worm[BOARDMAX];
-struct dragon_data    dragon[BOARDMAX];
-int                   number_of_dragons;
-struct dragon_data2   *dragon2 = NULL;
-struct half_eye_data  half_eye[BOARDMAX];
-struct eye_data       black_eye[BOARDMAX];
-struct eye_data       white_eye[BOARDMAX];
-struct vital_eye_points black_vital_points[BOARDMAX];
-struct vital_eye_points white_vital_points[BOARDMAX];
-struct surround_data  surroundings[MAX_SURROUND];
-int                   surround_pointer;
-
-int cutting_points[BOARDMAX];
+THREAD_LOCAL float best_move_values[10];
+THREAD_LOCAL int   best_moves[10];
+THREAD_LOCAL float white_score;
+THREAD_LOCAL float black_score;
+
+THREAD_LOCAL int close_worms[BOARDMAX][4];
+THREAD_LOCAL int number_close_worms[BOARDMAX];
+THREAD_LOCAL int close_black_worms[BOARDMAX][4];
+THREAD_LOCAL int number_close_black_worms[BOARDMAX];
+THREAD_LOCAL int close_white_worms[BOARDMAX][4];
+THREAD_LOCAL int number_close_white_worms[BOARDMAX];
+
+THREAD_LOCAL int false_eye_territory[BOARDMAX];
+THREAD_LOCAL int forced_backfilling_moves[BOARDMAX];
+
+THREAD_LOCAL struct worm_data      worm[BOARDMAX];
+THREAD_LOCAL struct dragon_data    dragon[BOARDMAX];
+THREAD_LOCAL int                   number_of_dragons;
+THREAD_LOCAL struct dragon_data2   *dragon2 = NULL;
+THREAD_LOCAL struct half_eye_data  half_eye[BOARDMAX];
+THREAD_LOCAL struct eye_data       black_eye[BOARDMAX];
+THREAD_LOCAL struct eye_data       white_eye[BOARDMAX];
+THREAD_LOCAL struct vital_eye_points black_vital_points[BOARDMAX];
+THREAD_LOCAL struct vital_eye_points white_vital_points[BOARDMAX];
+THREAD_LOCAL struct surround_data  surroundings[MAX_SURROUND];
+THREAD_LOCAL int                   surround_pointer;
+
+THREAD_LOCAL int cutting_points[BOARDMAX];
 
 double slowest_time = 0.0;
 int    slowest_move = NO_MOVE;
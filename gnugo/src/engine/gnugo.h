@@ -49,6 +49,11 @@
 /* interface.c */
 /* Initialize the whole thing. Should be called once. */
 void init_gnugo(float memory, unsigned int random_seed);
+/* With ENGINE_THREADS, set up and tear down the engine state of
+ * another thread. init_gnugo() must have been called first.
+ */
+void init_gnugo_thread(float memory);
+void exit_gnugo_thread(void);
 
 
 /* ================================================================ */
@@ -127,6 +132,7 @@ extern int printdragons;	/* print full data on each dragon */
 extern int printboard;		/* print board each move */
 extern int showstatistics;	/* print statistics */
 extern int profile_patterns;	/* print statistics of pattern usage */
+extern int profile_engine;	/* account nodes and time per routine */
 extern char outfilename[128];	/* output file (-o option) */
 extern int output_flags;	/* amount of output to outfile */
 
@@ -221,6 +227,11 @@ extern int mirror_stones_limit;      /* but stop at this number of stones */
 extern int gtp_version;              /* version of Go Text Protocol */
 extern int use_monte_carlo_genmove;  /* use Monte Carlo move generation */
 extern int mc_games_per_level;       /* number of Monte Carlo simulations per level */
+extern int mc_threads;               /* number of Monte Carlo search threads */
+extern int mc_bitboards;             /* bitboards in Monte Carlo simulations */
+extern int incremental_matching;     /* reuse DFA scans between matches */
+extern int incremental_influence;    /* reuse influence pattern matches */
+extern int reading_jobs;             /* processes for owl reading of dragons */
 
 /* Mandatory values of reading parameters. Normally -1, if set
  * these override the values derived from the level. */
@@ -241,7 +252,7 @@ extern int mandated_semeai_node_limit;
 
 extern int autolevel_on;
 
-extern float potential_moves[BOARDMAX];
+extern THREAD_LOCAL float potential_moves[BOARDMAX];
 
 extern int oracle_exists; /* oracle is available for consultation        */
 extern int metamachine;   /* use metamachine_genmove                     */
@@ -313,10 +324,13 @@ void silent_examine_position(int how_much);
 /* These are mostly used for GTP examination. */
 void reset_owl_node_counter(void);
 int get_owl_node_counter(void);
+void add_owl_node_counter(int nodes);
 void reset_reading_node_counter(void);
 int get_reading_node_counter(void);
+void add_reading_node_counter(int nodes);
 void reset_connection_node_counter(void);
 int get_connection_node_counter(void);
+void add_connection_node_counter(int nodes);
 
 
 
@@ -215,8 +215,8 @@ place_fixed_handicap(int desired_handicap)
  * placed handicap stones.
  */
 
-static int remaining_handicap_stones = -1;
-static int total_handicap_stones = -1;
+static THREAD_LOCAL int remaining_handicap_stones = -1;
+static THREAD_LOCAL int total_handicap_stones = -1;
 
 static int find_free_handicap_pattern(void);
 static void free_handicap_callback(int anchor, int color,
@@ -300,8 +300,8 @@ struct handicap_match {
 
 #define MAX_HANDICAP_MATCHES 40
 
-static struct handicap_match handicap_matches[MAX_HANDICAP_MATCHES];
-static int number_of_matches;
+static THREAD_LOCAL struct handicap_match handicap_matches[MAX_HANDICAP_MATCHES];
+static THREAD_LOCAL int number_of_matches;
 
 static int
 find_free_handicap_pattern()
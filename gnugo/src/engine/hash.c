@@ -208,7 +208,7 @@ goal_to_hashvalue(const signed char *goal)
 char *
 hashdata_to_string(Hash_data *hashdata)
 {
-  static char buffer[BUFFER_SIZE];
+  static THREAD_LOCAL char buffer[BUFFER_SIZE];
   int n = 0;
   int k;
 
@@ -79,7 +79,7 @@ typedef struct {
   Hashvalue hashval[NUM_HASHVALUES];
 } Hash_data;
 
-extern Hash_data board_hash;
+extern THREAD_LOCAL Hash_data board_hash;
 
 Hash_data goal_to_hashvalue(const signed char *goal);
 
@@ -48,31 +48,63 @@ static void enter_intrusion_source(int source_pos, int strength_pos,
                                    float strength, float attenuation,
                                    struct influence_data *q);
 static void add_marked_intrusions(struct influence_data *q);
+static void apply_influence_match(struct influence_data *q,
+				  struct influence_match *m);
+static void compute_territorial_influence(const struct influence_data *base,
+					  int color,
+					  const signed char safe_stones[BOARDMAX],
+					  const float strength[BOARDMAX],
+					  struct influence_data *q, int move,
+					  const char *trace_message);
  
 
 /* Influence computed for the initial position, i.e. before making
  * some move.
  */
-struct influence_data initial_black_influence;
-struct influence_data initial_white_influence;
+THREAD_LOCAL struct influence_data initial_black_influence;
+THREAD_LOCAL struct influence_data initial_white_influence;
 
 /* Influence computed after some move has been made. */
-struct influence_data move_influence;
-struct influence_data followup_influence;
+THREAD_LOCAL struct influence_data move_influence;
+THREAD_LOCAL struct influence_data followup_influence;
 
 /* Influence used for estimation of escape potential. */
-static struct influence_data escape_influence;
+static THREAD_LOCAL struct influence_data escape_influence;
 
 /* Pointer to influence data used during pattern matching. */
-static struct influence_data *current_influence = NULL;
+static THREAD_LOCAL struct influence_data *current_influence = NULL;
+
+/* Pass of the pattern matching in find_influence_patterns(), 0 for
+ * influence.db and 2 for barriers.db, and whether the match list
+ * overflowed.
+ */
+static THREAD_LOCAL int influence_pass;
+static THREAD_LOCAL int match_list_overflow;
+
+/* Matches of a base influence merged with those found again after a
+ * move, see find_influence_patterns().
+ */
+static THREAD_LOCAL struct influence_match merged_matches[MAX_INFLUENCE_MATCHES];
+
+/* Full recomputation to compare incremental influence against, see
+ * influence_set_verification().
+ */
+static THREAD_LOCAL struct influence_data verify_influence;
+static THREAD_LOCAL int verify_incremental_influence = 0;
+
+/* Statistics, see influence_get_stats(). */
+static THREAD_LOCAL double influence_time = 0.0;
+static THREAD_LOCAL int influence_incremental = 0;
+static THREAD_LOCAL int influence_verified = 0;
+static THREAD_LOCAL int influence_differing = 0;
 
 
 /* Thresholds values used in the whose_moyo() functions */
-static struct moyo_determination_data moyo_data;
-static struct moyo_determination_data moyo_restricted_data;
+static THREAD_LOCAL struct moyo_determination_data moyo_data;
+static THREAD_LOCAL struct moyo_determination_data moyo_restricted_data;
  
 /* Thresholds value used in the whose_territory() function */
-static float territory_determination_value; 
+static THREAD_LOCAL float territory_determination_value; 
  
 
 
@@ -109,12 +141,12 @@ static struct interpolation_data territory_correction =
 /* If set, print influence map when computing this move. Purely for
  * debugging.
  */
-static int debug_influence = NO_MOVE;
+static THREAD_LOCAL int debug_influence = NO_MOVE;
 
 /* Assigns an id to all influence computations for reference in the
  * delta territory cache.
  */
-static int influence_id = 0;
+static THREAD_LOCAL int influence_id = 0;
 
 /* This is the core of the influence function. Given the coordinates
  * and color of an influence source, it radiates the influence
@@ -195,8 +227,8 @@ accumulate_influence(struct influence_data *q, int pos, int color)
   int queue_start = 0;
   int queue_end = 1;
 
-  static float working[BOARDMAX];
-  static int working_area_initialized = 0;
+  static THREAD_LOCAL float working[BOARDMAX];
+  static THREAD_LOCAL int working_area_initialized = 0;
 
   if (!working_area_initialized) {
     for (ii = 0; ii < BOARDMAX; ii++)
@@ -663,14 +695,17 @@ add_marked_intrusions(struct influence_data *q)
  * Classes A, D, and B are matched with color as O, and it is assumed
  * that O is in turn to move. Classes E and I are matched with either
  * color as O.
+ *
+ * The matches are only recorded in q->matches here, to be applied by
+ * apply_influence_match() once all of them are known. If q->num_matches
+ * is -1 they are applied at once instead.
  */
 static void
 influence_callback(int anchor, int color, struct pattern *pattern, int ll,
 		   void *data)
 {
-  int pos = AFFINE_TRANSFORM(pattern->move_offset, ll, anchor);
-  int k;
   struct influence_data *q = data;
+  struct influence_match match;
   
   /* We also ignore enhancement patterns in territorial influence. */
   if ((pattern->class & CLASS_E) && q->is_territorial_influence)
@@ -679,6 +714,35 @@ influence_callback(int anchor, int color, struct pattern *pattern, int ll,
   /* Don't use invasion (I) patterns when scoring. */
   if (doing_scoring && (pattern->class & CLASS_I))
     return;
+
+  match.pattern = pattern;
+  match.anchor = anchor;
+  match.ll = ll;
+  match.color = color;
+  match.pass = influence_pass + (board[anchor] == BLACK);
+
+  if (q->num_matches < 0)
+    apply_influence_match(q, &match);
+  else if (q->num_matches < MAX_INFLUENCE_MATCHES)
+    q->matches[q->num_matches++] = match;
+  else
+    match_list_overflow = 1;
+}
+
+
+/* Check a pattern match recorded by influence_callback() against the
+ * current permeabilities and strengths, call its constraint, and add
+ * its effect to q.
+ */
+static void
+apply_influence_match(struct influence_data *q, struct influence_match *m)
+{
+  struct pattern *pattern = m->pattern;
+  int anchor = m->anchor;
+  int ll = m->ll;
+  int color = m->color;
+  int pos = AFFINE_TRANSFORM(pattern->move_offset, ll, anchor);
+  int k;
   
   /* Loop through pattern elements to see if an A or D pattern
    * can possibly have any effect. If not we can skip evaluating
@@ -952,22 +1016,218 @@ influence_erase_territory(struct influence_data *q, int pos, int color)
   }
 }
 
+/* Return the largest distance, along either axis, from the anchor of
+ * a pattern in pdb to any point the pattern looks at.
+ */
+static int
+pattern_db_reach(struct pattern_db *pdb)
+{
+  struct pattern *pattern;
+  int k;
+  /* The grid matcher checks the 4x4 square around the anchor. */
+  int reach = 2;
+
+  for (pattern = pdb->patterns; pattern->patn; pattern++)
+    for (k = 0; k <= pattern->patlen; k++) {
+      int offset = (k < pattern->patlen ? pattern->patn[k].offset
+		    : pattern->move_offset);
+      int dx = gg_abs(offset % (2*MAX_BOARD - 1) - (MAX_BOARD - 1));
+      int dy = gg_abs(offset / (2*MAX_BOARD - 1) - (MAX_BOARD - 1));
+      reach = gg_max(reach, gg_max(dx, dy));
+    }
+
+  return reach;
+}
+
+
+/* Mark in influence_anchors[] and barriers_anchors[] the anchors of
+ * influence.db and barriers.db whose matches may differ between base
+ * and the current position. These are the anchors within reach of a
+ * changed intersection, of a string next to one, or of a stone whose
+ * initial strength or permeability in q differs from base. Return 0 if
+ * base was computed for another board size.
+ */
+static int
+mark_changed_anchors(const struct influence_data *q,
+		     const struct influence_data *base,
+		     signed char influence_anchors[BOARDMAX],
+		     signed char barriers_anchors[BOARDMAX])
+{
+  static THREAD_LOCAL int influence_reach = -1;
+  static THREAD_LOCAL int barriers_reach = -1;
+  signed char changed[BOARDMAX];
+  signed char marked[BOARDMAX];
+  int ii;
+  int k;
+
+  if (influence_reach < 0) {
+    influence_reach = pattern_db_reach(&influencepat_db);
+    barriers_reach = pattern_db_reach(&barrierspat_db);
+  }
+
+  memset(changed, 0, sizeof(changed));
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++) {
+    if (base->position[ii] != board[ii]) {
+      if (base->position[ii] == GRAY || board[ii] == GRAY)
+	return 0;
+      changed[ii] = 1;
+    }
+    else if (IS_STONE(board[ii])
+	     && (q->white_strength[ii] != base->white_strength[ii]
+		 || q->black_strength[ii] != base->black_strength[ii]
+		 || q->white_permeability[ii] != base->white_permeability[ii]
+		 || q->black_permeability[ii] != base->black_permeability[ii]))
+      changed[ii] = 1;
+  }
+
+  /* The constraints read the strings in the patterns, so all stones of
+   * a string which gained or lost liberties count as changed.
+   */
+  memcpy(marked, changed, sizeof(marked));
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+    if (changed[ii]) {
+      if (IS_STONE(board[ii]))
+	mark_string(ii, marked, 1);
+      for (k = 0; k < 4; k++)
+	if (IS_STONE(board[ii + delta[k]]))
+	  mark_string(ii + delta[k], marked, 1);
+    }
+
+  memset(influence_anchors, 0, BOARDMAX);
+  memset(barriers_anchors, 0, BOARDMAX);
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+    if (marked[ii]) {
+      int i;
+      int j;
+      for (i = I(ii) - influence_reach; i <= I(ii) + influence_reach; i++)
+	for (j = J(ii) - influence_reach; j <= J(ii) + influence_reach; j++)
+	  if (ON_BOARD2(i, j)) {
+	    influence_anchors[POS(i, j)] = 1;
+	    if (gg_abs(i - I(ii)) <= barriers_reach
+		&& gg_abs(j - J(ii)) <= barriers_reach)
+	      barriers_anchors[POS(i, j)] = 1;
+	  }
+    }
+
+  return 1;
+}
+
+
+/* Merge the matches of base at anchors not marked in influence_anchors[]
+ * or barriers_anchors[] with the num_matches matches in q->matches,
+ * keeping the order of pass and anchor, into merged_matches[]. Return
+ * the number of merged matches, or -1 if there are too many.
+ *
+ * The constraints of the matches of base are called again when the
+ * merged matches are applied. A constraint may read tactically, e.g. a
+ * ladder, beyond the reach of the pattern.
+ */
+static int
+merge_influence_matches(const struct influence_data *q,
+			const struct influence_data *base,
+			const signed char influence_anchors[BOARDMAX],
+			const signed char barriers_anchors[BOARDMAX])
+{
+  int i = 0;
+  int j = 0;
+  int n = 0;
+
+  while (i < base->num_matches || j < q->num_matches) {
+    const struct influence_match *m;
+    if (i < base->num_matches) {
+      m = &base->matches[i];
+      if ((m->pass < 2 ? influence_anchors : barriers_anchors)[m->anchor]) {
+	i++;
+	continue;
+      }
+      if (j < q->num_matches
+	  && (q->matches[j].pass < m->pass
+	      || (q->matches[j].pass == m->pass
+		  && q->matches[j].anchor < m->anchor)))
+	m = &q->matches[j++];
+      else
+	i++;
+    }
+    else
+      m = &q->matches[j++];
+
+    if (n == MAX_INFLUENCE_MATCHES)
+      return -1;
+    merged_matches[n++] = *m;
+  }
+
+  return n;
+}
+
+
 /* Match the patterns in influence.db and barriers.db in order to add:
  * - influence barriers,
  * - extra influence sources at possible invasion and intrusion points, and
  * - extra influence induced by strong positions.
  * Reduce permeability around each living stone.
  * Reset permeability to 1.0 at intrusion points.
+ *
+ * If base is not NULL, its matches are reused at all anchors whose
+ * surroundings have not changed since base was computed, and only the
+ * remaining anchors are matched again.
  */
 static void
-find_influence_patterns(struct influence_data *q)
+find_influence_patterns(struct influence_data *q,
+			const struct influence_data *base)
 {
   int ii;
+  int k;
+  int num_matches;
+  struct influence_match *matches = q->matches;
+  signed char influence_anchors[BOARDMAX];
+  signed char barriers_anchors[BOARDMAX];
 
   current_influence = q;
-  matchpat(influence_callback, ANCHOR_COLOR, &influencepat_db, q, NULL);
-  if (q->color_to_move != EMPTY)
-    matchpat(influence_callback, q->color_to_move, &barrierspat_db, q, NULL);
+  memcpy(q->position, board, sizeof(q->position));
+  q->num_matches = 0;
+  match_list_overflow = 0;
+
+  if (base != NULL
+      && mark_changed_anchors(q, base, influence_anchors, barriers_anchors)) {
+    influence_pass = 0;
+    matchpat_anchors(influence_callback, ANCHOR_COLOR, &influencepat_db, q,
+		     influence_anchors);
+    influence_pass = 2;
+    matchpat_anchors(influence_callback, q->color_to_move, &barrierspat_db, q,
+		     barriers_anchors);
+    num_matches = merge_influence_matches(q, base, influence_anchors,
+					  barriers_anchors);
+    matches = merged_matches;
+    if (num_matches < 0)
+      match_list_overflow = 1;
+  }
+  else {
+    influence_pass = 0;
+    matchpat(influence_callback, ANCHOR_COLOR, &influencepat_db, q, NULL);
+    influence_pass = 2;
+    if (q->color_to_move != EMPTY)
+      matchpat(influence_callback, q->color_to_move, &barrierspat_db, q, NULL);
+    num_matches = q->num_matches;
+  }
+
+  if (match_list_overflow) {
+    /* Match again and apply each match as it is found. */
+    DEBUG(DEBUG_INFLUENCE, "influence match list exhausted\n");
+    q->num_matches = -1;
+    influence_pass = 0;
+    matchpat(influence_callback, ANCHOR_COLOR, &influencepat_db, q, NULL);
+    influence_pass = 2;
+    if (q->color_to_move != EMPTY)
+      matchpat(influence_callback, q->color_to_move, &barrierspat_db, q, NULL);
+  }
+  else {
+    /* Apply the matches in order and keep them for later computations. */
+    for (k = 0; k < num_matches; k++)
+      apply_influence_match(q, &matches[k]);
+    if (matches != q->matches)
+      memcpy(q->matches, matches, num_matches * sizeof(*matches));
+    q->num_matches = num_matches;
+  }
 
   if (q->is_territorial_influence)
     add_marked_intrusions(q);
@@ -1100,7 +1360,8 @@ remove_double_blocks(struct influence_data *q,
 
 
 /* Do the real work of influence computation. This is called from
- * compute_influence and compute_escape_influence.
+ * compute_influence and compute_escape_influence. If base is not NULL,
+ * the pattern matches of base are reused where possible.
  *
  * q->is_territorial_influence and q->color_to_move must be set by the caller.
  */
@@ -1108,13 +1369,14 @@ static void
 do_compute_influence(const signed char safe_stones[BOARDMAX],
 		     const signed char inhibited_sources[BOARDMAX],
     		     const float strength[BOARDMAX], struct influence_data *q,
+		     const struct influence_data *base,
 		     int move, const char *trace_message)
 {
   int ii;
   init_influence(q, safe_stones, strength);
 
   modify_depth_values(stackp - 1);
-  find_influence_patterns(q);
+  find_influence_patterns(q, base);
   modify_depth_values(1 - stackp);
   
   for (ii = BOARDMIN; ii < BOARDMAX; ii++)
@@ -1160,8 +1422,76 @@ void
 compute_influence(int color, const signed char safe_stones[BOARDMAX],
     	          const float strength[BOARDMAX], struct influence_data *q,
 		  int move, const char *trace_message)
+{
+  compute_territorial_influence(NULL, color, safe_stones, strength, q,
+				move, trace_message);
+}
+
+
+/* Same as compute_influence(), but reuse the pattern matches of base,
+ * which must have been computed by compute_influence() or this
+ * function for the same color to move, at all intersections not close
+ * to where the board differs from the one base was computed for.
+ * Typically base is the influence before the move which has just been
+ * tried. The pattern constraints are all evaluated again, so the
+ * result is the same as that of compute_influence(). The GTP command
+ * influence_benchmark verifies this.
+ */
+void
+compute_incremental_influence(const struct influence_data *base, int color,
+			      const signed char safe_stones[BOARDMAX],
+			      const float strength[BOARDMAX],
+			      struct influence_data *q,
+			      int move, const char *trace_message)
+{
+  if (!incremental_influence
+      || !base->is_territorial_influence
+      || base->color_to_move != color
+      || base->num_matches < 0) {
+    compute_influence(color, safe_stones, strength, q, move, trace_message);
+    return;
+  }
+
+  compute_territorial_influence(base, color, safe_stones, strength, q,
+				move, trace_message);
+}
+
+
+/* Returns 1 if the results of two influence computations differ. */
+static int
+influence_differs(const struct influence_data *q1,
+		  const struct influence_data *q2)
+{
+  int ii;
+
+  for (ii = BOARDMIN; ii < BOARDMAX; ii++)
+    if (ON_BOARD(ii)
+	&& (q1->white_influence[ii] != q2->white_influence[ii]
+	    || q1->black_influence[ii] != q2->black_influence[ii]
+	    || q1->white_strength[ii] != q2->white_strength[ii]
+	    || q1->black_strength[ii] != q2->black_strength[ii]
+	    || q1->white_permeability[ii] != q2->white_permeability[ii]
+	    || q1->black_permeability[ii] != q2->black_permeability[ii]
+	    || q1->territory_value[ii] != q2->territory_value[ii]
+	    || q1->non_territory[ii] != q2->non_territory[ii]))
+      return 1;
+
+  return 0;
+}
+
+
+/* Common part of compute_influence() and
+ * compute_incremental_influence().
+ */
+static void
+compute_territorial_influence(const struct influence_data *base, int color,
+			      const signed char safe_stones[BOARDMAX],
+			      const float strength[BOARDMAX],
+			      struct influence_data *q,
+			      int move, const char *trace_message)
 {
   int save_debug = debug;
+  double start = gg_gettimeofday();
   VALGRIND_MAKE_WRITABLE(q, sizeof(*q));
 
   q->is_territorial_influence = 1;
@@ -1179,9 +1509,66 @@ compute_influence(int color, const signed char safe_stones[BOARDMAX],
   q->id = influence_id;
 
   do_compute_influence(safe_stones, NULL, strength,
-		       q, move, trace_message);
+		       q, base, move, trace_message);
 
+  influence_time += gg_gettimeofday() - start;
   debug = save_debug;
+
+  /* Compare with a full computation if asked to. */
+  if (base != NULL) {
+    influence_incremental++;
+    if (verify_incremental_influence) {
+      debug = save_debug &~ DEBUG_INFLUENCE;
+      verify_influence.is_territorial_influence = 1;
+      verify_influence.color_to_move = color;
+      do_compute_influence(safe_stones, NULL, strength, &verify_influence,
+			   NULL, -1, NULL);
+      debug = save_debug;
+      current_influence = q;
+      influence_verified++;
+      if (influence_differs(q, &verify_influence)) {
+	influence_differing++;
+	DEBUG(DEBUG_INFLUENCE,
+	      "incremental influence after %1m differs from full\n", move);
+      }
+    }
+  }
+}
+
+
+/* Turn on or off comparing each incremental influence computation
+ * with a full one, see influence_get_stats().
+ */
+void
+influence_set_verification(int verify)
+{
+  verify_incremental_influence = verify;
+}
+
+
+/* Clear the influence statistics. */
+void
+influence_clear_stats()
+{
+  influence_time = 0.0;
+  influence_incremental = 0;
+  influence_verified = 0;
+  influence_differing = 0;
+}
+
+
+/* Return the time spent computing territorial influence, the number
+ * of incremental computations, and how many of those were compared
+ * with a full computation and differed from it.
+ */
+void
+influence_get_stats(double *time, int *incremental, int *verified,
+		    int *differing)
+{
+  *time = influence_time;
+  *incremental = influence_incremental;
+  *verified = influence_verified;
+  *differing = influence_differing;
 }
 
 /* Return the color of the territory at (pos). If it's territory for
@@ -1437,7 +1824,7 @@ segment_region(struct influence_data *q, owner_function_ptr region_owner,
 	       struct moyo_data *regions)
 {
   int ii;
-  static signed char marked[BOARDMAX];
+  static THREAD_LOCAL signed char marked[BOARDMAX];
   regions->number = 0;
 
   /* Reset the markings. */
@@ -1607,9 +1994,9 @@ compute_escape_influence(int color, const signed char safe_stones[BOARDMAX],
    * strength[] will currently always be identical for identical board[]
    * states. Better check for these, too.
    */
-  static int cached_board[BOARDMAX];
-  static signed char escape_values[BOARDMAX][2];
-  static int active_caches[2] = {0, 0};
+  static THREAD_LOCAL int cached_board[BOARDMAX];
+  static THREAD_LOCAL signed char escape_values[BOARDMAX][2];
+  static THREAD_LOCAL int active_caches[2] = {0, 0};
 
   int cache_number = (color == WHITE);
 
@@ -1655,7 +2042,7 @@ compute_escape_influence(int color, const signed char safe_stones[BOARDMAX],
     debug &= ~DEBUG_INFLUENCE;
 
   do_compute_influence(safe_stones, goal, strength,
-      		       &escape_influence, -1, NULL);
+      		       &escape_influence, NULL, -1, NULL);
 
   debug = save_debug;
   
@@ -1707,12 +2094,12 @@ compute_escape_influence(int color, const signed char safe_stones[BOARDMAX],
 
 
 /* Cache of delta_territory_values. */
-static float delta_territory_cache[BOARDMAX];
-static float followup_territory_cache[BOARDMAX];
-static Hash_data delta_territory_cache_hash[BOARDMAX];
-static int territory_cache_position_number = -1;
-static int territory_cache_influence_id = -1;
-static int territory_cache_color = -1;
+static THREAD_LOCAL float delta_territory_cache[BOARDMAX];
+static THREAD_LOCAL float followup_territory_cache[BOARDMAX];
+static THREAD_LOCAL Hash_data delta_territory_cache_hash[BOARDMAX];
+static THREAD_LOCAL int territory_cache_position_number = -1;
+static THREAD_LOCAL int territory_cache_influence_id = -1;
+static THREAD_LOCAL int territory_cache_color = -1;
 
 /* We cache territory computations. This avoids unnecessary re-computations
  * when review_move_reasons is run a second time for the endgame patterns.
@@ -68,6 +68,21 @@
 
 #define MAX_INTRUSIONS (2 * MAX_BOARD * MAX_BOARD)
 
+/* A pattern match found by find_influence_patterns(). The matches
+ * are applied in the order they were found, which is the order of
+ * pass and anchor.
+ */
+struct influence_match
+{
+  struct pattern *pattern;
+  int anchor;
+  int ll;
+  int color;            /* Color the pattern was matched for. */
+  int pass;             /* Database and color of the anchor. */
+};
+
+#define MAX_INFLUENCE_MATCHES (4 * MAX_BOARD * MAX_BOARD)
+
 struct intrusion_data
 {
   int source_pos; 	/* Stone from which intrusion originates.*/
@@ -102,6 +117,14 @@ struct influence_data
   int intrusion_counter;
   struct intrusion_data intrusions[MAX_INTRUSIONS];
 
+  /* The board the patterns were matched at, and the matches, which a
+   * later computation after a move may reuse. num_matches is -1 if the
+   * list overflowed.
+   */
+  Intersection position[BOARDMAX];
+  int num_matches;
+  struct influence_match matches[MAX_INFLUENCE_MATCHES];
+
   int id;
 };
 
@@ -125,7 +148,7 @@ typedef int (*owner_function_ptr)(const struct influence_data *q, int pos);
  * In the current implementation, cosmic_importance decreases 
  * slowly for 19*19 games from 1.0 at move 4 to 0.0 at move 120.
  */
-float cosmic_importance;
+THREAD_LOCAL float cosmic_importance;
 
 
 /* Used in the whose_moyo() function */
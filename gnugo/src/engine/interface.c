@@ -59,6 +59,43 @@ init_gnugo(float memory, unsigned int seed)
 }
 
 
+/*
+ * Initialize the engine state of another thread. Only the state
+ * belonging to a position is set up here; the pattern databases and
+ * hash keys initialized by init_gnugo() are shared. Afterwards the
+ * thread can set up a position of its own, e.g. with restore_board(),
+ * and analyze it.
+ */
+
+void
+init_gnugo_thread(float memory)
+{
+  reading_cache_init(memory * 1024 * 1024);
+  persistent_cache_init();
+  clear_board();
+
+  clear_approxlib_cache();
+  clear_accuratelib_cache();
+}
+
+
+/*
+ * Free the engine state of the calling thread.
+ */
+
+void
+exit_gnugo_thread(void)
+{
+  reading_cache_free();
+  persistent_cache_free();
+  free_owl_stack();
+  if (dragon2 != NULL) {
+    free(dragon2);
+    dragon2 = NULL;
+  }
+}
+
+
 /* ---------------------------------------------------------------- */
 
 /* Check whether we can accept a certain boardsize. Set out to NULL to
@@ -48,6 +48,8 @@ void start_timer(int n);
 double time_report(int n, const char *occupation, int move, double mintime);
 void showstats(void);
 void clearstats(void);
+void save_stats(FILE *outfile);
+int merge_stats(FILE *infile);
 
 void transformation_init(void);
 
@@ -114,6 +116,12 @@ enum routine_id {
 
 const char *routine_id_to_string(enum routine_id routine);
 
+void profile_clear(void);
+void profile_enter(enum routine_id routine);
+void profile_leave(enum routine_id routine);
+void profile_cache_lookup(enum routine_id routine, int persistent, int found);
+void profile_report(FILE *outfile, int id, const char *command);
+
 
 /* This is used for both the dragon status and safety fields.
  * Also used for unconditional status in struct worm_data and for the
@@ -189,15 +197,31 @@ void matchpat(matchpat_callback_fn_ptr callback, int color,
 void matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 	      struct pattern_db *pdb, void *callback_data,
 	      signed char goal[BOARDMAX], int anchor_in_goal);
+void matchpat_anchors(matchpat_callback_fn_ptr callback, int color,
+	      struct pattern_db *pdb, void *callback_data,
+	      signed char anchors[BOARDMAX]);
 void fullboard_matchpat(fullboard_matchpat_callback_fn_ptr callback,
 			int color, struct fullboard_pattern *pattern);
 void corner_matchpat(corner_matchpat_callback_fn_ptr callback, int color,
 		     struct corner_db *database);
 void dfa_match_init(void);
+void matchpat_clear_stats(void);
+void matchpat_show_stats(void);
+void matchpat_get_stats(int *scans, int *reused);
+void matchpat_save_stats(FILE *outfile);
+int matchpat_merge_stats(FILE *infile);
 
 void reading_cache_init(int bytes);
+void reading_cache_free(void);
 void reading_cache_clear(void);
+void reading_cache_clear_stats(void);
+void reading_cache_show_stats(void);
+void reading_cache_save_stats(FILE *outfile);
+int reading_cache_merge_stats(FILE *infile);
 float reading_cache_default_size(void);
+float reading_cache_size(void);
+int reading_cache_threads_check(int num_threads, int num_stores,
+				int *lookups, int *hits, int *stale);
 
 /* reading.c */
 int attack(int str, int *move);
@@ -222,8 +246,13 @@ void draw_reading_shadow(void);
 
 /* persistent.c */
 void persistent_cache_init(void);
+void persistent_cache_free(void);
 void purge_persistent_caches(void);
 void clear_persistent_caches(void);
+void checkpoint_persistent_caches(void);
+void rollback_persistent_caches(FILE *outfile);
+int read_persistent_cache_changes(FILE *infile);
+void commit_persistent_caches(void);
 
 int search_persistent_reading_cache(enum routine_id routine, int str,
 				    int *result, int *move);
@@ -301,6 +330,7 @@ void decrease_depth_values(void);
 int get_depth_modification(void);
 
 int safe_move(int move, int color);
+void clear_safe_move_cache(void);
 int does_secure(int color, int move, int pos);
 
 void compute_new_dragons(int dragon_origins[BOARDMAX]);
@@ -502,6 +532,7 @@ int mc_load_patterns_from_db(const char *filename, unsigned int *values);
 void mc_init_patterns(const unsigned int *values);
 int choose_mc_patterns(char *name);
 void list_mc_patterns(void);
+float mc_run_playouts(int color, int num_games, int use_bitboards);
 
 void uct_genmove(int color, int *move, int *forbidden_moves,
 		 int *allowed_moves, int nodes, float *move_values,
@@ -524,6 +555,7 @@ void owl_analyze_semeai_after_move(int move, int color, int apos, int bpos,
 				   int *semeai_move, int owl,
 				   int *semeai_result_certain,
 				   int recompute_dragons);
+void free_owl_stack(void);
 
 void set_limit_search(int value);
 void set_search_diamond(int pos);
@@ -611,10 +643,10 @@ struct moyo_data
  * in influence.c, however!
  */
 struct influence_data;
-extern struct influence_data initial_black_influence;
-extern struct influence_data initial_white_influence;
-extern struct influence_data move_influence;
-extern struct influence_data followup_influence;
+extern THREAD_LOCAL struct influence_data initial_black_influence;
+extern THREAD_LOCAL struct influence_data initial_white_influence;
+extern THREAD_LOCAL struct influence_data move_influence;
+extern THREAD_LOCAL struct influence_data followup_influence;
 
 #define INITIAL_INFLUENCE(color) ((color) == WHITE ? \
 				    &initial_white_influence \
@@ -628,6 +660,12 @@ void compute_influence(int color, const signed char safe_stones[BOARDMAX],
 		       const float strength[BOARDMAX],
 		       struct influence_data *q,
 		       int move, const char *trace_message);
+void compute_incremental_influence(const struct influence_data *base,
+				   int color,
+				   const signed char safe_stones[BOARDMAX],
+				   const float strength[BOARDMAX],
+				   struct influence_data *q,
+				   int move, const char *trace_message);
 void compute_followup_influence(const struct influence_data *base,
 			        struct influence_data *q, 
 		                int move, const char *trace_message);
@@ -673,6 +711,10 @@ float game_status(int color);
 void influence_mark_non_territory(int pos, int color);
 int influence_considered_lively(const struct influence_data *q, int pos);
 void influence_erase_territory(struct influence_data *q, int pos, int color);
+void influence_set_verification(int verify);
+void influence_clear_stats(void);
+void influence_get_stats(double *time, int *incremental, int *verified,
+			 int *differing);
 
 void break_territories(int color_to_move, struct influence_data *q,
 		       int store, int pos);
@@ -721,31 +763,31 @@ extern int disable_endgame_patterns;
 extern int doing_scoring;
 
 /* Reading parameters */
-extern int depth;               /* deep reading cutoff */
-extern int backfill_depth;      /* deep reading cutoff */
-extern int backfill2_depth;     /* deep reading cutoff */
-extern int break_chain_depth;   /* deep reading cutoff */
-extern int superstring_depth;   /* deep reading cutoff */
-extern int branch_depth;        /* deep reading cutoff */
-extern int fourlib_depth;       /* deep reading cutoff */
-extern int ko_depth;            /* deep ko reading cutoff */
-extern int aa_depth;            /* deep global reading cutoff */
-extern int depth_offset;        /* keeps track of temporary depth changes */
-extern int owl_distrust_depth;  /* below this owl trusts the optics code */
-extern int owl_branch_depth;    /* below this owl tries only one variation */
-extern int owl_reading_depth;   /* owl does not read below this depth */
-extern int owl_node_limit;      /* maximum number of nodes considered */
-extern int semeai_branch_depth;
-extern int semeai_branch_depth2;
-extern int semeai_node_limit;
-extern int connect_depth;
-extern int connect_depth2;
-extern int connection_node_limit;
-extern int breakin_depth;
-extern int breakin_node_limit;
+extern THREAD_LOCAL int depth;               /* deep reading cutoff */
+extern THREAD_LOCAL int backfill_depth;      /* deep reading cutoff */
+extern THREAD_LOCAL int backfill2_depth;     /* deep reading cutoff */
+extern THREAD_LOCAL int break_chain_depth;   /* deep reading cutoff */
+extern THREAD_LOCAL int superstring_depth;   /* deep reading cutoff */
+extern THREAD_LOCAL int branch_depth;        /* deep reading cutoff */
+extern THREAD_LOCAL int fourlib_depth;       /* deep reading cutoff */
+extern THREAD_LOCAL int ko_depth;            /* deep ko reading cutoff */
+extern THREAD_LOCAL int aa_depth;            /* deep global reading cutoff */
+extern THREAD_LOCAL int depth_offset;        /* keeps track of temporary depth changes */
+extern THREAD_LOCAL int owl_distrust_depth;  /* below this owl trusts the optics code */
+extern THREAD_LOCAL int owl_branch_depth;    /* below this owl tries only one variation */
+extern THREAD_LOCAL int owl_reading_depth;   /* owl does not read below this depth */
+extern THREAD_LOCAL int owl_node_limit;      /* maximum number of nodes considered */
+extern THREAD_LOCAL int semeai_branch_depth;
+extern THREAD_LOCAL int semeai_branch_depth2;
+extern THREAD_LOCAL int semeai_node_limit;
+extern THREAD_LOCAL int connect_depth;
+extern THREAD_LOCAL int connect_depth2;
+extern THREAD_LOCAL int connection_node_limit;
+extern THREAD_LOCAL int breakin_depth;
+extern THREAD_LOCAL int breakin_node_limit;
 extern int semeai_variations;   /* max variations considered reading semeai */
-extern float best_move_values[10];
-extern int best_moves[10];
+extern THREAD_LOCAL float best_move_values[10];
+extern THREAD_LOCAL int best_moves[10];
 
 extern int experimental_owl_ext;     /* use experimental owl (GAIN/LOSS) */
 extern int experimental_semeai;      /* use experimental semeai module */
@@ -756,8 +798,8 @@ extern int experimental_break_in;    /* use experimental module breakin.c */
 extern int cosmic_gnugo;             /* use center oriented influence */
 extern int large_scale;              /* seek large scale captures */
 
-extern int thrashing_dragon;        /* Dead opponent's dragon trying to live */
-extern signed char thrashing_stone[BOARDMAX];       /* All thrashing stones. */
+extern THREAD_LOCAL int thrashing_dragon;        /* Dead opponent's dragon trying to live */
+extern THREAD_LOCAL signed char thrashing_stone[BOARDMAX];       /* All thrashing stones. */
 
 extern int transformation[MAX_OFFSET][8];
 extern const int transformation2[8][2][2];
@@ -775,15 +817,15 @@ extern const int transformation2[8][2][2];
  * See compute_effective_worm_sizes() in worm.c for details.
  */
 #define MAX_CLOSE_WORMS 4
-extern int close_worms[BOARDMAX][MAX_CLOSE_WORMS];
-extern int number_close_worms[BOARDMAX];
-extern int close_black_worms[BOARDMAX][MAX_CLOSE_WORMS];
-extern int number_close_black_worms[BOARDMAX];
-extern int close_white_worms[BOARDMAX][MAX_CLOSE_WORMS];
-extern int number_close_white_worms[BOARDMAX];
+extern THREAD_LOCAL int close_worms[BOARDMAX][MAX_CLOSE_WORMS];
+extern THREAD_LOCAL int number_close_worms[BOARDMAX];
+extern THREAD_LOCAL int close_black_worms[BOARDMAX][MAX_CLOSE_WORMS];
+extern THREAD_LOCAL int number_close_black_worms[BOARDMAX];
+extern THREAD_LOCAL int close_white_worms[BOARDMAX][MAX_CLOSE_WORMS];
+extern THREAD_LOCAL int number_close_white_worms[BOARDMAX];
 
-extern int false_eye_territory[BOARDMAX];
-extern int forced_backfilling_moves[BOARDMAX];
+extern THREAD_LOCAL int false_eye_territory[BOARDMAX];
+extern THREAD_LOCAL int forced_backfilling_moves[BOARDMAX];
 
 extern double slowest_time;      /* Timing statistics */
 extern int slowest_move;
@@ -809,7 +851,7 @@ struct half_eye_data {
 };
 
 /* array of half-eye data */
-extern struct half_eye_data half_eye[BOARDMAX];
+extern THREAD_LOCAL struct half_eye_data half_eye[BOARDMAX];
 
 /*
  * data concerning a worm. A copy is kept at each vertex of the worm.
@@ -854,11 +896,11 @@ struct worm_data {
   int defense_threat_codes[MAX_TACTICAL_POINTS];
 };
 
-extern struct worm_data worm[BOARDMAX];
+extern THREAD_LOCAL struct worm_data worm[BOARDMAX];
 
 /* Unconditionally meaningless moves. */
-extern int meaningless_black_moves[BOARDMAX];
-extern int meaningless_white_moves[BOARDMAX];
+extern THREAD_LOCAL int meaningless_black_moves[BOARDMAX];
+extern THREAD_LOCAL int meaningless_white_moves[BOARDMAX];
 
 /* Surround cache (see surround.c) */
 
@@ -869,8 +911,8 @@ struct surround_data {
   signed char surround_map[BOARDMAX]; /* surround map                     */
 };
 
-extern struct surround_data surroundings[MAX_SURROUND];
-extern int surround_pointer;
+extern THREAD_LOCAL struct surround_data surroundings[MAX_SURROUND];
+extern THREAD_LOCAL int surround_pointer;
 
 /*
  * data concerning a dragon. A copy is kept at each stone of the string.
@@ -887,7 +929,7 @@ struct dragon_data {
   enum dragon_status status;       /* best trusted status                    */
 };
 
-extern struct dragon_data dragon[BOARDMAX];
+extern THREAD_LOCAL struct dragon_data dragon[BOARDMAX];
 
 /* Supplementary data concerning a dragon. Only one copy is stored per
  * dragon in the dragon2 array.
@@ -940,8 +982,8 @@ struct dragon_data2 {
 };
 
 /* dragon2 is dynamically allocated */
-extern int number_of_dragons;
-extern struct dragon_data2 *dragon2;
+extern THREAD_LOCAL int number_of_dragons;
+extern THREAD_LOCAL struct dragon_data2 *dragon2;
 
 /* Macros for accessing the dragon2 data with board coordinates and
  * the dragon data with a dragon id.
@@ -955,7 +997,7 @@ struct dragon_data2 *dragon2_func(int pos);
 
 #define DRAGON(d) dragon[dragon2[d].origin]
 
-extern float white_score, black_score;
+extern THREAD_LOCAL float white_score, black_score;
 
 /* Global variables to tune strategy. */
 
@@ -1004,17 +1046,17 @@ struct vital_eye_points {
   int defense_points[MAX_EYE_ATTACKS];
 };
 
-extern struct vital_eye_points black_vital_points[BOARDMAX];
-extern struct vital_eye_points white_vital_points[BOARDMAX];
+extern THREAD_LOCAL struct vital_eye_points black_vital_points[BOARDMAX];
+extern THREAD_LOCAL struct vital_eye_points white_vital_points[BOARDMAX];
 
-extern struct eye_data white_eye[BOARDMAX];
-extern struct eye_data black_eye[BOARDMAX];
+extern THREAD_LOCAL struct eye_data white_eye[BOARDMAX];
+extern THREAD_LOCAL struct eye_data black_eye[BOARDMAX];
 
 /* Array with the information which was previously stored in the cut
  * field and in the INHIBIT_CONNECTION bit of the type field in struct
  * eye_data.
  */
-extern int cutting_points[BOARDMAX];
+extern THREAD_LOCAL int cutting_points[BOARDMAX];
 
 /* The following declarations have to be postponed until after the
  * definition of struct eye_data or struct half_eye_data.
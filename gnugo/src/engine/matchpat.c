@@ -146,6 +146,9 @@ static void matchpat_loop(matchpat_callback_fn_ptr callback,
 			  struct pattern_db *pdb, void *callback_data,
 			  signed char goal[BOARDMAX], int anchor_in_goal);
 
+/* Value of anchor_in_goal for matchpat_anchors(). */
+#define ANCHORS_ONLY 2
+
 /* Precomputed tables to allow rapid checks on the piece at
  * the board. This table relies on the fact that color is
  * 1 or 2.
@@ -198,7 +201,7 @@ static const int val_mask[2][8] = {
  * we care about each time.
  */
   
-static unsigned int class_mask[NUM_DRAGON_STATUS][3];
+static THREAD_LOCAL unsigned int class_mask[NUM_DRAGON_STATUS][3];
 
 
 /* In the current implementation, the edge constraints depend on
@@ -505,8 +508,8 @@ matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
   
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0))
-      do_matchpat(pos, callback, color, pdb->patterns,
-		  callback_data, goal);
+      do_matchpat(pos, callback, color, pdb->patterns, callback_data,
+		  anchor_in_goal == ANCHORS_ONLY ? NULL : goal);
   }
 }
 
@@ -519,8 +522,8 @@ matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
 /* #define DFA_TRACE 1 */
 
 /* Data. */
-static int dfa_board_size = -1;
-static int dfa_p[DFA_BASE * DFA_BASE];
+static THREAD_LOCAL int dfa_board_size = -1;
+static THREAD_LOCAL int dfa_p[DFA_BASE * DFA_BASE];
 
 /* This is used by the EXPECTED_COLOR macro. */
 static const int convert[3][4] = {
@@ -532,15 +535,16 @@ static const int convert[3][4] = {
 		(convert[player_c][position_c])
 
 /* Forward declarations. */
+struct dfa_match_cache;
 static void dfa_prepare_for_match(int color);
 static int scan_for_patterns(dfa_rt_t *pdfa, int l, int *dfa_pos,
-			     int *pat_list);
-static void do_dfa_matchpat(dfa_rt_t *pdfa,
+			     int *pat_list, int *rows);
+static void do_dfa_matchpat(dfa_rt_t *pdfa, struct dfa_match_cache *cache,
 			    int anchor, matchpat_callback_fn_ptr callback,
 			    int color, struct pattern *database,
 			    void *callback_data, signed char goal[BOARDMAX],
                             int anchor_in_goal);
-static void check_pattern_light(int anchor, 
+static int check_pattern_light(int anchor, 
 				matchpat_callback_fn_ptr callback,
 				int color, struct pattern *pattern, int ll,
 				void *callback_data,
@@ -638,10 +642,12 @@ dump_dfa_board(int m, int n)
 /*
  * Scan the board with a DFA to get all patterns matching at
  * `dfa_pos' with transformation l.  Store patterns indexes
- * `pat_list'.  Return the number of patterns found.
+ * `pat_list'.  Return the number of patterns found. `rows' is raised
+ * to the number of spiral rows looked at if that is larger.
  */
 static int
-scan_for_patterns(dfa_rt_t *pdfa, int l, int *dfa_pos, int *pat_list)
+scan_for_patterns(dfa_rt_t *pdfa, int l, int *dfa_pos, int *pat_list,
+		  int *rows)
 {
   int delta;
   int state = 1; /* initial state */
@@ -663,13 +669,323 @@ scan_for_patterns(dfa_rt_t *pdfa, int l, int *dfa_pos, int *pat_list)
     row++;
   } while (delta != 0); /* while not on error state */
 
+  if (*rows < row)
+    *rows = row;
+
   return id;
 }
 
 
-/* Perform pattern matching with DFA filtering. */
+/* Incremental matching.
+ *
+ * Reading and owl code match the same databases over and over again
+ * in positions which differ by only a few stones from the previous
+ * call. The DFA scan at an anchor depends only on the intersections
+ * visited along the spiral until the DFA stops, so its result can be
+ * kept until one of those intersections changes.
+ *
+ * There is one cache for each database and color of the dfa board.
+ * It holds a copy of the board from the last time it was used and
+ * the pattern lists, in the format built by do_dfa_matchpat(), of
+ * the anchors scanned since then. When the cache is used again the
+ * board is compared to the copy, and the lists of all anchors within
+ * reach of a changed intersection are dropped. The reach is the
+ * largest distance along the spiral looked at by any scan in the
+ * cache. Thus it does not matter whether the board was changed by
+ * trymove(), popgo() or something else.
+ *
+ * Only the scan is cached. The class and goal checks and the
+ * callbacks are done for every match as before, since they depend on
+ * more than the stones on the board.
+ */
+
+#define MAX_DFA_MATCH_CACHES   8
+#define DFA_MATCH_CACHE_POOL   (16 * MAX_BOARD * MAX_BOARD)
+#define MAX_DFA_MATCH_CHANGES  16
+
+struct dfa_match_cache {
+  struct pattern_db *pdb;
+  int color;
+  int busy;                      /* In use, don't enter it recursively. */
+  int board_size;
+  Intersection board[BOARDMAX];  /* The board when last used. */
+  int distance;                  /* Reach of the scans in the cache. */
+  int start[BOARDMAX];           /* Index of the list in pool, or -1. */
+  int length[BOARDMAX];
+  int pool_size;
+  int pool[DFA_MATCH_CACHE_POOL];
+
+  /* Statistics. */
+  int scans;                     /* Anchors matched. */
+  int reused;                    /* Anchors not scanned again. */
+  int matches;                   /* Patterns passed to the callback. */
+};
+
+static THREAD_LOCAL struct dfa_match_cache
+  dfa_match_caches[MAX_DFA_MATCH_CACHES];
+static THREAD_LOCAL int num_dfa_match_caches = 0;
+
+/* Time spent in matchpat() and number of calls, measured when
+ * statistics are shown. See matchpat_show_stats().
+ */
+static THREAD_LOCAL int matchpat_depth = 0;
+static THREAD_LOCAL double matchpat_time = 0.0;
+static THREAD_LOCAL int matchpat_calls = 0;
+
+
+/* Drop all pattern lists in the cache. */
 static void
-do_dfa_matchpat(dfa_rt_t *pdfa,
+dfa_match_cache_flush(struct dfa_match_cache *cache)
+{
+  int pos;
+
+  for (pos = 0; pos < BOARDMAX; pos++)
+    cache->start[pos] = -1;
+  cache->pool_size = 0;
+  cache->distance = 0;
+}
+
+
+/* Drop the pattern lists of the anchors within reach of pos. */
+static void
+dfa_match_cache_invalidate(struct dfa_match_cache *cache, int pos)
+{
+  int d = cache->distance;
+  int di;
+  int dj;
+
+  for (di = -d; di <= d; di++) {
+    int i = I(pos) + di;
+    int dd = d - gg_abs(di);
+    for (dj = -dd; dj <= dd; dj++) {
+      int j = J(pos) + dj;
+      if (ON_BOARD2(i, j))
+	cache->start[POS(i, j)] = -1;
+    }
+  }
+}
+
+
+/* Find the cache for pdb and color, or create it. Return NULL if
+ * there is no room for another cache.
+ */
+static struct dfa_match_cache *
+dfa_match_cache_find(struct pattern_db *pdb, int color)
+{
+  struct dfa_match_cache *cache;
+  int k;
+
+  for (k = 0; k < num_dfa_match_caches; k++)
+    if (dfa_match_caches[k].pdb == pdb && dfa_match_caches[k].color == color)
+      return &dfa_match_caches[k];
+
+  if (num_dfa_match_caches == MAX_DFA_MATCH_CACHES)
+    return NULL;
+  cache = &dfa_match_caches[num_dfa_match_caches++];
+  memset(cache, 0, sizeof(*cache));
+  cache->pdb = pdb;
+  cache->color = color;
+  cache->board_size = -1;
+  dfa_match_cache_flush(cache);
+  return cache;
+}
+
+
+/* Find the cache for pdb and color and bring it up to date with the
+ * board. Return NULL if the cache is already in use by an enclosing
+ * call or there is no room for another cache. If incremental matching
+ * is turned off the cache is only used for the statistics.
+ */
+static struct dfa_match_cache *
+dfa_match_cache_get(struct pattern_db *pdb, int color)
+{
+  struct dfa_match_cache *cache = dfa_match_cache_find(pdb, color);
+  int changes[MAX_DFA_MATCH_CHANGES];
+  int num_changes = 0;
+  int pos;
+  int k;
+
+  if (cache == NULL || cache->busy)
+    return NULL;
+  cache->busy = 1;
+
+  if (!incremental_matching || cache->board_size != board_size) {
+    if (cache->pool_size > 0)
+      dfa_match_cache_flush(cache);
+    cache->board_size = board_size;
+    memcpy(cache->board, board, sizeof(cache->board));
+    return cache;
+  }
+
+  if (memcmp(cache->board, board, sizeof(cache->board)) == 0)
+    return cache;
+
+  for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
+    if (cache->board[pos] != board[pos]) {
+      if (num_changes == MAX_DFA_MATCH_CHANGES) {
+	/* Too much has changed to be worth sorting out. */
+	dfa_match_cache_flush(cache);
+	num_changes = 0;
+	break;
+      }
+      changes[num_changes++] = pos;
+    }
+  }
+
+  for (k = 0; k < num_changes; k++)
+    dfa_match_cache_invalidate(cache, changes[k]);
+
+  memcpy(cache->board, board, sizeof(cache->board));
+  return cache;
+}
+
+
+/* Store the pattern list of an anchor. rows is the number of spiral
+ * rows looked at by the scan.
+ */
+static void
+dfa_match_cache_store(struct dfa_match_cache *cache, int anchor,
+		      int *patterns, int num_patterns, int rows)
+{
+  if (cache->pool_size + num_patterns > DFA_MATCH_CACHE_POOL)
+    dfa_match_cache_flush(cache);
+
+  /* The spiral visits the intersections at distance d in rows
+   * 2d(d-1) + 1 to 2d(d+1).
+   */
+  while (1 + 2 * cache->distance * (cache->distance + 1) < rows)
+    cache->distance++;
+
+  memcpy(cache->pool + cache->pool_size, patterns,
+	 num_patterns * sizeof(patterns[0]));
+  cache->start[anchor] = cache->pool_size;
+  cache->length[anchor] = num_patterns;
+  cache->pool_size += num_patterns;
+}
+
+
+/* Clear the statistics of the incremental matching. */
+void
+matchpat_clear_stats()
+{
+  int k;
+
+  matchpat_time = 0.0;
+  matchpat_calls = 0;
+  for (k = 0; k < num_dfa_match_caches; k++) {
+    dfa_match_caches[k].scans = 0;
+    dfa_match_caches[k].reused = 0;
+    dfa_match_caches[k].matches = 0;
+  }
+}
+
+
+/* Show the time spent in matchpat() and the statistics of the
+ * incremental matching for each database and color.
+ */
+void
+matchpat_show_stats()
+{
+  int k;
+
+  fprintf(stderr, "Pattern matching time:    %.2f seconds in %d calls\n",
+	  matchpat_time, matchpat_calls);
+  fprintf(stderr, "%-24s %9s %9s %9s\n", "Pattern matching:",
+	  "anchors", "reused", "matches");
+  for (k = 0; k < num_dfa_match_caches; k++) {
+    struct dfa_match_cache *cache = &dfa_match_caches[k];
+    if (cache->scans == 0)
+      continue;
+    fprintf(stderr, "  %-16s %-5s %9d %9d %9d\n", cache->pdb->pdfa->name,
+	    color_to_string(cache->color), cache->scans, cache->reused,
+	    cache->matches);
+  }
+}
+
+
+/* Sum the anchors matched and the anchors not scanned again over all
+ * databases.
+ */
+void
+matchpat_get_stats(int *scans, int *reused)
+{
+  int k;
+
+  *scans = 0;
+  *reused = 0;
+  for (k = 0; k < num_dfa_match_caches; k++) {
+    *scans += dfa_match_caches[k].scans;
+    *reused += dfa_match_caches[k].reused;
+  }
+}
+
+
+/* Write the statistics of the incremental matching to (outfile), to
+ * be added by matchpat_merge_stats() in the process which forked this
+ * one. The pattern databases are identified by their addresses, which
+ * are the same in both processes.
+ */
+void
+matchpat_save_stats(FILE *outfile)
+{
+  int k;
+
+  fwrite(&num_dfa_match_caches, sizeof(num_dfa_match_caches), 1, outfile);
+  for (k = 0; k < num_dfa_match_caches; k++) {
+    struct dfa_match_cache *cache = &dfa_match_caches[k];
+    fwrite(&cache->pdb, sizeof(cache->pdb), 1, outfile);
+    fwrite(&cache->color, sizeof(cache->color), 1, outfile);
+    fwrite(&cache->scans, sizeof(cache->scans), 1, outfile);
+    fwrite(&cache->reused, sizeof(cache->reused), 1, outfile);
+    fwrite(&cache->matches, sizeof(cache->matches), 1, outfile);
+  }
+}
+
+
+/* Add the statistics written by matchpat_save_stats(). Return 0 if the
+ * input is truncated.
+ */
+int
+matchpat_merge_stats(FILE *infile)
+{
+  int num_caches;
+  int k;
+
+  if (fread(&num_caches, sizeof(num_caches), 1, infile) != 1)
+    return 0;
+
+  for (k = 0; k < num_caches; k++) {
+    struct pattern_db *pdb;
+    int color;
+    int scans;
+    int reused;
+    int matches;
+    struct dfa_match_cache *cache;
+
+    if (fread(&pdb, sizeof(pdb), 1, infile) != 1
+	|| fread(&color, sizeof(color), 1, infile) != 1
+	|| fread(&scans, sizeof(scans), 1, infile) != 1
+	|| fread(&reused, sizeof(reused), 1, infile) != 1
+	|| fread(&matches, sizeof(matches), 1, infile) != 1)
+      return 0;
+
+    cache = dfa_match_cache_find(pdb, color);
+    if (cache) {
+      cache->scans += scans;
+      cache->reused += reused;
+      cache->matches += matches;
+    }
+  }
+
+  return 1;
+}
+
+
+/* Perform pattern matching with DFA filtering. If cache is not NULL,
+ * the scan is looked up in and stored in it.
+ */
+static void
+do_dfa_matchpat(dfa_rt_t *pdfa, struct dfa_match_cache *cache,
 		int anchor, matchpat_callback_fn_ptr callback,
 		int color, struct pattern *database,
 		void *callback_data, signed char goal[BOARDMAX],
@@ -677,21 +993,35 @@ do_dfa_matchpat(dfa_rt_t *pdfa,
 {
   int k;
   int ll;      /* Iterate over transformations (rotations or reflections)  */
-  int patterns[DFA_MAX_MATCHED + 8];
+  int scanned[DFA_MAX_MATCHED + 8];
+  int *patterns = scanned;
   int num_matched = 0;
+  int rows = 0;
   int *dfa_pos = dfa_p + DFA_POS(I(anchor), J(anchor));
 
   /* Basic sanity checks. */
   ASSERT_ON_BOARD1(anchor);
 
-  /* One scan by transformation */
-  for (ll = 0; ll < 8; ll++) {
-    num_matched += scan_for_patterns(pdfa, ll, dfa_pos,
-				     patterns + num_matched);
-    patterns[num_matched++] = -1;
+  if (cache)
+    cache->scans++;
+
+  if (cache && cache->start[anchor] != -1) {
+    patterns = cache->pool + cache->start[anchor];
+    cache->reused++;
   }
+  else {
+    /* One scan by transformation */
+    for (ll = 0; ll < 8; ll++) {
+      num_matched += scan_for_patterns(pdfa, ll, dfa_pos,
+				       patterns + num_matched, &rows);
+      patterns[num_matched++] = -1;
+    }
+
+    ASSERT1(num_matched <= DFA_MAX_MATCHED + 8, anchor);
 
-  ASSERT1(num_matched <= DFA_MAX_MATCHED + 8, anchor);
+    if (cache && incremental_matching)
+      dfa_match_cache_store(cache, anchor, patterns, num_matched, rows);
+  }
 
   /* Constraints and other tests. */
   for (ll = 0, k = 0; ll < 8; k++) {
@@ -708,8 +1038,10 @@ do_dfa_matchpat(dfa_rt_t *pdfa,
     database[matched].dfa_hits++;
 #endif
 
-    check_pattern_light(anchor, callback, color, database + matched,
-			ll, callback_data, goal, anchor_in_goal);
+    if (check_pattern_light(anchor, callback, color, database + matched,
+			    ll, callback_data, goal, anchor_in_goal)
+	&& cache)
+      cache->matches++;
   }
 }
 
@@ -718,15 +1050,17 @@ do_dfa_matchpat(dfa_rt_t *pdfa,
  * Do the pattern matching for a given pattern and a given 
  * transformation ll. 
  * (does not recompute what dfa filtering has already done)
+ * Return 1 if the pattern matched and the callback was called.
  */
 
-static void
+static int
 check_pattern_light(int anchor, matchpat_callback_fn_ptr callback, int color,
 		    struct pattern *pattern, int ll, void *callback_data,
 		    signed char goal[BOARDMAX], int anchor_in_goal)
 {
   int k;			/* Iterate over elements of pattern */
   int found_goal = 0;
+  int matched = 0;
   
 #if PROFILE_PATTERNS
   int nodes_before;
@@ -739,11 +1073,11 @@ check_pattern_light(int anchor, matchpat_callback_fn_ptr callback, int color,
   /* Throw out duplicating orientations of symmetric patterns. */
   if (pattern->trfno == 5) {
     if (ll < 2 || ll >= 6)
-      return;
+      return 0;
   }
   else {
     if (ll >= pattern->trfno)
-      return;
+      return 0;
   }
 
  
@@ -787,11 +1121,15 @@ check_pattern_light(int anchor, matchpat_callback_fn_ptr callback, int color,
 #if PROFILE_PATTERNS
   pattern->reading_nodes += stats.nodes - nodes_before;
 #endif
+
+  matched = 1;
   
   /* We jump to here as soon as we discover a pattern has failed. */
  match_failed:
   DEBUG(DEBUG_MATCHER, "end of pattern '%s', rotation %d at %1m\n---\n",
 	pattern->name, ll, anchor);
+
+  return matched;
   
 } /* check_pattern_light */
 
@@ -807,12 +1145,16 @@ dfa_matchpat_loop(matchpat_callback_fn_ptr callback, int color, int anchor,
 		  signed char goal[BOARDMAX], int anchor_in_goal) 
 {
   int pos;
+  struct dfa_match_cache *cache = dfa_match_cache_get(pdb, color);
 
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (board[pos] == anchor && (!anchor_in_goal || goal[pos] != 0))
-      do_dfa_matchpat(pdb->pdfa, pos, callback, color, pdb->patterns,
+      do_dfa_matchpat(pdb->pdfa, cache, pos, callback, color, pdb->patterns,
 		      callback_data, goal, anchor_in_goal);
   }
+
+  if (cache)
+    cache->busy = 0;
 }
 
 
@@ -855,6 +1197,16 @@ matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 {
   loop_fn_ptr_t loop = matchpat_loop;
   prepare_fn_ptr_t prepare = prepare_for_match;
+  double start = 0.0;
+
+  /* Callbacks may match patterns themselves. Only the outermost call
+   * is timed.
+   */
+  if (showstatistics) {
+    if (matchpat_depth++ == 0)
+      start = gg_gettimeofday();
+    matchpat_calls++;
+  }
 
   /* check board size */
   if (pdb->fixed_for_size != board_size) {
@@ -893,6 +1245,23 @@ matchpat_goal_anchor(matchpat_callback_fn_ptr callback, int color,
 	loop(callback, color, BLACK, pdb, callback_data, goal, anchor_in_goal);
       }
   }
+
+  if (showstatistics && --matchpat_depth == 0)
+    matchpat_time += gg_gettimeofday() - start;
+}
+
+
+/* Match the patterns anchored at the points marked in anchors[].
+ * Unlike matchpat_goal_anchor(), the grid matcher does not require
+ * that a pattern involves a stone marked in anchors[].
+ */
+void
+matchpat_anchors(matchpat_callback_fn_ptr callback, int color,
+		 struct pattern_db *pdb, void *callback_data,
+		 signed char anchors[BOARDMAX])
+{
+  matchpat_goal_anchor(callback, color, pdb, callback_data, anchors,
+		       ANCHORS_ONLY);
 }
 
 
@@ -917,7 +1286,7 @@ fullboard_matchpat(fullboard_matchpat_callback_fn_ptr callback, int color,
   int ll;   /* Iterate over transformations (rotations or reflections)  */
   /* We transform around the center point. */
   int number_of_stones_on_board = stones_on_board(BLACK | WHITE);
-  static int color_map[gg_max(WHITE, BLACK) + 1];
+  static THREAD_LOCAL int color_map[gg_max(WHITE, BLACK) + 1];
   /* One hash value for each rotation/reflection: */
   Hash_data current_board_hash[8];
   
@@ -993,13 +1362,13 @@ static const int corner_y[8] = {0, 1, 1, 0, 1, 0, 0, 1};
  * However, it may be anchored at any corner of the board, so if the board is
  * small, we may calculate NUM_STONES() at negative coordinates.
  */
-static int num_stones[2*BOARDMAX];
+static THREAD_LOCAL int num_stones[2*BOARDMAX];
 #define NUM_STONES(pos) num_stones[(pos) + BOARDMAX]
 
 /* Stone locations are stored in this array. They might be needed by callback
  * function.
  */
-static int pattern_stones[BOARDMAX];
+static THREAD_LOCAL int pattern_stones[BOARDMAX];
 
 
 /* Recursively performs corner matching. This function checks whether
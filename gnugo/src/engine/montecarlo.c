@@ -34,6 +34,10 @@
 #include "random.h"
 #include <math.h>
 
+#if ENGINE_THREADS
+#include <pthread.h>
+#endif
+
 /* FIXME: Replace with a DEBUG_MC symbol for use with -d. */
 static int mc_debug = 0;
 
@@ -114,6 +118,12 @@ static int mc_debug = 0;
  * The partitioned_move_value_sums_* arrays are simply the sums of
  * move values in each partition and the move_value_sum_white_* fields
  * are the sum of the values of all legal moves.
+ *
+ * If use_bitboards is set, the strings are not tracked by the
+ * reference_stone, next_stone and liberty edge fields. Instead the
+ * stones of each color and the empty vertices are kept in the stones
+ * bitboards, indexed by color, and strings and their liberties are
+ * found by flood fills when they are needed. See mc_bits below.
  */
 
 #if MAX_BOARD < 4
@@ -126,6 +136,23 @@ static int mc_debug = 0;
 #define NUM_MOVE_PARTITIONS 16
 #endif
 
+/* A bitboard has one bit for each vertex from BOARDMIN to BOARDMAX,
+ * bit number pos - BOARDMIN for the vertex pos. Since the board
+ * array has an off-board column between the rows, the neighbors of
+ * a bit are found by shifting one step for east and west and NS
+ * steps for north and south, exactly as for the delta[] offsets.
+ * The bits are stored in 64-bit words, six of them for a 19x19 board,
+ * with an always empty word at both ends so that the shifts in
+ * mc_bits_dilate() need no special cases and can be vectorized.
+ */
+#define MC_BITS_PER_WORD 64
+#define MC_WORDS ((BOARDMAX - BOARDMIN + MC_BITS_PER_WORD - 1) \
+		  / MC_BITS_PER_WORD)
+
+struct mc_bits {
+  unsigned long long words[MC_WORDS + 2];
+};
+
 struct mc_board {
   Intersection board[BOARDSIZE];
   int local_context[BOARDSIZE];
@@ -145,6 +172,8 @@ struct mc_board {
   int previous_liberty_edge[4 * BOARDMAX];
   int next_liberty_edge[4 * BOARDMAX];
   Hash_data hash;
+  int use_bitboards;
+  struct mc_bits stones[3];
 };
 
 #define MC_ADD_TO_UPDATE_QUEUE(mc, pos) \
@@ -157,6 +186,103 @@ struct mc_board {
 
 #define MC_ON_BOARD(pos) (mc->board[pos] != GRAY)
 
+#define MC_BIT_WORD(pos) (((pos) - BOARDMIN) / MC_BITS_PER_WORD + 1)
+#define MC_BIT_MASK(pos) \
+  ((unsigned long long) 1 << (((pos) - BOARDMIN) % MC_BITS_PER_WORD))
+#define MC_BITS_SET(bits, pos) \
+  ((bits)->words[MC_BIT_WORD(pos)] |= MC_BIT_MASK(pos))
+#define MC_BITS_CLEAR(bits, pos) \
+  ((bits)->words[MC_BIT_WORD(pos)] &= ~MC_BIT_MASK(pos))
+#define MC_BITS_TEST(bits, pos) \
+  (((bits)->words[MC_BIT_WORD(pos)] & MC_BIT_MASK(pos)) != 0)
+
+/* Number of set bits in a word. */
+static int
+mc_popcount(unsigned long long word)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(word);
+#else
+  int n = 0;
+  while (word) {
+    word &= word - 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/* Index of the lowest set bit in a non-zero word. */
+static int
+mc_lowest_bit(unsigned long long word)
+{
+#ifdef __GNUC__
+  return __builtin_ctzll(word);
+#else
+  int n = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/* Number of vertices in a bitboard. */
+static int
+mc_bits_count(const struct mc_bits *bits)
+{
+  int n = 0;
+  int k;
+  for (k = 1; k <= MC_WORDS; k++)
+    if (bits->words[k])
+      n += mc_popcount(bits->words[k]);
+  return n;
+}
+
+/* Word k of the vertices in bits together with their neighbors. */
+#define MC_DILATE_WORD(bits, k)					\
+  ((bits)->words[k]						\
+   | (bits)->words[k] << 1					\
+   | (bits)->words[(k) - 1] >> (MC_BITS_PER_WORD - 1)		\
+   | (bits)->words[k] >> 1					\
+   | (bits)->words[(k) + 1] << (MC_BITS_PER_WORD - 1)		\
+   | (bits)->words[k] << NS					\
+   | (bits)->words[(k) - 1] >> (MC_BITS_PER_WORD - NS)		\
+   | (bits)->words[k] >> NS					\
+   | (bits)->words[(k) + 1] << (MC_BITS_PER_WORD - NS))
+
+/* Set out to the vertices in bits together with their neighbors,
+ * restricted to the vertices in mask. The bitboards bits and out must
+ * not be the same.
+ */
+static void
+mc_bits_dilate(const struct mc_bits *bits, const struct mc_bits *mask,
+	       struct mc_bits *out)
+{
+  int k;
+  out->words[0] = 0;
+  out->words[MC_WORDS + 1] = 0;
+  for (k = 1; k <= MC_WORDS; k++)
+    out->words[k] = MC_DILATE_WORD(bits, k) & mask->words[k];
+}
+
+/* Add the vertices in bits to the update queue. */
+static void
+mc_bits_queue(struct mc_board *mc, const struct mc_bits *bits)
+{
+  int k;
+  for (k = 1; k <= MC_WORDS; k++) {
+    unsigned long long word = bits->words[k];
+    while (word) {
+      int pos = BOARDMIN + (k - 1) * MC_BITS_PER_WORD + mc_lowest_bit(word);
+      MC_ADD_TO_UPDATE_QUEUE(mc, pos);
+      word &= word - 1;
+    }
+  }
+}
+
+
 /* Add a liberty edge for a string at pos with liberty at lib and
  * direction dir.
  */
@@ -330,9 +456,12 @@ mc_remove_string(struct mc_board *mc, int str)
 }
 
 
-/* Initialize a Monte Carlo board struct from the global board. */
+/* Initialize a Monte Carlo board struct from the global board. The
+ * strings are tracked with bitboards if use_bitboards is set and with
+ * liberty edges otherwise.
+ */
 static void
-mc_init_board_from_global_board(struct mc_board *mc)
+mc_init_board_from_global_board(struct mc_board *mc, int use_bitboards)
 {
   int stones[BOARDMAX];
   int num_stones;
@@ -345,6 +474,8 @@ mc_init_board_from_global_board(struct mc_board *mc)
   mc->hash = board_hash;
   memset(mc->queue, 0, sizeof(mc->queue));
   mc->queue[0] = 1;
+  mc->use_bitboards = use_bitboards;
+  memset(mc->stones, 0, sizeof(mc->stones));
 
   memset(mc->next_stone, 0, sizeof(mc->next_stone));
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
@@ -385,7 +516,11 @@ mc_init_board_from_global_board(struct mc_board *mc)
       mc->local_context[pos] |= captured_white_stones << 18;
     }
     
-    if (IS_STONE(board[pos]) && mc->next_stone[pos] == 0) {
+    if (use_bitboards) {
+      if (ON_BOARD(pos))
+	MC_BITS_SET(&mc->stones[board[pos]], pos);
+    }
+    else if (IS_STONE(board[pos]) && mc->next_stone[pos] == 0) {
       num_stones = findstones(pos, BOARDMAX, stones);
       mc->first_liberty_edge[pos] = 0;
       for (r = 0; r < num_stones; r++) {
@@ -796,13 +931,459 @@ mc_update_local_context(struct mc_board *mc, int pos)
 }
 
 
-/* Play the move at pos by color. */
+/* Update the strings for a stone of color just placed at pos, using
+ * the liberty edges. Remove captured strings and set the ko position.
+ */
+static void
+mc_play_stone(struct mc_board *mc, int pos, int color)
+{
+  int k;
+  int captured_stones = 0;
+  int num_direct_liberties = 0;
+  int pos2;
+
+  mc->next_stone[pos] = pos;
+  mc->reference_stone[pos] = pos;
+  mc->first_liberty_edge[pos] = 0;
+
+  for (k = 0; k < 4; k++) {
+    pos2 = pos + delta[k];
+    if (mc->board[pos2] == EMPTY) {
+      mc_add_liberty_edge(mc, pos, pos2, (k + 2) % 4);
+      num_direct_liberties++;
+      MC_ADD_TO_UPDATE_QUEUE(mc, pos2);
+    }
+  }
+  
+  for (k = 0; k < 4; k++) {
+    int liberty;
+    pos2 = pos + delta[k];
+    if (mc->board[pos2] == color) {
+      if (mc->reference_stone[pos] != mc->reference_stone[pos2]) {
+	if (mc_has_two_liberties_one_given(mc, pos2, pos, &liberty))
+	  MC_ADD_TO_UPDATE_QUEUE(mc, liberty);
+	mc_join_strings(mc, pos, pos2);
+      }
+      mc_remove_liberty_edge(mc, pos2, pos, k);
+    }
+  }
+
+  for (k = 0; k < 4; k++) {
+    pos2 = pos + delta[k];
+    if (mc->board[pos2] == OTHER_COLOR(color)) {
+      if (mc_remove_liberty_edge(mc, pos2, pos, k) == 0)
+	captured_stones += mc_remove_string(mc, pos2);
+      else
+	mc_queue_max_two_liberties(mc, pos2);
+    }
+  }
+
+  if (captured_stones == 1
+      && mc->next_stone[pos] == pos
+      && num_direct_liberties == 0) {
+    mc->board_ko_pos = mc->first_liberty_edge[pos] >> 2;
+    hashdata_invert_ko(&mc->hash, mc->board_ko_pos);
+  }
+
+  mc_queue_max_two_liberties(mc, pos);
+}
+
+
+/* The functions below do the work of mc_play_stone(),
+ * mc_remove_string() and mc_update_local_context() on a board which
+ * tracks the strings with bitboards. They queue the same vertices
+ * for updates, although not necessarily in the same order.
+ */
+
+/* Find the string at str and its liberties by a flood fill from str.
+ * Since a string can only grow by one word in each direction per
+ * step, only the words holding the string and their neighbors are
+ * examined.
+ */
+static void
+mc_bb_find_string(struct mc_board *mc, int str, struct mc_bits *string,
+		  struct mc_bits *liberties)
+{
+  const struct mc_bits *region = &mc->stones[mc->board[str]];
+  unsigned long long next[MC_WORDS + 2];
+  unsigned long long changed;
+  int first = MC_BIT_WORD(str);
+  int last = first;
+  int k;
+
+  memset(string, 0, sizeof(*string));
+  MC_BITS_SET(string, str);
+
+  /* Lone stones are common enough to be worth a shortcut. */
+  if (mc->board[SOUTH(str)] != mc->board[str]
+      && mc->board[WEST(str)] != mc->board[str]
+      && mc->board[NORTH(str)] != mc->board[str]
+      && mc->board[EAST(str)] != mc->board[str]) {
+    memset(liberties, 0, sizeof(*liberties));
+    for (k = 0; k < 4; k++)
+      if (mc->board[str + delta[k]] == EMPTY)
+	MC_BITS_SET(liberties, str + delta[k]);
+    return;
+  }
+
+  do {
+    first = gg_max(first - 1, 1);
+    last = gg_min(last + 1, MC_WORDS);
+    for (k = first; k <= last; k++)
+      next[k] = MC_DILATE_WORD(string, k) & region->words[k];
+    changed = 0;
+    for (k = first; k <= last; k++) {
+      changed |= next[k] ^ string->words[k];
+      string->words[k] = next[k];
+    }
+    while (string->words[first] == 0)
+      first++;
+    while (string->words[last] == 0)
+      last--;
+  } while (changed);
+
+  memset(liberties, 0, sizeof(*liberties));
+  first = gg_max(first - 1, 1);
+  last = gg_min(last + 1, MC_WORDS);
+  for (k = first; k <= last; k++)
+    liberties->words[k] = (MC_DILATE_WORD(string, k)
+			   & mc->stones[EMPTY].words[k]);
+}
+
+
+/* Queue the liberties of a string if there are at most two of them. */
+static void
+mc_bb_queue_max_two_liberties(struct mc_board *mc,
+			      const struct mc_bits *liberties)
+{
+  if (mc_bits_count(liberties) <= 2)
+    mc_bits_queue(mc, liberties);
+}
+
+
+/* Remove the string of color given by the bitboard string. */
 static int
-mc_play_move(struct mc_board *mc, int pos, int color)
+mc_bb_remove_string(struct mc_board *mc, const struct mc_bits *string,
+		    int color)
+{
+  int other = OTHER_COLOR(color);
+  struct mc_bits neighbors;
+  struct mc_bits neighbor_string;
+  struct mc_bits liberties;
+  int num_removed_stones = 0;
+  int pos;
+  int k;
+  int m;
+
+  /* The adjacent strings are about to get more liberties. */
+  mc_bits_dilate(string, &mc->stones[other], &neighbors);
+  for (m = 1; m <= MC_WORDS; m++) {
+    while (neighbors.words[m]) {
+      pos = (BOARDMIN + (m - 1) * MC_BITS_PER_WORD
+	     + mc_lowest_bit(neighbors.words[m]));
+      mc_bb_find_string(mc, pos, &neighbor_string, &liberties);
+      mc_bb_queue_max_two_liberties(mc, &liberties);
+      for (k = m; k <= MC_WORDS; k++)
+	neighbors.words[k] &= ~neighbor_string.words[k];
+    }
+  }
+
+  for (m = 1; m <= MC_WORDS; m++) {
+    unsigned long long word = string->words[m];
+    while (word) {
+      pos = BOARDMIN + (m - 1) * MC_BITS_PER_WORD + mc_lowest_bit(word);
+      word &= word - 1;
+      for (k = 0; k < 8; k++)
+	if (mc->board[pos + delta[k]] == EMPTY)
+	  MC_ADD_TO_UPDATE_QUEUE(mc, pos + delta[k]);
+      mc->board[pos] = EMPTY;
+      mc->local_context[NW(pos)] ^= color << 14;
+      mc->local_context[SW(pos)] ^= color << 12;
+      mc->local_context[SE(pos)] ^= color << 10;
+      mc->local_context[NE(pos)] ^= color << 8;
+      mc->local_context[WEST(pos)] ^= color << 6;
+      mc->local_context[SOUTH(pos)] ^= color << 4;
+      mc->local_context[EAST(pos)] ^= color << 2;
+      mc->local_context[NORTH(pos)] ^= color;
+      hashdata_invert_stone(&(mc->hash), pos, color);
+      MC_ADD_TO_UPDATE_QUEUE(mc, pos);
+      num_removed_stones++;
+    }
+    mc->stones[color].words[m] &= ~string->words[m];
+    mc->stones[EMPTY].words[m] |= string->words[m];
+  }
+
+  return num_removed_stones;
+}
+
+
+/* Strings found while a move is played and the local contexts
+ * around it are updated. Nothing changes on the board during the
+ * updates, so each string needs to be flood filled only once.
+ */
+#define MC_STRING_CACHE_SIZE 16
+
+struct mc_string_cache {
+  int num_strings;
+  struct mc_bits strings[MC_STRING_CACHE_SIZE];
+  int num_liberties[MC_STRING_CACHE_SIZE];
+  int num_stones[MC_STRING_CACHE_SIZE];
+};
+
+
+/* Add a string with the given liberties to the cache and return its
+ * index.
+ */
+static int
+mc_bb_cache_string(struct mc_string_cache *cache,
+		   const struct mc_bits *string,
+		   const struct mc_bits *liberties)
+{
+  int k = cache->num_strings++;
+  cache->strings[k] = *string;
+  cache->num_liberties[k] = mc_bits_count(liberties);
+  cache->num_stones[k] = mc_bits_count(string);
+  return k;
+}
+
+
+/* Return the index of the string at str in the cache, or -1 if it
+ * isn't there.
+ */
+static int
+mc_bb_lookup_string(struct mc_string_cache *cache, int str)
 {
   int k;
+  for (k = 0; k < cache->num_strings; k++)
+    if (MC_BITS_TEST(&cache->strings[k], str))
+      return k;
+  return -1;
+}
+
+
+/* Return the index of the string at str in the cache, adding it if
+ * necessary.
+ */
+static int
+mc_bb_cached_string(struct mc_board *mc, struct mc_string_cache *cache,
+		    int str)
+{
+  struct mc_bits string;
+  struct mc_bits liberties;
+  int k = mc_bb_lookup_string(cache, str);
+
+  if (k >= 0)
+    return k;
+  mc_bb_find_string(mc, str, &string, &liberties);
+  return mc_bb_cache_string(cache, &string, &liberties);
+}
+
+
+/* Bitboard version of mc_play_stone(). The new string and the
+ * adjacent strings of the opponent are left in the cache, which must
+ * be empty initially.
+ */
+static void
+mc_bb_play_stone(struct mc_board *mc, int pos, int color,
+		 struct mc_string_cache *cache)
+{
+  int other = OTHER_COLOR(color);
+  struct mc_bits new_string;
+  struct mc_bits string;
+  struct mc_bits liberties;
   int captured_stones = 0;
   int num_direct_liberties = 0;
+  int num_friendly_neighbors = 0;
+  int pos2;
+  int k;
+  int m;
+
+  /* Collect the friendly strings which pos joins. Those with only one
+   * liberty besides pos get more, so queue that liberty.
+   */
+  memset(&new_string, 0, sizeof(new_string));
+  for (k = 0; k < 4; k++) {
+    pos2 = pos + delta[k];
+    if (mc->board[pos2] == EMPTY) {
+      num_direct_liberties++;
+      MC_ADD_TO_UPDATE_QUEUE(mc, pos2);
+    }
+    else if (mc->board[pos2] == color) {
+      num_friendly_neighbors++;
+      if (!MC_BITS_TEST(&new_string, pos2)) {
+	mc_bb_find_string(mc, pos2, &string, &liberties);
+	if (mc_bits_count(&liberties) == 2) {
+	  MC_BITS_CLEAR(&liberties, pos);
+	  mc_bits_queue(mc, &liberties);
+	}
+	for (m = 1; m <= MC_WORDS; m++)
+	  new_string.words[m] |= string.words[m];
+      }
+    }
+  }
+
+  MC_BITS_SET(&new_string, pos);
+  MC_BITS_SET(&mc->stones[color], pos);
+  MC_BITS_CLEAR(&mc->stones[EMPTY], pos);
+
+  /* Capture opponent strings left without liberties. */
+  for (k = 0; k < 4; k++) {
+    pos2 = pos + delta[k];
+    if (mc->board[pos2] == other && mc_bb_lookup_string(cache, pos2) < 0) {
+      mc_bb_find_string(mc, pos2, &string, &liberties);
+      if (mc_bits_count(&liberties) == 0)
+	captured_stones += mc_bb_remove_string(mc, &string, other);
+      else {
+	mc_bb_queue_max_two_liberties(mc, &liberties);
+	mc_bb_cache_string(cache, &string, &liberties);
+      }
+    }
+  }
+
+  if (captured_stones == 1
+      && num_friendly_neighbors == 0
+      && num_direct_liberties == 0) {
+    for (k = 0; k < 4; k++)
+      if (mc->board[pos + delta[k]] == EMPTY)
+	mc->board_ko_pos = pos + delta[k];
+    hashdata_invert_ko(&mc->hash, mc->board_ko_pos);
+  }
+
+  mc_bits_dilate(&new_string, &mc->stones[EMPTY], &liberties);
+  mc_bb_queue_max_two_liberties(mc, &liberties);
+  mc_bb_cache_string(cache, &new_string, &liberties);
+}
+
+
+/* Would a stone of color at pos have at most one liberty? The
+ * adjacent strings are given by their indices in the cache, or -1
+ * for vertices without stones.
+ */
+static int
+mc_bb_is_self_atari(struct mc_board *mc, int pos, int color,
+		    struct mc_string_cache *cache, int strings[4])
+{
+  struct mc_bits string;
+  struct mc_bits region;
+  struct mc_bits liberties;
+  int k;
+  int m;
+
+  memset(&string, 0, sizeof(string));
+  region = mc->stones[EMPTY];
+  for (k = 0; k < 4; k++) {
+    int n = strings[k];
+    if (n < 0)
+      continue;
+    if (mc->board[pos + delta[k]] == color) {
+      for (m = 1; m <= MC_WORDS; m++)
+	string.words[m] |= cache->strings[n].words[m];
+    }
+    else if (cache->num_liberties[n] == 1) {
+      for (m = 1; m <= MC_WORDS; m++)
+	region.words[m] |= cache->strings[n].words[m];
+    }
+  }
+  MC_BITS_SET(&string, pos);
+  MC_BITS_CLEAR(&region, pos);
+  mc_bits_dilate(&string, &region, &liberties);
+
+  return mc_bits_count(&liberties) <= 1;
+}
+
+
+/* Bitboard version of mc_update_local_context(). Self-atari and
+ * captures are read off from the adjacent strings and their
+ * liberties.
+ */
+static void
+mc_bb_update_local_context(struct mc_board *mc, int pos,
+			   struct mc_string_cache *cache)
+{
+  int strings[4];
+  int min_white_liberties = 0;
+  int min_black_liberties = 0;
+  int white_liberty_through_stones = 0;
+  int black_liberty_through_stones = 0;
+  int white_suicide = 0;
+  int black_suicide = 0;
+  int white_self_atari = 0;
+  int black_self_atari = 0;
+  int white_captured_stones = 0;
+  int black_captured_stones = 0;
+  int k;
+
+  /* Make room for the strings around pos. */
+  if (cache->num_strings > MC_STRING_CACHE_SIZE - 4)
+    cache->num_strings = 0;
+
+  for (k = 0; k < 4; k++) {
+    int pos2 = pos + delta[k];
+    int n;
+
+    strings[k] = -1;
+    switch (mc->board[pos2]) {
+      case EMPTY:
+	min_white_liberties++;
+	min_black_liberties++;
+	break;
+      case WHITE:
+	n = mc_bb_cached_string(mc, cache, pos2);
+	strings[k] = n;
+	if (cache->num_liberties[n] == 1) {
+	  min_black_liberties++;
+	  white_captured_stones += cache->num_stones[n];
+	}
+	else
+	  white_liberty_through_stones = 1;
+	break;
+      case BLACK:
+	n = mc_bb_cached_string(mc, cache, pos2);
+	strings[k] = n;
+	if (cache->num_liberties[n] == 1) {
+	  min_white_liberties++;
+	  black_captured_stones += cache->num_stones[n];
+	}
+	else
+	  black_liberty_through_stones = 1;
+	break;
+    }
+  }
+
+  if (min_white_liberties + white_liberty_through_stones == 0) {
+    white_suicide = 1;
+    white_self_atari = 1;
+  }
+  else if (min_white_liberties <= 1)
+    white_self_atari = mc_bb_is_self_atari(mc, pos, WHITE, cache, strings);
+
+  if (min_black_liberties + black_liberty_through_stones == 0) {
+    black_suicide = 1;
+    black_self_atari = 1;
+  }
+  else if (min_black_liberties <= 1)
+    black_self_atari = mc_bb_is_self_atari(mc, pos, BLACK, cache, strings);
+
+  if (white_captured_stones > 3)
+    white_captured_stones = 3;
+  if (black_captured_stones > 3)
+    black_captured_stones = 3;
+
+  mc->local_context[pos] &= 0xffff;
+  mc->local_context[pos] |= black_captured_stones << 16;
+  mc->local_context[pos] |= white_captured_stones << 18;
+  mc->local_context[pos] |= white_self_atari << 20;
+  mc->local_context[pos] |= black_self_atari << 21;
+  mc->local_context[pos] |= white_suicide << 22;
+  mc->local_context[pos] |= black_suicide << 23;
+}
+
+
+/* Play the move at pos by color. */
+static int
+mc_play_move(struct mc_board *mc, int pos, int color)
+{
+  int k;
   int pos2;
 
   /* Clear the update queue. */
@@ -840,7 +1421,6 @@ mc_play_move(struct mc_board *mc, int pos, int color)
 #endif
   mc->board[pos] = color;
   hashdata_invert_stone(&mc->hash, pos, color);
-  mc->next_stone[pos] = pos;
   
   /* Update the geometry part of the local context. */
   mc->local_context[NW(pos)] |= color << 14;
@@ -851,58 +1431,25 @@ mc_play_move(struct mc_board *mc, int pos, int color)
   mc->local_context[SOUTH(pos)] |= color << 4;
   mc->local_context[EAST(pos)] |= color << 2;
   mc->local_context[NORTH(pos)] |= color;
-  
-  mc->reference_stone[pos] = pos;
-  mc->first_liberty_edge[pos] = 0;
 
-  for (k = 0; k < 4; k++) {
-    pos2 = pos + delta[k];
-    if (mc->board[pos2] == EMPTY) {
-      mc_add_liberty_edge(mc, pos, pos2, (k + 2) % 4);
-      num_direct_liberties++;
-      MC_ADD_TO_UPDATE_QUEUE(mc, pos2);
-    }
-  }
-  
-  for (k = 0; k < 4; k++) {
-    int liberty;
-    pos2 = pos + delta[k];
-    if (mc->board[pos2] == color) {
-      if (mc->reference_stone[pos] != mc->reference_stone[pos2]) {
-	if (mc_has_two_liberties_one_given(mc, pos2, pos, &liberty))
-	  MC_ADD_TO_UPDATE_QUEUE(mc, liberty);
-	mc_join_strings(mc, pos, pos2);
-      }
-      mc_remove_liberty_edge(mc, pos2, pos, k);
-    }
-  }
-
-  for (k = 0; k < 4; k++) {
-    pos2 = pos + delta[k];
-    if (mc->board[pos2] == OTHER_COLOR(color)) {
-      if (mc_remove_liberty_edge(mc, pos2, pos, k) == 0)
-	captured_stones += mc_remove_string(mc, pos2);
-      else
-	mc_queue_max_two_liberties(mc, pos2);
-    }
+  /* Update the strings, then traverse the update queue and update the
+   * local context for queued points.
+   */
+  if (mc->use_bitboards) {
+    struct mc_string_cache cache;
+    cache.num_strings = 0;
+    mc_bb_play_stone(mc, pos, color, &cache);
+    for (pos2 = mc->queue[0]; pos2 != 1; pos2 = mc->queue[pos2])
+      if (pos2 != pos)
+	mc_bb_update_local_context(mc, pos2, &cache);
   }
-
-  if (captured_stones == 1
-      && mc->next_stone[pos] == pos
-      && num_direct_liberties == 0) {
-    mc->board_ko_pos = mc->first_liberty_edge[pos] >> 2;
-    hashdata_invert_ko(&mc->hash, mc->board_ko_pos);
+  else {
+    mc_play_stone(mc, pos, color);
+    for (pos2 = mc->queue[0]; pos2 != 1; pos2 = mc->queue[pos2])
+      if (pos2 != pos)
+	mc_update_local_context(mc, pos2);
   }
 
-  mc_queue_max_two_liberties(mc, pos);
-
-  /* Traverse the update queue and update the local context for queued
-   * points.
-   */
-  for (pos2 = mc->queue[0]; pos2 != 1; pos2 = mc->queue[pos2])
-    if (pos2 != pos)
-      mc_update_local_context(mc, pos2);
-
   /* Add the immediate neighborhood of the move to the update queue
    * for recomputation of move values later on.
    */
@@ -1746,10 +2293,56 @@ static int mc_play_random_game(struct mc_game *game)
   return score;
 }
 
+
+/* Play num_games random games from the current position with color
+ * to move, tracking the strings with bitboards if use_bitboards is
+ * set. Return the average score, positive for white and without
+ * komi. This is used to compare the speed of the two board
+ * representations.
+ */
+float
+mc_run_playouts(int color, int num_games, int use_bitboards)
+{
+  struct mc_game starting_position;
+  struct mc_game game;
+  int total_score = 0;
+  int k;
+
+  mc_init_board_from_global_board(&starting_position.mc, use_bitboards);
+  mc_init_move_values(&starting_position.mc);
+  starting_position.color_to_move = color;
+  starting_position.consecutive_passes = 0;
+  starting_position.consecutive_ko_captures = 0;
+  starting_position.last_move = get_last_move();
+  starting_position.depth = 0;
+  memset(starting_position.settled, 0, sizeof(starting_position.settled));
+
+  for (k = 0; k < num_games; k++) {
+    game = starting_position;
+    total_score += mc_play_random_game(&game);
+  }
+
+  return (float) total_score / gg_max(num_games, 1);
+}
+
 /******************* UCT search ***********************/
 
+/* The search tree is shared by mc_threads threads, each playing its
+ * own simulations on its own copy of the starting position. Nodes,
+ * arcs and hash table slots are claimed with atomic operations, and
+ * the statistics of the nodes are updated atomically. A thread
+ * descending through a node counts a virtual loss for it until its
+ * simulation has been scored, which steers the other threads towards
+ * different variations.
+ */
+
 #define UCT_MAX_SEARCH_DEPTH BOARDMAX
 
+/* Arcs and nodes kept in reserve for each thread, since the threads
+ * only check for a full tree between their simulations.
+ */
+#define UCT_RESERVE_PER_THREAD 10
+
 struct bitboard {
   /* FIXME: Do this properly. */
   unsigned int bits[1 + BOARDMAX / 32];
@@ -1764,6 +2357,7 @@ struct uct_arc {
 struct uct_node {
   int wins;
   int games;
+  int virtual_losses;
   float sum_scores;
   float sum_scores2;
   struct uct_arc *child;
@@ -1771,6 +2365,7 @@ struct uct_node {
   Hash_data boardhash;
 };
 
+/* The part of the search shared by all threads. */
 struct uct_tree {
   struct uct_node *nodes;
   struct uct_arc *arcs;
@@ -1781,8 +2376,17 @@ struct uct_tree {
   int num_used_nodes;
   int num_arcs;
   int num_used_arcs;
+  int reserved_arcs;
+  int virtual_loss;
   int *forbidden_moves;
+  float komi;
+};
+
+/* The part of the search private to one thread. */
+struct uct_search {
+  struct uct_tree *tree;
   struct mc_game game;
+  int new_arcs;
   int move_score[BOARDSIZE];
   int move_ordering[BOARDSIZE];
   int inverse_move_ordering[BOARDSIZE];
@@ -1790,43 +2394,115 @@ struct uct_tree {
 };
 
 
+/* Atomic operations on the shared tree. Without ENGINE_THREADS there
+ * is only one thread and plain operations do.
+ */
+static int
+uct_fetch_and_add(int *value, int n)
+{
+#if ENGINE_THREADS
+  return __sync_fetch_and_add(value, n);
+#else
+  int old_value = *value;
+  *value += n;
+  return old_value;
+#endif
+}
+
+/* Clear bit in *bits and return whether it was set. */
+static int
+uct_test_and_clear_bit(unsigned int *bits, unsigned int bit)
+{
+#if ENGINE_THREADS
+  return (__sync_fetch_and_and(bits, ~bit) & bit) != 0;
+#else
+  int was_set = (*bits & bit) != 0;
+  *bits &= ~bit;
+  return was_set;
+#endif
+}
+
+static int
+uct_claim_hash_slot(unsigned int *slot, unsigned int node_index)
+{
+#if ENGINE_THREADS
+  return __sync_bool_compare_and_swap(slot, 0, node_index);
+#else
+  if (*slot != 0)
+    return 0;
+  *slot = node_index;
+  return 1;
+#endif
+}
+
+static void
+uct_push_arc(struct uct_node *parent, struct uct_arc *arc)
+{
+#if ENGINE_THREADS
+  do {
+    arc->next = parent->child;
+  } while (!__sync_bool_compare_and_swap(&parent->child, arc->next, arc));
+#else
+  arc->next = parent->child;
+  parent->child = arc;
+#endif
+}
+
+
 static struct uct_node *
-uct_init_node(struct uct_tree *tree, int *allowed_moves)
+uct_init_node(struct uct_search *search, int *allowed_moves)
 {
   int pos;
-  struct uct_node *node = &tree->nodes[tree->num_used_nodes++];
+  struct uct_tree *tree = search->tree;
+  int node_index = uct_fetch_and_add(&tree->num_used_nodes, 1);
+  struct uct_node *node = &tree->nodes[node_index];
+  gg_assert(node_index < tree->num_nodes);
 
   node->wins = 0;
   node->games = 0;
+  node->virtual_losses = 0;
   node->sum_scores = 0.0;
   node->sum_scores2 = 0.0;
   node->child = NULL;
   memset(node->untested.bits, 0, sizeof(node->untested.bits));
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
-    if (tree->game.mc.board[pos] == EMPTY
+    if (search->game.mc.board[pos] == EMPTY
 	&& !tree->forbidden_moves[pos]
 	&& (!allowed_moves || allowed_moves[pos])) {
       node->untested.bits[pos / 32] |= 1 << pos % 32;
     }
   }
-  node->boardhash = tree->game.mc.hash;
+  node->boardhash = search->game.mc.hash;
 
   return node;
 }
 
 static struct uct_node *
-uct_find_node(struct uct_tree *tree, struct uct_node *parent, int move)
+uct_find_node(struct uct_search *search, struct uct_node *parent, int move)
 {
+  struct uct_tree *tree = search->tree;
   struct uct_node *node = NULL;
-  Hash_data *boardhash = &tree->game.mc.hash;
+  struct uct_node *new_node = NULL;
+  Hash_data *boardhash = &search->game.mc.hash;
   unsigned int hash_index = hashdata_remainder(*boardhash,
 					       tree->hashtable_size);
   unsigned int *hashtable = tree->hashtable_even;
-  if (tree->game.depth & 1)
+  if (search->game.depth & 1)
     hashtable = tree->hashtable_odd;
 
-  while (hashtable[hash_index] != 0) {
+  while (!node) {
     int node_index = hashtable[hash_index];
+    if (node_index == 0) {
+      /* Add a new node here, unless another thread takes the slot
+       * first. Then look at the slot again, it may hold this very
+       * position.
+       */
+      if (!new_node)
+	new_node = uct_init_node(search, NULL);
+      if (uct_claim_hash_slot(&hashtable[hash_index], new_node - tree->nodes))
+	node = new_node;
+      continue;
+    }
     gg_assert(node_index > 0 && node_index < tree->num_nodes);
     if (hashdata_is_equal(tree->nodes[node_index].boardhash, *boardhash)) {
       node = &tree->nodes[node_index];
@@ -1837,23 +2513,15 @@ uct_find_node(struct uct_tree *tree, struct uct_node *parent, int move)
       hash_index = 0;
   }
 
-  if (!node) {
-    node = uct_init_node(tree, NULL);
-    gg_assert(hash_index < tree->hashtable_size);
-    hashtable[hash_index] = node - tree->nodes;
-  }
-  
   /* Add the node as the first of the siblings. */
   if (parent) {
-    struct uct_arc *arc = &tree->arcs[tree->num_used_arcs++];
-    gg_assert(tree->num_used_arcs < tree->num_arcs);
+    int arc_index = uct_fetch_and_add(&tree->num_used_arcs, 1);
+    struct uct_arc *arc = &tree->arcs[arc_index];
+    gg_assert(arc_index + 1 < tree->num_arcs);
     arc->move = move;
     arc->node = node;
-    if (parent->child)
-      arc->next = parent->child;
-    else
-      arc->next = NULL;
-    parent->child = arc;
+    uct_push_arc(parent, arc);
+    search->new_arcs++;
   }
 
   return node;
@@ -1861,61 +2529,61 @@ uct_find_node(struct uct_tree *tree, struct uct_node *parent, int move)
 
 
 static void
-uct_update_move_ordering(struct uct_tree *tree, int move)
+uct_update_move_ordering(struct uct_search *search, int move)
 {
-  int score = ++tree->move_score[move];
+  int score = ++search->move_score[move];
   while (1) {
-    int n = tree->inverse_move_ordering[move];
+    int n = search->inverse_move_ordering[move];
     int preceding_move;
     if (n == 0)
       return;
-    preceding_move = tree->move_ordering[n - 1];
-    if (tree->move_score[preceding_move] >= score)
+    preceding_move = search->move_ordering[n - 1];
+    if (search->move_score[preceding_move] >= score)
       return;
 
     /* Swap move ordering. */
-    tree->move_ordering[n - 1] = move;
-    tree->move_ordering[n] = preceding_move;
-    tree->inverse_move_ordering[move] = n - 1;
-    tree->inverse_move_ordering[preceding_move] = n;
+    search->move_ordering[n - 1] = move;
+    search->move_ordering[n] = preceding_move;
+    search->inverse_move_ordering[move] = n - 1;
+    search->inverse_move_ordering[preceding_move] = n;
   }
 }
 
 
 static void
-uct_init_move_ordering(struct uct_tree *tree)
+uct_init_move_ordering(struct uct_search *search)
 {
   int pos;
   int k = 0;
   /* FIXME: Exclude forbidden moves. */
-  memset(tree->move_score, 0, sizeof(tree->move_score));
+  memset(search->move_score, 0, sizeof(search->move_score));
   for (pos = BOARDMIN; pos < BOARDMAX; pos++)
     if (ON_BOARD(pos)) {
-      tree->move_ordering[k] = pos;
-      tree->inverse_move_ordering[pos] = k;
+      search->move_ordering[k] = pos;
+      search->inverse_move_ordering[pos] = k;
       k++;
     }
   
-  tree->num_ordered_moves = k;
+  search->num_ordered_moves = k;
 
   /* FIXME: Quick and dirty experiment. */
   for (pos = BOARDMIN; pos < BOARDMAX; pos++) {
     if (ON_BOARD(pos)) {
-      tree->move_score[pos] = (int) (10 * potential_moves[pos]) - 1;
-      uct_update_move_ordering(tree, pos);
+      search->move_score[pos] = (int) (10 * potential_moves[pos]) - 1;
+      uct_update_move_ordering(search, pos);
     }
   }
 }
 
 
 static float
-uct_finish_and_score_game(struct mc_game *game)
+uct_finish_and_score_game(struct uct_search *search)
 {
-  return komi + mc_play_random_game(game);
+  return search->tree->komi + mc_play_random_game(&search->game);
 }
 
 static struct uct_node *
-uct_play_move(struct uct_tree *tree, struct uct_node *node, float alpha,
+uct_play_move(struct uct_search *search, struct uct_node *node, float alpha,
 	      float *gamma, int *move)
 {
   struct uct_arc *child_arc;
@@ -1924,16 +2592,26 @@ uct_play_move(struct uct_tree *tree, struct uct_node *node, float alpha,
   struct uct_arc *best_winrate_arc = NULL;
   float best_uct_value = 0.0;
   float best_winrate = 0.0;
+  int node_games = node->games + node->virtual_losses;
   
   for (child_arc = node->child; child_arc; child_arc = child_arc->next) {
     struct uct_node *child_node = child_arc->node;
-    float winrate = (float) child_node->wins / child_node->games;
+    int child_games = child_node->games + child_node->virtual_losses;
+    float winrate;
     float uct_value;
-    float log_games_ratio = log(node->games) / child_node->games;
-    float x = winrate * (1.0 - winrate) + sqrt(2.0 * log_games_ratio);
+    float log_games_ratio;
+    float x;
+
+    /* A node which another thread has only just added. */
+    if (child_games == 0)
+      continue;
+
+    winrate = (float) child_node->wins / child_games;
+    log_games_ratio = log(node_games) / child_games;
+    x = winrate * (1.0 - winrate) + sqrt(2.0 * log_games_ratio);
     if (x < 0.25)
       x = 0.25;
-    uct_value = winrate + sqrt(2 * log_games_ratio * x / (1 + tree->game.depth));
+    uct_value = winrate + sqrt(2 * log_games_ratio * x / (1 + search->game.depth));
     if (uct_value > best_uct_value) {
       next_arc = child_arc;
       best_uct_value = uct_value;
@@ -1951,24 +2629,24 @@ uct_play_move(struct uct_tree *tree, struct uct_node *node, float alpha,
   else {
     /* First play a random previously unplayed move, if any. */
     int k;
-    for (k = -1; k < tree->num_ordered_moves; k++) {
+    for (k = -1; k < search->num_ordered_moves; k++) {
       if (k == -1 && best_uct_value > 0.0)
 	continue;
       else if (k == -1)
-	pos = mc_generate_random_move(&tree->game);
+	pos = mc_generate_random_move(&search->game);
       else
-	pos = tree->move_ordering[k];
+	pos = search->move_ordering[k];
       
-      if (node->untested.bits[pos / 32] & (1 << (pos % 32))) {
+      if (uct_test_and_clear_bit(&node->untested.bits[pos / 32],
+				 1 << (pos % 32))) {
 	int r;
 	int proper_small_eye = 1;
-	struct mc_board *mc = &tree->game.mc;
+	struct mc_board *mc = &search->game.mc;
 	*move = pos;
-	node->untested.bits[*move / 32] &= ~(1 << *move % 32);
 
 	for (r = 0; r < 4; r++) {
 	  if (mc->board[pos + delta[r]] == EMPTY
-	      || mc->board[pos + delta[r]] == OTHER_COLOR(tree->game.color_to_move)) {
+	      || mc->board[pos + delta[r]] == OTHER_COLOR(search->game.color_to_move)) {
 	    proper_small_eye = 0;
 	    break;
 	  }
@@ -1980,68 +2658,129 @@ uct_play_move(struct uct_tree *tree, struct uct_node *node, float alpha,
 	    int pos2 = pos + delta[r];
 	    if (!MC_ON_BOARD(pos2))
 	      diagonal_value++;
-	    else if (mc->board[pos2] == OTHER_COLOR(tree->game.color_to_move))
+	    else if (mc->board[pos2] == OTHER_COLOR(search->game.color_to_move))
 	      diagonal_value += 2;
 	  }
 	  if (diagonal_value > 3)
 	    proper_small_eye = 0;
 	}
 	
-	if (!proper_small_eye && mc_play_random_move(&tree->game, *move))
-	  return uct_find_node(tree, node, *move);
+	if (!proper_small_eye && mc_play_random_move(&search->game, *move))
+	  return uct_find_node(search, node, *move);
       }
     }
   }
   
   if (!next_arc) {
-    mc_play_random_move(&tree->game, PASS_MOVE);
+    mc_play_random_move(&search->game, PASS_MOVE);
     *move = PASS_MOVE;
-    return uct_find_node(tree, node, PASS_MOVE);
+    return uct_find_node(search, node, PASS_MOVE);
   }
 
   *move = next_arc->move;
-  mc_play_random_move(&tree->game, next_arc->move);
+  mc_play_random_move(&search->game, next_arc->move);
   
   return next_arc->node;
 }
 
 static float
-uct_traverse_tree(struct uct_tree *tree, struct uct_node *node,
+uct_traverse_tree(struct uct_search *search, struct uct_node *node,
 		  float alpha, float beta)
 {
-  int color = tree->game.color_to_move;
-  int num_passes = tree->game.consecutive_passes;
+  struct uct_tree *tree = search->tree;
+  int color = search->game.color_to_move;
+  int num_passes = search->game.consecutive_passes;
   float result;
   float gamma;
   int move = PASS_MOVE;
+
+  if (tree->virtual_loss)
+    uct_fetch_and_add(&node->virtual_losses, tree->virtual_loss);
   
   /* FIXME: Unify these. */
-  if (num_passes == 3 || tree->game.depth >= UCT_MAX_SEARCH_DEPTH
+  if (num_passes == 3 || search->game.depth >= UCT_MAX_SEARCH_DEPTH
       || (node->games == 0 && node != tree->nodes))
-    result = uct_finish_and_score_game(&tree->game);
+    result = uct_finish_and_score_game(search);
   else {
     struct uct_node *next_node;
-    next_node = uct_play_move(tree, node, alpha, &gamma, &move);
+    next_node = uct_play_move(search, node, alpha, &gamma, &move);
     
     gamma += 0.00;
     if (gamma > 0.8)
       gamma = 0.8;
-    result = uct_traverse_tree(tree, next_node, beta, gamma);
+    result = uct_traverse_tree(search, next_node, beta, gamma);
   }
 
-  node->games++;
+  uct_fetch_and_add(&node->games, 1);
   if ((result > 0) ^ (color == WHITE)) {
-    node->wins++;
+    uct_fetch_and_add(&node->wins, 1);
     if (move != PASS_MOVE)
-      uct_update_move_ordering(tree, move);
+      uct_update_move_ordering(search, move);
   }
 
+  /* These are only used for debug output and may lose an update when
+   * several threads are searching.
+   */
   node->sum_scores += result;
   node->sum_scores2 += result * result;
+
+  if (tree->virtual_loss)
+    uct_fetch_and_add(&node->virtual_losses, -tree->virtual_loss);
   
   return result;
 }
 
+
+/* Play simulations from the starting position until the tree is full.
+ * FIXME: Terribly dirty fix.
+ */
+static void
+uct_run_simulations(struct uct_search *search,
+		    struct mc_game *starting_position)
+{
+  struct uct_tree *tree = search->tree;
+
+  while (tree->num_used_arcs < tree->num_arcs - tree->reserved_arcs) {
+    search->new_arcs = 0;
+    search->game = *starting_position;
+    uct_traverse_tree(search, &tree->nodes[0], 1.0, 0.9);
+    /* FIXME: Ugly workaround for solved positions before running out
+     * of nodes.
+     */
+    if (search->new_arcs == 0)
+      break;
+  }
+}
+
+
+#if ENGINE_THREADS
+
+struct uct_worker {
+  pthread_t thread;
+  unsigned int seed;
+  struct board_state *position;
+  struct mc_game *starting_position;
+  struct uct_search search;
+};
+
+/* The simulations use their own boards, but assertions and traces
+ * look at the engine board of the thread. So the worker first sets up
+ * its board with the position searched from.
+ */
+static void *
+uct_worker_main(void *data)
+{
+  struct uct_worker *worker = data;
+
+  restore_board(worker->position);
+  gg_srand(worker->seed);
+  uct_run_simulations(&worker->search, worker->starting_position);
+  return NULL;
+}
+
+#endif
+
+
 static int
 uct_find_best_children(struct uct_node *node, struct uct_arc **children,
 		       int n)
@@ -2116,6 +2855,9 @@ uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
 	    int nodes, float *move_values, int *move_frequencies)
 {
   struct uct_tree tree;
+  struct uct_search search;
+  int threads = 1;
+  int reserve;
   float best_score;
   struct uct_arc *arc;
   struct uct_node *node;
@@ -2125,7 +2867,7 @@ uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
   struct uct_arc *most_games_arc;
   int pos;
 
-  mc_init_board_from_global_board(&starting_position.mc);
+  mc_init_board_from_global_board(&starting_position.mc, mc_bitboards);
   mc_init_move_values(&starting_position.mc);
   starting_position.color_to_move = color;
   /* FIXME: Fill in correct information. */
@@ -2136,38 +2878,72 @@ uct_genmove(int color, int *move, int *forbidden_moves, int *allowed_moves,
   for (pos = BOARDMIN; pos < BOARDMAX; pos++)
     starting_position.settled[pos] = forbidden_moves[pos];
 
-  tree.game = starting_position;
+#if ENGINE_THREADS
+  threads = gg_max(mc_threads, 1);
+#endif
+
+  /* Every thread may overshoot the size of the tree by a few arcs
+   * and, when it loses a race for a hash table slot, a node.
+   */
+  reserve = UCT_RESERVE_PER_THREAD * (threads - 1);
+
   /* FIXME: Don't reallocate between moves. */
-  tree.nodes = malloc(nodes * sizeof(*tree.nodes));
+  tree.num_nodes = nodes + reserve;
+  tree.nodes = malloc(tree.num_nodes * sizeof(*tree.nodes));
   gg_assert(tree.nodes);
-  tree.arcs = malloc(nodes * sizeof(*tree.arcs));
+  tree.num_arcs = nodes + reserve;
+  tree.arcs = malloc(tree.num_arcs * sizeof(*tree.arcs));
   gg_assert(tree.arcs);
-  tree.hashtable_size = nodes;
+  tree.hashtable_size = tree.num_nodes;
   tree.hashtable_odd = calloc(tree.hashtable_size,
 			      sizeof(*tree.hashtable_odd));
   tree.hashtable_even = calloc(tree.hashtable_size,
 			       sizeof(*tree.hashtable_even));
   gg_assert(tree.hashtable_odd);
   gg_assert(tree.hashtable_even);
-  tree.num_nodes = nodes;
-  tree.num_arcs = nodes;
   tree.num_used_nodes = 0;
   tree.num_used_arcs = 0;
+  tree.reserved_arcs = UCT_RESERVE_PER_THREAD + reserve;
+  tree.virtual_loss = (threads > 1);
   tree.forbidden_moves = forbidden_moves;
-  uct_init_node(&tree, allowed_moves);
-  uct_init_move_ordering(&tree);
-
-  /* Play simulations. FIXME: Terribly dirty fix. */
-  while (tree.num_used_arcs < tree.num_arcs - 10) {
-    int last_used_arcs = tree.num_used_arcs;
-    tree.game = starting_position;
-    uct_traverse_tree(&tree, &tree.nodes[0], 1.0, 0.9);
-    /* FIXME: Ugly workaround for solved positions before running out
-     * of nodes.
-     */
-    if (tree.num_used_arcs == last_used_arcs)
-      break;
+  tree.komi = komi;
+
+  search.tree = &tree;
+  search.game = starting_position;
+  uct_init_node(&search, allowed_moves);
+  uct_init_move_ordering(&search);
+
+  /* Play simulations. The other threads start from a copy of this
+   * search, with their own random numbers.
+   */
+#if ENGINE_THREADS
+  if (threads > 1) {
+    struct uct_worker *workers = malloc((threads - 1) * sizeof(*workers));
+    struct board_state *position = malloc(sizeof(*position));
+    int k;
+    gg_assert(workers);
+    gg_assert(position);
+    store_board(position);
+    for (k = 0; k < threads - 1; k++) {
+      workers[k].search = search;
+      workers[k].position = position;
+      workers[k].starting_position = &starting_position;
+      workers[k].seed = gg_urand();
+      if (pthread_create(&workers[k].thread, NULL, uct_worker_main,
+			 &workers[k]) != 0) {
+	perror("Couldn't start Monte Carlo search thread");
+	exit(EXIT_FAILURE);
+      }
+    }
+    uct_run_simulations(&search, &starting_position);
+    for (k = 0; k < threads - 1; k++)
+      pthread_join(workers[k].thread, NULL);
+    free(workers);
+    free(position);
   }
+  else
+#endif
+    uct_run_simulations(&search, &starting_position);
 
   /* Identify the best move on the top level. */
   best_score = 0.0;
@@ -146,17 +146,17 @@ struct move_data {
 #define MAX_ATTACK_THREATS	6
 
 
-extern struct move_data move[BOARDMAX];
-extern struct move_reason move_reasons[MAX_MOVE_REASONS];
-extern int next_reason;
+extern THREAD_LOCAL struct move_data move[BOARDMAX];
+extern THREAD_LOCAL struct move_reason move_reasons[MAX_MOVE_REASONS];
+extern THREAD_LOCAL int next_reason;
 
 /* Connections */
-extern int conn_worm1[MAX_CONNECTIONS];
-extern int conn_worm2[MAX_CONNECTIONS];
-extern int next_connection;
+extern THREAD_LOCAL int conn_worm1[MAX_CONNECTIONS];
+extern THREAD_LOCAL int conn_worm2[MAX_CONNECTIONS];
+extern THREAD_LOCAL int next_connection;
 
-extern int semeai_target1[MAX_POTENTIAL_SEMEAI];
-extern int semeai_target2[MAX_POTENTIAL_SEMEAI];
+extern THREAD_LOCAL int semeai_target1[MAX_POTENTIAL_SEMEAI];
+extern THREAD_LOCAL int semeai_target2[MAX_POTENTIAL_SEMEAI];
 
 /* Unordered sets (currently pairs) of move reasons / targets */
 typedef struct {
@@ -165,26 +165,26 @@ typedef struct {
   int reason2;
   int what2;
 } Reason_set;
-extern Reason_set either_data[MAX_EITHER];
-extern int        next_either;
-extern Reason_set all_data[MAX_ALL];
-extern int        next_all;
+extern THREAD_LOCAL Reason_set either_data[MAX_EITHER];
+extern THREAD_LOCAL int        next_either;
+extern THREAD_LOCAL Reason_set all_data[MAX_ALL];
+extern THREAD_LOCAL int        next_all;
 
 /* Eye shapes */
-extern int eyes[MAX_EYES];
-extern int eyecolor[MAX_EYES];
-extern int next_eye;
+extern THREAD_LOCAL int eyes[MAX_EYES];
+extern THREAD_LOCAL int eyecolor[MAX_EYES];
+extern THREAD_LOCAL int next_eye;
 
 /* Lunches */
-extern int lunch_dragon[MAX_LUNCHES]; /* eater */
-extern int lunch_worm[MAX_LUNCHES];   /* food */
-extern int next_lunch;
+extern THREAD_LOCAL int lunch_dragon[MAX_LUNCHES]; /* eater */
+extern THREAD_LOCAL int lunch_worm[MAX_LUNCHES];   /* food */
+extern THREAD_LOCAL int next_lunch;
 
 /* Point redistribution */
-extern int replacement_map[BOARDMAX];
+extern THREAD_LOCAL int replacement_map[BOARDMAX];
 
 /* The color for which we are evaluating moves. */
-extern int current_color;
+extern THREAD_LOCAL int current_color;
 
 int find_worm(int str);
 int find_dragon(int str);
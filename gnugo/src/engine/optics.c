@@ -85,12 +85,12 @@ static float evaluate_diagonal_intersection(int m, int n, int color,
 
 
 /* These are used during the calculations of eye spaces. */
-static int black_domain[BOARDMAX];
-static int white_domain[BOARDMAX];
+static THREAD_LOCAL int black_domain[BOARDMAX];
+static THREAD_LOCAL int white_domain[BOARDMAX];
 
 /* Used internally by mapping functions. */
-static int map_size;
-static signed char used_index[MAXEYE];
+static THREAD_LOCAL int map_size;
+static THREAD_LOCAL signed char used_index[MAXEYE];
 
 
 /*
@@ -2349,7 +2349,7 @@ eye_move_urgency(struct eyevalue *e)
 char *
 eyevalue_to_string(struct eyevalue *e)
 {
-  static char result[30];
+  static THREAD_LOCAL char result[30];
   if (e->a < 10 && e->b < 10 && e->c < 10 && e->d < 10)
     gg_snprintf(result, 29, "%d%d%d%d", e->a, e->b, e->c, e->d);
   else
@@ -2665,7 +2665,7 @@ test_eyeshape(int eyesize, int *eye_vertices)
 static int
 eyegraph_trymove(int pos, int color, const char *message, int str)
 {
-  static Hash_data remembered_board_hashes[MAXSTACK];
+  static THREAD_LOCAL Hash_data remembered_board_hashes[MAXSTACK];
   int k;
   int does_capture = does_capture_something(pos, color);
   
@@ -103,18 +103,18 @@ struct local_owl_data {
 };
 
 
-static int result_certain;
+static THREAD_LOCAL int result_certain;
 
 /* Statistics. */
-static int local_owl_node_counter;
+static THREAD_LOCAL int local_owl_node_counter;
 /* Node limitation. */
-static int global_owl_node_counter = 0;
+static THREAD_LOCAL int global_owl_node_counter = 0;
 
-static struct local_owl_data *current_owl_data;
-static struct local_owl_data *other_owl_data;
+static THREAD_LOCAL struct local_owl_data *current_owl_data;
+static THREAD_LOCAL struct local_owl_data *other_owl_data;
 
-static int goal_worms_computed = 0;
-static int owl_goal_worm[MAX_GOAL_WORMS];
+static THREAD_LOCAL int goal_worms_computed = 0;
+static THREAD_LOCAL int owl_goal_worm[MAX_GOAL_WORMS];
 
 
 #define MAX_CUTS 5
@@ -290,17 +290,17 @@ static void remove_eye_filling_moves(struct local_owl_data *our_owl,
 static int find_semeai_backfilling_move(int worm, int liberty);
 static int liberty_of_goal(int pos, struct local_owl_data *owl);
 static int second_liberty_of_goal(int pos, struct local_owl_data *owl);
-static int matches_found;
-static signed char found_matches[BOARDMAX];
+static THREAD_LOCAL int matches_found;
+static THREAD_LOCAL signed char found_matches[BOARDMAX];
 
 static void reduced_init_owl(struct local_owl_data **owl,
     			     int at_bottom_of_stack);
 static void init_owl(struct local_owl_data **owl, int target1, int target2,
 		     int move, int use_stack, int new_dragons[BOARDMAX]);
 
-static struct local_owl_data *owl_stack[2 * MAXSTACK];
-static int owl_stack_size = 0;
-static int owl_stack_pointer = 0;
+static THREAD_LOCAL struct local_owl_data *owl_stack[2 * MAXSTACK];
+static THREAD_LOCAL int owl_stack_size = 0;
+static THREAD_LOCAL int owl_stack_pointer = 0;
 static void check_owl_stack_size(void);
 static void push_owl(struct local_owl_data **owl);
 static void do_push_owl(struct local_owl_data **owl);
@@ -317,7 +317,7 @@ static int list_goal_worms(struct local_owl_data *owl,
 /* FIXME: taken from move_reasons.h */
 #define MAX_DRAGONS       2 * MAX_BOARD * MAX_BOARD / 3
 
-static int dragon_goal_worms[MAX_DRAGONS][MAX_GOAL_WORMS];
+static THREAD_LOCAL int dragon_goal_worms[MAX_DRAGONS][MAX_GOAL_WORMS];
 
 static void
 prepare_goal_list(int str, struct local_owl_data *owl,
@@ -330,12 +330,12 @@ finish_goal_list(int *flag, int *wpos, int list[MAX_GOAL_WORMS], int index);
 /* Semeai worms are worms whose capture wins the semeai. */
 
 #define MAX_SEMEAI_WORMS 20
-static int s_worms = 0;
-static int semeai_worms[MAX_SEMEAI_WORMS];
-static int important_semeai_worms[MAX_SEMEAI_WORMS];
+static THREAD_LOCAL int s_worms = 0;
+static THREAD_LOCAL int semeai_worms[MAX_SEMEAI_WORMS];
+static THREAD_LOCAL int important_semeai_worms[MAX_SEMEAI_WORMS];
 
 /* Whether one color prefers to get a ko over a seki. */
-static int prefer_ko;
+static THREAD_LOCAL int prefer_ko;
 
 /* Usually it's a bad idea to include the opponent worms involved in
  * the semeai in the eyespace. For some purposes (determining a
@@ -346,7 +346,7 @@ static int prefer_ko;
  * FIXME: We should implement a nicer mechanism to propagate this
  *        information to owl_lively(), where it's used.
  */
-static int include_semeai_worms_in_eyespace = 0;
+static THREAD_LOCAL int include_semeai_worms_in_eyespace = 0;
 
 
 
@@ -571,6 +571,7 @@ owl_analyze_semeai_after_move(int move, int color, int apos, int bpos,
   else
     prefer_ko = EMPTY;
   
+  profile_enter(ANALYZE_SEMEAI);
   if (move == PASS_MOVE)
     do_owl_analyze_semeai(apos, bpos, owla, owlb,
 			  resulta, resultb, semeai_move, 0, owl);
@@ -582,6 +583,7 @@ owl_analyze_semeai_after_move(int move, int color, int apos, int bpos,
     *resulta = REVERSE_RESULT(*resulta);
     *resultb = REVERSE_RESULT(*resultb);
   }
+  profile_leave(ANALYZE_SEMEAI);
 
   nodes_used = get_reading_node_counter() - reading_nodes_when_called;
   if (move == PASS_MOVE) {
@@ -1992,7 +1994,9 @@ owl_attack(int target, int *attack_point, int *certain, int *kworm)
   owl_make_domains(owl, NULL);
   prepare_goal_list(target, owl, owl_goal_worm, &goal_worms_computed,
 		    kworm, 1);
+  profile_enter(OWL_ATTACK);
   result = do_owl_attack(target, &move, &wid, owl, 0);
+  profile_leave(OWL_ATTACK);
   finish_goal_list(&goal_worms_computed, &wpos, owl_goal_worm, wid);
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
 
@@ -2516,6 +2520,7 @@ owl_threaten_attack(int target, int *attack1, int *attack2)
   memcpy(saved_boundary, owl->boundary, sizeof(saved_boundary));
   owl_make_domains(owl, NULL);
   owl_shapes(&shape_patterns, moves, other, owl, &owl_attackpat_db);
+  profile_enter(OWL_THREATEN_ATTACK);
   for (k = 0; k < MAX_MOVES; k++) {
     current_owl_data = owl;
     if (!get_next_move_from_list(&shape_patterns, other, moves, 1, owl))
@@ -2565,6 +2570,7 @@ owl_threaten_attack(int target, int *attack1, int *attack2)
 	}
     }
   }
+  profile_leave(OWL_THREATEN_ATTACK);
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
   gg_assert(stackp == 0);
 
@@ -2618,7 +2624,7 @@ int
 owl_defend(int target, int *defense_point, int *certain, int *kworm)
 {
   int result;
-  static struct local_owl_data *owl;
+  static THREAD_LOCAL struct local_owl_data *owl;
   int reading_nodes_when_called = get_reading_node_counter();
   double start = 0.0;
   int tactical_nodes;
@@ -2642,7 +2648,9 @@ owl_defend(int target, int *defense_point, int *certain, int *kworm)
   owl_make_domains(owl, NULL);
   prepare_goal_list(target, owl, owl_goal_worm, &goal_worms_computed,
 		    kworm, 1);
+  profile_enter(OWL_DEFEND);
   result = do_owl_defend(target, &move, &wid, owl, 0);
+  profile_leave(OWL_DEFEND);
   finish_goal_list(&goal_worms_computed, &wpos, owl_goal_worm, wid);
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
 
@@ -3037,6 +3045,7 @@ owl_threaten_defense(int target, int *defend1, int *defend2)
   memcpy(saved_goal, owl->goal, sizeof(saved_goal));
   owl_make_domains(owl, NULL);
   owl_shapes(&shape_patterns, moves, color, owl, &owl_defendpat_db);
+  profile_enter(OWL_THREATEN_DEFENSE);
   for (k = 0; k < MAX_MOVES; k++) {
     current_owl_data = owl;
     if (!get_next_move_from_list(&shape_patterns, color, moves, 1, owl))
@@ -3062,6 +3071,7 @@ owl_threaten_defense(int target, int *defend1, int *defend2)
 	}
     }
   }
+  profile_leave(OWL_THREATEN_DEFENSE);
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
   gg_assert(stackp == 0);
 
@@ -5546,7 +5556,9 @@ owl_does_defend(int move, int target, int *kworm)
     init_owl(&owl, target, NO_MOVE, move, 1, NULL);
     prepare_goal_list(target, owl, owl_goal_worm, &goal_worms_computed,
 		      kworm, 0);
+    profile_enter(OWL_DOES_DEFEND);
     acode = do_owl_attack(target, NULL, &wid, owl, 0);
+    profile_leave(OWL_DOES_DEFEND);
     finish_goal_list(&goal_worms_computed, &wpos, owl_goal_worm, wid);
     result = REVERSE_RESULT(acode);
     popgo();
@@ -5623,7 +5635,9 @@ owl_confirm_safety(int move, int target, int *defense_point, int *kworm)
     init_owl(&owl, target, NO_MOVE, move, 1, NULL);
     prepare_goal_list(target, owl, owl_goal_worm, &goal_worms_computed,
 		      kworm, 0);
+    profile_enter(OWL_CONFIRM_SAFETY);
     acode = do_owl_attack(target, &defense, &wid, owl, 0);
+    profile_leave(OWL_CONFIRM_SAFETY);
     finish_goal_list(&goal_worms_computed, &wpos, owl_goal_worm, wid);
     if (acode == 0)
       result = WIN;
@@ -5722,7 +5736,9 @@ owl_does_attack(int move, int target, int *kworm)
     else {
       prepare_goal_list(target, owl, owl_goal_worm, &goal_worms_computed,
 	                 kworm, 0);
+      profile_enter(OWL_DOES_ATTACK);
       dcode = do_owl_defend(target, NULL, &wid, owl, 0);
+      profile_leave(OWL_DOES_ATTACK);
       finish_goal_list(&goal_worms_computed, &wpos, owl_goal_worm, wid);
     }
     result = REVERSE_RESULT(dcode);
@@ -5783,8 +5799,10 @@ owl_connection_defends(int move, int target1, int target2)
 
   if (trymove(move, color, "owl_connection_defends", target1)) {
     owl_update_goal(move, SAME_DRAGON_MAYBE_CONNECTED, NO_MOVE, owl, 0, NULL);
+    profile_enter(OWL_CONNECTION_DEFENDS);
     if (!do_owl_attack(move, NULL, NULL, owl, 0))
       result = WIN;
+    profile_leave(OWL_CONNECTION_DEFENDS);
     owl->lunches_are_current = 0;
     popgo();
   }
@@ -6380,10 +6398,12 @@ owl_substantial(int str)
   owl_mark_boundary(owl);
   owl->lunches_are_current = 0;
 
+  profile_enter(OWL_SUBSTANTIAL);
   if (do_owl_attack(libs[0], NULL, NULL, owl, 0))
     result = 0;
   else
     result = 1;
+  profile_leave(OWL_SUBSTANTIAL);
   while (num_moves-- > 0) {
     if (get_level() >= 8)
       decrease_depth_values();
@@ -6987,6 +7007,16 @@ check_owl_stack_size(void)
   }
 }
 
+/* Free the owl stack. It is grown again on demand. */
+void
+free_owl_stack(void)
+{
+  while (owl_stack_size > 0) {
+    owl_stack_size--;
+    free(owl_stack[owl_stack_size]);
+  }
+}
+
 /* Push owl data one step upwards in the stack. Gets called from
  * push_owl.
  */
@@ -7174,6 +7204,14 @@ get_owl_node_counter()
 }
 
 
+/* Add nodes counted elsewhere, e.g. in a worker process. */
+void
+add_owl_node_counter(int nodes)
+{
+  global_owl_node_counter += nodes;
+}
+
+
 /*
  * Local Variables:
  * tab-width: 8
@@ -124,6 +124,13 @@ struct persistent_cache {
   struct persistent_cache_entry *table; /* Array of actual results. */
   int current_size; /* Current number of entries. */
   int last_purge_position_number;
+
+  /* See checkpoint_persistent_caches(). */
+  struct persistent_cache_entry *checkpoint; /* Entries at the checkpoint. */
+  int checkpoint_size;
+  struct persistent_cache_entry *changes; /* Entries to be committed. */
+  int num_changes;
+  int max_changes;
 };
 
 static void compute_active_owl_area(struct persistent_cache_entry *entry,
@@ -145,30 +152,30 @@ static void compute_active_breakin_area(struct persistent_cache_entry *entry,
 					    breakin_shadow[BOARDMAX],
 				        int dummy);
 
-static struct persistent_cache reading_cache =
+static THREAD_LOCAL struct persistent_cache reading_cache =
   { MAX_READING_CACHE_SIZE, MAX_READING_CACHE_DEPTH, 1.0,
     "reading cache", compute_active_reading_area,
-    NULL, 0, -1 };
+    NULL, 0, -1, NULL, 0, NULL, 0, 0 };
 
-static struct persistent_cache connection_cache =
+static THREAD_LOCAL struct persistent_cache connection_cache =
   { MAX_CONNECTION_CACHE_SIZE, MAX_CONNECTION_CACHE_DEPTH, 1.0,
     "connection cache", compute_active_connection_area,
-    NULL, 0, -1 };
+    NULL, 0, -1, NULL, 0, NULL, 0, 0 };
 
-static struct persistent_cache breakin_cache =
+static THREAD_LOCAL struct persistent_cache breakin_cache =
   { MAX_BREAKIN_CACHE_SIZE, MAX_BREAKIN_CACHE_DEPTH, 0.75,
     "breakin cache", compute_active_breakin_area,
-    NULL, 0, -1 };
+    NULL, 0, -1, NULL, 0, NULL, 0, 0 };
 
-static struct persistent_cache owl_cache =
+static THREAD_LOCAL struct persistent_cache owl_cache =
   { MAX_OWL_CACHE_SIZE, MAX_OWL_CACHE_DEPTH, 1.0,
     "owl cache", compute_active_owl_area,
-    NULL, 0, -1 };
+    NULL, 0, -1, NULL, 0, NULL, 0, 0 };
 
-static struct persistent_cache semeai_cache =
+static THREAD_LOCAL struct persistent_cache semeai_cache =
   { MAX_SEMEAI_CACHE_SIZE, MAX_SEMEAI_CACHE_DEPTH, 0.75,
     "semeai cache", compute_active_semeai_area,
-    NULL, 0, -1 };
+    NULL, 0, -1, NULL, 0, NULL, 0, 0 };
 
 /* ================================================================ */
 /* Common helper functions.   		                            */
@@ -419,6 +426,7 @@ search_persistent_cache(struct persistent_cache *cache,
   struct persistent_cache_entry *entry;
   entry = find_persistent_cache_entry(cache, routine, apos, bpos, cpos, color,
 				      goal_hash, node_limit);
+  profile_cache_lookup(routine, 1, entry != NULL);
   if (entry == NULL)
     return 0;
 
@@ -457,6 +465,38 @@ search_persistent_cache(struct persistent_cache *cache,
   return 1;
 }
 
+/* Make space for an entry worth (cost) in the cache. If the cache is
+ * full, we delete the lowest scoring entry, provided it scores less
+ * than (cost). Return 1 if there is space, 0 otherwise.
+ */
+static int
+make_room_in_persistent_cache(struct persistent_cache *cache, int cost)
+{
+  int worst_entry = -1;
+  int worst_score = cost;
+  int k;
+
+  if (cache->current_size < cache->max_size)
+    return 1;
+
+  for (k = 0; k < cache->current_size; k++) {
+    if (cache->table[k].score < worst_score) {
+      worst_score = cache->table[k].score;
+      worst_entry = k;
+    }
+  }
+
+  if (worst_entry == -1)
+    return 0;
+
+  /* Move the last entry in the cache here to make space. */
+  if (worst_entry < cache->current_size - 1)
+    cache->table[worst_entry] = cache->table[cache->current_size - 1];
+  cache->current_size--;
+  return 1;
+}
+
+
 /* Generic function that tries to store a cache entry. If the cache
  * is full, we delete the lowest scoring entry.
  *
@@ -479,30 +519,12 @@ store_persistent_cache(struct persistent_cache *cache,
     return;
 
   /* If cache is still full, consider kicking out an old entry. */
-  if (cache->current_size == cache->max_size) {
-    int worst_entry = -1;
-    int worst_score = cost;
-    int k;
-
-    for (k = 0; k < cache->current_size; k++) {
-      if (cache->table[k].score < worst_score) {
-	worst_score = cache->table[k].score;
-	worst_entry = k;
-      }
-    }
-
-    if (worst_entry != -1) {
-      /* Move the last entry in the cache here to make space.
-       */
-      if (worst_entry < cache->current_size - 1)
-	cache->table[worst_entry] = cache->table[cache->current_size - 1];
-      cache->current_size--;
-    }
-    else
-      return;
-  }
+  if (!make_room_in_persistent_cache(cache, cost))
+    return;
 
   entry = &(cache->table[cache->current_size]);
+  /* Leave nothing undefined for same_persistent_cache_entry(). */
+  memset(entry, 0, sizeof(*entry));
   entry->boardsize  	 = board_size;
   entry->routine    	 = routine;
   entry->apos	     	 = apos;
@@ -544,6 +566,167 @@ store_persistent_cache(struct persistent_cache *cache,
 }
 
 
+/* Return 1 if the two entries hold the same reading result. The
+ * scores are not compared since they only record how useful an entry
+ * has been.
+ */
+static int
+same_persistent_cache_entry(const struct persistent_cache_entry *a,
+			    const struct persistent_cache_entry *b)
+{
+  int k;
+
+  if (a->routine != b->routine
+      || a->apos != b->apos
+      || a->bpos != b->bpos
+      || a->cpos != b->cpos
+      || a->color != b->color
+      || a->boardsize != b->boardsize
+      || a->movenum != b->movenum
+      || a->result != b->result
+      || a->result2 != b->result2
+      || a->result_certain != b->result_certain
+      || a->remaining_depth != b->remaining_depth
+      || a->node_limit != b->node_limit
+      || a->move != b->move
+      || a->move2 != b->move2
+      || a->cost != b->cost
+      || !hashdata_is_equal(a->goal_hash, b->goal_hash))
+    return 0;
+
+  for (k = 0; k < MAX_CACHE_DEPTH; k++)
+    if (a->stack[k] != b->stack[k] || a->move_color[k] != b->move_color[k])
+      return 0;
+
+  for (k = 0; k < BOARDMAX; k++)
+    if (a->board[k] != b->board[k])
+      return 0;
+
+  return 1;
+}
+
+
+/* Return 1 if the entry is among the first (size) entries of (table). */
+static int
+persistent_cache_entry_in(const struct persistent_cache_entry *entry,
+			  const struct persistent_cache_entry *table, int size)
+{
+  int k;
+
+  for (k = 0; k < size; k++)
+    if (same_persistent_cache_entry(entry, &table[k]))
+      return 1;
+
+  return 0;
+}
+
+
+/* Add an entry to the changes to be committed. */
+static void
+add_cache_change(struct persistent_cache *cache,
+			    const struct persistent_cache_entry *entry)
+{
+  if (cache->num_changes == cache->max_changes) {
+    cache->max_changes = 2 * cache->max_changes + cache->max_size;
+    cache->changes = realloc(cache->changes,
+			     cache->max_changes * sizeof(*cache->changes));
+    gg_assert(cache->changes);
+  }
+  cache->changes[cache->num_changes++] = *entry;
+}
+
+
+/* Remember the entries of the cache and drop the uncommitted changes. */
+static void
+checkpoint_cache(struct persistent_cache *cache)
+{
+  if (!cache->checkpoint) {
+    cache->checkpoint = malloc(cache->max_size * sizeof(*cache->checkpoint));
+    gg_assert(cache->checkpoint);
+  }
+  memcpy(cache->checkpoint, cache->table,
+	 cache->current_size * sizeof(*cache->checkpoint));
+  cache->checkpoint_size = cache->current_size;
+  cache->num_changes = 0;
+}
+
+
+/* Restore the entries of the checkpoint. The entries which are new
+ * since then are written to (outfile), or added to the changes if
+ * (outfile) is NULL.
+ */
+static void
+rollback_cache(struct persistent_cache *cache, FILE *outfile)
+{
+  int num_new = 0;
+  int k;
+
+  for (k = 0; k < cache->current_size; k++) {
+    struct persistent_cache_entry *entry = &cache->table[k];
+    if (persistent_cache_entry_in(entry, cache->checkpoint,
+				  cache->checkpoint_size))
+      continue;
+    if (outfile == NULL)
+      add_cache_change(cache, entry);
+    else
+      cache->table[num_new] = *entry;
+    num_new++;
+  }
+
+  if (outfile) {
+    fwrite(&num_new, sizeof(num_new), 1, outfile);
+    fwrite(cache->table, sizeof(cache->table[0]), num_new, outfile);
+  }
+
+  memcpy(cache->table, cache->checkpoint,
+	 cache->checkpoint_size * sizeof(*cache->table));
+  cache->current_size = cache->checkpoint_size;
+}
+
+
+/* Add entries written by rollback_cache() to the changes.
+ * Return 0 if the input is truncated.
+ */
+static int
+read_cache_changes(struct persistent_cache *cache, FILE *infile)
+{
+  int num_new;
+  int k;
+
+  if (fread(&num_new, sizeof(num_new), 1, infile) != 1
+      || num_new < 0 || num_new > cache->max_size)
+    return 0;
+
+  for (k = 0; k < num_new; k++) {
+    struct persistent_cache_entry entry;
+    if (fread(&entry, sizeof(entry), 1, infile) != 1)
+      return 0;
+    add_cache_change(cache, &entry);
+  }
+
+  return 1;
+}
+
+
+/* Store the changes in the order they were added, except those
+ * which are already present. The same eviction rule as in
+ * store_persistent_cache() is used.
+ */
+static void
+commit_cache(struct persistent_cache *cache)
+{
+  int k;
+
+  for (k = 0; k < cache->num_changes; k++) {
+    struct persistent_cache_entry *entry = &cache->changes[k];
+    if (!persistent_cache_entry_in(entry, cache->table, cache->current_size)
+	&& make_room_in_persistent_cache(cache, entry->score))
+      cache->table[cache->current_size++] = *entry;
+  }
+  cache->num_changes = 0;
+}
+
+
 /* ================================================================ */
 /* Interface functions relevant to all caches.			    */
 /* ================================================================ */
@@ -570,6 +753,34 @@ persistent_cache_init()
 }
 
 
+/* Free the actual cache table. */
+static void
+free_cache(struct persistent_cache *cache)
+{
+  free(cache->table);
+  cache->table = NULL;
+  cache->current_size = 0;
+  free(cache->checkpoint);
+  cache->checkpoint = NULL;
+  cache->checkpoint_size = 0;
+  free(cache->changes);
+  cache->changes = NULL;
+  cache->num_changes = 0;
+  cache->max_changes = 0;
+}
+
+/* Frees the tables allocated by persistent_cache_init(). */
+void
+persistent_cache_free()
+{
+  free_cache(&reading_cache);
+  free_cache(&breakin_cache);
+  free_cache(&connection_cache);
+  free_cache(&owl_cache);
+  free_cache(&semeai_cache);
+}
+
+
 /* Discards all persistent cache entries. */
 void
 clear_persistent_caches()
@@ -595,6 +806,65 @@ purge_persistent_caches()
   purge_persistent_cache(&semeai_cache);
 }
 
+/* Remember the contents of all persistent caches. Reading made after
+ * this is undone by rollback_persistent_caches(), which keeps the new
+ * entries to be stored by commit_persistent_caches(). This lets
+ * several independent readings start from the same caches, in this
+ * process or in worker processes, while the result does not depend
+ * on how they were distributed.
+ */
+void
+checkpoint_persistent_caches()
+{
+  checkpoint_cache(&reading_cache);
+  checkpoint_cache(&connection_cache);
+  checkpoint_cache(&breakin_cache);
+  checkpoint_cache(&owl_cache);
+  checkpoint_cache(&semeai_cache);
+}
+
+/* Restore the caches of the checkpoint. The entries added since then
+ * are written to (outfile), to be read by
+ * read_persistent_cache_changes() in the process which made the
+ * checkpoint, or kept for commit_persistent_caches() if (outfile) is
+ * NULL.
+ */
+void
+rollback_persistent_caches(FILE *outfile)
+{
+  rollback_cache(&reading_cache, outfile);
+  rollback_cache(&connection_cache, outfile);
+  rollback_cache(&breakin_cache, outfile);
+  rollback_cache(&owl_cache, outfile);
+  rollback_cache(&semeai_cache, outfile);
+}
+
+/* Keep the entries written by rollback_persistent_caches() for
+ * commit_persistent_caches(). Return 0 if the input is truncated.
+ */
+int
+read_persistent_cache_changes(FILE *infile)
+{
+  return (read_cache_changes(&reading_cache, infile)
+	  && read_cache_changes(&connection_cache, infile)
+	  && read_cache_changes(&breakin_cache, infile)
+	  && read_cache_changes(&owl_cache, infile)
+	  && read_cache_changes(&semeai_cache, infile));
+}
+
+/* Store the entries kept since the checkpoint, in the order they were
+ * rolled back.
+ */
+void
+commit_persistent_caches()
+{
+  commit_cache(&reading_cache);
+  commit_cache(&connection_cache);
+  commit_cache(&breakin_cache);
+  commit_cache(&owl_cache);
+  commit_cache(&semeai_cache);
+}
+
 /* ================================================================ */
 /*                  Tactical reading functions                      */
 /* ================================================================ */
@@ -87,15 +87,15 @@ static int recursive_non_transitivity(int str1, int str2, int str3, int *move);
 static void order_connection_moves(int *moves, int str1, int str2,
 				   int color_to_move, const char *funcname);
 
-static int nodes_connect = 0;
+static THREAD_LOCAL int nodes_connect = 0;
 
 /* Used by alternate connections. */
-static signed char connection_shadow[BOARDMAX];
+static THREAD_LOCAL signed char connection_shadow[BOARDMAX];
 
-static signed char breakin_shadow[BOARDMAX]; 
+static THREAD_LOCAL signed char breakin_shadow[BOARDMAX]; 
 
 /* Statistics. */
-static int global_connection_node_counter = 0;
+static THREAD_LOCAL int global_connection_node_counter = 0;
 
 static void
 init_zone(zone *zn)
@@ -1136,7 +1136,9 @@ string_connect(int str1, int str2, int *move)
       verbose--;
     start = gg_cputime();
     memset(connection_shadow, 0, sizeof(connection_shadow));
+    profile_enter(CONNECT);
     result = recursive_connect2(str1, str2, move, 0);
+    profile_leave(CONNECT);
     verbose = save_verbose;
     tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
     connection_node_limit = save_connection_node_limit;
@@ -1321,7 +1323,9 @@ disconnect(int str1, int str2, int *move)
       verbose--;
     start = gg_cputime();
     memset(connection_shadow, 0, sizeof(connection_shadow));
+    profile_enter(DISCONNECT);
     result = recursive_disconnect2(str1, str2, move, 0);
+    profile_leave(DISCONNECT);
     verbose = save_verbose;
     tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
     connection_node_limit = save_connection_node_limit;
@@ -1906,6 +1910,14 @@ get_connection_node_counter()
 }
 
 
+/* Add nodes counted elsewhere, e.g. in a worker process. */
+void
+add_connection_node_counter(int nodes)
+{
+  global_connection_node_counter += nodes;
+}
+
+
 /*********************************************************
  *
  * Alternate connection reading algorithm.
@@ -3108,7 +3120,9 @@ break_in(int str, const signed char goal[BOARDMAX], int *move)
     verbose--;
   start = gg_cputime();
   memcpy(breakin_shadow, goal, sizeof(breakin_shadow));
+  profile_enter(BREAK_IN);
   result = recursive_break(str, goal, move, 0, &goal_hash);
+  profile_leave(BREAK_IN);
   verbose = save_verbose;
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
   if (debug & DEBUG_BREAKIN) {
@@ -3168,7 +3182,9 @@ block_off(int str, const signed char goal[BOARDMAX], int *move)
     verbose--;
   start = gg_cputime();
   memcpy(breakin_shadow, goal, sizeof(breakin_shadow));
+  profile_enter(BLOCK_OFF);
   result = recursive_block(str, goal, move, 0, &goal_hash);
+  profile_leave(BLOCK_OFF);
   verbose = save_verbose;
   tactical_nodes = get_reading_node_counter() - reading_nodes_when_called;
 
@@ -305,8 +305,8 @@ static int in_list(int move, int num_moves, int *moves);
 
 
 /* Statistics. */
-static int reading_node_counter = 0;
-static int nodes_when_called = 0;
+static THREAD_LOCAL int reading_node_counter = 0;
+static THREAD_LOCAL int nodes_when_called = 0;
 
  
 
@@ -370,7 +370,9 @@ attack(int str, int *move)
   }
 
   memset(shadow, 0, sizeof(shadow));
+  profile_enter(ATTACK);
   result = do_attack(str, &the_move);
+  profile_leave(ATTACK);
   nodes = reading_node_counter - nodes_when_called;
 
   if (debug & DEBUG_READING_PERFORMANCE) {
@@ -441,7 +443,9 @@ find_defense(int str, int *move)
   }
 
   memset(shadow, 0, sizeof(shadow));
+  profile_enter(FIND_DEFENSE);
   result = do_find_defense(str, &the_move);
+  profile_leave(FIND_DEFENSE);
   nodes = reading_node_counter - nodes_when_called;
 
   if (debug & DEBUG_READING_PERFORMANCE) {
@@ -1282,8 +1286,8 @@ fast_defense(int str, int liberties, int *libs, int *move)
    * compilers warn, quite correctly, that -1 is not an unsigned
    * number.
    */
-  static unsigned liberty_mark = ~0U;
-  static unsigned lm[BOARDMAX];
+  static THREAD_LOCAL unsigned liberty_mark = ~0U;
+  static THREAD_LOCAL unsigned lm[BOARDMAX];
 
   ASSERT1(libs != NULL, str);
   ASSERT1(move != NULL, str);
@@ -5396,11 +5400,11 @@ tune_move_ordering(int params[MOVE_ORDERING_PARAMETERS])
 /* ================================================================ */
 
 
-static int safe_move_cache[BOARDMAX][2];
-static int safe_move_cache_when[BOARDMAX][2];
-static void clear_safe_move_cache(void);
+static THREAD_LOCAL int safe_move_cache[BOARDMAX][2];
+static THREAD_LOCAL int safe_move_cache_when[BOARDMAX][2];
 
-static void
+/* Forget the results cached by safe_move(). */
+void
 clear_safe_move_cache(void)
 {
   int k;
@@ -5423,7 +5427,7 @@ int
 safe_move(int move, int color)
 {
   int safe = 0;
-  static int initialized = 0;
+  static THREAD_LOCAL int initialized = 0;
   int ko_move;
   
   if (!initialized) {
@@ -5501,6 +5505,14 @@ get_reading_node_counter()
   return reading_node_counter;
 }
 
+
+/* Add nodes counted elsewhere, e.g. in a worker process. */
+void
+add_reading_node_counter(int nodes)
+{
+  reading_node_counter += nodes;
+}
+
 /* ============ Reading shadow =============== */
 
 /* Draw the reading shadow, for debugging purposes */
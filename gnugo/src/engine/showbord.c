@@ -50,10 +50,10 @@
  */
 
 /* Element at origin of each worm stores allocated worm number. */
-static unsigned char dragon_num[BOARDMAX];
+static THREAD_LOCAL unsigned char dragon_num[BOARDMAX];
 
-static int next_white;		/* next worm number to allocate */
-static int next_black;
+static THREAD_LOCAL int next_white;		/* next worm number to allocate */
+static THREAD_LOCAL int next_black;
 
 /* linux console :
  *  0=black
@@ -37,7 +37,7 @@ static void show_surround_map(signed char mf[BOARDMAX],
 			      signed char mn[BOARDMAX]);
 
 /* Globals */
-static int gg;      /* stores the gravity center of the goal */
+static THREAD_LOCAL int gg;      /* stores the gravity center of the goal */
 
 
 /* Returns true if a dragon is enclosed within the convex hull of
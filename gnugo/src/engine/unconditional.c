@@ -30,8 +30,8 @@
 #include "liberty.h"
 
 /* Unconditionally meaningless moves. */
-int meaningless_black_moves[BOARDMAX];
-int meaningless_white_moves[BOARDMAX];
+THREAD_LOCAL int meaningless_black_moves[BOARDMAX];
+THREAD_LOCAL int meaningless_white_moves[BOARDMAX];
 
 /* Capture as many strings of the given color as we can. Played stones
  * are left on the board and the number of played stones is returned.
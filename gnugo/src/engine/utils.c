@@ -894,7 +894,7 @@ breakin_node_limit: %d\n\n",
 }
 
 
-static int depth_modification = 0;
+static THREAD_LOCAL int depth_modification = 0;
 
 /*
  * Modify the various tactical reading depth parameters. This is
@@ -1902,13 +1902,27 @@ superstring_add_string(int str,
 
 /* Internal timers for assessing time spent on various tasks. */
 #define NUMBER_OF_TIMERS 4
-static double timers[NUMBER_OF_TIMERS];
+static THREAD_LOCAL double timers[NUMBER_OF_TIMERS];
+
+/* Timer 1 is used by do_genmove() to time its phases. With
+ * --profile-engine the same intervals are accounted in the profile,
+ * see profile_phase().
+ */
+#define PHASE_TIMER 1
+
+static void profile_phase_start(void);
+static void profile_phase(const char *name);
+static void profile_clear_nodes(void);
+static void profile_save(FILE *outfile);
+static int profile_merge(FILE *infile);
 
 /* Start a timer. */
 void
 start_timer(int n)
 {
   gg_assert(n >= 0 && n < NUMBER_OF_TIMERS);
+  if (n == PHASE_TIMER)
+    profile_phase_start();
   if (!showtime)
     return;
 
@@ -1925,6 +1939,8 @@ time_report(int n, const char *occupation, int move, double mintime)
   double dt;
   gg_assert(n >= 0 && n < NUMBER_OF_TIMERS);
 
+  if (n == PHASE_TIMER)
+    profile_phase(occupation);
   if (!showtime)
     return 0.0;
 
@@ -1943,10 +1959,13 @@ time_report(int n, const char *occupation, int move, double mintime)
 void
 clearstats()
 {
+  profile_clear_nodes();
   stats.nodes                    = 0;
   stats.read_result_entered      = 0;
   stats.read_result_hits         = 0;
   stats.trusted_read_result_hits = 0;
+  reading_cache_clear_stats();
+  matchpat_clear_stats();
 }
   
 void
@@ -1956,6 +1975,368 @@ showstats()
   gprintf("Read results entered:     %d\n", stats.read_result_entered);
   gprintf("Read result hits:         %d\n", stats.read_result_hits);
   gprintf("Trusted read result hits: %d\n", stats.trusted_read_result_hits);
+  reading_cache_show_stats();
+  matchpat_show_stats();
+}
+
+
+/* Write the statistics since clearstats() to (outfile), to be added
+ * by merge_stats() in the process which forked this one.
+ */
+void
+save_stats(FILE *outfile)
+{
+  fwrite(&stats, sizeof(stats), 1, outfile);
+  reading_cache_save_stats(outfile);
+  matchpat_save_stats(outfile);
+  profile_save(outfile);
+}
+
+/* Add the statistics written by save_stats(). Return 0 if the input
+ * is truncated.
+ */
+int
+merge_stats(FILE *infile)
+{
+  struct stats_data other;
+
+  if (fread(&other, sizeof(other), 1, infile) != 1)
+    return 0;
+  stats.nodes                    += other.nodes;
+  stats.read_result_entered      += other.read_result_entered;
+  stats.read_result_hits         += other.read_result_hits;
+  stats.trusted_read_result_hits += other.trusted_read_result_hits;
+
+  return (reading_cache_merge_stats(infile)
+	  && matchpat_merge_stats(infile)
+	  && profile_merge(infile));
+}
+
+
+/* Engine profile, enabled by --profile-engine.
+ *
+ * The expensive searches of the reading routines are bracketed by
+ * profile_enter() and profile_leave(). For each routine_id we count
+ * the searches and the nodes (stats.nodes) and wall time spent in
+ * them, both inclusive and excluding nested searches of other
+ * routines. Inclusive figures of a routine are only accumulated at
+ * its outermost search, so recursion is not counted twice. Cache
+ * lookups are counted for the transposition table and the
+ * persistent caches separately.
+ *
+ * The phases of do_genmove() are accounted through timer 1, see
+ * start_timer(). profile_report() writes everything as one line of
+ * JSON and clears the profile; the GTP loop calls it after each
+ * command.
+ */
+
+struct profile_routine_data {
+  int searches;
+  int nodes;
+  int self_nodes;
+  double time;
+  double self_time;
+  int tt_lookups;
+  int tt_hits;
+  int persistent_lookups;
+  int persistent_hits;
+};
+
+struct profile_frame {
+  enum routine_id routine;
+  int nodes;            /* stats.nodes at profile_enter(). */
+  double start;
+  int child_nodes;      /* Spent in nested searches. */
+  double child_time;
+};
+
+struct profile_phase_data {
+  const char *name;
+  int count;
+  int nodes;
+  double time;
+};
+
+#define MAX_PROFILE_DEPTH  64
+#define MAX_PROFILE_PHASES 16
+
+static THREAD_LOCAL struct profile_routine_data
+  profile_routines[NUM_CACHE_ROUTINES];
+static THREAD_LOCAL int profile_active[NUM_CACHE_ROUTINES];
+static THREAD_LOCAL struct profile_frame profile_stack[MAX_PROFILE_DEPTH];
+static THREAD_LOCAL int profile_depth = 0;
+static THREAD_LOCAL struct profile_phase_data
+  profile_phases[MAX_PROFILE_PHASES];
+static THREAD_LOCAL int profile_num_phases = 0;
+static THREAD_LOCAL int profile_phase_nodes;
+static THREAD_LOCAL double profile_phase_time;
+static THREAD_LOCAL int profile_start_nodes;
+static THREAD_LOCAL double profile_start_time;
+
+
+/* Clear the profile. Searches in progress are not affected. */
+void
+profile_clear()
+{
+  memset(profile_routines, 0, sizeof(profile_routines));
+  profile_num_phases = 0;
+  profile_start_nodes = stats.nodes;
+  profile_start_time = gg_gettimeofday();
+}
+
+
+/* Rebase the node counts of the profile before clearstats() resets
+ * stats.nodes.
+ */
+static void
+profile_clear_nodes()
+{
+  int k;
+
+  profile_start_nodes -= stats.nodes;
+  profile_phase_nodes -= stats.nodes;
+  for (k = 0; k < profile_depth && k < MAX_PROFILE_DEPTH; k++)
+    profile_stack[k].nodes -= stats.nodes;
+}
+
+
+/* Start a search of the given routine. */
+void
+profile_enter(enum routine_id routine)
+{
+  struct profile_frame *frame;
+
+  if (!profile_engine)
+    return;
+
+  gg_assert(routine >= 0 && routine < NUM_CACHE_ROUTINES);
+  profile_depth++;
+  if (profile_depth > MAX_PROFILE_DEPTH)
+    return;
+
+  frame = &profile_stack[profile_depth - 1];
+  frame->routine = routine;
+  frame->nodes = stats.nodes;
+  frame->start = gg_gettimeofday();
+  frame->child_nodes = 0;
+  frame->child_time = 0.0;
+  profile_active[routine]++;
+}
+
+
+/* Finish the search started by the matching profile_enter(). */
+void
+profile_leave(enum routine_id routine)
+{
+  struct profile_frame *frame;
+  struct profile_routine_data *data;
+  int nodes;
+  double time;
+
+  if (!profile_engine)
+    return;
+
+  profile_depth--;
+  if (profile_depth >= MAX_PROFILE_DEPTH)
+    return;
+
+  frame = &profile_stack[profile_depth];
+  gg_assert(frame->routine == routine);
+  nodes = stats.nodes - frame->nodes;
+  time = gg_gettimeofday() - frame->start;
+
+  data = &profile_routines[routine];
+  data->searches++;
+  data->self_nodes += nodes - frame->child_nodes;
+  data->self_time += time - frame->child_time;
+  if (--profile_active[routine] == 0) {
+    data->nodes += nodes;
+    data->time += time;
+  }
+
+  if (profile_depth > 0) {
+    profile_stack[profile_depth - 1].child_nodes += nodes;
+    profile_stack[profile_depth - 1].child_time += time;
+  }
+}
+
+
+/* Count a cache lookup for the given routine. */
+void
+profile_cache_lookup(enum routine_id routine, int persistent, int found)
+{
+  if (!profile_engine)
+    return;
+
+  if (persistent) {
+    profile_routines[routine].persistent_lookups++;
+    if (found)
+      profile_routines[routine].persistent_hits++;
+  }
+  else {
+    profile_routines[routine].tt_lookups++;
+    if (found)
+      profile_routines[routine].tt_hits++;
+  }
+}
+
+
+/* Write the routine data of the profile to (outfile). */
+static void
+profile_save(FILE *outfile)
+{
+  fwrite(profile_routines, sizeof(profile_routines), 1, outfile);
+}
+
+
+/* Add the routine data written by profile_save(). The phases are not
+ * affected, except through the nodes added to stats.nodes. Return 0
+ * if the input is truncated.
+ */
+static int
+profile_merge(FILE *infile)
+{
+  struct profile_routine_data other[NUM_CACHE_ROUTINES];
+  int k;
+
+  if (fread(other, sizeof(other), 1, infile) != 1)
+    return 0;
+
+  for (k = 0; k < NUM_CACHE_ROUTINES; k++) {
+    struct profile_routine_data *data = &profile_routines[k];
+    data->searches += other[k].searches;
+    data->nodes += other[k].nodes;
+    data->self_nodes += other[k].self_nodes;
+    data->time += other[k].time;
+    data->self_time += other[k].self_time;
+    data->tt_lookups += other[k].tt_lookups;
+    data->tt_hits += other[k].tt_hits;
+    data->persistent_lookups += other[k].persistent_lookups;
+    data->persistent_hits += other[k].persistent_hits;
+  }
+
+  return 1;
+}
+
+
+/* Start the first phase of move generation. */
+static void
+profile_phase_start()
+{
+  if (!profile_engine)
+    return;
+
+  profile_phase_nodes = stats.nodes;
+  profile_phase_time = gg_gettimeofday();
+}
+
+
+/* Account the time and nodes since the last phase to the named
+ * phase and start the next one.
+ */
+static void
+profile_phase(const char *name)
+{
+  int k;
+  double now;
+
+  if (!profile_engine)
+    return;
+
+  for (k = 0; k < profile_num_phases; k++)
+    if (strcmp(profile_phases[k].name, name) == 0)
+      break;
+
+  if (k == profile_num_phases) {
+    if (k == MAX_PROFILE_PHASES)
+      return;
+    profile_phases[k].name = name;
+    profile_phases[k].count = 0;
+    profile_phases[k].nodes = 0;
+    profile_phases[k].time = 0.0;
+    profile_num_phases++;
+  }
+
+  now = gg_gettimeofday();
+  profile_phases[k].count++;
+  profile_phases[k].nodes += stats.nodes - profile_phase_nodes;
+  profile_phases[k].time += now - profile_phase_time;
+  profile_phase_nodes = stats.nodes;
+  profile_phase_time = now;
+}
+
+
+/* Write a JSON string, escaping quotes, backslashes and control
+ * characters.
+ */
+static void
+profile_write_string(FILE *outfile, const char *s)
+{
+  putc('"', outfile);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      fprintf(outfile, "\\%c", *s);
+    else if ((unsigned char) *s < 32)
+      fprintf(outfile, "\\u%04x", (unsigned char) *s);
+    else
+      putc(*s, outfile);
+  }
+  putc('"', outfile);
+}
+
+
+/* Write the profile since the last call as one line of JSON and
+ * clear it. (id) is the GTP command id, or -1 if there is none.
+ */
+void
+profile_report(FILE *outfile, int id, const char *command)
+{
+  int k;
+  int first = 1;
+
+  fprintf(outfile, "{\"command\":");
+  profile_write_string(outfile, command);
+  if (id >= 0)
+    fprintf(outfile, ",\"id\":%d", id);
+  else
+    fprintf(outfile, ",\"id\":null");
+  fprintf(outfile, ",\"nodes\":%d,\"time\":%.6f",
+	  stats.nodes - profile_start_nodes,
+	  gg_gettimeofday() - profile_start_time);
+
+  fprintf(outfile, ",\"routines\":{");
+  for (k = 0; k < NUM_CACHE_ROUTINES; k++) {
+    struct profile_routine_data *data = &profile_routines[k];
+    if (data->searches == 0 && data->tt_lookups == 0
+	&& data->persistent_lookups == 0)
+      continue;
+    if (!first)
+      putc(',', outfile);
+    first = 0;
+    profile_write_string(outfile, routine_id_to_string(k));
+    fprintf(outfile, ":{\"searches\":%d,\"nodes\":%d,\"self_nodes\":%d,"
+	    "\"time\":%.6f,\"self_time\":%.6f,"
+	    "\"tt_lookups\":%d,\"tt_hits\":%d,"
+	    "\"persistent_lookups\":%d,\"persistent_hits\":%d}",
+	    data->searches, data->nodes, data->self_nodes,
+	    data->time, data->self_time,
+	    data->tt_lookups, data->tt_hits,
+	    data->persistent_lookups, data->persistent_hits);
+  }
+
+  fprintf(outfile, "},\"phases\":[");
+  for (k = 0; k < profile_num_phases; k++) {
+    if (k > 0)
+      putc(',', outfile);
+    fprintf(outfile, "{\"name\":");
+    profile_write_string(outfile, profile_phases[k].name);
+    fprintf(outfile, ",\"count\":%d,\"nodes\":%d,\"time\":%.6f}",
+	    profile_phases[k].count, profile_phases[k].nodes,
+	    profile_phases[k].time);
+  }
+  fprintf(outfile, "]}\n");
+
+  profile_clear();
 }
 
 
@@ -2489,8 +2489,9 @@ estimate_territorial_value(int pos, int color, float our_score,
 					   OPPOSITE_INFLUENCE(color),
 					   safety_hash)) {
 
-      compute_influence(OTHER_COLOR(color), safe_stones, strength, 
-	  		&move_influence, pos, "after move");
+      compute_incremental_influence(OPPOSITE_INFLUENCE(color),
+				    OTHER_COLOR(color), safe_stones, strength,
+				    &move_influence, pos, "after move");
       increase_depth_values();
       break_territories(OTHER_COLOR(color), &move_influence, 0, pos);
       decrease_depth_values();
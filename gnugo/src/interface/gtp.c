@@ -63,6 +63,9 @@ static int gtp_boardsize = -1;
 static gtp_transform_ptr vertex_transform_input_hook = NULL;
 static gtp_transform_ptr vertex_transform_output_hook = NULL;
 
+/* Hook called after each command. */
+static gtp_command_hook_ptr command_hook = NULL;
+
 /* Current id number. We keep track of this internally rather than
  * pass it to the functions processing the commands, since those can't
  * do anything useful with it anyway.
@@ -146,6 +149,9 @@ gtp_main_loop(struct gtp_command commands[],
     if (commands[i].name == NULL)
       gtp_failure("unknown command");
 
+    if (command_hook)
+      command_hook(current_id, command);
+
     if (status == GTP_FATAL)
       gtp_panic();
   }
@@ -170,6 +176,16 @@ gtp_set_vertex_transform_hooks(gtp_transform_ptr in, gtp_transform_ptr out)
   vertex_transform_output_hook = out;
 }
 
+/* Set a hook function which is called after each command has been
+ * processed, with the id number (-1 if none) and the command name.
+ * GNU Go uses this to write engine profiles.
+ */
+void
+gtp_set_command_hook(gtp_command_hook_ptr hook)
+{
+  command_hook = hook;
+}
+
 /*
  * This function works like printf, except that it only understands
  * very few of the standard formats, to be precise %c, %d, %f, %s.
@@ -36,6 +36,10 @@ void play_ascii(SGFTree *tree, Gameinfo *gameinfo,
 		char *filename, char *until);
 void play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
 	      int gtp_initial_orientation);
+void play_gtp_parallel(FILE *gtp_input, FILE *gtp_output,
+		       FILE *gtp_dump_commands, int gtp_initial_orientation,
+		       int jobs);
+void gtp_set_profile_output(FILE *output);
 void play_gmp(Gameinfo *gameinfo, int simplified);
 void play_solo(Gameinfo *gameinfo, int benchmark);
 void play_replay(SGFTree *tree, int color_to_test);
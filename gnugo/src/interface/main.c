@@ -89,6 +89,7 @@ enum {OPT_BOARDSIZE = 127,
       OPT_GTP_DUMP_COMMANDS,
       OPT_GTP_INITIAL_ORIENTATION,
       OPT_GTP_VERSION,
+      OPT_GTP_JOBS,
       OPT_SHOWCOPYRIGHT,
       OPT_REPLAY_GAME,
       OPT_DECIDE_STRING,
@@ -130,6 +131,9 @@ enum {OPT_BOARDSIZE = 127,
       OPT_NOFUSEKIDB,
       OPT_NOFUSEKI,
       OPT_NOJOSEKIDB,
+      OPT_NO_INCREMENTAL_MATCHING,
+      OPT_NO_INCREMENTAL_INFLUENCE,
+      OPT_READING_JOBS,
       OPT_LEVEL,
       OPT_MIN_LEVEL,
       OPT_MAX_LEVEL,
@@ -140,6 +144,7 @@ enum {OPT_BOARDSIZE = 127,
       OPT_SCORE,
       OPT_PRINTSGF,
       OPT_PROFILE_PATTERNS,
+      OPT_PROFILE_ENGINE,
       OPT_CHINESE_RULES,
       OPT_OWL_THREATS,
       OPT_NO_OWL_THREATS,
@@ -162,7 +167,9 @@ enum {OPT_BOARDSIZE = 127,
       OPT_MC_GAMES_PER_LEVEL,
       OPT_MC_PATTERNS,
       OPT_MC_LIST_PATTERNS,
-      OPT_MC_LOAD_PATTERNS
+      OPT_MC_LOAD_PATTERNS,
+      OPT_MC_THREADS,
+      OPT_MC_BITBOARDS
 };
 
 /* names of playing modes */
@@ -214,6 +221,7 @@ static struct gg_option const long_options[] =
   {"gtp-initial-orientation",
   		     required_argument, 0, OPT_GTP_INITIAL_ORIENTATION},
   {"gtp-version",    required_argument, 0, OPT_GTP_VERSION},
+  {"gtp-jobs",       required_argument, 0, OPT_GTP_JOBS},
   {"infile",         required_argument, 0, 'l'},
   {"until",          required_argument, 0, 'L'},
   {"outfile",        required_argument, 0, 'o'},
@@ -299,12 +307,16 @@ static struct gg_option const long_options[] =
   {"nofusekidb",     no_argument,       0, OPT_NOFUSEKIDB},
   {"nofuseki",       no_argument,       0, OPT_NOFUSEKI},
   {"nojosekidb",     no_argument,       0, OPT_NOJOSEKIDB},
+  {"no-incremental-matching", no_argument, 0, OPT_NO_INCREMENTAL_MATCHING},
+  {"no-incremental-influence", no_argument, 0, OPT_NO_INCREMENTAL_INFLUENCE},
+  {"reading-jobs",   required_argument, 0, OPT_READING_JOBS},
   {"debug-influence", required_argument, 0, OPT_DEBUG_INFLUENCE},
   {"showtime",       no_argument,       0, OPT_SHOWTIME},
   {"showscore",      no_argument,       0, OPT_SHOWSCORE},
   {"score",          required_argument, 0, OPT_SCORE},
   {"printsgf",       required_argument, 0, OPT_PRINTSGF},
   {"profile-patterns", no_argument,     0, OPT_PROFILE_PATTERNS},
+  {"profile-engine", required_argument, 0, OPT_PROFILE_ENGINE},
   {"mirror",         no_argument,       0, OPT_MIRROR},
   {"mirror-limit",   required_argument, 0, OPT_MIRROR_LIMIT},
   {"metamachine",    no_argument,       0, OPT_METAMACHINE},
@@ -315,6 +327,8 @@ static struct gg_option const long_options[] =
   {"mc-patterns",    required_argument, 0, OPT_MC_PATTERNS},
   {"mc-list-patterns", no_argument,     0, OPT_MC_LIST_PATTERNS},
   {"mc-load-patterns", required_argument, 0, OPT_MC_LOAD_PATTERNS},
+  {"mc-threads",     required_argument, 0, OPT_MC_THREADS},
+  {"mc-bitboards",   no_argument,       0, OPT_MC_BITBOARDS},
   {NULL, 0, NULL, 0}
 };
 
@@ -337,6 +351,7 @@ main(int argc, char *argv[])
   char *outflags = NULL;
   char *gtpfile = NULL;
   char *gtp_dump_commands_file = NULL;
+  char *profile_engine_file = NULL;
   int gtp_tcp_ip_mode = 0;
   char *gtp_tcp_ip_address = NULL;
   
@@ -349,6 +364,7 @@ main(int argc, char *argv[])
   int benchmark = 0;  /* benchmarking mode (-b) */
   FILE *output_check;
   int orientation = 0;
+  int gtp_jobs = 1;
 
   char mc_pattern_name[40] = "";
   char mc_pattern_filename[320] = "";
@@ -464,6 +480,15 @@ main(int argc, char *argv[])
 	gtp_version = atoi(gg_optarg);
 	break;
 	
+      case OPT_GTP_JOBS:
+	gtp_jobs = atoi(gg_optarg);
+	if (gtp_jobs < 1) {
+	  fprintf(stderr, "Invalid number of jobs: %d.\n", gtp_jobs);
+	  fprintf(stderr, "Try `gnugo --help' for more information.\n");
+	  exit(EXIT_FAILURE);
+	}
+	break;
+	
       case OPT_OPTIONS:
 	if (USE_BREAK_IN)
 	  fprintf(stdout,
@@ -675,6 +700,25 @@ main(int argc, char *argv[])
 	strcpy(mc_pattern_filename, gg_optarg);
 	break;
 
+      case OPT_MC_THREADS:
+	mc_threads = atoi(gg_optarg);
+	if (mc_threads < 1) {
+	  fprintf(stderr, "Invalid number of threads: %d.\n", mc_threads);
+	  fprintf(stderr, "Try `gnugo --help' for more information.\n");
+	  exit(EXIT_FAILURE);
+	}
+#if !ENGINE_THREADS
+	if (mc_threads > 1) {
+	  fprintf(stderr, "--mc-threads needs a build with engine threads.\n");
+	  exit(EXIT_FAILURE);
+	}
+#endif
+	break;
+
+      case OPT_MC_BITBOARDS:
+	mc_bitboards = 1;
+	break;
+
       case OPT_MODE: 
 	if (strcmp(gg_optarg, "ascii") == 0)
 	  playmode = MODE_ASCII;
@@ -850,6 +894,29 @@ main(int argc, char *argv[])
 	josekidb = 0;
 	break;
 	
+      case OPT_NO_INCREMENTAL_MATCHING:
+	incremental_matching = 0;
+	break;
+	
+      case OPT_NO_INCREMENTAL_INFLUENCE:
+	incremental_influence = 0;
+	break;
+	
+      case OPT_READING_JOBS:
+	reading_jobs = atoi(gg_optarg);
+	if (reading_jobs < 1) {
+	  fprintf(stderr, "Invalid number of jobs: %d.\n", reading_jobs);
+	  fprintf(stderr, "Try `gnugo --help' for more information.\n");
+	  exit(EXIT_FAILURE);
+	}
+#ifndef HAVE_FORK
+	if (reading_jobs > 1) {
+	  fprintf(stderr, "--reading-jobs needs a system with fork().\n");
+	  exit(EXIT_FAILURE);
+	}
+#endif
+	break;
+	
       case OPT_LEVEL:
 	set_level(atoi(gg_optarg));
 	break;
@@ -928,6 +995,10 @@ main(int argc, char *argv[])
 	prepare_pattern_profiling();
 	break;
 	
+      case OPT_PROFILE_ENGINE:
+	profile_engine_file = gg_optarg;
+	break;
+	
       case OPT_COLOR: 
 	if (strcmp(gg_optarg, "white") == 0)
 	  mandated_color = WHITE;
@@ -1382,6 +1453,7 @@ main(int argc, char *argv[])
       FILE *gtp_input_FILE = stdin;
       FILE *gtp_output_FILE = stdout;
       FILE *gtp_dump_commands_FILE = NULL;
+      FILE *profile_engine_FILE = NULL;
 
       if (gtpfile != NULL) {
 	gtp_input_FILE = fopen(gtpfile, "r");
@@ -1428,11 +1500,32 @@ main(int argc, char *argv[])
 	}
       }
 
-      play_gtp(gtp_input_FILE, gtp_output_FILE, gtp_dump_commands_FILE,
-	       orientation);
+      if (profile_engine_file != NULL) {
+	if (strcmp(profile_engine_file, "-") == 0)
+	  profile_engine_FILE = stderr;
+	else
+	  profile_engine_FILE = fopen(profile_engine_file, "w");
+	if (profile_engine_FILE == NULL) {
+	  fprintf(stderr, "gnugo: Cannot open file %s\n",
+		  profile_engine_file);
+	  return EXIT_FAILURE;
+	}
+	gtp_set_profile_output(profile_engine_FILE);
+      }
+
+#ifdef HAVE_FORK
+      if (gtpfile != NULL && gtp_jobs > 1)
+	play_gtp_parallel(gtp_input_FILE, gtp_output_FILE,
+			  gtp_dump_commands_FILE, orientation, gtp_jobs);
+      else
+#endif
+	play_gtp(gtp_input_FILE, gtp_output_FILE, gtp_dump_commands_FILE,
+		 orientation);
 
       if (gtp_dump_commands_FILE)
 	fclose(gtp_dump_commands_FILE);
+      if (profile_engine_FILE && profile_engine_FILE != stderr)
+	fclose(profile_engine_FILE);
 
       if (gtp_tcp_ip_mode == OPT_GTP_CONNECT)
 	socket_close_connection(gtp_input_FILE, gtp_output_FILE);
@@ -1565,6 +1658,8 @@ Connection options\n\
                      Wait for the first TCP/IP connection on the given port\n\
                      (if HOST is specified, only to that host)\n\
    --gtp-version\n\
+   --gtp-jobs <n>    Run the loadsgf blocks of a --gtp-input regression\n\
+                     file in n parallel processes\n\
 \n\
 "
 
@@ -1579,6 +1674,9 @@ Experimental options:\n\
    --nofusekidb            turn off fuseki database\n\
    --nofuseki              turn off fuseki moves entirely\n\
    --nojosekidb            turn off joseki database\n\
+   --no-incremental-matching  rescan all anchors at each pattern match\n\
+   --no-incremental-influence  match all influence patterns after each move\n\
+   --reading-jobs <n>      read the owl status of dragons in n processes\n\
    --mirror                try to play mirror go\n\
    --mirror-limit <n>      stop mirroring when n stones on board\n\n\
    --monte-carlo           enable Monte Carlo move generation (9x9 or smaller)\n\
@@ -1586,6 +1684,8 @@ Experimental options:\n\
    --mc-list-patterns      list names of builtin Monte Carlo patterns\n\
    --mc-patterns <name>    choose a built in Monte Carlo pattern database\n\
    --mc-load-patterns <filename> read Monte Carlo patterns from file\n\
+   --mc-threads <n>        number of threads for Monte Carlo search\n\
+   --mc-bitboards          use bitboards for strings in Monte Carlo simulations\n\
    --alternate-connections\n\
    --experimental-connections\n\
    --experimental-owl-ext\n\
@@ -1638,6 +1738,8 @@ Debugging Options:\n\
    -b, --benchmark num           benchmarking mode - can be used with -l\n\
    -S, --statistics              print statistics (for debugging purposes)\n\n\
        --profile-patterns        print statistics for pattern usage\n\
+       --profile-engine <file>   write nodes, cache hits and time per\n\
+                                 reading routine after each GTP command\n\
        --showtime                print timing diagnostic\n\
    -t, --trace                   verbose tracing\n\
    -O, --output-flags <flags>    optional output (use with -o)\n\
@@ -24,11 +24,22 @@
 #include "gnugo.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <ctype.h>
 #include <string.h>
 #include <math.h>
 
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if ENGINE_THREADS
+#include <pthread.h>
+#endif
+
 #include "interface.h"
 #include "liberty.h"
 #include "gtp.h"
@@ -107,6 +118,7 @@ DECLARE(gtp_gg_genmove);
 DECLARE(gtp_gg_undo);
 DECLARE(gtp_half_eye_data);
 DECLARE(gtp_increase_depths);
+DECLARE(gtp_influence_benchmark);
 DECLARE(gtp_initial_influence);
 DECLARE(gtp_invariant_hash);
 DECLARE(gtp_invariant_hash_for_moves);
@@ -120,6 +132,8 @@ DECLARE(gtp_limit_search);
 DECLARE(gtp_list_commands);
 DECLARE(gtp_list_stones);
 DECLARE(gtp_loadsgf);
+DECLARE(gtp_matchpat_benchmark);
+DECLARE(gtp_mc_playout_benchmark);
 DECLARE(gtp_move_influence);
 DECLARE(gtp_move_probabilities);
 DECLARE(gtp_move_reasons);
@@ -145,6 +159,7 @@ DECLARE(gtp_protocol_version);
 DECLARE(gtp_query_boardsize);
 DECLARE(gtp_query_orientation);
 DECLARE(gtp_quit);
+DECLARE(gtp_reading_cache_threads_check);
 DECLARE(gtp_reg_genmove);
 DECLARE(gtp_report_uncertainty);
 DECLARE(gtp_reset_connection_node_counter);
@@ -168,6 +183,7 @@ DECLARE(gtp_start_sgftrace);
 DECLARE(gtp_surround_map);
 DECLARE(gtp_tactical_analyze_semeai);
 DECLARE(gtp_test_eyeshape);
+DECLARE(gtp_threads_check);
 DECLARE(gtp_time_left);
 DECLARE(gtp_time_settings);
 DECLARE(gtp_top_moves);
@@ -176,6 +192,7 @@ DECLARE(gtp_top_moves_white);
 DECLARE(gtp_tryko);
 DECLARE(gtp_trymove);
 DECLARE(gtp_tune_move_ordering);
+DECLARE(gtp_uct_benchmark);
 DECLARE(gtp_unconditional_status);
 DECLARE(gtp_undo);
 DECLARE(gtp_what_color);
@@ -250,6 +267,7 @@ static struct gtp_command commands[] = {
   {"half_eye_data",           gtp_half_eye_data},
   {"help",                    gtp_list_commands},
   {"increase_depths",  	      gtp_increase_depths},
+  {"influence_benchmark",     gtp_influence_benchmark},
   {"initial_influence",       gtp_initial_influence},
   {"invariant_hash_for_moves",gtp_invariant_hash_for_moves},
   {"invariant_hash",   	      gtp_invariant_hash},
@@ -265,6 +283,8 @@ static struct gtp_command commands[] = {
   {"list_commands",    	      gtp_list_commands},
   {"list_stones",    	      gtp_list_stones},
   {"loadsgf",          	      gtp_loadsgf},
+  {"matchpat_benchmark",      gtp_matchpat_benchmark},
+  {"mc_playout_benchmark",    gtp_mc_playout_benchmark},
   {"move_influence",          gtp_move_influence},
   {"move_probabilities",      gtp_move_probabilities},
   {"move_reasons",            gtp_move_reasons},
@@ -289,6 +309,7 @@ static struct gtp_command commands[] = {
   {"query_boardsize",         gtp_query_boardsize},
   {"query_orientation",       gtp_query_orientation},
   {"quit",             	      gtp_quit},
+  {"reading_cache_threads_check", gtp_reading_cache_threads_check},
   {"reg_genmove",             gtp_reg_genmove},
   {"report_uncertainty",      gtp_report_uncertainty},
   {"reset_connection_node_counter", gtp_reset_connection_node_counter},
@@ -308,6 +329,7 @@ static struct gtp_command commands[] = {
   {"surround_map",            gtp_surround_map},
   {"tactical_analyze_semeai", gtp_tactical_analyze_semeai},
   {"test_eyeshape",           gtp_test_eyeshape},
+  {"threads_check",           gtp_threads_check},
   {"time_left",               gtp_time_left},
   {"time_settings",           gtp_time_settings},
   {"top_moves",               gtp_top_moves},
@@ -316,6 +338,7 @@ static struct gtp_command commands[] = {
   {"tryko",          	      gtp_tryko},
   {"trymove",          	      gtp_trymove},
   {"tune_move_ordering",      gtp_tune_move_ordering},
+  {"uct_benchmark",           gtp_uct_benchmark},
   {"unconditional_status",    gtp_unconditional_status},
   {"undo",                    gtp_undo},
   {"version",                 gtp_program_version},
@@ -327,10 +350,31 @@ static struct gtp_command commands[] = {
 };
 
 
-/* Start playing using the Go Text Protocol. */
+/* Where the engine profile is written after each command, see
+ * --profile-engine.
+ */
+static FILE *profile_output = NULL;
+
+/* Write the engine profile of the command just processed. */
+static void
+report_profile(int id, const char *command)
+{
+  profile_report(profile_output, id, command);
+  fflush(profile_output);
+}
+
+/* Write an engine profile after each command to (output). */
 void
-play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
-	 int gtp_initial_orientation)
+gtp_set_profile_output(FILE *output)
+{
+  profile_output = output;
+  profile_engine = 1;
+}
+
+
+/* Prepare the engine and the GTP utility functions for a session. */
+static void
+gtp_setup(FILE *gtp_output, int gtp_initial_orientation)
 {
   /* Make sure `gtp_output' is unbuffered. (Line buffering is also
    * okay but not necessary. Block buffering breaks GTP mode.)
@@ -350,12 +394,268 @@ play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
   /* Prepare pattern matcher and reading code. */
   reset_engine();
   clearstats();
+
+  if (profile_output) {
+    gtp_set_command_hook(report_profile);
+    profile_clear();
+  }
+}
+
+
+/* Start playing using the Go Text Protocol. */
+void
+play_gtp(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
+	 int gtp_initial_orientation)
+{
+  gtp_setup(gtp_output, gtp_initial_orientation);
   gtp_main_loop(commands, gtp_input, gtp_output, gtp_dump_commands);
   if (showstatistics)
     showstats();
 }
 
 
+#ifdef HAVE_FORK
+
+/* A regression test block: the lines from a loadsgf command up to the
+ * next one. Every loadsgf resets the engine, so the blocks of a test
+ * file can be run in any order, each in its own process.
+ */
+struct gtp_block {
+  const char *text;
+  int length;
+  int line;		/* Line number of the first line. */
+  FILE *output;
+  pid_t pid;
+  int done;
+  int failed;
+  double time;		/* Wall time in seconds. */
+};
+
+/* Read all of `input' into a NUL-terminated buffer. */
+static char *
+read_gtp_commands(FILE *input, int *length)
+{
+  int size = 16384;
+  int n = 0;
+  int k;
+  char *buffer = malloc(size + 1);
+
+  while (buffer && (k = fread(buffer + n, 1, size - n, input)) > 0) {
+    n += k;
+    if (n == size) {
+      size *= 2;
+      buffer = realloc(buffer, size + 1);
+    }
+  }
+  if (!buffer) {
+    fprintf(stderr, "gnugo: Out of memory reading GTP commands\n");
+    exit(EXIT_FAILURE);
+  }
+
+  buffer[n] = 0;
+  *length = n;
+  return buffer;
+}
+
+/* Return 1 if the GTP command on the line starting at `line' is `name'.
+ * The command may be preceded by an id number.
+ */
+static int
+line_has_command(const char *line, const char *name)
+{
+  int length = strlen(name);
+  const char *p = line;
+
+  while (*p == ' ' || *p == '\t')
+    p++;
+  while (isdigit((int) *p))
+    p++;
+  while (*p == ' ' || *p == '\t')
+    p++;
+
+  return (strncmp(p, name, length) == 0
+	  && (p[length] == 0 || p[length] == '#' || isspace((int) p[length])));
+}
+
+/* Run `block' in a child process, writing its responses to a temporary
+ * file which is read back when the block is merged.
+ */
+static void
+start_gtp_block(struct gtp_block *block)
+{
+  block->output = tmpfile();
+  if (!block->output) {
+    perror("gnugo: Cannot create temporary file");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Nothing buffered in the parent may be written twice. */
+  fflush(NULL);
+
+  block->time = gg_gettimeofday();
+  block->pid = fork();
+  if (block->pid < 0) {
+    perror("gnugo: Cannot fork");
+    exit(EXIT_FAILURE);
+  }
+
+  if (block->pid == 0) {
+    FILE *input = tmpfile();
+    if (!input
+	|| fwrite(block->text, 1, block->length, input) != (size_t) block->length)
+      _exit(EXIT_FAILURE);
+    rewind(input);
+    gtp_main_loop(commands, input, block->output, NULL);
+    fflush(block->output);
+    _exit(EXIT_SUCCESS);
+  }
+}
+
+/* Copy the responses of a finished block to the real output. */
+static void
+merge_gtp_block(struct gtp_block *block, FILE *gtp_output,
+		FILE *gtp_dump_commands)
+{
+  char buffer[4096];
+  size_t n;
+
+  if (gtp_dump_commands) {
+    fwrite(block->text, 1, block->length, gtp_dump_commands);
+    fflush(gtp_dump_commands);
+  }
+
+  rewind(block->output);
+  while ((n = fread(buffer, 1, sizeof(buffer), block->output)) > 0)
+    fwrite(buffer, 1, n, gtp_output);
+  fclose(block->output);
+
+  if (block->failed)
+    fprintf(stderr, "gnugo: Block at line %d failed\n", block->line);
+  if (showtime)
+    fprintf(stderr, "Block at line %d: %.2f seconds\n",
+	    block->line, block->time);
+}
+
+/* Run a file of GTP commands with up to `jobs' regression test blocks
+ * (see struct gtp_block) in parallel. The commands before the first
+ * loadsgf are run first, and every block starts from the state they
+ * leave. The responses are merged in the order of the input, so the
+ * output is the same as that of play_gtp(). Settings changed inside a
+ * block do not carry over to the following blocks. With --showtime the
+ * time of every block is reported.
+ */
+void
+play_gtp_parallel(FILE *gtp_input, FILE *gtp_output, FILE *gtp_dump_commands,
+		  int gtp_initial_orientation, int jobs)
+{
+  int length;
+  char *text = read_gtp_commands(gtp_input, &length);
+  struct gtp_block *blocks;
+  int num_blocks = 0;
+  int max_blocks = 1;
+  int preamble_length = length;
+  int line = 1;
+  int quit = 0;
+  int next = 0;
+  int merged = 0;
+  int running = 0;
+  double start_time = gg_gettimeofday();
+  char *p;
+
+  for (p = text; *p; p++)
+    if (*p == '\n')
+      max_blocks++;
+  blocks = malloc(max_blocks * sizeof(*blocks));
+  if (!blocks) {
+    fprintf(stderr, "gnugo: Out of memory reading GTP commands\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Split the input into blocks. A quit ends the input. */
+  for (p = text; *p && !quit; line++) {
+    char *end = strchr(p, '\n');
+    end = end ? end + 1 : p + strlen(p);
+
+    if (line_has_command(p, "loadsgf")) {
+      if (num_blocks == 0)
+	preamble_length = p - text;
+      blocks[num_blocks].text = p;
+      blocks[num_blocks].line = line;
+      blocks[num_blocks].done = 0;
+      blocks[num_blocks].failed = 0;
+      num_blocks++;
+    }
+    if (line_has_command(p, "quit")) {
+      quit = 1;
+      if (num_blocks == 0)
+	preamble_length = end - text;
+    }
+    if (num_blocks > 0)
+      blocks[num_blocks - 1].length = end - blocks[num_blocks - 1].text;
+    p = end;
+  }
+
+  gtp_setup(gtp_output, gtp_initial_orientation);
+
+  if (preamble_length > 0) {
+    FILE *preamble = tmpfile();
+    if (!preamble) {
+      perror("gnugo: Cannot create temporary file");
+      exit(EXIT_FAILURE);
+    }
+    fwrite(text, 1, preamble_length, preamble);
+    rewind(preamble);
+    gtp_main_loop(commands, preamble, gtp_output, gtp_dump_commands);
+    fclose(preamble);
+  }
+
+  while (merged < num_blocks) {
+    int status;
+    pid_t pid;
+    int k;
+
+    /* Finished blocks keep their output open until all blocks before
+     * them are merged, so only a few may run ahead of the oldest one.
+     */
+    while (running < jobs && next < num_blocks
+	   && next - merged < 2 * jobs) {
+      start_gtp_block(&blocks[next++]);
+      running++;
+    }
+
+    pid = wait(&status);
+    if (pid < 0) {
+      perror("gnugo: wait");
+      exit(EXIT_FAILURE);
+    }
+    for (k = merged; k < next; k++)
+      if (blocks[k].pid == pid && !blocks[k].done) {
+	blocks[k].done = 1;
+	blocks[k].failed = !WIFEXITED(status)
+			   || WEXITSTATUS(status) != EXIT_SUCCESS;
+	blocks[k].time = gg_gettimeofday() - blocks[k].time;
+	running--;
+	break;
+      }
+
+    while (merged < next && blocks[merged].done)
+      merge_gtp_block(&blocks[merged++], gtp_output, gtp_dump_commands);
+  }
+
+  if (showtime && num_blocks > 0)
+    fprintf(stderr, "%d blocks in %.2f seconds on %d jobs\n", num_blocks,
+	    gg_gettimeofday() - start_time, jobs);
+
+  free(blocks);
+  free(text);
+
+  if (showstatistics)
+    showstats();
+}
+
+#endif /* HAVE_FORK */
+
+
 /****************************
  * Administrative commands. *
  ****************************/
@@ -2866,6 +3166,422 @@ gtp_top_moves_black(char *s)
 }
 
 
+#define MAX_UCT_BENCHMARK_RUNS 100
+
+/* Function:  Run the Monte Carlo search several times with one thread
+ *            and as often with the given number of threads and compare
+ *            the moves. Since the search is random, two one-thread runs
+ *            do not always agree either, so the moves of the runs with
+ *            threads are compared with those of the one-thread runs at
+ *            the rate the one-thread runs agree among themselves. The
+ *            size of the search is taken from the level and
+ *            --mc-games-per-level, as in genmove.
+ * Arguments: color to move, optional number of threads (default 2),
+ *            optional number of runs of each kind (default 5)
+ * Fails:     invalid color, invalid number of threads or runs, or more
+ *            than one thread in a build without engine threads
+ * Returns:   For one thread and for the given number of threads the
+ *            move chosen most often, the number of runs choosing it,
+ *            the playouts per run and the playouts per second. Then the
+ *            number of agreeing pairs of one-thread runs out of all
+ *            such pairs, and the same for pairs of a one-thread run and
+ *            a run with threads.
+ */
+static int
+gtp_uct_benchmark(char *s)
+{
+  int color;
+  int threads = 2;
+  int runs = 5;
+  int n;
+  int k;
+  int run;
+  int pos;
+  int forbidden_moves[BOARDMAX];
+  float move_values[BOARDMAX];
+  int move_frequencies[BOARDMAX];
+  int moves[2][MAX_UCT_BENCHMARK_RUNS];
+  int playouts[2];
+  double times[2];
+  int agreeing_pairs[2];
+  int pairs[2];
+  int saved_mc_threads = mc_threads;
+  int nodes = mc_games_per_level * gg_max(get_level(), 1);
+
+  n = gtp_decode_color(s, &color);
+  if (!n)
+    return gtp_failure("invalid color");
+
+  sscanf(s + n, "%d %d", &threads, &runs);
+  if (threads < 1)
+    return gtp_failure("invalid number of threads");
+  if (runs < 2 || runs > MAX_UCT_BENCHMARK_RUNS)
+    return gtp_failure("invalid number of runs");
+#if !ENGINE_THREADS
+  if (threads > 1)
+    return gtp_failure("engine threads not enabled in this build");
+#endif
+
+  if (stackp > 0)
+    return gtp_failure("uct_benchmark cannot be called when stackp > 0");
+
+  for (pos = BOARDMIN; pos < BOARDMAX; pos++)
+    forbidden_moves[pos] = 0;
+
+  for (k = 0; k < 2; k++) {
+    mc_threads = (k == 0 ? 1 : threads);
+    playouts[k] = 0;
+    times[k] = gg_gettimeofday();
+    for (run = 0; run < runs; run++) {
+      memset(move_frequencies, 0, sizeof(move_frequencies));
+      uct_genmove(color, &moves[k][run], forbidden_moves, NULL, nodes,
+		  move_values, move_frequencies);
+      for (pos = BOARDMIN; pos < BOARDMAX; pos++)
+	if (ON_BOARD(pos))
+	  playouts[k] += move_frequencies[pos];
+    }
+    times[k] = gg_gettimeofday() - times[k];
+  }
+  mc_threads = saved_mc_threads;
+
+  agreeing_pairs[0] = 0;
+  pairs[0] = 0;
+  for (run = 0; run < runs; run++)
+    for (n = run + 1; n < runs; n++) {
+      pairs[0]++;
+      if (moves[0][run] == moves[0][n])
+	agreeing_pairs[0]++;
+    }
+
+  agreeing_pairs[1] = 0;
+  pairs[1] = 0;
+  for (run = 0; run < runs; run++)
+    for (n = 0; n < runs; n++) {
+      pairs[1]++;
+      if (moves[0][run] == moves[1][n])
+	agreeing_pairs[1]++;
+    }
+
+  gtp_start_response(GTP_SUCCESS);
+  for (k = 0; k < 2; k++) {
+    int best_move = NO_MOVE;
+    int best_count = 0;
+    for (run = 0; run < runs; run++) {
+      int count = 0;
+      for (n = 0; n < runs; n++)
+	if (moves[k][n] == moves[k][run])
+	  count++;
+      if (count > best_count) {
+	best_move = moves[k][run];
+	best_count = count;
+      }
+    }
+    gtp_printf("%d ", k == 0 ? 1 : threads);
+    gtp_print_vertex(I(best_move), J(best_move));
+    gtp_printf(" %d %d %.0f\n", best_count, playouts[k] / runs,
+	       playouts[k] / gg_max(times[k], 0.001));
+  }
+  gtp_printf("%d/%d %d/%d\n", agreeing_pairs[0], pairs[0],
+	     agreeing_pairs[1], pairs[1]);
+  gtp_printf("\n");
+
+  return GTP_OK;
+}
+
+
+/* Function:  Play random Monte Carlo games from the current position,
+ *            first tracking the strings with liberty lists and then
+ *            with bitboards.
+ * Arguments: color to move, optional number of games (default 1000)
+ * Fails:     invalid color or number of games
+ * Returns:   For each board representation the number of games played
+ *            per second and the average score, positive for white and
+ *            without komi.
+ */
+static int
+gtp_mc_playout_benchmark(char *s)
+{
+  int color;
+  int num_games = 1000;
+  int n;
+  int k;
+  double start;
+  double elapsed;
+  float score;
+
+  n = gtp_decode_color(s, &color);
+  if (!n)
+    return gtp_failure("invalid color");
+
+  sscanf(s + n, "%d", &num_games);
+  if (num_games < 1)
+    return gtp_failure("invalid number of games");
+
+  if (stackp > 0)
+    return gtp_failure("mc_playout_benchmark cannot be called when stackp > 0");
+
+  gtp_start_response(GTP_SUCCESS);
+  for (k = 0; k < 2; k++) {
+    start = gg_gettimeofday();
+    score = mc_run_playouts(color, num_games, k);
+    elapsed = gg_gettimeofday() - start;
+    gtp_printf("%s %.0f %.2f\n", k == 0 ? "lists" : "bitboards",
+	       num_games / gg_max(elapsed, 0.001), score);
+  }
+  gtp_printf("\n");
+
+  return GTP_OK;
+}
+
+
+/* Function:  Generate a move first with every DFA pattern match
+ *            scanning all anchors and then with incremental matching.
+ *            The persistent caches are cleared before each run.
+ * Arguments: color to move
+ * Fails:     invalid color
+ * Returns:   For each run the move, the time in seconds, the number
+ *            of anchors matched and the number of them whose scan was
+ *            reused, followed by "agree" or "disagree".
+ */
+static int
+gtp_matchpat_benchmark(char *s)
+{
+  int color;
+  int k;
+  int moves[2];
+  double times[2];
+  int scans[2];
+  int reused[2];
+  int saved_incremental_matching = incremental_matching;
+
+  if (!gtp_decode_color(s, &color))
+    return gtp_failure("invalid color");
+
+  if (stackp > 0)
+    return gtp_failure("matchpat_benchmark cannot be called when stackp > 0");
+
+  for (k = 0; k < 2; k++) {
+    incremental_matching = k;
+    clear_persistent_caches();
+    matchpat_clear_stats();
+    times[k] = gg_gettimeofday();
+    moves[k] = genmove(color, NULL, NULL);
+    times[k] = gg_gettimeofday() - times[k];
+    matchpat_get_stats(&scans[k], &reused[k]);
+  }
+  incremental_matching = saved_incremental_matching;
+
+  gtp_start_response(GTP_SUCCESS);
+  for (k = 0; k < 2; k++) {
+    gtp_printf("%s ", k == 0 ? "full" : "incremental");
+    gtp_print_vertex(I(moves[k]), J(moves[k]));
+    gtp_printf(" %.2f %d %d\n", times[k], scans[k], reused[k]);
+  }
+  gtp_printf("%s\n", moves[0] == moves[1] ? "agree" : "disagree");
+  gtp_printf("\n");
+
+  return GTP_OK;
+}
+
+
+/* Function:  Generate a move first with the influence after each
+ *            candidate move computed from scratch, then reusing the
+ *            pattern matches of earlier influence computations, and
+ *            finally once more comparing each incremental influence
+ *            with a full computation. The persistent caches are
+ *            cleared before each run.
+ * Arguments: color to move
+ * Fails:     invalid color
+ * Returns:   For the first two runs the move, the time in seconds, the
+ *            time spent computing territorial influence and the number
+ *            of incremental computations, then the number of compared
+ *            computations and how many of them differed, followed by
+ *            "agree" or "disagree".
+ */
+static int
+gtp_influence_benchmark(char *s)
+{
+  int color;
+  int k;
+  int moves[3];
+  double times[3];
+  double influence_times[3];
+  int incremental[3];
+  int verified[3];
+  int differing[3];
+  int saved_incremental_influence = incremental_influence;
+
+  if (!gtp_decode_color(s, &color))
+    return gtp_failure("invalid color");
+
+  if (stackp > 0)
+    return gtp_failure("influence_benchmark cannot be called when stackp > 0");
+
+  for (k = 0; k < 3; k++) {
+    incremental_influence = (k > 0);
+    influence_set_verification(k == 2);
+    clear_persistent_caches();
+    influence_clear_stats();
+    times[k] = gg_gettimeofday();
+    moves[k] = genmove(color, NULL, NULL);
+    times[k] = gg_gettimeofday() - times[k];
+    influence_get_stats(&influence_times[k], &incremental[k], &verified[k],
+			&differing[k]);
+  }
+  incremental_influence = saved_incremental_influence;
+  influence_set_verification(0);
+
+  gtp_start_response(GTP_SUCCESS);
+  for (k = 0; k < 2; k++) {
+    gtp_printf("%s ", k == 0 ? "full" : "incremental");
+    gtp_print_vertex(I(moves[k]), J(moves[k]));
+    gtp_printf(" %.2f %.2f %d\n", times[k], influence_times[k],
+	       incremental[k]);
+  }
+  gtp_printf("verified %d %d\n", verified[2], differing[2]);
+  gtp_printf("%s\n", (moves[0] == moves[1] && moves[1] == moves[2]
+		      ? "agree" : "disagree"));
+  gtp_printf("\n");
+
+  return GTP_OK;
+}
+
+
+#if ENGINE_THREADS
+
+/* A move generated by threads_check, see below. */
+struct threads_check_job {
+  struct board_state position;
+  int color;
+  int move;
+  float value;
+  pthread_t thread;
+};
+
+static void *
+threads_check_main(void *data)
+{
+  struct threads_check_job *job = data;
+
+  init_gnugo_thread(reading_cache_size());
+  restore_board(&job->position);
+  job->move = genmove(job->color, &job->value, NULL);
+  exit_gnugo_thread();
+  return NULL;
+}
+
+#endif
+
+
+/* Function:  Generate a move in the current position and in the position
+ *            before the last move, each in a new engine thread, first
+ *            one after the other and then at the same time.
+ * Arguments: none
+ * Fails:     no move has been played, or a build without engine threads
+ * Returns:   For each position the move and its value of the serial and
+ *            the threaded run, followed by "agree" or "disagree".
+ */
+static int
+gtp_threads_check(char *s)
+{
+#if ENGINE_THREADS
+  struct board_state current;
+  struct threads_check_job serial[2];
+  struct threads_check_job threaded[2];
+  int agree = 1;
+  int k;
+  UNUSED(s);
+
+  if (stackp > 0)
+    return gtp_failure("threads_check cannot be called when stackp > 0");
+  if (get_last_player() == EMPTY)
+    return gtp_failure("no move has been played");
+
+  store_board(&current);
+  serial[0].color = OTHER_COLOR(get_last_player());
+  store_board(&serial[0].position);
+  serial[1].color = get_last_player();
+  undo_move(1);
+  store_board(&serial[1].position);
+  restore_board(&current);
+
+  for (k = 0; k < 2; k++) {
+    threaded[k] = serial[k];
+    if (pthread_create(&serial[k].thread, NULL, threads_check_main,
+		       &serial[k]) != 0)
+      return gtp_failure("cannot start thread");
+    pthread_join(serial[k].thread, NULL);
+  }
+
+  for (k = 0; k < 2; k++)
+    if (pthread_create(&threaded[k].thread, NULL, threads_check_main,
+		       &threaded[k]) != 0)
+      return gtp_failure("cannot start thread");
+  for (k = 0; k < 2; k++)
+    pthread_join(threaded[k].thread, NULL);
+
+  gtp_start_response(GTP_SUCCESS);
+  for (k = 0; k < 2; k++) {
+    gtp_print_vertex(I(serial[k].move), J(serial[k].move));
+    gtp_printf(" %.2f ", serial[k].value);
+    gtp_print_vertex(I(threaded[k].move), J(threaded[k].move));
+    gtp_printf(" %.2f\n", threaded[k].value);
+    if (serial[k].move != threaded[k].move
+	|| serial[k].value != threaded[k].value)
+      agree = 0;
+  }
+  gtp_printf("%s\n", agree ? "agree" : "disagree");
+  gtp_printf("\n");
+
+  return GTP_OK;
+#else
+  UNUSED(s);
+  return gtp_failure("engine threads not enabled in this build");
+#endif
+}
+
+
+/* Function:  Let several engine threads store and look up made-up
+ *            reading results in one small shared transposition table,
+ *            which is cleared between rounds.
+ * Arguments: optional number of threads (default 4), optional number
+ *            of stores per thread and round (default 1000)
+ * Fails:     invalid number of threads or stores, or a build without
+ *            engine threads
+ * Returns:   The number of lookups, the number of hits, the number of
+ *            hits with a wrong result and the number of results found
+ *            again after clearing the table. The last two should
+ *            always be 0.
+ */
+static int
+gtp_reading_cache_threads_check(char *s)
+{
+#if ENGINE_THREADS
+  int threads = 4;
+  int stores = 1000;
+  int lookups;
+  int hits;
+  int stale;
+  int mismatches;
+
+  sscanf(s, "%d %d", &threads, &stores);
+  if (threads < 1)
+    return gtp_failure("invalid number of threads");
+  if (stores < 1)
+    return gtp_failure("invalid number of stores");
+
+  mismatches = reading_cache_threads_check(threads, stores,
+					   &lookups, &hits, &stale);
+  if (mismatches < 0)
+    return gtp_failure("cannot start thread");
+
+  return gtp_success("%d %d %d %d", lookups, hits, mismatches, stale);
+#else
+  UNUSED(s);
+  return gtp_failure("engine threads not enabled in this build");
+#endif
+}
+
 
 /* Function:  Set the playing level.
  * Arguments: int
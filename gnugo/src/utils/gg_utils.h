@@ -52,6 +52,18 @@
 #include <io.h>
 #endif
 
+/* Storage class for engine state which belongs to one position: the
+ * board and its move stack, the reading caches and the worm and dragon
+ * data. With ENGINE_THREADS each thread gets its own copy, so several
+ * threads can analyze different positions at the same time; see
+ * init_gnugo_thread(). Options and constant tables stay shared.
+ */
+#if ENGINE_THREADS
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
 void gg_init_color(void);
 void write_color_char(int c, int x);
 void write_color_string(int c, const char *str);
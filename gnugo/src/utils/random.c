@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <assert.h>
 
+#include "gg_utils.h"
 #include "random.h"
 
 /* This is an implementation of the TGFSR (twisted generalized
@@ -51,12 +52,12 @@ static const unsigned int c = 0xdb8b0000U;
 
 
 /* Global state for the random number generator. */
-static unsigned int x[N];
-static int k;
+static THREAD_LOCAL unsigned int x[N];
+static THREAD_LOCAL int k;
 
 
 /* Set when properly seeded. */
-static int rand_initialized = 0;
+static THREAD_LOCAL int rand_initialized = 0;
 
 /* We use this to detect whether unsigned ints are bigger than 32
  * bits. If they are we need to clear higher order bits, otherwise we
@@ -51,6 +51,12 @@ target_local_cflags := -Wno-endif-labels -Wno-import -Wno-format \
 	-fvisibility=hidden -Wno-psabi -Darm
 endif
 
+# Set WEBKIT_SYSTEM_MALLOC=false to allocate fastMalloc() memory with
+# FastMalloc's thread-caching allocator instead of the system malloc.
+ifeq ($(WEBKIT_SYSTEM_MALLOC),false)
+target_local_cflags += -DUSE_SYSTEM_MALLOC=0
+endif
+
 # Build our list of include paths. We include WebKit/android/icu first so that
 # any files that include <unicode/ucnv.h> will include our ucnv.h first. We
 # also add external/ as an include directory so that we can specify the real
@@ -229,3 +235,80 @@ target_local_android_shared_libs := $(WEBKIT_SHARED_LIBRARIES)
 target_local_shared_libs := libwebcore
 
 include $(BUILD)/build_executable.mk
+
+
+#####################################
+include $(BUILD)/clear.mk
+TARGET := regex_bench
+#####################################
+
+# Regex micro-benchmark comparing PCRE, the YARR interpreter and the YARR JIT.
+# Run as: regex_bench ${PERFLAB_INPUT}/regex_corpus.txt ${PERFLAB_INPUT}/cnn.html
+target_srcs := \
+	JavaScriptCore/regexbench.cpp
+
+target_local_android_shared_libs := $(WEBKIT_SHARED_LIBRARIES)
+target_local_android_static_libs := $(WEBKIT_STATIC_LIBRARIES)
+target_local_static_libs := libwebcore libjs
+target_local_cflags := $(WEBKIT_CFLAGS)
+target_local_includes := $(WEBKIT_C_INCLUDES)
+
+include $(BUILD)/build_executable.mk
+
+
+#####################################
+include $(BUILD)/clear.mk
+TARGET := gc_bench
+#####################################
+
+# JavaScript collector micro-benchmark timing full collections of a synthetic
+# heap with 0..N parallel marking helper threads. Run as: gc_bench -t 3
+target_srcs := \
+	JavaScriptCore/gcbench.cpp
+
+target_local_android_shared_libs := $(WEBKIT_SHARED_LIBRARIES)
+target_local_android_static_libs := $(WEBKIT_STATIC_LIBRARIES)
+target_local_static_libs := libwebcore libjs
+target_local_cflags := $(WEBKIT_CFLAGS)
+target_local_includes := $(WEBKIT_C_INCLUDES)
+
+include $(BUILD)/build_executable.mk
+
+
+#####################################
+include $(BUILD)/clear.mk
+TARGET := string_bench
+#####################################
+
+# String building micro-benchmark (+= loops, markup templates, join). Compare
+# builds with and without JSC_ROPE_STRINGS; the checksums must match.
+# Run as: string_bench -n 20000
+target_srcs := \
+	JavaScriptCore/stringbench.cpp
+
+target_local_android_shared_libs := $(WEBKIT_SHARED_LIBRARIES)
+target_local_android_static_libs := $(WEBKIT_STATIC_LIBRARIES)
+target_local_static_libs := libwebcore libjs
+target_local_cflags := $(WEBKIT_CFLAGS)
+target_local_includes := $(WEBKIT_C_INCLUDES)
+
+include $(BUILD)/build_executable.mk
+
+
+#####################################
+include $(BUILD)/clear.mk
+TARGET := decoder_bench
+#####################################
+
+# Text decoder micro-benchmark reporting Latin-1 and UTF-8 decoding
+# throughput in MB/s. Run as: decoder_bench ${PERFLAB_INPUT}/cnn.html
+target_srcs := \
+	WebKit/android/benchmark/decoderbench.cpp
+
+target_local_android_shared_libs := $(WEBKIT_SHARED_LIBRARIES)
+target_local_android_static_libs := $(WEBKIT_STATIC_LIBRARIES)
+target_local_static_libs := libwebcore libjs
+target_local_cflags := $(WEBKIT_CFLAGS)
+target_local_includes := $(WEBKIT_C_INCLUDES)
+
+include $(BUILD)/build_executable.mk
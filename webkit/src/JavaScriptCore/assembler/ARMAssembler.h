@@ -132,6 +132,7 @@ namespace JSC {
             FDTR = 0x0d000b00,
             B = 0x0a000000,
             BL = 0x0b000000,
+            BX = 0x012fff10,
             FMSR = 0x0e000a10,
             FSITOD = 0x0eb80bc0,
             FMSTAT = 0x0ef1fa10,
@@ -492,6 +493,11 @@ namespace JSC {
             m_buffer.putInt(static_cast<ARMWord>(cc) | FMSTAT);
         }
 
+        void bx(int rm, Condition cc = AL)
+        {
+            m_buffer.putInt(static_cast<ARMWord>(cc) | BX | RM(rm));
+        }
+
 #if ARM_ARCH_VERSION >= 5
         void clz_r(int rd, int rm, Condition cc = AL)
         {
@@ -531,7 +531,9 @@ public:
 
     void ret()
     {
-        m_assembler.mov_r(ARMRegisters::pc, linkRegister);
+        // Use an interworking return so Thumb callers (the default for
+        // Android builds) get back into Thumb state.
+        m_assembler.bx(linkRegister);
     }
 
     void set32(Condition cond, RegisterID left, RegisterID right, RegisterID dest)
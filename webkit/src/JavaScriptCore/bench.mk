@@ -28,6 +28,9 @@ LOCAL_SRC_FILES := \
 	API/JSCallbackObject.cpp \
 	API/OpaqueJSString.cpp \
 	\
+	assembler/ARMAssembler.cpp \
+	assembler/MacroAssemblerARM.cpp \
+	\
 	bytecode/CodeBlock.cpp \
 	bytecode/JumpTable.cpp \
 	bytecode/Opcode.cpp \
@@ -44,6 +47,10 @@ LOCAL_SRC_FILES := \
 	interpreter/Interpreter.cpp \
 	interpreter/RegisterFile.cpp \
 	\
+	jit/ExecutableAllocator.cpp \
+	jit/ExecutableAllocatorPosix.cpp \
+	\
+	parser/CodeCache.cpp \
 	parser/Lexer.cpp \
 	parser/Nodes.cpp \
 	parser/Parser.cpp \
@@ -125,6 +132,7 @@ LOCAL_SRC_FILES := \
 	runtime/ObjectConstructor.cpp \
 	runtime/ObjectPrototype.cpp \
 	runtime/Operations.cpp \
+	runtime/ParallelMarker.cpp \
 	runtime/PropertyDescriptor.cpp \
 	runtime/PropertyNameArray.cpp \
 	runtime/PropertySlot.cpp \
@@ -171,7 +179,11 @@ LOCAL_SRC_FILES := \
 	wtf/unicode/CollatorDefault.cpp \
 	wtf/unicode/UTF8.cpp \
 	\
-	wtf/unicode/icu/CollatorICU.cpp
+	wtf/unicode/icu/CollatorICU.cpp \
+	\
+	yarr/RegexCompiler.cpp \
+	yarr/RegexInterpreter.cpp \
+	yarr/RegexJIT.cpp
 
 # Rule to build grammar.y with our custom bison.
 GEN := $(intermediates)/parser/Grammar.cpp
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Garbage collector micro-benchmark. Builds a heap of plain objects, arrays,
+// strings and closures from script, then times full collections of it with
+// each number of marking helper threads from 0 up to the given maximum. The
+// number of live objects after every collection must match the serial run.
+//
+// Usage: gc_bench [-n objects] [-c collections] [-t max helper threads]
+
+#include "config.h"
+
+#include "Completion.h"
+#include "CurrentTime.h"
+#include "InitializeThreading.h"
+#include "JSGlobalData.h"
+#include "JSGlobalObject.h"
+#include "JSLock.h"
+#include "SourceCode.h"
+#include "UString.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace JSC;
+using namespace WTF;
+
+class GlobalObject : public JSGlobalObject {
+public:
+    virtual UString className() const { return "global"; }
+};
+
+// Keeps everything reachable from the global object: wide arrays of small
+// objects, linked lists and trees (deep chains), strings and closures.
+static const char* heapBuilderScript =
+    "var heap = { arrays: [], lists: [], trees: [], closures: [] };\n"
+    "function makeTree(depth) {\n"
+    "    if (!depth) return { leaf: 'leaf' };\n"
+    "    return { left: makeTree(depth - 1), right: makeTree(depth - 1), depth: depth };\n"
+    "}\n"
+    "function build(objects) {\n"
+    "    var made = 0;\n"
+    "    while (made < objects) {\n"
+    "        var array = [];\n"
+    "        for (var i = 0; i < 1000; i++)\n"
+    "            array.push({ index: i, name: 'item' + i, next: null });\n"
+    "        heap.arrays.push(array);\n"
+    "        var list = null;\n"
+    "        for (var i = 0; i < 500; i++)\n"
+    "            list = { value: i, next: list };\n"
+    "        heap.lists.push(list);\n"
+    "        heap.trees.push(makeTree(9));\n"
+    "        for (var i = 0; i < 200; i++)\n"
+    "            heap.closures.push((function (captured) { return function () { return captured; }; })(array[i]));\n"
+    "        made += 1000 * 2 + 500 + 1023 + 200 * 2;\n"
+    "    }\n"
+    "}\n";
+
+int main(int argc, char** argv)
+{
+    int objects = 200000;
+    int collections = 10;
+    int maxHelpers = 3;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            objects = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            collections = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            maxHelpers = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: gc_bench [-n objects] [-c collections] [-t max helper threads]\n");
+            return 1;
+        }
+    }
+    if (objects <= 0 || collections <= 0 || maxHelpers < 0) {
+        fprintf(stderr, "Usage: gc_bench [-n objects] [-c collections] [-t max helper threads]\n");
+        return 1;
+    }
+
+    JSC::initializeThreading();
+    RefPtr<JSGlobalData> globalData = JSGlobalData::create();
+    JSLock lock(SilenceAssertionsOnly);
+
+    GlobalObject* globalObject = new (globalData.get()) GlobalObject;
+    globalData->heap.protect(globalObject);
+    ExecState* exec = globalObject->globalExec();
+    char buildCall[64];
+    snprintf(buildCall, sizeof(buildCall), "build(%d);", objects);
+    Completion completion = evaluate(exec, globalObject->globalScopeChain(), makeSource(UString(heapBuilderScript) + buildCall, "gc_bench"));
+    if (completion.complType() == Throw) {
+        fprintf(stderr, "gc_bench: building the heap threw %s\n", completion.value().toString(exec).UTF8String().c_str());
+        return 1;
+    }
+
+    Heap& heap = globalData->heap;
+#if !ENABLE(JSC_PARALLEL_MARKING)
+    maxHelpers = 0;
+#endif
+
+    heap.collect();
+    size_t liveObjects = heap.objectCount();
+    Heap::Statistics statistics = heap.statistics();
+    printf("gc_bench: %zu live objects, %zu byte heap, %d collections per run\n", liveObjects, statistics.size, collections);
+    printf("%-8s %12s %12s %8s\n", "helpers", "mark ms/gc", "pause ms/gc", "speedup");
+
+    bool success = true;
+    double serialMarkTime = 0;
+    for (int helpers = 0; helpers <= maxHelpers; ++helpers) {
+#if ENABLE(JSC_PARALLEL_MARKING)
+        heap.setMarkingHelperThreadCount(helpers);
+#endif
+        // The first collection also starts the helper threads.
+        heap.collect();
+
+        Heap::CollectionStatistics before = heap.collectionStatistics();
+        for (int i = 0; i < collections; ++i) {
+            heap.collect();
+            if (heap.objectCount() != liveObjects) {
+                printf("  %d helpers: MISMATCH (%zu live objects, expected %zu)\n", helpers, heap.objectCount(), liveObjects);
+                success = false;
+            }
+        }
+        const Heap::CollectionStatistics& after = heap.collectionStatistics();
+        double markTime = (after.totalMarkTime - before.totalMarkTime) / collections;
+        double pauseTime = (after.totalPauseTime - before.totalPauseTime) / collections;
+        if (!helpers)
+            serialMarkTime = markTime;
+        printf("%-8d %12.3f %12.3f %7.2fx\n", helpers, markTime * 1000, pauseTime * 1000, markTime ? serialMarkTime / markTime : 0);
+    }
+
+    heap.destroy();
+    return success ? 0 : 2;
+}
@@ -42,6 +42,10 @@
 #include <e32std.h>
 #endif
 
+#if PLATFORM(ANDROID) && PLATFORM(ARM)
+#include <unistd.h>
+#endif
+
 #define JIT_ALLOCATOR_PAGE_SIZE (ExecutableAllocator::pageSize)
 #define JIT_ALLOCATOR_LARGE_ALLOC_SIZE (ExecutableAllocator::pageSize * 4)
 
@@ -194,6 +198,13 @@ public:
     {
         User::IMB_Range(code, static_cast<char*>(code) + size);
     }
+#elif PLATFORM(ANDROID) && PLATFORM(ARM)
+    static void cacheFlush(void* code, size_t size)
+    {
+        // bionic wraps the ARM cacheflush syscall; unlike the inline asm below
+        // this also builds for Thumb-1 and Thumb-2 translation units.
+        cacheflush(reinterpret_cast<long>(code), reinterpret_cast<long>(code) + size, 0);
+    }
 #elif PLATFORM(ARM_TRADITIONAL) && PLATFORM(LINUX)
     static void cacheFlush(void* code, size_t size)
     {
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "CodeCache.h"
+
+#if ENABLE(JSC_CODE_CACHE)
+
+#include "Nodes.h"
+#include "Parser.h"
+#include "SourceCode.h"
+#include <algorithm>
+#include <string.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+CodeCache::CodeCache()
+    : m_capacity(defaultCapacity)
+    , m_useCounter(0)
+{
+    memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+CodeCache::~CodeCache()
+{
+}
+
+unsigned CodeCache::programKey(const SourceCode& source)
+{
+    uint64_t textHash = UString::Rep::computeHash(source.data(), source.length());
+    unsigned hash = WTF::intHash(textHash << 32 | source.provider()->url().rep()->hash());
+    hash ^= WTF::intHash(static_cast<uint32_t>(source.firstLine()));
+
+    // 0 and -1 are the empty and deleted keys of the map.
+    if (!hash || hash == static_cast<unsigned>(-1))
+        hash = 1;
+    return hash;
+}
+
+bool CodeCache::isShared(ScopeNode* node)
+{
+    return !node->hasOneRef();
+}
+
+bool CodeCache::sourceEquals(const SourceCode& a, const SourceCode& b)
+{
+    return a.length() == b.length()
+        && a.firstLine() == b.firstLine()
+        && a.provider()->url() == b.provider()->url()
+        && !memcmp(a.data(), b.data(), a.length() * sizeof(UChar));
+}
+
+PassRefPtr<ProgramNode> CodeCache::program(JSGlobalData* globalData, Debugger* debugger, ExecState* exec, const SourceCode& source, int* errLine, UString* errMsg)
+{
+    // A debugger expects to be told about every parse, so it always gets a fresh tree.
+    if (debugger || source.length() > static_cast<int>(maxCacheableSourceLength))
+        return globalData->parser->parse<ProgramNode>(globalData, debugger, exec, source, errLine, errMsg);
+
+    unsigned key = programKey(source);
+    ProgramMap::iterator it = m_programs.find(key);
+    if (it != m_programs.end() && sourceEquals(it->second.node->source(), source)) {
+        Entry& entry = it->second;
+        entry.lastUse = ++m_useCounter;
+        m_statistics.programHits++;
+        m_statistics.parseTimeSaved += entry.parseTime;
+        if (errLine)
+            *errLine = -1;
+        if (errMsg)
+            *errMsg = 0;
+        return static_cast<ProgramNode*>(entry.node.get());
+    }
+
+    m_statistics.programMisses++;
+    double startTime = currentTime();
+    RefPtr<ProgramNode> programNode = globalData->parser->parse<ProgramNode>(globalData, debugger, exec, source, errLine, errMsg);
+    double parseTime = currentTime() - startTime;
+    m_statistics.parseTime += parseTime;
+
+    if (programNode)
+        add(m_programs.add(key, Entry()).first->second, programNode.get(), parseTime);
+    return programNode.release();
+}
+
+PassRefPtr<FunctionBodyNode> CodeCache::functionBody(JSGlobalData* globalData, const SourceCode& source)
+{
+    if (source.length() > static_cast<int>(maxCacheableSourceLength))
+        return globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, source);
+
+    // The cached tree holds a reference to its source provider, so the
+    // provider's ID cannot be reused while the entry is alive.
+    std::pair<intptr_t, int> key(source.provider()->asID(), source.startOffset());
+    FunctionMap::iterator it = m_functions.find(key);
+    if (it != m_functions.end() && it->second.node->source().endOffset() == source.endOffset()) {
+        Entry& entry = it->second;
+        entry.lastUse = ++m_useCounter;
+        m_statistics.functionHits++;
+        m_statistics.parseTimeSaved += entry.parseTime;
+        return static_cast<FunctionBodyNode*>(entry.node.get());
+    }
+
+    m_statistics.functionMisses++;
+    double startTime = currentTime();
+    RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, source);
+    double parseTime = currentTime() - startTime;
+    m_statistics.parseTime += parseTime;
+
+    if (body)
+        add(m_functions.add(key, Entry()).first->second, body.get(), parseTime);
+    return body.release();
+}
+
+void CodeCache::add(Entry& entry, ScopeNode* node, double parseTime)
+{
+    if (entry.node)
+        m_statistics.cachedSourceBytes -= entry.node->source().length() * sizeof(UChar);
+    entry.node = node;
+    entry.parseTime = parseTime;
+    entry.lastUse = ++m_useCounter;
+    m_statistics.cachedSourceBytes += node->source().length() * sizeof(UChar);
+
+    if (m_statistics.cachedSourceBytes > m_capacity)
+        prune();
+}
+
+void CodeCache::prune()
+{
+    // Drop the least recently used trees until the cache is back to three
+    // quarters of its capacity, so that a full cache does not prune on
+    // every miss.
+    Vector<std::pair<unsigned, size_t> > uses;
+    uses.reserveCapacity(m_programs.size() + m_functions.size());
+    for (ProgramMap::iterator it = m_programs.begin(); it != m_programs.end(); ++it)
+        uses.append(std::make_pair(it->second.lastUse, it->second.node->source().length() * sizeof(UChar)));
+    for (FunctionMap::iterator it = m_functions.begin(); it != m_functions.end(); ++it)
+        uses.append(std::make_pair(it->second.lastUse, it->second.node->source().length() * sizeof(UChar)));
+    std::sort(uses.begin(), uses.end());
+
+    size_t target = m_capacity / 4 * 3;
+    size_t size = m_statistics.cachedSourceBytes;
+    unsigned cutoff = 0;
+    for (size_t i = 0; i < uses.size() && size > target; ++i) {
+        size -= uses[i].second;
+        cutoff = uses[i].first;
+    }
+
+    Vector<unsigned> programKeys;
+    for (ProgramMap::iterator it = m_programs.begin(); it != m_programs.end(); ++it) {
+        if (it->second.lastUse <= cutoff)
+            programKeys.append(it->first);
+    }
+    Vector<std::pair<intptr_t, int> > functionKeys;
+    for (FunctionMap::iterator it = m_functions.begin(); it != m_functions.end(); ++it) {
+        if (it->second.lastUse <= cutoff)
+            functionKeys.append(it->first);
+    }
+
+    for (size_t i = 0; i < programKeys.size(); ++i)
+        m_programs.remove(programKeys[i]);
+    for (size_t i = 0; i < functionKeys.size(); ++i)
+        m_functions.remove(functionKeys[i]);
+
+    m_statistics.evictions += programKeys.size() + functionKeys.size();
+    m_statistics.cachedSourceBytes = size;
+}
+
+void CodeCache::setCapacity(size_t capacity)
+{
+    m_capacity = capacity;
+    if (m_statistics.cachedSourceBytes > m_capacity)
+        prune();
+}
+
+void CodeCache::clear()
+{
+    m_programs.clear();
+    m_functions.clear();
+    m_statistics.cachedSourceBytes = 0;
+}
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_CODE_CACHE)
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CodeCache_h
+#define CodeCache_h
+
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+
+#if ENABLE(JSC_CODE_CACHE)
+
+namespace JSC {
+
+    class Debugger;
+    class ExecState;
+    class FunctionBodyNode;
+    class JSGlobalData;
+    class ProgramNode;
+    class ScopeNode;
+    class SourceCode;
+    class UString;
+
+    // Keeps the syntax trees of recently loaded scripts so that loading the
+    // same script again skips the lexer and parser. Program trees are keyed
+    // by a hash of the source text, the URL and the first line; function
+    // bodies by their source provider and offsets. Bytecode is not cached:
+    // generated code resolves globals against one JSGlobalObject, and every
+    // page load gets a new one.
+    class CodeCache : public Noncopyable {
+    public:
+        struct Statistics {
+            size_t programHits;
+            size_t programMisses;
+            size_t functionHits;
+            size_t functionMisses;
+            size_t evictions;
+            double parseTime; // in seconds, spent parsing on misses
+            double parseTimeSaved; // in seconds, recorded parse time of the trees that were reused
+            size_t cachedSourceBytes;
+        };
+
+        CodeCache();
+        ~CodeCache();
+
+        // Same contract as Parser::parse<ProgramNode>(). The returned tree
+        // may be shared with the cache, in which case the caller must not
+        // destroy its data; see isShared().
+        PassRefPtr<ProgramNode> program(JSGlobalData*, Debugger*, ExecState*, const SourceCode&, int* errLine, UString* errMsg);
+        PassRefPtr<FunctionBodyNode> functionBody(JSGlobalData*, const SourceCode&);
+
+        static bool isShared(ScopeNode*);
+
+        // Capacity is measured in bytes of cached source text.
+        void setCapacity(size_t);
+        void clear();
+
+        const Statistics& statistics() const { return m_statistics; }
+
+    private:
+        struct Entry {
+            RefPtr<ScopeNode> node;
+            double parseTime;
+            unsigned lastUse;
+        };
+
+        typedef HashMap<unsigned, Entry> ProgramMap;
+        typedef HashMap<std::pair<intptr_t, int>, Entry> FunctionMap;
+
+        static const size_t defaultCapacity = 1024 * 1024;
+        static const size_t maxCacheableSourceLength = 256 * 1024;
+
+        static unsigned programKey(const SourceCode&);
+        static bool sourceEquals(const SourceCode&, const SourceCode&);
+
+        void add(Entry&, ScopeNode*, double parseTime);
+        void prune();
+
+        ProgramMap m_programs;
+        FunctionMap m_functions;
+        size_t m_capacity;
+        unsigned m_useCounter;
+        Statistics m_statistics;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_CODE_CACHE)
+
+#endif // CodeCache_h
@@ -52,6 +52,9 @@ static const UChar byteOrderMark = 0xFEFF;
 
 Lexer::Lexer(JSGlobalData* globalData)
     : m_isReparsing(false)
+    , m_sawFunction(false)
+    , m_skippedFunctionBodyDepth(0)
+    , m_skippedFunctionBodyCount(0)
     , m_globalData(globalData)
     , m_keywordTable(JSC::mainTable)
 {
@@ -151,6 +154,9 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     m_codeEnd = data + source.endOffset();
     m_error = false;
     m_atLineStart = true;
+    m_sawFunction = false;
+    m_skippedFunctionBodyDepth = 0;
+    m_skippedFunctionBodyCount = 0;
 
     // ECMA-262 calls for stripping all Cf characters, but we only strip BOM characters.
     // See <https://bugs.webkit.org/show_bug.cgi?id=4931> for details.
@@ -205,6 +211,38 @@ ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, s
     return &m_arena->makeIdentifier(m_globalData, characters, length);
 }
 
+// Identifiers inside a skipped function body are not atomized. Keywords are
+// found by hashing the characters the way the keyword table's keys are hashed.
+// The only identifiers the _NoNode grammar looks at are "get" and "set".
+int Lexer::skippedIdentifierOrKeyword(const UChar* characters, size_t length, const Identifier*& ident)
+{
+    m_keywordTable.initializeIfNeeded(m_globalData);
+    const HashEntry* entry = &m_keywordTable.table[UString::Rep::computeHash(characters, length) & m_keywordTable.compactHashSizeMask];
+    if (entry->key()) {
+        do {
+            UString::Rep* key = entry->key();
+            if (static_cast<size_t>(key->size()) == length && !memcmp(key->data(), characters, length * sizeof(UChar))) {
+                ident = &m_globalData->propertyNames->nullIdentifier;
+                return entry->lexerValue();
+            }
+            entry = entry->next();
+        } while (entry);
+    }
+
+    if (length == 3 && characters[1] == 'e' && characters[2] == 't') {
+        if (characters[0] == 'g') {
+            ident = &m_globalData->propertyNames->get;
+            return IDENT;
+        }
+        if (characters[0] == 's') {
+            ident = &m_globalData->propertyNames->set;
+            return IDENT;
+        }
+    }
+    ident = &m_globalData->propertyNames->nullIdentifier;
+    return IDENT;
+}
+
 inline bool Lexer::lastTokenWasRestrKeyword() const
 {
     return m_lastToken == CONTINUE || m_lastToken == BREAK || m_lastToken == RETURN || m_lastToken == THROW;
@@ -518,12 +556,22 @@ start:
             lvalp->intValue = currentOffset();
             shift1();
             token = OPENBRACE;
+            if (m_skippedFunctionBodyDepth)
+                ++m_skippedFunctionBodyDepth;
+            else if (m_sawFunction) {
+                // The first brace after 'function' opens its body.
+                m_sawFunction = false;
+                m_skippedFunctionBodyDepth = 1;
+                ++m_skippedFunctionBodyCount;
+            }
             break;
         case '}':
             lvalp->intValue = currentOffset();
             shift1();
             m_delimited = true;
             token = CLOSEBRACE;
+            if (m_skippedFunctionBodyDepth)
+                --m_skippedFunctionBodyDepth;
             break;
         case '\\':
             goto startIdentifierWithBackslash;
@@ -576,7 +624,10 @@ startString: {
         }
         shift1();
     }
-    lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
+    if (m_skippedFunctionBodyDepth)
+        lvalp->ident = &m_globalData->propertyNames->nullIdentifier;
+    else
+        lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
     shift1();
     m_atLineStart = false;
     m_delimited = false;
@@ -665,6 +716,12 @@ startIdentifierOrKeyword: {
     while (isIdentPart(m_current))
         shift1();
     if (LIKELY(m_current != '\\')) {
+        if (UNLIKELY(m_skippedFunctionBodyDepth)) {
+            token = skippedIdentifierOrKeyword(identifierStart, currentCharacter() - identifierStart, lvalp->ident);
+            m_atLineStart = false;
+            m_delimited = false;
+            goto returnToken;
+        }
         lvalp->ident = makeIdentifier(identifierStart, currentCharacter() - identifierStart);
         goto doneIdentifierOrKeyword;
     }
@@ -873,6 +930,8 @@ doneIdentifierOrKeyword: {
     m_buffer16.resize(0);
     const HashEntry* entry = m_keywordTable.entry(m_globalData, *lvalp->ident);
     token = entry ? entry->lexerValue() : IDENT;
+    if (token == FUNCTION)
+        m_sawFunction = true;
     goto returnToken;
 }
 
@@ -881,7 +940,10 @@ doneString:
     shift1();
     m_atLineStart = false;
     m_delimited = false;
-    lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
+    if (m_skippedFunctionBodyDepth)
+        lvalp->ident = &m_globalData->propertyNames->nullIdentifier;
+    else
+        lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
     m_buffer16.resize(0);
     token = STRING;
 
@@ -56,6 +56,7 @@ namespace JSC {
 
         // Functions for use after parsing.
         bool sawError() const { return m_error; }
+        unsigned skippedFunctionBodyCount() const { return m_skippedFunctionBodyCount; }
         void clear();
 
     private:
@@ -80,6 +81,7 @@ namespace JSC {
         const UChar* currentCharacter() const;
 
         const Identifier* makeIdentifier(const UChar* characters, size_t length);
+        int skippedIdentifierOrKeyword(const UChar* characters, size_t length, const Identifier*&);
 
         bool lastTokenWasRestrKeyword() const;
 
@@ -101,6 +103,13 @@ namespace JSC {
         bool m_atLineStart;
         bool m_error;
 
+        // Inner function bodies are only syntax checked by the parser (the
+        // _NoNode productions in Grammar.y) and are parsed again on their
+        // first call, so tokens inside them do not need identifiers.
+        bool m_sawFunction;
+        unsigned m_skippedFunctionBodyDepth;
+        unsigned m_skippedFunctionBodyCount;
+
         // current and following unicode characters (int to allow for -1 for end-of-file marker)
         int m_current;
         int m_next1;
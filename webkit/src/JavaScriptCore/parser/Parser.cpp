@@ -25,6 +25,9 @@
 
 #include "Debugger.h"
 #include "Lexer.h"
+#include <algorithm>
+#include <string.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/HashSet.h>
 #include <wtf/Vector.h>
 #include <memory>
@@ -41,11 +44,17 @@ extern int jscyyparse(void*);
 
 namespace JSC {
 
-void Parser::parse(JSGlobalData* globalData, int* errLine, UString* errMsg)
+Parser::Parser()
+{
+    memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+void Parser::parse(JSGlobalData* globalData, bool isFunctionBody, int* errLine, UString* errMsg)
 {
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::start(android::TimeCounter::JavaScriptParseTimeCounter);
 #endif
+    double startTime = currentTime();
     m_sourceElements = 0;
 
     int defaultErrLine;
@@ -65,13 +74,24 @@ void Parser::parse(JSGlobalData* globalData, int* errLine, UString* errMsg)
     int parseError = jscyyparse(globalData);
     bool lexError = lexer.sawError();
     int lineNumber = lexer.lineNumber();
+    unsigned skippedFunctionBodies = lexer.skippedFunctionBodyCount();
     lexer.clear();
 
     if (parseError || lexError) {
         *errLine = lineNumber;
         *errMsg = "Parse error";
         m_sourceElements = 0;
+    } else {
+        if (isFunctionBody)
+            m_statistics.functionBodiesParsed++;
+        else
+            m_statistics.programsParsed++;
+        m_statistics.functionBodiesSkipped += skippedFunctionBodies;
+        size_t arenaBytes = m_arena.size();
+        m_statistics.arenaBytes += arenaBytes;
+        m_statistics.maxArenaBytes = std::max(m_statistics.maxArenaBytes, arenaBytes);
     }
+    m_statistics.parseTime += currentTime() - startTime;
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::record(android::TimeCounter::JavaScriptParseTimeCounter, __FUNCTION__);
 #endif
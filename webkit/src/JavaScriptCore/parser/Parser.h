@@ -45,6 +45,17 @@ namespace JSC {
 
     class Parser : public Noncopyable {
     public:
+        struct Statistics {
+            size_t programsParsed;
+            size_t functionBodiesParsed; // on first call, after being skipped
+            size_t functionBodiesSkipped; // syntax checked only
+            double parseTime; // in seconds
+            size_t arenaBytes; // total over all parses
+            size_t maxArenaBytes; // largest single parse
+        };
+
+        Parser();
+
         template <class ParsedNode>
         PassRefPtr<ParsedNode> parse(JSGlobalData* globalData, Debugger*, ExecState*, const SourceCode& source, int* errLine = 0, UString* errMsg = 0);
 
@@ -53,8 +64,10 @@ namespace JSC {
 
         ParserArena& arena() { return m_arena; }
 
+        const Statistics& statistics() const { return m_statistics; }
+
     private:
-        void parse(JSGlobalData*, int* errLine, UString* errMsg);
+        void parse(JSGlobalData*, bool isFunctionBody, int* errLine, UString* errMsg);
 
         ParserArena m_arena;
         const SourceCode* m_source;
@@ -64,6 +77,7 @@ namespace JSC {
         CodeFeatures m_features;
         int m_lastLine;
         int m_numConstants;
+        Statistics m_statistics;
     };
 
     template <class ParsedNode>
@@ -72,7 +86,7 @@ namespace JSC {
         m_source = &source;
         if (ParsedNode::scopeIsFunction)
             globalData->lexer->setIsReparsing();
-        parse(globalData, errLine, errMsg);
+        parse(globalData, ParsedNode::scopeIsFunction, errLine, errMsg);
 
         RefPtr<ParsedNode> result;
         if (m_sourceElements) {
@@ -33,6 +33,7 @@ namespace JSC {
 ParserArena::ParserArena()
     : m_freeableMemory(0)
     , m_freeablePoolEnd(0)
+    , m_deletableBytes(0)
     , m_identifierArena(new IdentifierArena)
 {
 }
@@ -90,6 +91,7 @@ void ParserArena::reset()
 
     m_freeableMemory = 0;
     m_freeablePoolEnd = 0;
+    m_deletableBytes = 0;
     m_identifierArena->clear();
     m_freeablePools.clear();
     m_deletableObjects.clear();
@@ -116,6 +118,12 @@ bool ParserArena::isEmpty() const
         && m_refCountedObjects.isEmpty();
 }
 
+size_t ParserArena::size() const
+{
+    size_t pools = m_freeablePools.size() + (m_freeablePoolEnd ? 1 : 0);
+    return pools * freeablePoolSize + m_deletableBytes + m_identifierArena->size() * sizeof(Identifier);
+}
+
 void ParserArena::derefWithArena(PassRefPtr<ParserArenaRefCounted> object)
 {
     m_refCountedObjects.append(object);
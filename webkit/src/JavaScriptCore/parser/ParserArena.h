@@ -41,6 +41,7 @@ namespace JSC {
 
         void clear() { m_identifiers.clear(); }
         bool isEmpty() const { return m_identifiers.isEmpty(); }
+        size_t size() const { return m_identifiers.size(); }
 
     private:
         typedef SegmentedVector<Identifier, 64> IdentifierVector;
@@ -68,6 +69,7 @@ namespace JSC {
         {
             std::swap(m_freeableMemory, otherArena.m_freeableMemory);
             std::swap(m_freeablePoolEnd, otherArena.m_freeablePoolEnd);
+            std::swap(m_deletableBytes, otherArena.m_deletableBytes);
             m_identifierArena.swap(otherArena.m_identifierArena);
             m_freeablePools.swap(otherArena.m_freeablePools);
             m_deletableObjects.swap(otherArena.m_deletableObjects);
@@ -91,6 +93,7 @@ namespace JSC {
         {
             ParserArenaDeletable* deletable = static_cast<ParserArenaDeletable*>(fastMalloc(size));
             m_deletableObjects.append(deletable);
+            m_deletableBytes += size;
             return deletable;
         }
 
@@ -102,6 +105,9 @@ namespace JSC {
         bool isEmpty() const;
         void reset();
 
+        // Bytes held by the arena's pools, deletable nodes and identifiers.
+        size_t size() const;
+
         IdentifierArena& identifierArena() { return *m_identifierArena; }
 
     private:
@@ -118,6 +124,7 @@ namespace JSC {
 
         char* m_freeableMemory;
         char* m_freeablePoolEnd;
+        size_t m_deletableBytes;
 
         OwnPtr<IdentifierArena> m_identifierArena;
         Vector<void*> m_freeablePools;
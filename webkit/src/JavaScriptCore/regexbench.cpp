@@ -0,0 +1,415 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Regex micro-benchmark. Compiles every pattern of a corpus with PCRE, the
+// YARR interpreter and the YARR JIT, runs each one globally over a subject
+// file (normally a saved page) and reports compile and match times per engine.
+// Match results are cross-checked so an engine that disagrees is reported.
+//
+// Usage: regex_bench [-n iterations] [-v] corpus.txt subject.html
+//
+// The corpus has one regex literal per line, e.g. /^\s+|\s+$/g. Empty lines
+// and lines starting with '#' are ignored.
+
+#include "config.h"
+
+#include "CurrentTime.h"
+#include "InitializeThreading.h"
+#include "JSGlobalData.h"
+#include "JSLock.h"
+#include "UString.h"
+#include <pcre/pcre.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
+
+#if ENABLE(YARR)
+#include "yarr/RegexInterpreter.h"
+#endif
+#if ENABLE(YARR_JIT)
+#include "yarr/RegexJIT.h"
+#endif
+
+using namespace JSC;
+using namespace WTF;
+
+struct Pattern {
+    UString source;
+    bool ignoreCase;
+    bool multiline;
+};
+
+struct MatchResult {
+    MatchResult()
+        : count(0)
+        , checksum(0)
+    {
+    }
+
+    bool operator==(const MatchResult& other) const { return count == other.count && checksum == other.checksum; }
+    bool operator!=(const MatchResult& other) const { return !(*this == other); }
+
+    unsigned count;
+    unsigned checksum;
+};
+
+class RegexEngine {
+public:
+    virtual ~RegexEngine() { }
+    virtual const char* name() const = 0;
+    // Returns false (and sets error) if the pattern does not compile.
+    virtual bool compile(JSGlobalData*, const Pattern&, const char*& error) = 0;
+    // Returns the start of the match, or -1.
+    virtual int match(const UString& subject, int start, int* ovector, int ovectorSize) = 0;
+    virtual void release() = 0;
+    virtual bool isFallback() const { return false; }
+
+    unsigned numSubpatterns() const { return m_numSubpatterns; }
+
+protected:
+    RegexEngine()
+        : m_numSubpatterns(0)
+    {
+    }
+
+    unsigned m_numSubpatterns;
+};
+
+class PCREEngine : public RegexEngine {
+public:
+    PCREEngine()
+        : m_regExp(0)
+    {
+    }
+
+    virtual const char* name() const { return "pcre"; }
+
+    virtual bool compile(JSGlobalData*, const Pattern& pattern, const char*& error)
+    {
+        release();
+        error = 0;
+        m_regExp = jsRegExpCompile(reinterpret_cast<const UChar*>(pattern.source.data()), pattern.source.size(),
+            pattern.ignoreCase ? JSRegExpIgnoreCase : JSRegExpDoNotIgnoreCase,
+            pattern.multiline ? JSRegExpMultiline : JSRegExpSingleLine,
+            &m_numSubpatterns, &error);
+        return m_regExp;
+    }
+
+    virtual int match(const UString& subject, int start, int* ovector, int ovectorSize)
+    {
+        int result = jsRegExpExecute(m_regExp, reinterpret_cast<const UChar*>(subject.data()), subject.size(), start, ovector, ovectorSize);
+        return result < 0 ? -1 : ovector[0];
+    }
+
+    virtual void release()
+    {
+        if (m_regExp)
+            jsRegExpFree(m_regExp);
+        m_regExp = 0;
+    }
+
+private:
+    JSRegExp* m_regExp;
+};
+
+#if ENABLE(YARR)
+class YarrInterpreterEngine : public RegexEngine {
+public:
+    virtual const char* name() const { return "yarr-interp"; }
+
+    virtual bool compile(JSGlobalData*, const Pattern& pattern, const char*& error)
+    {
+        error = 0;
+        m_bytecode.set(Yarr::byteCompileRegex(pattern.source, m_numSubpatterns, error, pattern.ignoreCase, pattern.multiline));
+        return !error && m_bytecode;
+    }
+
+    virtual int match(const UString& subject, int start, int* ovector, int)
+    {
+        return Yarr::interpretRegex(m_bytecode.get(), subject.data(), start, subject.size(), ovector);
+    }
+
+    virtual void release() { m_bytecode.clear(); }
+
+private:
+    OwnPtr<Yarr::BytecodePattern> m_bytecode;
+};
+#endif
+
+#if ENABLE(YARR_JIT)
+class YarrJITEngine : public RegexEngine {
+public:
+    virtual const char* name() const { return "yarr-jit"; }
+
+    virtual bool compile(JSGlobalData* globalData, const Pattern& pattern, const char*& error)
+    {
+        error = 0;
+        m_codeBlock.set(new Yarr::RegexCodeBlock);
+        Yarr::jitCompileRegex(globalData, *m_codeBlock, pattern.source, m_numSubpatterns, error, pattern.ignoreCase, pattern.multiline);
+        return !error && (!!*m_codeBlock || m_codeBlock->getFallback());
+    }
+
+    virtual int match(const UString& subject, int start, int* ovector, int ovectorSize)
+    {
+        return Yarr::executeRegex(*m_codeBlock, subject.data(), start, subject.size(), ovector, ovectorSize);
+    }
+
+    virtual void release() { m_codeBlock.clear(); }
+
+    // The JIT hands patterns it cannot compile (e.g. back references) to PCRE.
+    virtual bool isFallback() const { return m_codeBlock && m_codeBlock->getFallback(); }
+
+private:
+    OwnPtr<Yarr::RegexCodeBlock> m_codeBlock;
+};
+#endif
+
+struct EngineTotals {
+    EngineTotals()
+        : compileTime(0)
+        , matchTime(0)
+        , compiled(0)
+        , failed(0)
+        , fallbacks(0)
+        , mismatches(0)
+    {
+    }
+
+    double compileTime;
+    double matchTime;
+    unsigned compiled;
+    unsigned failed;
+    unsigned fallbacks;
+    unsigned mismatches;
+};
+
+static bool readFile(const char* fileName, Vector<char>& buffer)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (!f) {
+        fprintf(stderr, "Could not open file: %s\n", fileName);
+        return false;
+    }
+
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buffer.append(chunk, read);
+    fclose(f);
+    return true;
+}
+
+// Widens the bytes of the subject as Latin-1, which is what webkit_bench
+// uses as the default encoding.
+static UString latin1String(const Vector<char>& buffer)
+{
+    Vector<UChar> characters(buffer.size());
+    for (size_t i = 0; i < buffer.size(); ++i)
+        characters[i] = static_cast<unsigned char>(buffer[i]);
+    return UString(characters);
+}
+
+static bool parseCorpus(const Vector<char>& buffer, Vector<Pattern>& patterns)
+{
+    size_t lineStart = 0;
+    unsigned lineNumber = 0;
+    while (lineStart < buffer.size()) {
+        size_t lineEnd = lineStart;
+        while (lineEnd < buffer.size() && buffer[lineEnd] != '\n')
+            ++lineEnd;
+        ++lineNumber;
+
+        size_t end = lineEnd;
+        while (end > lineStart && (buffer[end - 1] == '\r' || buffer[end - 1] == ' ' || buffer[end - 1] == '\t'))
+            --end;
+
+        if (end > lineStart && buffer[lineStart] != '#') {
+            // Find the closing slash; everything after it is flags.
+            size_t close = end - 1;
+            while (close > lineStart && buffer[close] != '/')
+                --close;
+            if (buffer[lineStart] != '/' || close == lineStart) {
+                fprintf(stderr, "corpus line %u: expected /pattern/flags\n", lineNumber);
+                return false;
+            }
+
+            Vector<UChar> source;
+            for (size_t i = lineStart + 1; i < close; ++i)
+                source.append(static_cast<unsigned char>(buffer[i]));
+
+            Pattern pattern;
+            pattern.source = UString(source);
+            pattern.ignoreCase = false;
+            pattern.multiline = false;
+            for (size_t i = close + 1; i < end; ++i) {
+                if (buffer[i] == 'i')
+                    pattern.ignoreCase = true;
+                else if (buffer[i] == 'm')
+                    pattern.multiline = true;
+            }
+            patterns.append(pattern);
+        }
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
+
+// Runs the pattern over the whole subject the way String.prototype.match
+// does with the global flag, advancing past empty matches.
+static MatchResult matchAll(RegexEngine* engine, const UString& subject, Vector<int>& ovector)
+{
+    MatchResult result;
+    int start = 0;
+    while (start <= subject.size()) {
+        for (size_t i = 0; i < ovector.size(); ++i)
+            ovector[i] = -1;
+        int matchStart = engine->match(subject, start, ovector.data(), ovector.size());
+        if (matchStart < 0)
+            break;
+        int matchEnd = ovector[1];
+        result.count++;
+        result.checksum = result.checksum * 31 + matchStart * 7 + matchEnd;
+        start = matchEnd > matchStart ? matchEnd : matchStart + 1;
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 10;
+    bool verbose = false;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+            break;
+    }
+    if (argc - i != 2 || iterations <= 0) {
+        fprintf(stderr, "Usage: regex_bench [-n iterations] [-v] corpus.txt subject.html\n");
+        return 1;
+    }
+
+    Vector<char> corpusBuffer;
+    Vector<char> subjectBuffer;
+    if (!readFile(argv[i], corpusBuffer) || !readFile(argv[i + 1], subjectBuffer))
+        return 1;
+
+    Vector<Pattern> patterns;
+    if (!parseCorpus(corpusBuffer, patterns))
+        return 1;
+
+    JSC::initializeThreading();
+    RefPtr<JSGlobalData> globalData = JSGlobalData::create();
+    JSLock lock(SilenceAssertionsOnly);
+
+    UString subject = latin1String(subjectBuffer);
+
+    Vector<RegexEngine*> engines;
+    engines.append(new PCREEngine);
+#if ENABLE(YARR)
+    engines.append(new YarrInterpreterEngine);
+#endif
+#if ENABLE(YARR_JIT)
+    engines.append(new YarrJITEngine);
+#endif
+
+    printf("regex_bench: %zu patterns, %d byte subject, %d iterations\n", patterns.size(), subject.size(), iterations);
+
+    Vector<EngineTotals> totals(engines.size());
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        const Pattern& pattern = patterns[p];
+        // PCRE is the reference result every other engine is checked against.
+        MatchResult reference;
+        bool haveReference = false;
+
+        for (size_t e = 0; e < engines.size(); ++e) {
+            RegexEngine* engine = engines[e];
+            EngineTotals& total = totals[e];
+            const char* error = 0;
+
+            double start = currentTime();
+            bool compiled = false;
+            for (int iteration = 0; iteration < iterations; ++iteration)
+                compiled = engine->compile(globalData.get(), pattern, error);
+            double compileTime = (currentTime() - start) / iterations;
+
+            if (!compiled) {
+                total.failed++;
+                if (verbose)
+                    printf("  %-12s /%s/: compile failed (%s)\n", engine->name(), pattern.source.UTF8String().c_str(), error ? error : "unknown");
+                engine->release();
+                continue;
+            }
+            total.compiled++;
+            total.compileTime += compileTime;
+            if (engine->isFallback())
+                total.fallbacks++;
+
+            Vector<int> ovector((engine->numSubpatterns() + 1) * 3);
+            MatchResult result;
+            start = currentTime();
+            for (int iteration = 0; iteration < iterations; ++iteration)
+                result = matchAll(engine, subject, ovector);
+            double matchTime = (currentTime() - start) / iterations;
+            total.matchTime += matchTime;
+            engine->release();
+
+            if (!haveReference) {
+                reference = result;
+                haveReference = true;
+            } else if (result != reference) {
+                total.mismatches++;
+                printf("  %-12s /%s/: MISMATCH (%u matches, expected %u)\n", engine->name(), pattern.source.UTF8String().c_str(), result.count, reference.count);
+            }
+
+            if (verbose)
+                printf("  %-12s /%s/: %u matches, compile %.3f ms, match %.3f ms%s\n", engine->name(),
+                    pattern.source.UTF8String().c_str(), result.count, compileTime * 1000, matchTime * 1000,
+                    engine->isFallback() ? " (pcre fallback)" : "");
+        }
+    }
+
+    printf("%-12s %10s %10s %9s %7s %9s %10s\n", "engine", "compile ms", "match ms", "compiled", "failed", "fallback", "mismatch");
+    for (size_t e = 0; e < engines.size(); ++e) {
+        const EngineTotals& total = totals[e];
+        printf("%-12s %10.3f %10.3f %9u %7u %9u %10u\n", engines[e]->name(), total.compileTime * 1000, total.matchTime * 1000,
+            total.compiled, total.failed, total.fallbacks, total.mismatches);
+    }
+
+    bool success = true;
+    for (size_t e = 0; e < engines.size(); ++e) {
+        if (totals[e].mismatches)
+            success = false;
+        delete engines[e];
+    }
+
+    globalData->heap.destroy();
+    return success ? 0 : 2;
+}
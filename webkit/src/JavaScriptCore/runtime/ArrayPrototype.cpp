@@ -84,6 +84,25 @@ static inline bool isNumericCompareFunction(ExecState* exec, CallType callType,
     return codeBlock.isNumericCompareFunction();
 }
 
+#if ENABLE(JSC_ROPE_STRINGS)
+static const unsigned maxJoinRopeFibers = 256;
+
+// Appends to the rope built by join(), chaining a full rope in as the first
+// fiber of a new one. Returns false if out of memory.
+template <typename T> static bool appendToJoinRope(RefPtr<JSString::Rope>& rope, const T& string)
+{
+    if (rope->isFull()) {
+        RefPtr<JSString::Rope> next = JSString::Rope::createOrNull(maxJoinRopeFibers);
+        if (!next)
+            return false;
+        next->append(JSString::Rope::Fiber(rope.get()));
+        rope = next.release();
+    }
+    rope->append(string);
+    return rope->stringLength() <= JSString::maxLength;
+}
+#endif
+
 // ------------------------------ ArrayPrototype ----------------------------
 
 const ClassInfo ArrayPrototype::info = {"Array", &JSArray::info, 0, ExecState::arrayTable};
@@ -276,12 +295,45 @@ JSValue JSC_HOST_CALL arrayProtoFuncJoin(ExecState* exec, JSObject*, JSValue thi
     if (alreadyVisited)
         return jsEmptyString(exec); // return an empty string, avoding infinite recursion.
 
-    Vector<UChar, 256> strBuffer;
-
     UChar comma = ',';
     UString separator = args.at(0).isUndefined() ? UString(&comma, 1) : args.at(0).toString(exec);
 
     unsigned length = thisObj->get(exec, exec->propertyNames().length).toUInt32(exec);
+
+#if ENABLE(JSC_ROPE_STRINGS)
+    // Collect the elements and separators into a rope rather than copying
+    // them into a buffer and then once more into the result; the rope is
+    // flattened in a single pass when its characters are first needed.
+    RefPtr<JSString::Rope> rope = JSString::Rope::createOrNull(2 * std::min(length, maxJoinRopeFibers / 2) + 1);
+    bool outOfMemory = !rope;
+    for (unsigned k = 0; !outOfMemory && k < length; k++) {
+        if (k >= 1 && !appendToJoinRope(rope, separator)) {
+            outOfMemory = true;
+            break;
+        }
+
+        JSValue element = thisObj->get(exec, k);
+        if (element.isUndefinedOrNull())
+            continue;
+
+        if (element.isString())
+            outOfMemory = !appendToJoinRope(rope, asString(element));
+        else
+            outOfMemory = !appendToJoinRope(rope, element.toString(exec));
+
+        if (exec->hadException())
+            break;
+    }
+    arrayVisitedElements.remove(thisObj);
+
+    if (outOfMemory)
+        return throwError(exec, GeneralError, "Out of memory");
+    if (!rope->stringLength())
+        return jsEmptyString(exec);
+    return new (exec) JSString(&exec->globalData(), rope.get());
+#else
+    Vector<UChar, 256> strBuffer;
+
     for (unsigned k = 0; k < length; k++) {
         if (k >= 1)
             strBuffer.append(separator.data(), separator.size());
@@ -308,6 +360,7 @@ JSValue JSC_HOST_CALL arrayProtoFuncJoin(ExecState* exec, JSObject*, JSValue thi
     }
     arrayVisitedElements.remove(thisObj);
     return jsString(exec, UString(strBuffer.data(), strBuffer.data() ? strBuffer.size() : 0));
+#endif
 }
 
 JSValue JSC_HOST_CALL arrayProtoFuncConcat(ExecState* exec, JSObject*, JSValue thisValue, const ArgList& args)
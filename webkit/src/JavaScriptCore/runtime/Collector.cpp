@@ -34,11 +34,13 @@
 #include "JSValue.h"
 #include "MarkStack.h"
 #include "Nodes.h"
+#include "ParallelMarker.h"
 #include "Tracing.h"
 #include <algorithm>
 #include <limits.h>
 #include <setjmp.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -147,6 +149,12 @@ Heap::Heap(JSGlobalData* globalData)
 #if ENABLE(JSC_MULTIPLE_THREADS)
     , m_registeredThreads(0)
     , m_currentThreadRegistrar(0)
+#endif
+#if ENABLE(JSC_GENERATIONAL_GC)
+    , m_liveObjectsAfterFullCollection(0)
+#endif
+#if ENABLE(JSC_PARALLEL_MARKING)
+    , m_markingHelperThreads(ParallelMarker::defaultHelperThreadCount())
 #endif
     , m_globalData(globalData)
 {
@@ -174,6 +182,7 @@ Heap::Heap(JSGlobalData* globalData)
     
     memset(&primaryHeap, 0, sizeof(CollectorHeap));
     memset(&numberHeap, 0, sizeof(CollectorHeap));
+    memset(&m_collectionStatistics, 0, sizeof(CollectionStatistics));
 }
 
 Heap::~Heap()
@@ -196,6 +205,16 @@ void Heap::destroy()
     delete m_markListSet;
     m_markListSet = 0;
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+    m_parallelMarker.clear();
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // Mark bits are sticky, so old cells would otherwise survive this sweep.
+    m_rememberedCells.clear();
+    m_oldCellsWithCustomMarking.clear();
+    clearMarkBits<PrimaryHeap>();
+#endif
     sweep<PrimaryHeap>();
     // No need to sweep number heap, because the JSNumber destructor doesn't do anything.
 
@@ -428,7 +447,11 @@ collect:
 #ifndef NDEBUG
             heap.operationInProgress = NoOperation;
 #endif
+#if ENABLE(JSC_GENERATIONAL_GC)
+            bool foundGarbage = collect(collectionTypeForAllocation());
+#else
             bool foundGarbage = collect();
+#endif
             numLiveObjects = heap.numLiveObjects;
             usedBlocks = heap.usedBlocks;
             i = heap.firstBlockWithPossibleSpace;
@@ -716,6 +739,18 @@ void Heap::registerThread()
 
 #endif
 
+// Serial marking drains the mark stack after each root to keep it shallow. With
+// parallel marking the roots are only pushed, and the stack is drained once by
+// all the marking threads.
+static inline void drainAfterRoot(MarkStack& markStack)
+{
+#if ENABLE(JSC_PARALLEL_MARKING)
+    UNUSED_PARAM(markStack);
+#else
+    markStack.drain();
+#endif
+}
+
 #define IS_POINTER_ALIGNED(p) (((intptr_t)(p) & (sizeof(char*) - 1)) == 0)
 
 // cell size needs to be a power of two for this to be valid
@@ -763,7 +798,7 @@ void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
                 if ((primaryBlocks[block] == blockAddr) & (offset <= lastCellOffset)) {
                     if (reinterpret_cast<CollectorCell*>(xAsBits)->u.freeCell.zeroIfFree) {
                         markStack.append(reinterpret_cast<JSCell*>(xAsBits));
-                        markStack.drain();
+                        drainAfterRoot(markStack);
                     }
                     break;
                 }
@@ -1007,7 +1042,7 @@ void Heap::markProtectedObjects(MarkStack& markStack)
     ProtectCountSet::iterator end = m_protectedValues.end();
     for (ProtectCountSet::iterator it = m_protectedValues.begin(); it != end; ++it) {
         markStack.append(it->first);
-        markStack.drain();
+        drainAfterRoot(markStack);
     }
 }
 
@@ -1080,7 +1115,11 @@ template <HeapType heapType> size_t Heap::sweep()
         
         curBlock->usedCells = static_cast<uint32_t>(usedCells);
         curBlock->freeList = freeList;
+#if !ENABLE(JSC_GENERATIONAL_GC)
+        // With generational collection the mark bits of surviving cells are left set;
+        // they identify the old generation until the next full collection.
         curBlock->marked.clearAll();
+#endif
         
         if (!usedCells)
             ++emptyBlocks;
@@ -1113,7 +1152,93 @@ template <HeapType heapType> size_t Heap::sweep()
     return numLiveObjects;
 }
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+
+template <HeapType heapType> void Heap::clearMarkBits()
+{
+    CollectorHeap& heap = heapType == PrimaryHeap ? primaryHeap : numberHeap;
+    for (size_t block = 0; block < heap.usedBlocks; block++)
+        heap.blocks[block]->marked.clearAll();
+}
+
+void Heap::rememberCell(JSCell* cell)
+{
+    ASSERT(isCellMarked(cell));
+    ASSERT((primaryHeap.operationInProgress == NoOperation) & (numberHeap.operationInProgress == NoOperation));
+
+    // Clearing the mark bit makes the cell look young to the write barrier, so
+    // further stores into it do not record it again before the next collection.
+    cellBlock(cell)->marked.clear(cellOffset(cell));
+    m_rememberedCells.append(cell);
+    ++m_collectionStatistics.rememberedCells;
+}
+
+void Heap::markRememberedCells(MarkStack& markStack)
+{
+    size_t size = m_rememberedCells.size();
+    for (size_t i = 0; i < size; ++i) {
+        markStack.append(m_rememberedCells[i]);
+        drainAfterRoot(markStack);
+    }
+    m_rememberedCells.clear();
+}
+
+void Heap::markOldCellsWithCustomMarking(MarkStack& markStack)
+{
+    // Objects that override markChildren() may hold references outside their
+    // property storage (registers, scope chains, DOM wrappers, array vectors) which
+    // are not covered by the write barrier, so their children are always revisited.
+    // Plain objects only reach other cells through their property storage and
+    // prototype, so old ones are skipped unless the barrier remembered them.
+    // The marker records every cell with custom marking it visits, so the old
+    // ones are those recorded by the last collection, all of which are still
+    // live. A remembered one has its mark bit cleared and is visited from the
+    // remembered cells instead.
+    size_t size = m_oldCellsWithCustomMarking.size();
+    for (size_t i = 0; i < size; ++i) {
+        JSCell* cell = m_oldCellsWithCustomMarking[i];
+        if (!isCellMarked(cell))
+            continue;
+        markStack.revisit(cell);
+        drainAfterRoot(markStack);
+    }
+}
+
+CollectionType Heap::collectionTypeForAllocation() const
+{
+    // Once the old generation has grown by GROWTH_FACTOR since the last full
+    // collection, do a full collection so that garbage among old cells is reclaimed.
+    size_t oldObjects = primaryHeap.numLiveObjectsAtLastCollect + numberHeap.numLiveObjectsAtLastCollect;
+    if (oldObjects >= GROWTH_FACTOR * m_liveObjectsAfterFullCollection + ALLOCATIONS_PER_COLLECTION)
+        return FullCollection;
+    return YoungCollection;
+}
+
+#endif // ENABLE(JSC_GENERATIONAL_GC)
+
+void Heap::recordCollection(CollectionType collectionType, double pauseTime)
+{
+    if (collectionType == FullCollection)
+        ++m_collectionStatistics.fullCollections;
+    else
+        ++m_collectionStatistics.youngCollections;
+
+    m_collectionStatistics.totalPauseTime += pauseTime;
+    if (pauseTime > m_collectionStatistics.maxPauseTime)
+        m_collectionStatistics.maxPauseTime = pauseTime;
+
+    size_t bucket = 0;
+    for (double limit = 0.001; pauseTime >= limit && bucket < CollectionStatistics::pauseHistogramSize - 1; limit *= 2)
+        ++bucket;
+    ++m_collectionStatistics.pauseHistogram[bucket];
+}
+
 bool Heap::collect()
+{
+    return collect(FullCollection);
+}
+
+bool Heap::collect(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance) {
@@ -1126,12 +1251,33 @@ bool Heap::collect()
     if ((primaryHeap.operationInProgress != NoOperation) | (numberHeap.operationInProgress != NoOperation))
         CRASH();
 
+    double startTime = currentTime();
     JAVASCRIPTCORE_GC_BEGIN();
     primaryHeap.operationInProgress = Collection;
     numberHeap.operationInProgress = Collection;
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // Every cell that survived the previous collection is still marked.
+    size_t oldPrimaryObjects = primaryHeap.numLiveObjectsAtLastCollect;
+    size_t oldNumberObjects = numberHeap.numLiveObjectsAtLastCollect;
+    if (collectionType == FullCollection) {
+        m_rememberedCells.clear();
+        clearMarkBits<PrimaryHeap>();
+        clearMarkBits<NumberHeap>();
+    }
+#else
+    collectionType = FullCollection;
+#endif
+
     // MARK: first mark all referenced objects recursively starting out from the set of root objects
     MarkStack& markStack = m_globalData->markStack;
+#if ENABLE(JSC_GENERATIONAL_GC)
+    markStack.cellsWithCustomMarking().clear();
+    if (collectionType == YoungCollection) {
+        markOldCellsWithCustomMarking(markStack);
+        markRememberedCells(markStack);
+    }
+#endif
     markStackObjectsConservatively(markStack);
     markProtectedObjects(markStack);
     if (m_markListSet && m_markListSet->size())
@@ -1145,21 +1291,53 @@ bool Heap::collect()
     if (m_globalData->firstStringifierToMark)
         JSONObject::markStringifiers(markStack, m_globalData->firstStringifierToMark);
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+    if (!m_parallelMarker)
+        m_parallelMarker.set(new ParallelMarker(m_globalData->jsArrayVPtr, m_markingHelperThreads));
+    m_parallelMarker->drain(markStack);
+#else
     markStack.drain();
+#endif
     markStack.compact();
+#if ENABLE(JSC_GENERATIONAL_GC)
+    m_oldCellsWithCustomMarking.swap(markStack.cellsWithCustomMarking());
+    markStack.cellsWithCustomMarking().clear();
+#endif
     JAVASCRIPTCORE_GC_MARKED();
+    m_collectionStatistics.totalMarkTime += currentTime() - startTime;
 
     size_t originalLiveObjects = primaryHeap.numLiveObjects + numberHeap.numLiveObjects;
     size_t numLiveObjects = sweep<PrimaryHeap>();
     numLiveObjects += sweep<NumberHeap>();
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    if (collectionType == YoungCollection) {
+        // Old cells are never swept by a young collection, so whatever else is
+        // live now was allocated since the last collection.
+        m_collectionStatistics.bytesPromoted += (primaryHeap.numLiveObjects - oldPrimaryObjects) * HeapConstants<PrimaryHeap>::cellSize
+            + (numberHeap.numLiveObjects - oldNumberObjects) * HeapConstants<NumberHeap>::cellSize;
+    } else
+        m_liveObjectsAfterFullCollection = numLiveObjects;
+#endif
+
     primaryHeap.operationInProgress = NoOperation;
     numberHeap.operationInProgress = NoOperation;
     JAVASCRIPTCORE_GC_END(originalLiveObjects, numLiveObjects);
 
+    recordCollection(collectionType, currentTime() - startTime);
+
     return numLiveObjects < originalLiveObjects;
 }
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+void Heap::setMarkingHelperThreadCount(unsigned count)
+{
+    ASSERT(!isBusy());
+    m_markingHelperThreads = count;
+    m_parallelMarker.clear();
+}
+#endif
+
 size_t Heap::objectCount() 
 {
     return primaryHeap.numLiveObjects + numberHeap.numLiveObjects - m_globalData->smallStrings.count(); 
@@ -29,6 +29,7 @@
 #include <wtf/Noncopyable.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 // This is supremely lame that we require pthreads to build on windows.
 #if ENABLE(JSC_MULTIPLE_THREADS)
@@ -45,9 +46,11 @@ namespace JSC {
     class JSValue;
     class MarkedArgumentBuffer;
     class MarkStack;
+    class ParallelMarker;
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
     enum HeapType { PrimaryHeap, NumberHeap };
+    enum CollectionType { FullCollection, YoungCollection };
 
     template <HeapType> class CollectorHeapIterator;
 
@@ -88,6 +91,22 @@ namespace JSC {
         };
         Statistics statistics() const;
 
+        struct CollectionStatistics {
+            // Pause times are bucketed by powers of two milliseconds: [0, 1), [1, 2),
+            // [2, 4), ... with the last bucket collecting everything longer.
+            static const size_t pauseHistogramSize = 8;
+
+            size_t fullCollections;
+            size_t youngCollections;
+            double totalPauseTime; // in seconds
+            double maxPauseTime;
+            size_t pauseHistogram[pauseHistogramSize];
+            size_t bytesPromoted; // bytes of young cells that survived a young collection
+            size_t rememberedCells; // old cells recorded by the write barrier
+            double totalMarkTime; // in seconds, included in totalPauseTime
+        };
+        const CollectionStatistics& collectionStatistics() const { return m_collectionStatistics; }
+
         void protect(JSValue);
         void unprotect(JSValue);
 
@@ -103,6 +122,19 @@ namespace JSC {
 
         static bool isCellMarked(const JSCell*);
         static void markCell(JSCell*);
+#if ENABLE(JSC_PARALLEL_MARKING)
+        // Atomically marks the cell; returns whether it was already marked.
+        static bool testAndSetCellMarked(JSCell*);
+
+        // Number of threads marking alongside the collecting thread. Defaults to
+        // one less than the number of online cores.
+        void setMarkingHelperThreadCount(unsigned);
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC)
+        // Must be called after a reference to value is stored into owner.
+        static void writeBarrier(JSCell* owner, JSValue value);
+#endif
 
         void markConservatively(MarkStack&, void* start, void* end);
 
@@ -118,6 +150,8 @@ namespace JSC {
     private:
         template <HeapType heapType> void* heapAllocate(size_t);
         template <HeapType heapType> size_t sweep();
+        bool collect(CollectionType);
+        void recordCollection(CollectionType, double pauseTime);
         static CollectorBlock* cellBlock(const JSCell*);
         static size_t cellOffset(const JSCell*);
 
@@ -137,6 +171,27 @@ namespace JSC {
         void markOtherThreadConservatively(MarkStack&, Thread*);
         void markStackObjectsConservatively(MarkStack&);
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+        CollectionType collectionTypeForAllocation() const;
+        template <HeapType heapType> void clearMarkBits();
+        void rememberCell(JSCell*);
+        void markOldCellsWithCustomMarking(MarkStack&);
+        void markRememberedCells(MarkStack&);
+
+        // Old cells that had a young cell stored into them since the last collection.
+        // Their mark bits are cleared while they are on this list, so each is recorded once.
+        Vector<JSCell*> m_rememberedCells;
+        // The cells with their own markChildren() that survived the last collection.
+        Vector<JSCell*> m_oldCellsWithCustomMarking;
+        size_t m_liveObjectsAfterFullCollection;
+#endif
+        CollectionStatistics m_collectionStatistics;
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+        OwnPtr<ParallelMarker> m_parallelMarker;
+        unsigned m_markingHelperThreads;
+#endif
+
         typedef HashCountedSet<JSCell*> ProtectCountSet;
 
         CollectorHeap primaryHeap;
@@ -197,6 +252,22 @@ namespace JSC {
         void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
         void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
         void clearAll() { memset(bits, 0, sizeof(bits)); }
+
+        // Sets bit n and returns its previous value. Other bits of the same word
+        // may be set concurrently, as happens during parallel marking.
+        bool testAndSet(size_t n)
+        {
+            uint32_t mask = 1 << (n & 0x1F);
+#if PLATFORM(ANDROID)
+            return android_atomic_or(mask, reinterpret_cast<volatile int32_t*>(&bits[n >> 5])) & mask;
+#elif COMPILER(GCC)
+            return __sync_fetch_and_or(&bits[n >> 5], mask) & mask;
+#else
+            bool wasSet = get(n);
+            set(n);
+            return wasSet;
+#endif
+        }
     };
   
     struct CollectorCell {
@@ -282,6 +353,13 @@ namespace JSC {
         cellBlock(cell)->marked.set(cellOffset(cell));
     }
 
+#if ENABLE(JSC_PARALLEL_MARKING)
+    inline bool Heap::testAndSetCellMarked(JSCell* cell)
+    {
+        return cellBlock(cell)->marked.testAndSet(cellOffset(cell));
+    }
+#endif
+
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
         if (cost > minExtraCostSize) 
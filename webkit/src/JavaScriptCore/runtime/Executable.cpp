@@ -28,6 +28,7 @@
 
 #include "BytecodeGenerator.h"
 #include "CodeBlock.h"
+#include "CodeCache.h"
 #include "JIT.h"
 #include "Parser.h"
 #include "Vector.h"
@@ -59,6 +60,35 @@ FunctionExecutable::~FunctionExecutable()
     delete m_codeBlock;
 }
 
+static inline PassRefPtr<ProgramNode> parseProgram(ExecState* exec, const SourceCode& source, int* errLine, UString* errMsg)
+{
+    JSGlobalData* globalData = &exec->globalData();
+#if ENABLE(JSC_CODE_CACHE)
+    return globalData->codeCache->program(globalData, exec->lexicalGlobalObject()->debugger(), exec, source, errLine, errMsg);
+#else
+    return globalData->parser->parse<ProgramNode>(globalData, exec->lexicalGlobalObject()->debugger(), exec, source, errLine, errMsg);
+#endif
+}
+
+static inline PassRefPtr<FunctionBodyNode> parseFunctionBody(JSGlobalData* globalData, const SourceCode& source)
+{
+#if ENABLE(JSC_CODE_CACHE)
+    return globalData->codeCache->functionBody(globalData, source);
+#else
+    return globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, source);
+#endif
+}
+
+// Trees held by the code cache keep their data for the next load of the same source.
+static inline void destroySyntaxTreeData(ScopeNode* node)
+{
+#if ENABLE(JSC_CODE_CACHE)
+    if (CodeCache::isShared(node))
+        return;
+#endif
+    node->destroyData();
+}
+
 JSObject* EvalExecutable::compile(ExecState* exec, ScopeChainNode* scopeChainNode)
 {
     int errLine;
@@ -94,7 +124,7 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
 {
     int errLine;
     UString errMsg;
-    RefPtr<ProgramNode> programNode = exec->globalData().parser->parse<ProgramNode>(&exec->globalData(), exec->lexicalGlobalObject()->debugger(), exec, m_source, &errLine, &errMsg);
+    RefPtr<ProgramNode> programNode = parseProgram(exec, m_source, &errLine, &errMsg);
     if (!programNode)
         return Error::create(exec, SyntaxError, errMsg, errLine, m_source.provider()->asID(), m_source.provider()->url());
     recordParse(programNode->features(), programNode->lineNo(), programNode->lastLine());
@@ -107,14 +137,15 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(programNode.get(), globalObject->debugger(), scopeChain, &globalObject->symbolTable(), m_programCodeBlock));
     generator->generate();
 
-    programNode->destroyData();
+    destroySyntaxTreeData(programNode.get());
     return 0;
 }
 
 void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
 {
     JSGlobalData* globalData = scopeChainNode->globalData;
-    RefPtr<FunctionBodyNode> body = globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, m_source);
+    RefPtr<FunctionBodyNode> body = parseFunctionBody(globalData, m_source);
+    CodeFeatures parsedFeatures = body->features();
     if (m_forceUsesArguments)
         body->setUsesArguments();
     body->finishParsing(m_parameters, m_name);
@@ -131,7 +162,8 @@ void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
     ASSERT(m_numParameters);
     m_numVariables = m_codeBlock->m_numVars;
 
-    body->destroyData();
+    body->setFeatures(parsedFeatures);
+    destroySyntaxTreeData(body.get());
 }
 
 #if ENABLE(JIT)
@@ -179,7 +211,8 @@ void FunctionExecutable::markAggregate(MarkStack& markStack)
 
 ExceptionInfo* FunctionExecutable::reparseExceptionInfo(JSGlobalData* globalData, ScopeChainNode* scopeChainNode, CodeBlock* codeBlock)
 {
-    RefPtr<FunctionBodyNode> newFunctionBody = globalData->parser->parse<FunctionBodyNode>(globalData, 0, 0, m_source);
+    RefPtr<FunctionBodyNode> newFunctionBody = parseFunctionBody(globalData, m_source);
+    CodeFeatures parsedFeatures = newFunctionBody->features();
     if (m_forceUsesArguments)
         newFunctionBody->setUsesArguments();
     newFunctionBody->finishParsing(m_parameters, m_name);
@@ -202,6 +235,7 @@ ExceptionInfo* FunctionExecutable::reparseExceptionInfo(JSGlobalData* globalData
 #endif
 
     globalData->functionCodeBlockBeingReparsed = 0;
+    newFunctionBody->setFeatures(parsedFeatures);
 
     return newCodeBlock->extractExceptionInfo();
 }
@@ -170,6 +170,9 @@ namespace JSC {
 #endif
             return;
         }
+#if ENABLE(JSC_GENERATIONAL_GC)
+        m_cellsWithCustomMarking.append(cell);
+#endif
         if (cell->vptr() == m_jsArrayVPtr) {
             asArray(cell)->markChildrenDirect(*this);
             return;
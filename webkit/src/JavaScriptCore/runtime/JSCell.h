@@ -319,7 +319,12 @@ namespace JSC {
         ASSERT(cell);
         if (Heap::isCellMarked(cell))
             return;
+#if ENABLE(JSC_PARALLEL_MARKING)
+        if (Heap::testAndSetCellMarked(cell))
+            return;
+#else
         Heap::markCell(cell);
+#endif
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
@@ -331,6 +336,13 @@ namespace JSC {
             append(value.asCell());
     }
 
+    inline void MarkStack::revisit(JSCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
+        ASSERT(cell->structure()->typeInfo().type() >= CompoundType);
+        m_values.append(cell);
+    }
+
     inline Heap* Heap::heap(JSValue v)
     {
         if (!v.isCell())
@@ -343,6 +355,17 @@ namespace JSC {
         return cellBlock(c)->heap;
     }
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // Between collections a set mark bit means the cell survived a collection, so
+    // only a young cell stored into an old one needs to be remembered.
+    ALWAYS_INLINE void Heap::writeBarrier(JSCell* owner, JSValue value)
+    {
+        if (!value.isCell() || !isCellMarked(owner) || isCellMarked(value.asCell()))
+            return;
+        heap(owner)->rememberCell(owner);
+    }
+#endif
+
 } // namespace JSC
 
 #endif // JSCell_h
@@ -30,6 +30,7 @@
 #include "JSGlobalData.h"
 
 #include "ArgList.h"
+#include "CodeCache.h"
 #include "Collector.h"
 #include "CommonIdentifiers.h"
 #include "FunctionConstructor.h"
@@ -136,6 +137,9 @@ JSGlobalData::JSGlobalData(bool isShared, const VPtrSet& vptrSet)
     , emptyList(new MarkedArgumentBuffer)
     , lexer(new Lexer(this))
     , parser(new Parser)
+#if ENABLE(JSC_CODE_CACHE)
+    , codeCache(new CodeCache)
+#endif
     , interpreter(new Interpreter)
 #if ENABLE(JIT)
     , jitStubs(this)
@@ -184,6 +188,9 @@ JSGlobalData::~JSGlobalData()
     fastDelete(const_cast<HashTable*>(regExpConstructorTable));
     fastDelete(const_cast<HashTable*>(stringTable));
 
+#if ENABLE(JSC_CODE_CACHE)
+    delete codeCache;
+#endif
     delete parser;
     delete lexer;
 
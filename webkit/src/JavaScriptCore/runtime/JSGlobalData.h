@@ -48,6 +48,7 @@ struct OpaqueJSClassContextData;
 namespace JSC {
 
     class CodeBlock;
+    class CodeCache;
     class CommonIdentifiers;
     class IdentifierTable;
     class Interpreter;
@@ -125,6 +126,9 @@ namespace JSC {
 
         Lexer* lexer;
         Parser* parser;
+#if ENABLE(JSC_CODE_CACHE)
+        CodeCache* codeCache;
+#endif
         Interpreter* interpreter;
 #if ENABLE(JIT)
         JITThunks jitStubs;
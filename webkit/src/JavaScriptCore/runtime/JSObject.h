@@ -182,7 +182,13 @@ namespace JSC {
 
         // Fast access to known property offsets.
         JSValue getDirectOffset(size_t offset) const { return JSValue::decode(propertyStorage()[offset]); }
-        void putDirectOffset(size_t offset, JSValue value) { propertyStorage()[offset] = JSValue::encode(value); }
+        void putDirectOffset(size_t offset, JSValue value)
+        {
+            propertyStorage()[offset] = JSValue::encode(value);
+#if ENABLE(JSC_GENERATIONAL_GC)
+            Heap::writeBarrier(this, value);
+#endif
+        }
 
         void fillGetterPropertySlot(PropertySlot&, JSValue* location);
 
@@ -217,6 +223,9 @@ namespace JSC {
         void putAnonymousValue(unsigned index, JSValue value)
         {
             *locationForOffset(index) = value;
+#if ENABLE(JSC_GENERATIONAL_GC)
+            Heap::writeBarrier(this, value);
+#endif
         }
         JSValue getAnonymousValue(unsigned index)
         {
@@ -312,6 +321,10 @@ inline void JSObject::setStructure(NonNullPassRefPtr<Structure> structure)
 {
     m_structure->deref();
     m_structure = structure.releaseRef(); // ~JSObject balances this ref()
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // The prototype is reached through the Structure, so it is marked as a child of this object.
+    Heap::writeBarrier(this, m_structure->storedPrototype());
+#endif
 }
 
 inline Structure* JSObject::inheritorID()
@@ -30,6 +30,103 @@
 
 namespace JSC {
 
+#if ENABLE(JSC_ROPE_STRINGS)
+
+PassRefPtr<JSString::Rope> JSString::Rope::createOrNull(unsigned fiberCapacity)
+{
+    ASSERT(fiberCapacity);
+    void* allocation;
+    if (!tryFastMalloc(sizeof(Rope) + (fiberCapacity - 1) * sizeof(Fiber)).getValue(allocation))
+        return 0;
+    return adoptRef(new (allocation) Rope(fiberCapacity));
+}
+
+void JSString::Rope::destructNonRecursive()
+{
+    // Concatenating in a loop builds a rope as deep as the loop is long, so
+    // release nested ropes from a work list rather than recursively.
+    Vector<Rope*, 32> workQueue;
+    Rope* rope = this;
+    while (true) {
+        for (unsigned i = 0; i < rope->m_fiberCount; ++i) {
+            Fiber fiber = rope->m_fibers[i];
+            if (fiber.isString())
+                fiber.string()->deref();
+            else if (fiber.rope()->derefBase())
+                workQueue.append(fiber.rope());
+        }
+        rope->~Rope();
+        fastFree(rope);
+
+        if (workQueue.isEmpty())
+            return;
+        rope = workQueue.last();
+        workQueue.removeLast();
+    }
+}
+
+// Collect the leaves of a rope in order, using a work list rather than
+// recursion for the same reason as destructNonRecursive().
+static void collectRopeLeaves(JSString::Rope* root, Vector<UString::Rep*, 32>& leaves)
+{
+    Vector<JSString::Rope::Fiber, 32> workQueue;
+    workQueue.append(JSString::Rope::Fiber(root));
+    while (!workQueue.isEmpty()) {
+        JSString::Rope::Fiber fiber = workQueue.last();
+        workQueue.removeLast();
+
+        if (fiber.isRope()) {
+            JSString::Rope* rope = fiber.rope();
+            for (unsigned i = rope->fiberCount(); i--; )
+                workQueue.append(rope->fibers(i));
+        } else
+            leaves.append(fiber.string());
+    }
+}
+
+void JSString::resolveRope() const
+{
+    ASSERT(m_rope);
+
+    Vector<UString::Rep*, 32> leaves;
+    collectRopeLeaves(m_rope.get(), leaves);
+
+    // If the buffer of the leftmost leaf can grow to hold the whole
+    // string, append the other leaves to it in place: a string built with
+    // += and read between appends then stays linear instead of being
+    // copied in full every time it is flattened.
+    UString result;
+    UString::Rep* first = leaves[0];
+    if (first->reserveCapacity(first->offset + m_stringLength)) {
+        result = UString(first);
+        for (size_t i = 1; i < leaves.size() && !result.isNull(); ++i)
+            result.append(UString(leaves[i]));
+    }
+
+    // UString::append() leaves a null string when it runs out of memory.
+    // Copy into a new buffer then, so m_value never holds part of the
+    // string. Flattening happens behind a const accessor with no way to
+    // throw, so if this allocation fails too it crashes like any other
+    // fastMalloc.
+    if (result.isNull() || static_cast<unsigned>(result.size()) != m_stringLength) {
+        UChar* buffer = static_cast<UChar*>(fastMalloc(m_stringLength * sizeof(UChar)));
+        UChar* position = buffer;
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            memcpy(position, leaves[i]->data(), leaves[i]->size() * sizeof(UChar));
+            position += leaves[i]->size();
+        }
+        ASSERT(position == buffer + m_stringLength);
+        result = UString::Rep::create(buffer, m_stringLength);
+    }
+    ASSERT(static_cast<unsigned>(result.size()) == m_stringLength);
+
+    m_value = result;
+    m_rope.clear();
+    Heap::heap(this)->reportExtraMemoryCost(m_value.cost());
+}
+
+#endif // ENABLE(JSC_ROPE_STRINGS)
+
 JSValue JSString::toPrimitive(ExecState*, PreferredPrimitiveType) const
 {
     return const_cast<JSString*>(this);
@@ -38,28 +135,28 @@ JSValue JSString::toPrimitive(ExecState*, PreferredPrimitiveType) const
 bool JSString::getPrimitiveNumber(ExecState*, double& number, JSValue& value)
 {
     value = this;
-    number = m_value.toDouble();
+    number = this->value().toDouble();
     return false;
 }
 
 bool JSString::toBoolean(ExecState*) const
 {
-    return !m_value.isEmpty();
+    return m_stringLength;
 }
 
 double JSString::toNumber(ExecState*) const
 {
-    return m_value.toDouble();
+    return value().toDouble();
 }
 
 UString JSString::toString(ExecState*) const
 {
-    return m_value;
+    return value();
 }
 
 UString JSString::toThisString(ExecState*) const
 {
-    return m_value;
+    return value();
 }
 
 JSString* JSString::toThisJSString(ExecState*)
@@ -106,14 +203,14 @@ bool JSString::getOwnPropertySlot(ExecState* exec, const Identifier& propertyNam
 bool JSString::getStringPropertyDescriptor(ExecState* exec, const Identifier& propertyName, PropertyDescriptor& descriptor)
 {
     if (propertyName == exec->propertyNames().length) {
-        descriptor.setDescriptor(jsNumber(exec, m_value.size()), DontEnum | DontDelete | ReadOnly);
+        descriptor.setDescriptor(jsNumber(exec, m_stringLength), DontEnum | DontDelete | ReadOnly);
         return true;
     }
     
     bool isStrictUInt32;
     unsigned i = propertyName.toStrictUInt32(&isStrictUInt32);
-    if (isStrictUInt32 && i < static_cast<unsigned>(m_value.size())) {
-        descriptor.setDescriptor(jsSingleCharacterSubstring(exec, m_value, i), DontDelete | ReadOnly);
+    if (isStrictUInt32 && i < m_stringLength) {
+        descriptor.setDescriptor(jsSingleCharacterSubstring(exec, value(), i), DontDelete | ReadOnly);
         return true;
     }
     
@@ -29,6 +29,7 @@
 #include "JSNumberCell.h"
 #include "PropertyDescriptor.h"
 #include "PropertySlot.h"
+#include <wtf/RefCounted.h>
 
 namespace JSC {
 
@@ -64,9 +65,93 @@ namespace JSC {
         friend struct VPtrSet;
 
     public:
+#if ENABLE(JSC_ROPE_STRINGS)
+        // A rope is the lazy concatenation of its fibers, each of which is a
+        // flat string or another rope. A JSString holding a rope flattens it
+        // the first time its characters are needed. Ropes hold no references
+        // to cells, so the collector does not need to know about them.
+        class Rope : public WTF::RefCountedBase {
+        public:
+            class Fiber {
+            public:
+                Fiber() : m_value(0) { }
+                Fiber(UString::Rep* string) : m_value(reinterpret_cast<intptr_t>(string)) { }
+                Fiber(Rope* rope) : m_value(reinterpret_cast<intptr_t>(rope) | 1) { }
+
+                bool isRope() const { return m_value & 1; }
+                bool isString() const { return !isRope(); }
+                Rope* rope() const { ASSERT(isRope()); return reinterpret_cast<Rope*>(m_value & ~1); }
+                UString::Rep* string() const { ASSERT(isString()); return reinterpret_cast<UString::Rep*>(m_value); }
+                unsigned length() const { return isRope() ? rope()->stringLength() : string()->size(); }
+
+            private:
+                intptr_t m_value;
+            };
+
+            // Returns 0 if the allocation fails.
+            static PassRefPtr<Rope> createOrNull(unsigned fiberCapacity);
+
+            void deref()
+            {
+                if (derefBase())
+                    destructNonRecursive();
+            }
+
+            // Empty fibers are dropped. The caller checks that the total
+            // length stays within JSString::maxLength.
+            void append(Fiber fiber)
+            {
+                ASSERT(!isFull());
+                unsigned length = fiber.length();
+                if (!length)
+                    return;
+                if (fiber.isRope())
+                    fiber.rope()->ref();
+                else
+                    fiber.string()->ref();
+                m_fibers[m_fiberCount++] = fiber;
+                m_stringLength += length;
+            }
+            void append(const UString& string) { append(Fiber(string.rep())); }
+            inline void append(JSString*);
+
+            unsigned fiberCount() const { return m_fiberCount; }
+            unsigned fiberCapacity() const { return m_fiberCapacity; }
+            bool isFull() const { return m_fiberCount == m_fiberCapacity; }
+            Fiber fibers(unsigned index) const { ASSERT(index < m_fiberCount); return m_fibers[index]; }
+            unsigned stringLength() const { return m_stringLength; }
+
+        private:
+            Rope(unsigned fiberCapacity)
+                : m_fiberCount(0)
+                , m_fiberCapacity(fiberCapacity)
+                , m_stringLength(0)
+            {
+            }
+
+            void destructNonRecursive();
+
+            unsigned m_fiberCount;
+            unsigned m_fiberCapacity;
+            unsigned m_stringLength;
+            Fiber m_fibers[1];
+        };
+#endif
+
+        // UString lengths are ints.
+        static const unsigned maxLength = 0x7fffffff;
+#if ENABLE(JSC_ROPE_STRINGS)
+        // Flat strings shorter than this are concatenated onto by copying:
+        // a rope costs an allocation of its own and a second copy to flatten.
+        // From this length on UString can append in place, which is cheaper
+        // still, so ropes are only built when it cannot.
+        static const unsigned minRopeLength = minShareSize;
+#endif
+
         JSString(JSGlobalData* globalData, const UString& value)
             : JSCell(globalData->stringStructure.get())
             , m_value(value)
+            , m_stringLength(value.size())
         {
             Heap::heap(this)->reportExtraMemoryCost(value.cost());
         }
@@ -75,21 +160,45 @@ namespace JSC {
         JSString(JSGlobalData* globalData, const UString& value, HasOtherOwnerType)
             : JSCell(globalData->stringStructure.get())
             , m_value(value)
+            , m_stringLength(value.size())
         {
         }
         JSString(JSGlobalData* globalData, PassRefPtr<UString::Rep> value, HasOtherOwnerType)
             : JSCell(globalData->stringStructure.get())
             , m_value(value)
+            , m_stringLength(m_value.size())
         {
         }
-        
-        const UString& value() const { return m_value; }
+
+#if ENABLE(JSC_ROPE_STRINGS)
+        JSString(JSGlobalData* globalData, Rope* rope)
+            : JSCell(globalData->stringStructure.get())
+            , m_stringLength(rope->stringLength())
+            , m_rope(rope)
+        {
+            ASSERT(m_stringLength);
+        }
+
+        bool isRope() const { return m_rope; }
+#endif
+
+        const UString& value() const
+        {
+#if ENABLE(JSC_ROPE_STRINGS)
+            if (m_rope)
+                resolveRope();
+#endif
+            return m_value;
+        }
+
+        // Does not flatten a rope.
+        unsigned length() const { return m_stringLength; }
 
         bool getStringPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
         bool getStringPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
         bool getStringPropertyDescriptor(ExecState*, const Identifier& propertyName, PropertyDescriptor&);
 
-        bool canGetIndex(unsigned i) { return i < static_cast<unsigned>(m_value.size()); }
+        bool canGetIndex(unsigned i) { return i < m_stringLength; }
         JSString* getIndex(JSGlobalData*, unsigned);
 
         static PassRefPtr<Structure> createStructure(JSValue proto) { return Structure::create(proto, TypeInfo(StringType, OverridesGetOwnPropertySlot | NeedsThisConversion)); }
@@ -117,9 +226,27 @@ namespace JSC {
         virtual bool getOwnPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
         virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
 
-        UString m_value;
+#if ENABLE(JSC_ROPE_STRINGS)
+        void resolveRope() const;
+#endif
+
+        mutable UString m_value;
+        unsigned m_stringLength;
+#if ENABLE(JSC_ROPE_STRINGS)
+        mutable RefPtr<Rope> m_rope;
+#endif
     };
 
+#if ENABLE(JSC_ROPE_STRINGS)
+    inline void JSString::Rope::append(JSString* string)
+    {
+        if (string->m_rope)
+            append(Fiber(string->m_rope.get()));
+        else
+            append(string->m_value);
+    }
+#endif
+
     JSString* asString(JSValue);
 
     inline JSString* asString(JSValue value)
@@ -166,7 +293,7 @@ namespace JSC {
     inline JSString* JSString::getIndex(JSGlobalData* globalData, unsigned i)
     {
         ASSERT(canGetIndex(i));
-        return jsSingleCharacterSubstring(globalData, m_value, i);
+        return jsSingleCharacterSubstring(globalData, value(), i);
     }
 
     inline JSString* jsString(JSGlobalData* globalData, const UString& s)
@@ -222,14 +349,14 @@ namespace JSC {
     ALWAYS_INLINE bool JSString::getStringPropertySlot(ExecState* exec, const Identifier& propertyName, PropertySlot& slot)
     {
         if (propertyName == exec->propertyNames().length) {
-            slot.setValue(jsNumber(exec, m_value.size()));
+            slot.setValue(jsNumber(exec, m_stringLength));
             return true;
         }
 
         bool isStrictUInt32;
         unsigned i = propertyName.toStrictUInt32(&isStrictUInt32);
-        if (isStrictUInt32 && i < static_cast<unsigned>(m_value.size())) {
-            slot.setValue(jsSingleCharacterSubstring(exec, m_value, i));
+        if (isStrictUInt32 && i < m_stringLength) {
+            slot.setValue(jsSingleCharacterSubstring(exec, value(), i));
             return true;
         }
 
@@ -238,8 +365,8 @@ namespace JSC {
         
     ALWAYS_INLINE bool JSString::getStringPropertySlot(ExecState* exec, unsigned propertyName, PropertySlot& slot)
     {
-        if (propertyName < static_cast<unsigned>(m_value.size())) {
-            slot.setValue(jsSingleCharacterSubstring(exec, m_value, propertyName));
+        if (propertyName < m_stringLength) {
+            slot.setValue(jsSingleCharacterSubstring(exec, value(), propertyName));
             return true;
         }
 
@@ -28,10 +28,12 @@
 
 #include "JSValue.h"
 #include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
 
 namespace JSC {
 
     class JSGlobalData;
+    class ParallelMarker;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -48,6 +50,8 @@ namespace JSC {
 
         ALWAYS_INLINE void append(JSValue);
         void append(JSCell*);
+        // Queues the children of a cell that is already marked.
+        void revisit(JSCell*);
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -63,6 +67,12 @@ namespace JSC {
         inline void drain();
         void compact();
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+        // The cells with their own markChildren() visited since this was
+        // last cleared; see Heap::markOldCellsWithCustomMarking().
+        Vector<JSCell*>& cellsWithCustomMarking() { return m_cellsWithCustomMarking; }
+#endif
+
         ~MarkStack()
         {
             ASSERT(m_markSets.isEmpty());
@@ -70,6 +80,8 @@ namespace JSC {
         }
 
     private:
+        friend class ParallelMarker;
+
         void markChildren(JSCell*);
 
         struct MarkSet {
@@ -176,6 +188,9 @@ namespace JSC {
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
+#if ENABLE(JSC_GENERATIONAL_GC)
+        Vector<JSCell*> m_cellsWithCustomMarking;
+#endif
 
 #ifndef NDEBUG
     public:
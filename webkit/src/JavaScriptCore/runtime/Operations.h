@@ -193,6 +193,42 @@ namespace JSC {
     //    13962   Add case: 5 3
     //    4000    Add case: 3 5
 
+#if ENABLE(JSC_ROPE_STRINGS)
+    // Whether concatenate() can copy a string of the given length onto the
+    // end of a's buffer in place, which is cheaper than building a rope.
+    inline bool canAppendInPlace(UString::Rep* a, unsigned length)
+    {
+        UString::BaseString* base = a->baseString();
+        return a->offset + a->len == base->usedCapacity && a->len >= minShareSize
+            && 4 * static_cast<unsigned>(a->len) >= length && !base->isBufferReadOnly();
+    }
+
+    ALWAYS_INLINE JSValue jsString(ExecState* exec, JSString* s1, JSString* s2)
+    {
+        if (!s1->length())
+            return s2;
+        if (!s2->length())
+            return s1;
+        unsigned length = s1->length() + s2->length();
+        if (length > JSString::maxLength)
+            return throwOutOfMemoryError(exec);
+
+        if (!s1->isRope() && !s2->isRope() && (s1->length() < JSString::minRopeLength || canAppendInPlace(s1->value().rep(), s2->length()))) {
+            RefPtr<UString::Rep> value = concatenate(s1->value().rep(), s2->value().rep());
+            if (!value)
+                return throwOutOfMemoryError(exec);
+            return jsString(exec, value.release());
+        }
+
+        RefPtr<JSString::Rope> rope = JSString::Rope::createOrNull(2);
+        if (UNLIKELY(!rope))
+            return throwOutOfMemoryError(exec);
+        rope->append(s1);
+        rope->append(s2);
+        return new (exec) JSString(&exec->globalData(), rope.get());
+    }
+#endif
+
     ALWAYS_INLINE JSValue jsAdd(CallFrame* callFrame, JSValue v1, JSValue v2)
     {
         double left;
@@ -204,10 +240,14 @@ namespace JSC {
         
         bool leftIsString = v1.isString();
         if (leftIsString && v2.isString()) {
+#if ENABLE(JSC_ROPE_STRINGS)
+            return jsString(callFrame, asString(v1), asString(v2));
+#else
             RefPtr<UString::Rep> value = concatenate(asString(v1)->value().rep(), asString(v2)->value().rep());
             if (!value)
                 return throwOutOfMemoryError(callFrame);
             return jsString(callFrame, value.release());
+#endif
         }
 
         if (rightIsNumber & leftIsString) {
@@ -294,6 +334,29 @@ namespace JSC {
         return JSValue();
     }
 
+#if ENABLE(JSC_ROPE_STRINGS)
+    ALWAYS_INLINE JSValue concatenateStringsIntoRope(CallFrame* callFrame, Register* strings, unsigned count)
+    {
+        RefPtr<JSString::Rope> rope = JSString::Rope::createOrNull(count);
+        if (UNLIKELY(!rope))
+            return throwOutOfMemoryError(callFrame);
+
+        for (unsigned i = 0; i < count; ++i) {
+            JSValue v = strings[i].jsValue();
+            if (LIKELY(v.isString()))
+                rope->append(asString(v));
+            else
+                rope->append(v.toString(callFrame));
+            if (rope->stringLength() > JSString::maxLength)
+                return throwOutOfMemoryError(callFrame);
+        }
+
+        if (!rope->stringLength())
+            return jsEmptyString(callFrame);
+        return new (callFrame) JSString(&callFrame->globalData(), rope.get());
+    }
+#endif
+
     ALWAYS_INLINE JSValue concatenateStrings(CallFrame* callFrame, Register* strings, unsigned count)
     {
         ASSERT(count >= 3);
@@ -308,11 +371,24 @@ namespace JSC {
         for (unsigned i = 0; i < count; ++i) {
             JSValue v = strings[i].jsValue();
             if (LIKELY(v.isString()))
-                bufferSize += asString(v)->value().size();
+                bufferSize += asString(v)->length();
             else
                 bufferSize += 11;
         }
 
+#if ENABLE(JSC_ROPE_STRINGS)
+        // Build a rope unless the result is short or the first string is
+        // flat and either short or can be appended to in place.
+        JSValue first = strings[0].jsValue();
+        if (first.isString()) {
+            JSString* firstString = asString(first);
+            if (firstString->isRope() || (firstString->length() >= JSString::minRopeLength
+                    && !canAppendInPlace(firstString->value().rep(), bufferSize - firstString->length())))
+                return concatenateStringsIntoRope(callFrame, strings, count);
+        } else if (bufferSize >= JSString::minRopeLength)
+            return concatenateStringsIntoRope(callFrame, strings, count);
+#endif
+
         // Allocate an output string to store the result.
         // If the first argument is a String, and if it has the capacity (or can grow
         // its capacity) to hold the entire result then use this as a base to concatenate
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ParallelMarker.h"
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+
+#include "JSArray.h"
+#include "JSCell.h"
+#include <unistd.h>
+
+namespace JSC {
+
+// Cells a thread visits between checks for whether it should donate work.
+static const unsigned donationInterval = 32;
+// A thread keeps at least this many cells before it gives any away.
+static const size_t minimumCellsToDonate = 16;
+// Mark sets larger than this are split when other threads have nothing to do.
+static const size_t markSetSplitSize = 512;
+// Cells taken from the shared pool at a time.
+static const size_t cellsPerSteal = 64;
+// A helper hands deferred cells to the main thread once it has this many.
+static const size_t deferredCellsFlushSize = 64;
+static const unsigned maximumHelperThreads = 3;
+
+ParallelMarker::ParallelMarker(void* jsArrayVPtr, unsigned helperThreads)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_activeThreads(0)
+    , m_isMarking(false)
+    , m_shouldExit(false)
+    , m_sharedWorkSize(0)
+{
+    for (unsigned i = 0; i < helperThreads; ++i) {
+        ThreadIdentifier thread = createThread(helperThreadEntry, this, "JavaScriptCore::Marking");
+        if (!thread)
+            break;
+        m_helperThreads.append(thread);
+    }
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    {
+        MutexLocker locker(m_lock);
+        ASSERT(!m_isMarking);
+        m_shouldExit = true;
+        m_condition.broadcast();
+    }
+    for (size_t i = 0; i < m_helperThreads.size(); ++i)
+        waitForThreadCompletion(m_helperThreads[i], 0);
+}
+
+unsigned ParallelMarker::defaultHelperThreadCount()
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores <= 1)
+        return 0;
+    return std::min(static_cast<unsigned>(cores - 1), maximumHelperThreads);
+}
+
+void* ParallelMarker::helperThreadEntry(void* marker)
+{
+    static_cast<ParallelMarker*>(marker)->helperThreadMain();
+    return 0;
+}
+
+void ParallelMarker::helperThreadMain()
+{
+    MarkStack markStack(m_jsArrayVPtr);
+    Vector<JSCell*> deferredCells;
+
+    MutexLocker locker(m_lock);
+    while (true) {
+        while (!m_shouldExit && !(m_isMarking && hasSharedWork()))
+            m_condition.wait(m_lock);
+        if (m_shouldExit)
+            break;
+
+        ++m_activeThreads;
+        takeSharedWork(markStack);
+
+        m_lock.unlock();
+        drainLocal(markStack, &deferredCells);
+        markStack.compact();
+        m_lock.lock();
+
+        if (!deferredCells.isEmpty()) {
+            m_mainThreadCells.append(deferredCells.data(), deferredCells.size());
+            deferredCells.clear();
+        }
+#if ENABLE(JSC_GENERATIONAL_GC)
+        Vector<JSCell*>& cellsWithCustomMarking = markStack.cellsWithCustomMarking();
+        if (!cellsWithCustomMarking.isEmpty()) {
+            m_helperCellsWithCustomMarking.append(cellsWithCustomMarking.data(), cellsWithCustomMarking.size());
+            cellsWithCustomMarking.clear();
+        }
+#endif
+        // The main thread waits for either cells it has to visit itself or for
+        // every thread to run out of work.
+        if (!--m_activeThreads || !m_mainThreadCells.isEmpty())
+            m_condition.broadcast();
+    }
+}
+
+void ParallelMarker::drain(MarkStack& markStack)
+{
+    if (m_helperThreads.isEmpty()) {
+        markStack.drain();
+        return;
+    }
+
+    {
+        MutexLocker locker(m_lock);
+        ASSERT(!m_isMarking && !m_activeThreads);
+        m_isMarking = true;
+        m_activeThreads = 1;
+    }
+    // Share the roots right away so the helpers do not wait for the first donation.
+    donate(markStack);
+
+    while (true) {
+        drainLocal(markStack, 0);
+
+        MutexLocker locker(m_lock);
+        --m_activeThreads;
+        while (m_mainThreadCells.isEmpty() && !hasSharedWork()) {
+            if (!m_activeThreads) {
+                m_isMarking = false;
+#if ENABLE(JSC_GENERATIONAL_GC)
+                markStack.cellsWithCustomMarking().append(m_helperCellsWithCustomMarking.data(), m_helperCellsWithCustomMarking.size());
+                m_helperCellsWithCustomMarking.clear();
+#endif
+                return;
+            }
+            m_condition.wait(m_lock);
+        }
+        ++m_activeThreads;
+
+        for (size_t i = 0; i < m_mainThreadCells.size(); ++i)
+            markStack.m_values.append(m_mainThreadCells[i]);
+        m_mainThreadCells.clear();
+        takeSharedWork(markStack);
+    }
+}
+
+void ParallelMarker::drainLocal(MarkStack& markStack, Vector<JSCell*>* deferredCells)
+{
+    unsigned cellsSinceDonationCheck = 0;
+    while (true) {
+        if (!markStack.m_markSets.isEmpty()) {
+            MarkSet current = markStack.m_markSets.removeLast();
+            JSValue* values = current.m_values;
+            JSValue* end = current.m_end;
+            if (static_cast<size_t>(end - values) > markSetSplitSize && !m_sharedWorkSize) {
+                JSValue* middle = values + (end - values) / 2;
+                shareMarkSet(MarkSet(middle, end, current.m_properties));
+                end = middle;
+            }
+            for (; values != end; ++values) {
+                JSValue value = *values;
+                if (!value || !value.isCell())
+                    continue;
+                JSCell* cell = value.asCell();
+                if (Heap::isCellMarked(cell) || Heap::testAndSetCellMarked(cell))
+                    continue;
+                if (cell->structure()->typeInfo().type() >= CompoundType)
+                    markStack.m_values.append(cell);
+            }
+            continue;
+        }
+
+        if (markStack.m_values.isEmpty())
+            break;
+
+        JSCell* cell = markStack.m_values.removeLast();
+        if (deferredCells && cell->structure()->typeInfo().overridesMarkChildren() && cell->vptr() != m_jsArrayVPtr) {
+            deferredCells->append(cell);
+            if (deferredCells->size() >= deferredCellsFlushSize) {
+                MutexLocker locker(m_lock);
+                m_mainThreadCells.append(deferredCells->data(), deferredCells->size());
+                m_condition.broadcast();
+                deferredCells->clear();
+            }
+            continue;
+        }
+        markStack.markChildren(cell);
+
+        if (++cellsSinceDonationCheck == donationInterval) {
+            cellsSinceDonationCheck = 0;
+            if (!m_sharedWorkSize && markStack.m_values.size() >= 2 * minimumCellsToDonate)
+                donate(markStack);
+        }
+    }
+}
+
+void ParallelMarker::donate(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    size_t cellsToDonate = markStack.m_values.size() / 2;
+    for (size_t i = 0; i < cellsToDonate; ++i)
+        m_sharedCells.append(markStack.m_values.removeLast());
+    size_t markSetsToDonate = markStack.m_markSets.size() / 2;
+    for (size_t i = 0; i < markSetsToDonate; ++i)
+        m_sharedMarkSets.append(markStack.m_markSets.removeLast());
+    updateSharedWorkSize();
+    if (cellsToDonate || markSetsToDonate)
+        m_condition.broadcast();
+}
+
+void ParallelMarker::shareMarkSet(const MarkSet& markSet)
+{
+    MutexLocker locker(m_lock);
+    m_sharedMarkSets.append(markSet);
+    updateSharedWorkSize();
+    m_condition.broadcast();
+}
+
+// Must be called with m_lock held.
+bool ParallelMarker::takeSharedWork(MarkStack& markStack)
+{
+    bool tookWork = false;
+    if (!m_sharedMarkSets.isEmpty()) {
+        markStack.m_markSets.append(m_sharedMarkSets.last());
+        m_sharedMarkSets.removeLast();
+        tookWork = true;
+    }
+    size_t cells = std::min(m_sharedCells.size(), cellsPerSteal);
+    for (size_t i = 0; i < cells; ++i) {
+        markStack.m_values.append(m_sharedCells.last());
+        m_sharedCells.removeLast();
+    }
+    updateSharedWorkSize();
+    return tookWork || cells;
+}
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_PARALLEL_MARKING)
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ParallelMarker_h
+#define ParallelMarker_h
+
+#if ENABLE(JSC_PARALLEL_MARKING)
+
+#include "MarkStack.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class JSCell;
+
+    // Drains a MarkStack with the help of worker threads. Every thread marks
+    // from its own MarkStack; a thread with a deep stack donates half of it to a
+    // shared pool, and idle threads take their work from that pool. Mark bits
+    // are set with an atomic test-and-set so a cell is only visited once.
+    //
+    // Helper threads only visit cells that the MarkStack can mark inline (plain
+    // objects and arrays). Cells with their own markChildren() implementation,
+    // which includes all the WebCore wrappers, are handed back to the thread
+    // that started the collection.
+    class ParallelMarker : public Noncopyable {
+    public:
+        // helperThreads is the number of threads marking alongside the caller of drain().
+        ParallelMarker(void* jsArrayVPtr, unsigned helperThreads);
+        ~ParallelMarker();
+
+        static unsigned defaultHelperThreadCount();
+
+        unsigned helperThreadCount() const { return m_helperThreads.size(); }
+
+        void drain(MarkStack&);
+
+    private:
+        typedef MarkStack::MarkSet MarkSet;
+
+        static void* helperThreadEntry(void*);
+        void helperThreadMain();
+
+        // deferredCells is 0 on the main thread, which visits every kind of cell.
+        void drainLocal(MarkStack&, Vector<JSCell*>* deferredCells);
+        void donate(MarkStack&);
+        void shareMarkSet(const MarkSet&);
+        bool takeSharedWork(MarkStack&);
+        bool hasSharedWork() const { return !m_sharedCells.isEmpty() || !m_sharedMarkSets.isEmpty(); }
+        void updateSharedWorkSize() { m_sharedWorkSize = m_sharedCells.size() + m_sharedMarkSets.size(); }
+
+        void* m_jsArrayVPtr;
+        Vector<ThreadIdentifier> m_helperThreads;
+
+        Mutex m_lock;
+        ThreadCondition m_condition;
+        Vector<JSCell*> m_sharedCells;
+        Vector<MarkSet> m_sharedMarkSets;
+        // Cells needing a virtual markChildren() call, which only the main thread makes.
+        Vector<JSCell*> m_mainThreadCells;
+#if ENABLE(JSC_GENERATIONAL_GC)
+        // Arrays visited by the helpers, for MarkStack::cellsWithCustomMarking().
+        Vector<JSCell*> m_helperCellsWithCustomMarking;
+#endif
+        unsigned m_activeThreads;
+        bool m_isMarking;
+        bool m_shouldExit;
+        // Read without the lock as a hint for when donating is worthwhile.
+        volatile size_t m_sharedWorkSize;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(JSC_PARALLEL_MARKING)
+
+#endif // ParallelMarker_h
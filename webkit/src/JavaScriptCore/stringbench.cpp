@@ -0,0 +1,168 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// String building micro-benchmark. Runs the concatenation patterns found in
+// page scripts (+= loops, markup templates, Array.prototype.join, divide and
+// conquer) and prints the best time of each together with a checksum of the
+// string it built. The checksums must not depend on the string
+// representation, so builds with and without JSC_ROPE_STRINGS can be
+// compared directly.
+//
+// Usage: string_bench [-n scale] [-r runs]
+
+#include "config.h"
+
+#include "Completion.h"
+#include "CurrentTime.h"
+#include "InitializeThreading.h"
+#include "JSGlobalData.h"
+#include "JSGlobalObject.h"
+#include "JSLock.h"
+#include "SourceCode.h"
+#include "UString.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace JSC;
+using namespace WTF;
+
+class GlobalObject : public JSGlobalObject {
+public:
+    virtual UString className() const { return "global"; }
+};
+
+static const char* workloadScript =
+    "function checksum(s) {\n"
+    "    var sum = s.length;\n"
+    "    var step = Math.max(1, Math.floor(s.length / 997));\n"
+    "    for (var i = 0; i < s.length; i += step)\n"
+    "        sum = (sum * 31 + s.charCodeAt(i)) % 1000000007;\n"
+    "    return sum;\n"
+    "}\n"
+    "function appendLoop(n) {\n"
+    "    var s = '';\n"
+    "    for (var i = 0; i < n; i++)\n"
+    "        s += 'item ' + i + ', ';\n"
+    "    return checksum(s);\n"
+    "}\n"
+    "function appendAndRead(n) {\n"
+    "    var s = '';\n"
+    "    var sum = 0;\n"
+    "    for (var i = 0; i < n; i++) {\n"
+    "        s += String.fromCharCode(97 + i % 26);\n"
+    "        sum += s.charCodeAt(s.length - 1);\n"
+    "    }\n"
+    "    return (checksum(s) + sum) % 1000000007;\n"
+    "}\n"
+    "function markup(n) {\n"
+    "    var html = '';\n"
+    "    for (var i = 0; i < n; i++)\n"
+    "        html += '<li class=\"' + (i % 2 ? 'odd' : 'even') + '\" id=\"row' + i + '\"><a href=\"/item/' + i + '\">Item ' + i + '</a></li>';\n"
+    "    return checksum('<ul>' + html + '</ul>');\n"
+    "}\n"
+    "function join(n) {\n"
+    "    var parts = [];\n"
+    "    for (var i = 0; i < n; i++)\n"
+    "        parts.push('<td>' + i + '</td>');\n"
+    "    return checksum('<tr>' + parts.join('') + '</tr>') + checksum(parts.join(', '));\n"
+    "}\n"
+    "function build(from, to) {\n"
+    "    if (to - from < 4)\n"
+    "        return 'n' + from + ';';\n"
+    "    var middle = (from + to) >> 1;\n"
+    "    return '(' + build(from, middle) + build(middle, to) + ')';\n"
+    "}\n"
+    "function divideAndConquer(n) {\n"
+    "    return checksum(build(0, n));\n"
+    "}\n";
+
+static const char* workloads[] = { "appendLoop", "appendAndRead", "markup", "join", "divideAndConquer" };
+
+int main(int argc, char** argv)
+{
+    int scale = 20000;
+    int runs = 5;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            scale = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            runs = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: string_bench [-n scale] [-r runs]\n");
+            return 1;
+        }
+    }
+    if (scale <= 0 || runs <= 0) {
+        fprintf(stderr, "Usage: string_bench [-n scale] [-r runs]\n");
+        return 1;
+    }
+
+    JSC::initializeThreading();
+    RefPtr<JSGlobalData> globalData = JSGlobalData::create();
+    JSLock lock(SilenceAssertionsOnly);
+
+    GlobalObject* globalObject = new (globalData.get()) GlobalObject;
+    globalData->heap.protect(globalObject);
+    ExecState* exec = globalObject->globalExec();
+    Completion completion = evaluate(exec, globalObject->globalScopeChain(), makeSource(workloadScript, "string_bench"));
+    if (completion.complType() == Throw) {
+        fprintf(stderr, "string_bench: loading the workloads threw %s\n", completion.value().toString(exec).UTF8String().c_str());
+        return 1;
+    }
+
+#if ENABLE(JSC_ROPE_STRINGS)
+    printf("string_bench: ropes on, scale %d, best of %d runs\n", scale, runs);
+#else
+    printf("string_bench: ropes off, scale %d, best of %d runs\n", scale, runs);
+#endif
+    printf("%-18s %10s %12s\n", "workload", "ms", "checksum");
+
+    double total = 0;
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); ++i) {
+        char call[64];
+        snprintf(call, sizeof(call), "%s(%d);", workloads[i], scale);
+        double best = 0;
+        UString result;
+        for (int run = 0; run < runs; ++run) {
+            double start = currentTime();
+            completion = evaluate(exec, globalObject->globalScopeChain(), makeSource(call, "string_bench"));
+            double elapsed = currentTime() - start;
+            if (completion.complType() == Throw) {
+                fprintf(stderr, "string_bench: %s threw %s\n", workloads[i], completion.value().toString(exec).UTF8String().c_str());
+                return 1;
+            }
+            result = completion.value().toString(exec);
+            if (!run || elapsed < best)
+                best = elapsed;
+        }
+        total += best;
+        printf("%-18s %10.2f %12s\n", workloads[i], best * 1000, result.UTF8String().c_str());
+    }
+    printf("%-18s %10.2f\n", "total", total * 1000);
+
+    globalData->heap.destroy();
+    return 0;
+}
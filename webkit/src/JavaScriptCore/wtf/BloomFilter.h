@@ -0,0 +1,89 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BloomFilter_h
+#define BloomFilter_h
+
+#include <string.h>
+#include <wtf/Assertions.h>
+#include <wtf/Noncopyable.h>
+
+namespace WTF {
+
+    // Counting bloom filter over 32-bit hashes, with two probes taken from
+    // the low and high halves of the hash. Keys can be removed again, which
+    // makes it usable as a filter for a stack of sets. mayContain() never
+    // returns false for a key that was added and not yet removed. A counter
+    // that saturates is never decremented again, so it only costs precision.
+    template <unsigned keyBits>
+    class BloomFilter : public Noncopyable {
+    public:
+        static const size_t tableSize = 1 << keyBits;
+        static const unsigned keyMask = (1 << keyBits) - 1;
+        static const unsigned char maximumCount = 0xff;
+
+        BloomFilter() { clear(); }
+
+        void add(unsigned hash)
+        {
+            unsigned char& first = firstSlot(hash);
+            unsigned char& second = secondSlot(hash);
+            if (first < maximumCount)
+                ++first;
+            if (second < maximumCount)
+                ++second;
+        }
+
+        // The hash must have been added before.
+        void remove(unsigned hash)
+        {
+            unsigned char& first = firstSlot(hash);
+            unsigned char& second = secondSlot(hash);
+            ASSERT(first);
+            ASSERT(second);
+            if (first < maximumCount)
+                --first;
+            if (second < maximumCount)
+                --second;
+        }
+
+        bool mayContain(unsigned hash) const { return firstSlot(hash) && secondSlot(hash); }
+
+        void clear() { memset(m_table, 0, sizeof(m_table)); }
+
+    private:
+        unsigned char& firstSlot(unsigned hash) { return m_table[hash & keyMask]; }
+        unsigned char& secondSlot(unsigned hash) { return m_table[(hash >> 16) & keyMask]; }
+        const unsigned char& firstSlot(unsigned hash) const { return m_table[hash & keyMask]; }
+        const unsigned char& secondSlot(unsigned hash) const { return m_table[(hash >> 16) & keyMask]; }
+
+        unsigned char m_table[tableSize];
+    };
+
+} // namespace WTF
+
+using WTF::BloomFilter;
+
+#endif // BloomFilter_h
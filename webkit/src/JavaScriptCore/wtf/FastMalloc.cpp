@@ -103,6 +103,13 @@
 #define USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY 1
 #endif
 
+// Count allocations per size class for fastMallocAllocationStatistics().
+#if PLATFORM(ANDROID)
+#define FAST_MALLOC_ALLOCATION_STATISTICS 1
+#else
+#define FAST_MALLOC_ALLOCATION_STATISTICS 0
+#endif
+
 #ifndef NDEBUG
 namespace WTF {
 
@@ -347,6 +354,11 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+void fastMallocAllocationStatistics(FastMallocAllocationStatistics& statistics)
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
 } // namespace WTF
 
 #if PLATFORM(DARWIN)
@@ -554,7 +566,12 @@ static const size_t kPageMapBigAllocationThreshold = 128 << 20;
 // should keep this value big because various incarnations of Linux
 // have small limits on the number of mmap() regions per
 // address-space.
+#if PLATFORM(ANDROID)
+// Phones have little memory to spare, so grow the heap in smaller steps.
+static const size_t kMinSystemAlloc = 1 << (18 - kPageShift);
+#else
 static const size_t kMinSystemAlloc = 1 << (20 - kPageShift);
+#endif
 
 // Number of objects to move between a per-thread list and a central
 // list in one shot.  We want this to be not too small so we can
@@ -572,10 +589,18 @@ static const int kMaxFreeListLength = 256;
 
 // Lower and upper bounds on the per-thread cache sizes
 static const size_t kMinThreadCacheSize = kMaxSize * 2;
+#if PLATFORM(ANDROID)
+static const size_t kMaxThreadCacheSize = 512 << 10;
+#else
 static const size_t kMaxThreadCacheSize = 2 << 20;
+#endif
 
 // Default bound on the total amount of thread caches
+#if PLATFORM(ANDROID)
+static const size_t kDefaultOverallThreadCacheSize = 2 << 20;
+#else
 static const size_t kDefaultOverallThreadCacheSize = 16 << 20;
+#endif
 
 // For all span-lengths < kMaxPages we keep an exact-size list.
 // REQUIRED: kMaxPages >= kMinSystemAlloc;
@@ -1220,7 +1245,11 @@ template <> class MapSelector<32> {
 static const int kScavengeTimerDelayInSeconds = 5;
 
 // Number of free committed pages that we want to keep around.
+#if PLATFORM(ANDROID)
+static const size_t kMinimumFreeCommittedPageCount = 128;
+#else
 static const size_t kMinimumFreeCommittedPageCount = 512;
+#endif
 
 // During a scavenge, we'll release up to a fraction of the free committed pages.
 #if PLATFORM(WIN)
@@ -2067,6 +2096,11 @@ class TCMalloc_ThreadCache {
   uint32_t      rnd_;                   // Cheap random number generator
   size_t        bytes_until_sample_;    // Bytes until we sample next
 
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  size_t        allocations_[kNumClasses];   // Objects allocated by this thread
+  size_t        deallocations_[kNumClasses]; // Objects freed by this thread
+#endif
+
   // Allocate a new heap. REQUIRES: pageheap_lock is held.
   static inline TCMalloc_ThreadCache* NewHeap(ThreadIdentifier tid);
 
@@ -2086,6 +2120,11 @@ class TCMalloc_ThreadCache {
   // Total byte size in cache
   size_t Size() const { return size_; }
 
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  size_t allocations(size_t cl) const { return allocations_[cl]; }
+  size_t deallocations(size_t cl) const { return deallocations_[cl]; }
+#endif
+
   void* Allocate(size_t size);
   void Deallocate(void* ptr, size_t size_class);
 
@@ -2345,6 +2384,16 @@ static PageHeapAllocator<TCMalloc_ThreadCache> threadheap_allocator;
 
 // Linked list of heap objects.  Protected by pageheap_lock.
 static TCMalloc_ThreadCache* thread_heaps = NULL;
+
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+// Counts of the thread caches that were deleted, of objects freed by threads
+// without a cache, and of allocations above kMaxSize. Protected by
+// pageheap_lock.
+static size_t retired_allocations[kNumClasses];
+static size_t retired_deallocations[kNumClasses];
+static size_t large_allocations = 0;
+static Length large_live_pages = 0;
+#endif
 static int thread_heap_count = 0;
 
 // Overall thread cache size.  Protected by pageheap_lock.
@@ -2649,6 +2698,10 @@ void TCMalloc_ThreadCache::Init(ThreadIdentifier tid) {
   for (size_t cl = 0; cl < kNumClasses; ++cl) {
     list_[cl].Init();
   }
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  memset(allocations_, 0, sizeof(allocations_));
+  memset(deallocations_, 0, sizeof(deallocations_));
+#endif
 
   // Initialize RNG -- run it for a bit to get to good values
   bytes_until_sample_ = 0;
@@ -2677,11 +2730,17 @@ ALWAYS_INLINE void* TCMalloc_ThreadCache::Allocate(size_t size) {
     if (list->empty()) return NULL;
   }
   size_ -= allocationSize;
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  allocations_[cl]++;
+#endif
   return list->Pop();
 }
 
 inline void TCMalloc_ThreadCache::Deallocate(void* ptr, size_t cl) {
   size_ += ByteSizeForClass(cl);
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  deallocations_[cl]++;
+#endif
   FreeList* list = &list_[cl];
   list->Push(ptr);
   // If enough data is free, put back into central cache
@@ -2990,6 +3049,12 @@ void TCMalloc_ThreadCache::DeleteCache(TCMalloc_ThreadCache* heap) {
 
   // Remove from linked list
   SpinLockHolder h(&pageheap_lock);
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+  for (size_t cl = 0; cl < kNumClasses; ++cl) {
+    retired_allocations[cl] += heap->allocations(cl);
+    retired_deallocations[cl] += heap->deallocations(cl);
+  }
+#endif
   if (heap->next_ != NULL) heap->next_->prev_ = heap->prev_;
   if (heap->prev_ != NULL) heap->prev_->next_ = heap->next_;
   if (thread_heaps == heap) thread_heaps = heap->next_;
@@ -3401,6 +3466,10 @@ static ALWAYS_INLINE void* do_malloc(size_t size) {
     SpinLockHolder h(&pageheap_lock);
     Span* span = pageheap->New(pages(size));
     if (span != NULL) {
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+      large_allocations++;
+      large_live_pages += span->length;
+#endif
       ret = SpanToMallocResult(span);
     }
   } else {
@@ -3442,11 +3511,18 @@ static ALWAYS_INLINE void do_free(void* ptr) {
       // Delete directly into central cache
       SLL_SetNext(ptr, NULL);
       central_cache[cl].InsertRange(ptr, ptr, 1);
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+      SpinLockHolder h(&pageheap_lock);
+      retired_deallocations[cl]++;
+#endif
     }
   } else {
     SpinLockHolder h(&pageheap_lock);
     ASSERT(reinterpret_cast<uintptr_t>(ptr) % kPageSize == 0);
     ASSERT(span != NULL && span->start == p);
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+    large_live_pages -= span->length;
+#endif
 #ifndef NO_TCMALLOC_SAMPLES
     if (span->sample) {
       DLL_Remove(span);
@@ -4368,6 +4444,38 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+void fastMallocAllocationStatistics(FastMallocAllocationStatistics& statistics)
+{
+    memset(&statistics, 0, sizeof(statistics));
+#if FAST_MALLOC_ALLOCATION_STATISTICS
+    COMPILE_ASSERT(kNumClasses <= FastMallocAllocationStatistics::maxSizeClasses, sizeClassesFitInStatistics);
+    SpinLockHolder lockHolder(&pageheap_lock);
+    if (!phinited)
+        return;
+
+    // Size class 0 is not used.
+    for (size_t cl = 1; cl < kNumClasses; ++cl) {
+        size_t allocations = retired_allocations[cl];
+        size_t deallocations = retired_deallocations[cl];
+        for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache; threadCache = threadCache->next_) {
+            allocations += threadCache->allocations(cl);
+            deallocations += threadCache->deallocations(cl);
+        }
+        FastMallocSizeClassStatistics& sizeClass = statistics.sizeClasses[statistics.sizeClassCount++];
+        sizeClass.size = ByteSizeForClass(cl);
+        sizeClass.allocations = allocations;
+        // Objects freed by another thread than the one that allocated them
+        // can make a thread's count go negative, but not the sum.
+        sizeClass.liveObjects = allocations - deallocations;
+        statistics.liveBytes += sizeClass.liveObjects * sizeClass.size;
+    }
+    statistics.largeAllocations = large_allocations;
+    statistics.liveBytes += large_live_pages << kPageShift;
+    statistics.peakHeapSize = static_cast<size_t>(pageheap->SystemBytes());
+    statistics.committedBytes = statistics.peakHeapSize - pageheap->ReturnedBytes();
+#endif
+}
+
 } // namespace WTF
 #endif
 
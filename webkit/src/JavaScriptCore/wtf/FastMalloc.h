@@ -94,6 +94,24 @@ namespace WTF {
     };
     FastMallocStatistics fastMallocStatistics();
 
+    // Allocation counts of the thread-caching allocator, kept on Android
+    // only. Everything is zero when fastMalloc() is the system malloc.
+    struct FastMallocSizeClassStatistics {
+        size_t size;
+        size_t allocations; // since startup
+        size_t liveObjects;
+    };
+    struct FastMallocAllocationStatistics {
+        static const size_t maxSizeClasses = 96;
+        FastMallocSizeClassStatistics sizeClasses[maxSizeClasses];
+        size_t sizeClassCount;
+        size_t largeAllocations; // above the largest size class, since startup
+        size_t liveBytes; // held by live objects, rounded up to their size class
+        size_t committedBytes; // heap pages not returned to the system
+        size_t peakHeapSize; // the heap is never unmapped, so this is also its current size
+    };
+    void fastMallocAllocationStatistics(FastMallocAllocationStatistics&);
+
     // This defines a type which holds an unsigned integer and is the same
     // size as the minimally aligned memory allocation.
     typedef unsigned long long AllocAlignmentInteger;
@@ -220,7 +238,9 @@ using WTF::fastMallocAllow;
 // new by accident.
 
 // We musn't customize the global operator new and delete for the Qt port.
-#if !PLATFORM(QT)
+// Nor for Android, where Skia and the framework delete objects that WebKit
+// allocates with new.
+#if !PLATFORM(QT) && !PLATFORM(ANDROID)
 
 WTF_PRIVATE_INLINE void* operator new(size_t size) { return fastMalloc(size); }
 WTF_PRIVATE_INLINE void* operator new(size_t size, const std::nothrow_t&) throw() { return fastMalloc(size); }
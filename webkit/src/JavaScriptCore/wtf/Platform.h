@@ -513,7 +513,10 @@
 #if PLATFORM(ANDROID)
 #define WTF_USE_PTHREADS 1
 #define WTF_PLATFORM_SGL 1
+/* Build with -DUSE_SYSTEM_MALLOC=0 to get FastMalloc's thread-caching allocator. */
+#if !defined(USE_SYSTEM_MALLOC)
 #define USE_SYSTEM_MALLOC 1
+#endif
 #define ENABLE_MAC_JAVA_BRIDGE 1
 #define LOG_DISABLED 1
 // Prevents Webkit from drawing the caret in textfields and textareas
@@ -623,6 +626,7 @@
 
 #define HAVE_ERRNO_H 1
 #define HAVE_LANGINFO_H 0
+#define HAVE_MADV_DONTNEED 1
 #define HAVE_MMAP 1
 #define HAVE_SBRK 1
 #define HAVE_STRINGS_H 1
@@ -828,6 +832,39 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
     #define WTF_USE_INTERPRETER 1
 #endif
 
+/* Generational collection in the JavaScriptCore heap. The write barrier lives in
+   JSObject's property storage setters, which the JIT's inline caches bypass. */
+#if !defined(ENABLE_JSC_GENERATIONAL_GC) && PLATFORM(ANDROID) && !ENABLE(JIT)
+#define ENABLE_JSC_GENERATIONAL_GC 1
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC) && ENABLE(JIT)
+#error "JSC_GENERATIONAL_GC requires the interpreter"
+#endif
+
+/* Parallel marking in the JavaScriptCore heap: helper threads drain the mark
+   stack alongside the collecting thread, setting mark bits atomically. */
+#if !defined(ENABLE_JSC_PARALLEL_MARKING) && PLATFORM(ANDROID) && USE(PTHREADS)
+#define ENABLE_JSC_PARALLEL_MARKING 1
+#endif
+
+/* Keep the syntax trees of loaded scripts so that reloading the same source
+   skips the parser. */
+#if !defined(ENABLE_JSC_CODE_CACHE) && PLATFORM(ANDROID)
+#define ENABLE_JSC_CODE_CACHE 1
+#endif
+
+/* Represent concatenated strings as ropes that are flattened on first
+   access. The JIT reads string buffers directly, so this is for the
+   interpreter only. */
+#if !defined(ENABLE_JSC_ROPE_STRINGS) && PLATFORM(ANDROID) && !ENABLE(JIT)
+#define ENABLE_JSC_ROPE_STRINGS 1
+#endif
+
+#if ENABLE(JSC_ROPE_STRINGS) && ENABLE(JIT)
+#error "JSC_ROPE_STRINGS requires the interpreter"
+#endif
+
 /* Yet Another Regex Runtime. */
 #if !defined(ENABLE_YARR_JIT)
 
@@ -850,8 +887,20 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
 #endif
 #endif
 
+/* Android uses the YARR JIT on ARM (both ARM and Thumb-2 code generation). */
+#if PLATFORM(ANDROID) && PLATFORM(ARM)
+#define ENABLE_YARR 1
+#define ENABLE_YARR_JIT 1
+#endif
+
 #endif /* !defined(ENABLE_YARR_JIT) */
 
+/* Android always uses YARR instead of PCRE; without the JIT it falls back to
+   the YARR bytecode interpreter. */
+#if PLATFORM(ANDROID) && !defined(ENABLE_YARR)
+#define ENABLE_YARR 1
+#endif
+
 /* Sanity Check */
 #if ENABLE(YARR_JIT) && !ENABLE(YARR)
 #error "YARR_JIT requires YARR"
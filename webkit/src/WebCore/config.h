@@ -119,6 +119,19 @@
 #undef ENABLE_INSPECTOR  // Enabled by default in Platform.h
 #define ENABLE_INSPECTOR 0
 #define ENABLE_EVENT_SOURCE 0
+// Reject descendant selectors with a filter of the ancestors' tag, id and
+// class names, and share styles with recently styled cousins.
+#define ENABLE_CSS_ANCESTOR_FILTER 1
+// Run the preload scanner over all incoming document data on a background
+// thread, not only while a script blocks the parser.
+#define ENABLE_BACKGROUND_PRELOAD_SCANNER 1
+// Remember the widths of short text runs across layouts and page loads.
+#define ENABLE_TEXT_WIDTH_CACHE 1
+// Decode the pixels of complete images on a background thread.
+#define ENABLE_ASYNC_IMAGE_DECODING 1
+// Record the painting of render layers into pictures and replay them until
+// the layer repaints.
+#define ENABLE_LAYER_PICTURE_CACHE 1
 
 #define FLATTEN_FRAMESET
 #define FLATTEN_IFRAME
@@ -58,6 +58,7 @@ public:
 
     void fontLoaded();
     virtual void fontCacheInvalidated();
+    virtual bool hasCustomFonts() const { return !m_fontFaces.isEmpty(); }
 
     bool isEmpty() const;
 
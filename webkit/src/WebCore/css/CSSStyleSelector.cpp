@@ -383,6 +383,7 @@ static CSSRuleSet* defaultViewSourceStyle;
 static CSSStyleSheet* simpleDefaultStyleSheet;
 
 RenderStyle* CSSStyleSelector::s_styleNotYetAvailable;
+CSSStyleSelector::Statistics CSSStyleSelector::s_statistics;
 
 static PseudoState pseudoState;
 
@@ -491,6 +492,11 @@ void CSSStyleSelector::init()
     m_ruleList = 0;
     m_rootDefaultStyle = 0;
     m_medium = 0;
+#if ENABLE(CSS_ANCESTOR_FILTER)
+    m_implicitParentCount = 0;
+    m_nextSharingCandidate = 0;
+    m_sharingCandidateCount = 0;
+#endif
 }
 
 CSSStyleSelector::~CSSStyleSelector()
@@ -695,11 +701,24 @@ void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleI
     if (!rules)
         return;
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+    bool canUseFastReject = parentStackIsConsistent(m_element->parentNode());
+#endif
+
     for (CSSRuleData* d = rules->first(); d; d = d->next()) {
         CSSStyleRule* rule = d->rule();
         const AtomicString& localName = m_element->localName();
         const AtomicString& selectorLocalName = d->selector()->m_tag.localName();
-        if ((localName == selectorLocalName || selectorLocalName == starAtom) && checkSelector(d->selector())) {
+        if (localName != selectorLocalName && selectorLocalName != starAtom)
+            continue;
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        if (canUseFastReject && fastRejectSelector(d)) {
+            ++s_statistics.selectorsFastRejected;
+            continue;
+        }
+#endif
+        ++s_statistics.selectorsChecked;
+        if (checkSelector(d->selector())) {
             // If the rule has no properties to apply, then ignore it.
             CSSMutableStyleDeclaration* decl = rule->declaration();
             if (!decl || !decl->length())
@@ -725,6 +744,101 @@ void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleI
     }
 }
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+
+// Keep equal tag, id and class names apart in the ancestor filter.
+static const unsigned cTagNameSalt = 13;
+static const unsigned cIdAttributeSalt = 17;
+static const unsigned cClassAttributeSalt = 19;
+
+static void collectElementIdentifierHashes(Element* element, Vector<unsigned, 64>& hashes)
+{
+    hashes.append(element->localName().impl()->hash() * cTagNameSalt);
+    if (element->hasID()) {
+        const AtomicString& id = element->getIDAttribute();
+        if (!id.isNull())
+            hashes.append(id.impl()->hash() * cIdAttributeSalt);
+    }
+    if (element->hasClass() && element->isStyledElement()) {
+        const ClassNames& classNames = static_cast<StyledElement*>(element)->classNames();
+        size_t size = classNames.size();
+        for (size_t i = 0; i < size; ++i)
+            hashes.append(classNames[i].impl()->hash() * cClassAttributeSalt);
+    }
+}
+
+bool CSSStyleSelector::parentStackIsConsistent(const Node* parent) const
+{
+    return !m_parentStack.isEmpty() && m_parentStack.last().element == parent;
+}
+
+void CSSStyleSelector::pushParentStackFrame(Element* parent)
+{
+    size_t firstIdentifierHash = m_ancestorIdentifierHashes.size();
+    m_parentStack.append(ParentStackFrame(parent, firstIdentifierHash));
+    collectElementIdentifierHashes(parent, m_ancestorIdentifierHashes);
+    for (size_t i = firstIdentifierHash; i < m_ancestorIdentifierHashes.size(); ++i)
+        m_ancestorIdentifierFilter.add(m_ancestorIdentifierHashes[i]);
+}
+
+void CSSStyleSelector::popParentStackFrame()
+{
+    size_t firstIdentifierHash = m_parentStack.last().firstIdentifierHash;
+    for (size_t i = firstIdentifierHash; i < m_ancestorIdentifierHashes.size(); ++i)
+        m_ancestorIdentifierFilter.remove(m_ancestorIdentifierHashes[i]);
+    m_ancestorIdentifierHashes.shrink(firstIdentifierHash);
+    m_parentStack.removeLast();
+}
+
+void CSSStyleSelector::clearParentStack()
+{
+    while (!m_parentStack.isEmpty())
+        popParentStackFrame();
+    m_implicitParentCount = 0;
+    for (unsigned i = 0; i < m_sharingCandidateCount; ++i)
+        m_sharingCandidates[i] = 0;
+    m_nextSharingCandidate = 0;
+    m_sharingCandidateCount = 0;
+}
+
+void CSSStyleSelector::pushParent(Element* parent)
+{
+    if (m_parentStack.isEmpty()) {
+        // A new subtree. The filter must cover all the ancestors of its root.
+        Vector<Element*, 32> ancestors;
+        for (Element* ancestor = parent->parentElement(); ancestor; ancestor = ancestor->parentElement())
+            ancestors.append(ancestor);
+        for (size_t i = ancestors.size(); i; --i)
+            pushParentStackFrame(ancestors[i - 1]);
+        m_implicitParentCount = ancestors.size();
+    } else if (!parentStackIsConsistent(parent->parentNode()))
+        return;
+    pushParentStackFrame(parent);
+}
+
+void CSSStyleSelector::popParent(Element* parent)
+{
+    if (!parentStackIsConsistent(parent))
+        return;
+    popParentStackFrame();
+    // Done with the subtree. Nothing on the stack or in the sharing cache is
+    // known to stay alive after this.
+    if (m_parentStack.size() == m_implicitParentCount)
+        clearParentStack();
+}
+
+bool CSSStyleSelector::fastRejectSelector(CSSRuleData* ruleData) const
+{
+    const unsigned* hashes = ruleData->descendantSelectorIdentifierHashes();
+    for (unsigned i = 0; i < CSSRuleData::maximumIdentifierCount && hashes[i]; ++i) {
+        if (!m_ancestorIdentifierFilter.mayContain(hashes[i]))
+            return true;
+    }
+    return false;
+}
+
+#endif // ENABLE(CSS_ANCESTOR_FILTER)
+
 static bool operator >(CSSRuleData& r1, CSSRuleData& r2)
 {
     int spec1 = r1.selector()->specificity();
@@ -1050,28 +1164,83 @@ RenderStyle* CSSStyleSelector::locateSharedStyle()
     if (m_styledElement && !m_styledElement->inlineStyleDecl() && !m_styledElement->hasID() && !m_styledElement->document()->usesSiblingRules()) {
         // Check previous siblings.
         unsigned count = 0;
+        bool searchCousins = true;
         Node* n;
         for (n = m_element->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
         while (n) {
-            if (canShareStyleWithElement(n))
+            if (canShareStyleWithElement(n)) {
+                ++s_statistics.stylesSharedWithSiblings;
                 return n->renderStyle();
-            if (count++ == cStyleSearchThreshold)
-                return 0;
+            }
+            if (count++ == cStyleSearchThreshold) {
+                searchCousins = false;
+                break;
+            }
             for (n = n->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
         }
-        if (!n) 
+        if (searchCousins) {
             n = locateCousinList(m_element->parentElement());
-        while (n) {
-            if (canShareStyleWithElement(n))
-                return n->renderStyle();
-            if (count++ == cStyleSearchThreshold)
-                return 0;
-            for (n = n->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
-        }        
+            while (n) {
+                if (canShareStyleWithElement(n)) {
+                    ++s_statistics.stylesSharedWithCousins;
+                    return n->renderStyle();
+                }
+                if (count++ == cStyleSearchThreshold)
+                    break;
+                for (n = n->previousSibling(); n && !n->isElementNode(); n = n->previousSibling()) { }
+            }
+        }
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        return locateSharedStyleInCache();
+#endif
     }
     return 0;
 }
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+
+RenderStyle* CSSStyleSelector::locateSharedStyleInCache()
+{
+    // Parents only end up with the same style object when their own parents
+    // have one too, so an element whose parent has our parent's style is a
+    // cousin at some distance, found here without walking the tree.
+    Node* parent = m_element->parentNode();
+    if (!parentStackIsConsistent(parent))
+        return 0;
+    RenderStyle* parentStyle = parent->renderStyle();
+    if (!parentStyle || parentStyle == s_styleNotYetAvailable)
+        return 0;
+
+    for (unsigned i = 1; i <= m_sharingCandidateCount; ++i) {
+        StyledElement* candidate = m_sharingCandidates[(m_nextSharingCandidate + maximumSharingCandidates - i) % maximumSharingCandidates].get();
+        Node* candidateParent = candidate->parentNode();
+        // Siblings have been checked already. A candidate taken out of the
+        // document since it was added has no style worth sharing.
+        if (candidate == m_element || !candidate->inDocument() || candidateParent == parent || !candidateParent || candidateParent->renderStyle() != parentStyle)
+            continue;
+        if (canShareStyleWithElement(candidate)) {
+            ++s_statistics.stylesSharedFromCache;
+            return candidate->renderStyle();
+        }
+    }
+    return 0;
+}
+
+void CSSStyleSelector::addSharingCandidate(Element* e)
+{
+    if (!e->isStyledElement() || !parentStackIsConsistent(e->parentNode()))
+        return;
+    StyledElement* element = static_cast<StyledElement*>(e);
+    if (element->inlineStyleDecl() || element->hasID())
+        return;
+    m_sharingCandidates[m_nextSharingCandidate] = element;
+    m_nextSharingCandidate = (m_nextSharingCandidate + 1) % maximumSharingCandidates;
+    if (m_sharingCandidateCount < maximumSharingCandidates)
+        ++m_sharingCandidateCount;
+}
+
+#endif // ENABLE(CSS_ANCESTOR_FILTER)
+
 void CSSStyleSelector::matchUARules(int& firstUARule, int& lastUARule)
 {
     // First we match rules from the user agent sheet.
@@ -1111,10 +1280,15 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     }
 
     initElementAndPseudoState(e);
+    ++s_statistics.elementsStyled;
     if (allowSharing) {
         RenderStyle* sharedStyle = locateSharedStyle();
-        if (sharedStyle)
+        if (sharedStyle) {
+#if ENABLE(CSS_ANCESTOR_FILTER)
+            addSharingCandidate(e);
+#endif
             return sharedStyle;
+        }
     }
     initForStyleResolve(e, defaultParent);
 
@@ -1286,6 +1460,11 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     if (m_style->hasPseudoStyle(FIRST_LETTER))
         m_style->setUnique();
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+    if (allowSharing)
+        addSharingCandidate(e);
+#endif
+
     // Now return the style.
     return m_style.release();
 }
@@ -2690,6 +2869,50 @@ CSSValue* CSSStyleSelector::resolveVariableDependentValue(CSSVariableDependentVa
 
 // -----------------------------------------------------------------
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+
+static inline void collectSelectorIdentifierHashes(const CSSSelector* selector, unsigned*& hash, const unsigned* end)
+{
+    if ((selector->m_match == CSSSelector::Id || selector->m_match == CSSSelector::Class) && !selector->m_value.isEmpty() && hash != end)
+        *hash++ = selector->m_value.impl()->hash() * (selector->m_match == CSSSelector::Id ? cIdAttributeSalt : cClassAttributeSalt);
+    const AtomicString& localName = selector->m_tag.localName();
+    if (localName != starAtom && hash != end)
+        *hash++ = localName.impl()->hash() * cTagNameSalt;
+}
+
+void CSSRuleData::collectDescendantSelectorIdentifierHashes()
+{
+    unsigned* hash = m_descendantSelectorIdentifierHashes;
+    const unsigned* end = hash + maximumIdentifierCount;
+
+    // Only the compound selectors that must match an ancestor of the element
+    // count. The element itself is found through the rule set's maps, and
+    // the siblings of an ancestor are not in the filter.
+    CSSSelector::Relation relation = m_selector->relation();
+    bool matchesAncestor = false;
+    for (const CSSSelector* selector = m_selector->tagHistory(); selector && hash != end; selector = selector->tagHistory()) {
+        switch (relation) {
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            matchesAncestor = true;
+            break;
+        case CSSSelector::DirectAdjacent:
+        case CSSSelector::IndirectAdjacent:
+            matchesAncestor = false;
+            break;
+        case CSSSelector::SubSelector:
+            break;
+        }
+        if (matchesAncestor)
+            collectSelectorIdentifierHashes(selector, hash, end);
+        relation = selector->relation();
+    }
+    if (hash != end)
+        *hash = 0;
+}
+
+#endif // ENABLE(CSS_ANCESTOR_FILTER)
+
 CSSRuleSet::CSSRuleSet()
 {
     m_universalRules = 0;
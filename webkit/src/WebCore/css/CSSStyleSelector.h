@@ -28,6 +28,7 @@
 #include "MediaQueryExp.h"
 #include "RenderStyle.h"
 #include "StringHash.h"
+#include <wtf/BloomFilter.h>
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/RefPtr.h>
@@ -92,6 +93,26 @@ public:
 
         PassRefPtr<RenderStyle> pseudoStyleForElement(PseudoId, Element*, RenderStyle* parentStyle = 0);
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        // Called around the children of an element while a subtree is styled
+        // in document order, so that descendant selectors can be rejected
+        // with a filter of the ancestors' identifiers. Calls that do not
+        // follow the tree are ignored.
+        void pushParent(Element*);
+        void popParent(Element*);
+#endif
+
+        struct Statistics {
+            unsigned elementsStyled;
+            unsigned selectorsChecked;
+            unsigned selectorsFastRejected;
+            unsigned stylesSharedWithSiblings;
+            unsigned stylesSharedWithCousins;
+            unsigned stylesSharedFromCache;
+        };
+        // Totals over all style selectors.
+        static const Statistics& statistics() { return s_statistics; }
+
 #if ENABLE(DATAGRID)
         // Datagrid style computation (uses unique pseudo elements and structures)
         PassRefPtr<RenderStyle> pseudoStyleForDataGridColumn(DataGridColumn*, RenderStyle* parentStyle);
@@ -103,6 +124,17 @@ public:
         Node* locateCousinList(Element* parent, unsigned depth = 1);
         bool canShareStyleWithElement(Node*);
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        bool parentStackIsConsistent(const Node* parent) const;
+        void pushParentStackFrame(Element*);
+        void popParentStackFrame();
+        void clearParentStack();
+        bool fastRejectSelector(CSSRuleData*) const;
+
+        RenderStyle* locateSharedStyleInCache();
+        void addSharingCandidate(Element*);
+#endif
+
         RenderStyle* style() const { return m_style.get(); }
 
     public:
@@ -212,6 +244,7 @@ public:
 
     private:
         static RenderStyle* s_styleNotYetAvailable;
+        static Statistics s_statistics;
 
         void init();
 
@@ -284,6 +317,33 @@ public:
         
         HashMap<String, CSSVariablesRule*> m_variablesMap;
         HashMap<CSSMutableStyleDeclaration*, RefPtr<CSSMutableStyleDeclaration> > m_resolvedVariablesDeclarations;
+
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        struct ParentStackFrame {
+            ParentStackFrame() : element(0), firstIdentifierHash(0) { }
+            ParentStackFrame(Element* element, size_t firstIdentifierHash) : element(element), firstIdentifierHash(firstIdentifierHash) { }
+            Element* element;
+            size_t firstIdentifierHash; // into m_ancestorIdentifierHashes
+        };
+        // The element ancestors of the elements being styled, outermost first,
+        // and the tag, id and class hashes they added to the filter. The
+        // first m_implicitParentCount frames are the ancestors of the subtree
+        // root, pushed when the stack was set up.
+        Vector<ParentStackFrame, 32> m_parentStack;
+        Vector<unsigned, 64> m_ancestorIdentifierHashes;
+        size_t m_implicitParentCount;
+        static const unsigned ancestorFilterKeyBits = 12;
+        BloomFilter<ancestorFilterKeyBits> m_ancestorIdentifierFilter;
+
+        // The last few elements of the current subtree that could share
+        // their style, used as a ring. They are referenced so that script or
+        // a plugin removing one from the tree mid-traversal cannot leave a
+        // dangling pointer here, and released when the traversal ends.
+        static const unsigned maximumSharingCandidates = 8;
+        RefPtr<StyledElement> m_sharingCandidates[maximumSharingCandidates];
+        unsigned m_nextSharingCandidate;
+        unsigned m_sharingCandidateCount;
+#endif
     };
 
     class CSSRuleData {
@@ -296,6 +356,9 @@ public:
         {
             if (prev)
                 prev->m_next = this;
+#if ENABLE(CSS_ANCESTOR_FILTER)
+            collectDescendantSelectorIdentifierHashes();
+#endif
         }
 
         ~CSSRuleData() 
@@ -307,11 +370,25 @@ public:
         CSSSelector* selector() { return m_selector; }
         CSSRuleData* next() { return m_next; }
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        // Hashes of tag, id and class names that some ancestor of a matching
+        // element must have, terminated by 0 unless all slots are used.
+        static const unsigned maximumIdentifierCount = 4;
+        const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
+#endif
+
     private:
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        void collectDescendantSelectorIdentifierHashes();
+#endif
+
         unsigned m_position;
         CSSStyleRule* m_rule;
         CSSSelector* m_selector;
         CSSRuleData* m_next;
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
+#endif
     };
 
     class CSSRuleDataList {
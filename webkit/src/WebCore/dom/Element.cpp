@@ -724,12 +724,48 @@ void Element::removedFromDocument()
     ContainerNode::removedFromDocument();
 }
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+// Tells the style selector that the children of an element are about to be
+// styled, for the lifetime of the object.
+class StyleSelectorParentPusher : public Noncopyable {
+public:
+    StyleSelectorParentPusher(Element* parent)
+        : m_parent(parent)
+        , m_pushed(false)
+    {
+        CSSStyleSelector* styleSelector = parent->document()->styleSelector();
+        if (styleSelector && parent->firstChild()) {
+            styleSelector->pushParent(parent);
+            m_pushed = true;
+        }
+    }
+
+    ~StyleSelectorParentPusher()
+    {
+        if (!m_pushed)
+            return;
+        // The document may have replaced its style selector meanwhile.
+        if (CSSStyleSelector* styleSelector = m_parent->document()->styleSelector())
+            styleSelector->popParent(m_parent);
+    }
+
+private:
+    Element* m_parent;
+    bool m_pushed;
+};
+#endif
+
 void Element::attach()
 {
     suspendPostAttachCallbacks();
 
     createRendererIfNeeded();
-    ContainerNode::attach();
+    {
+#if ENABLE(CSS_ANCESTOR_FILTER)
+        StyleSelectorParentPusher parentPusher(this);
+#endif
+        ContainerNode::attach();
+    }
     if (hasRareData()) {   
         ElementRareData* data = rareData();
         if (data->needsFocusAppearanceUpdateSoonAfterAttach()) {
@@ -855,6 +891,10 @@ void Element::recalcStyle(StyleChange change)
         }
     }
 
+#if ENABLE(CSS_ANCESTOR_FILTER)
+    StyleSelectorParentPusher parentPusher(this);
+#endif
+
     // FIXME: This check is good enough for :hover + foo, but it is not good enough for :hover + foo + bar.
     // For now we will just worry about the common case, since it's a lot trickier to get the second case right
     // without doing way too much re-resolution.
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BackgroundPreloadScanner.h"
+
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#include "DocLoader.h"
+#include "Document.h"
+#include "SegmentedString.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+// The strings in a task are owned by the task, which is handed over to the
+// scanning thread and deleted there.
+struct BackgroundPreloadScanner::ScanTask {
+    ScanTask(PassRefPtr<BackgroundPreloadScanner> scanner, const String& text, bool end)
+        : scanner(scanner)
+        , text(text)
+        , end(end)
+    {
+    }
+
+    RefPtr<BackgroundPreloadScanner> scanner;
+    String text;
+    bool end;
+};
+
+BackgroundPreloadScanner::Statistics BackgroundPreloadScanner::s_statistics;
+
+MessageQueue<BackgroundPreloadScanner::ScanTask*>& BackgroundPreloadScanner::scanQueue()
+{
+    DEFINE_STATIC_LOCAL(MessageQueue<ScanTask*>, queue, ());
+    return queue;
+}
+
+PassRefPtr<BackgroundPreloadScanner> BackgroundPreloadScanner::create(Document* document)
+{
+    return adoptRef(new BackgroundPreloadScanner(document));
+}
+
+BackgroundPreloadScanner::BackgroundPreloadScanner(Document* document)
+    : m_finished(false)
+    , m_document(document)
+    , m_issueScheduled(false)
+{
+    ++s_statistics.documentsScanned;
+}
+
+BackgroundPreloadScanner::~BackgroundPreloadScanner()
+{
+    ASSERT(!m_scanner);
+}
+
+void BackgroundPreloadScanner::post(ScanTask* task)
+{
+    ASSERT(isMainThread());
+    static ThreadIdentifier scanThread = 0;
+    if (!scanThread) {
+        scanThread = createThread(BackgroundPreloadScanner::scanThreadStart, 0, "WebCore: PreloadScanner");
+        if (!scanThread) {
+            delete task;
+            return;
+        }
+        detachThread(scanThread);
+    }
+    scanQueue().append(task);
+}
+
+void* BackgroundPreloadScanner::scanThreadStart(void*)
+{
+    ScanTask* task;
+    while (scanQueue().waitForMessage(task)) {
+        task->scanner->scan(task->text, task->end);
+        delete task;
+    }
+    return 0;
+}
+
+void BackgroundPreloadScanner::write(const SegmentedString& source)
+{
+    ASSERT(isMainThread());
+    if (m_finished)
+        return;
+    String text = source.toString();
+    if (text.isEmpty())
+        return;
+    post(new ScanTask(this, text.threadsafeCopy(), false));
+}
+
+void BackgroundPreloadScanner::finish()
+{
+    ASSERT(isMainThread());
+    if (m_finished)
+        return;
+    m_finished = true;
+    // The scanning thread made the scanner's strings, so it destroys them too.
+    post(new ScanTask(this, String(), true));
+}
+
+void BackgroundPreloadScanner::detach()
+{
+    ASSERT(isMainThread());
+    {
+        MutexLocker lock(m_mutex);
+        m_document = 0;
+        m_requests.clear();
+    }
+    finish();
+}
+
+void BackgroundPreloadScanner::scan(const String& text, bool end)
+{
+    bool detached;
+    {
+        MutexLocker lock(m_mutex);
+        detached = !m_document;
+    }
+
+    if (!detached && !text.isEmpty()) {
+        if (!m_scanner) {
+            m_scanner.set(new PreloadScanner(static_cast<PreloadScanner::Client*>(this)));
+            m_scanner->begin();
+        }
+        double startTime = currentTime();
+        m_scanner->write(SegmentedString(text));
+        s_statistics.scanTime += currentTime() - startTime;
+        s_statistics.charactersScanned += text.length();
+    }
+
+    if (end || detached)
+        m_scanner.clear();
+}
+
+void BackgroundPreloadScanner::preload(CachedResource::Type type, const String& url, const String& charset, bool inBody)
+{
+    MutexLocker lock(m_mutex);
+    if (!m_document)
+        return;
+
+    Request request;
+    request.type = type;
+    request.url = url.threadsafeCopy();
+    request.charset = charset.threadsafeCopy();
+    request.inBody = inBody;
+    m_requests.append(request);
+
+    if (m_issueScheduled)
+        return;
+    m_issueScheduled = true;
+    // Keeps this scanner alive until the main thread has run the callback.
+    ref();
+    callOnMainThread(issuePreloadsOnMainThread, this);
+}
+
+void BackgroundPreloadScanner::issuePreloadsOnMainThread(void* context)
+{
+    BackgroundPreloadScanner* scanner = static_cast<BackgroundPreloadScanner*>(context);
+    scanner->issuePreloads();
+    scanner->deref();
+}
+
+void BackgroundPreloadScanner::issuePreloads()
+{
+    ASSERT(isMainThread());
+    Vector<Request> requests;
+    {
+        MutexLocker lock(m_mutex);
+        m_requests.swap(requests);
+        m_issueScheduled = false;
+    }
+
+    if (!m_document)
+        return;
+
+    DocLoader* docLoader = m_document->docLoader();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const Request& request = requests[i];
+        docLoader->preload(request.type, request.url, request.charset, request.inBody || m_document->body());
+    }
+    s_statistics.preloadsIssued += requests.size();
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_PRELOAD_SCANNER)
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BackgroundPreloadScanner_h
+#define BackgroundPreloadScanner_h
+
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#include "PreloadScanner.h"
+#include <wtf/MessageQueue.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+    class Document;
+    class SegmentedString;
+
+    // Runs a PreloadScanner over all the data received for a document on a
+    // shared background thread, so subresource fetches start while the main
+    // thread is still tokenizing, running scripts or laying out. The preloads
+    // found are handed to the document's DocLoader on the main thread.
+    //
+    // The tree-building tokenizer stays on the main thread: document.write()
+    // and script execution change its input synchronously, and its tokens
+    // carry AtomicStrings, which belong to the thread that made them.
+    class BackgroundPreloadScanner : public ThreadSafeShared<BackgroundPreloadScanner>, private PreloadScanner::Client {
+    public:
+        struct Statistics {
+            size_t documentsScanned;
+            size_t charactersScanned;
+            size_t preloadsIssued;
+            double scanTime; // in seconds, spent on the scanning thread
+        };
+
+        static PassRefPtr<BackgroundPreloadScanner> create(Document*);
+        ~BackgroundPreloadScanner();
+
+        // Main thread only. Data written after finish() or detach() is ignored.
+        void write(const SegmentedString&);
+        void finish();
+        // Called when the document stops parsing; no more preloads are issued.
+        void detach();
+
+        static const Statistics& statistics() { return s_statistics; }
+
+    private:
+        BackgroundPreloadScanner(Document*);
+
+        struct ScanTask;
+        struct Request {
+            CachedResource::Type type;
+            String url;
+            String charset;
+            bool inBody;
+        };
+
+        static MessageQueue<ScanTask*>& scanQueue();
+        static void post(ScanTask*);
+        static void* scanThreadStart(void*);
+
+        // Scanning thread.
+        void scan(const String&, bool end);
+        virtual void preload(CachedResource::Type, const String& url, const String& charset, bool inBody);
+
+        // Main thread.
+        static void issuePreloadsOnMainThread(void*);
+        void issuePreloads();
+
+        bool m_finished; // main thread only
+        OwnPtr<PreloadScanner> m_scanner; // scanning thread only
+
+        Mutex m_mutex;
+        Document* m_document; // written under m_mutex on the main thread
+        Vector<Request> m_requests; // guarded by m_mutex
+        bool m_issueScheduled; // guarded by m_mutex
+
+        static Statistics s_statistics;
+    };
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#endif // BackgroundPreloadScanner_h
@@ -28,6 +28,7 @@
 #include "config.h"
 #include "HTMLTokenizer.h"
 
+#include "BackgroundPreloadScanner.h"
 #include "CSSHelper.h"
 #include "Cache.h"
 #include "CachedScript.h"
@@ -51,6 +52,7 @@
 #include "ScriptController.h"
 #include "ScriptSourceCode.h"
 #include "ScriptValue.h"
+#include "Settings.h"
 #include "XSSAuditor.h"
 #include <wtf/ASCIICType.h>
 #include <wtf/CurrentTime.h>
@@ -171,6 +173,7 @@ HTMLTokenizer::HTMLTokenizer(HTMLDocument* doc, bool reportErrors)
     , m_requestingScript(false)
     , m_hasScriptsWaitingForStylesheets(false)
     , m_timer(this, &HTMLTokenizer::timerFired)
+    , m_nameHashLength(0)
     , m_doc(doc)
     , m_parser(new HTMLParser(doc, reportErrors))
     , m_inWrite(false)
@@ -190,6 +193,7 @@ HTMLTokenizer::HTMLTokenizer(HTMLViewSourceDocument* doc)
     , m_requestingScript(false)
     , m_hasScriptsWaitingForStylesheets(false)
     , m_timer(this, &HTMLTokenizer::timerFired)
+    , m_nameHashLength(0)
     , m_doc(doc)
     , m_parser(0)
     , m_inWrite(false)
@@ -208,6 +212,7 @@ HTMLTokenizer::HTMLTokenizer(DocumentFragment* frag)
     , m_requestingScript(false)
     , m_hasScriptsWaitingForStylesheets(false)
     , m_timer(this, &HTMLTokenizer::timerFired)
+    , m_nameHashLength(0)
     , m_doc(frag->document())
     , m_parser(new HTMLParser(frag))
     , m_inWrite(false)
@@ -235,6 +240,13 @@ void HTMLTokenizer::reset()
     m_scriptCode = 0;
     m_scriptCodeSize = m_scriptCodeCapacity = m_scriptCodeResync = 0;
 
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner) {
+        m_backgroundPreloadScanner->detach();
+        m_backgroundPreloadScanner = 0;
+    }
+#endif
+
     m_timer.stop();
     m_state.setAllowYield(false);
     m_state.setForceSynchronous(false);
@@ -534,8 +546,20 @@ HTMLTokenizer::State HTMLTokenizer::scriptHandler(State state)
         if (!m_pendingScripts.isEmpty()) {
             if (m_currentPrependingSrc)
                 m_currentPrependingSrc->append(prependingSrc);
-            else
+            else {
                 m_pendingSrc.prepend(prependingSrc);
+#if PRELOAD_SCANNER_ENABLED && ENABLE(BACKGROUND_PRELOAD_SCANNER)
+                // The background scanner only sees the data from the network.
+                // Check the document.write()n source that now waits for the
+                // pending scripts here, like scriptExecution() does.
+                if (m_backgroundPreloadScanner) {
+                    PreloadScanner documentWritePreloadScanner(m_doc);
+                    documentWritePreloadScanner.begin();
+                    documentWritePreloadScanner.write(prependingSrc);
+                    documentWritePreloadScanner.end();
+                }
+#endif
+            }
         } else {
             m_state = state;
             write(prependingSrc, false);
@@ -544,7 +568,13 @@ HTMLTokenizer::State HTMLTokenizer::scriptHandler(State state)
     }
     
 #if PRELOAD_SCANNER_ENABLED
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    // The background scanner has already seen the pending data from the
+    // network, and the document.write()n part has been scanned above.
+    if (!m_pendingScripts.isEmpty() && !m_executingScript && !m_backgroundPreloadScanner) {
+#else
     if (!m_pendingScripts.isEmpty() && !m_executingScript) {
+#endif
         if (!m_preloadScanner)
             m_preloadScanner.set(new PreloadScanner(m_doc));
         if (!m_preloadScanner->inProgress()) {
@@ -1139,6 +1169,36 @@ HTMLTokenizer::State HTMLTokenizer::parseDoctype(SegmentedString& src, State sta
     return state;
 }
 
+inline void HTMLTokenizer::appendToName(unsigned& cBufferPos, UChar c)
+{
+    if (!cBufferPos) {
+        m_nameHasher = StringHasher();
+        m_nameHashLength = 0;
+    }
+    m_cBuffer[cBufferPos++] = c;
+
+    // The '/' of an end tag is not part of the tag name. Attribute names
+    // never start with one.
+    if (cBufferPos == 1 && c == '/')
+        return;
+    // AtomicString(const UChar*) stops at a null character.
+    if (!c)
+        m_nameHashLength = UINT_MAX;
+    if (m_nameHashLength == UINT_MAX)
+        return;
+    m_nameHasher.addCharacter(c);
+    ++m_nameHashLength;
+}
+
+inline AtomicString HTMLTokenizer::atomizeName(const UChar* name, unsigned length)
+{
+    ASSERT(!name[length]);
+    // The hash does not cover the name if a trailing '/' was cut off, as in <br/>.
+    if (length != m_nameHashLength)
+        return AtomicString(name);
+    return AtomicString(name, length, m_nameHasher.hash());
+}
+
 HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
 {
     ASSERT(!state.hasEntityState());
@@ -1185,7 +1245,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                         m_cBufferPos = cBufferPos;
                         return state; // Finished parsing tag!
                     }
-                    m_cBuffer[cBufferPos++] = *src;
+                    appendToName(cBufferPos, *src);
                     src.advancePastNonNewline();
                     break;
                 } else
@@ -1195,7 +1255,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
             if (m_doctypeSearchCount > 0) {
                 if (toASCIILower(*src) == doctypeStart[m_doctypeSearchCount]) {
                     m_doctypeSearchCount++;
-                    m_cBuffer[cBufferPos++] = *src;
+                    appendToName(cBufferPos, *src);
                     src.advancePastNonNewline();
                     if (m_doctypeSearchCount == 9) {
                         // Found '<!DOCTYPE' sequence
@@ -1224,9 +1284,9 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 
                 // tolower() shows up on profiles. This is faster!
                 if (curchar >= 'A' && curchar <= 'Z' && !inViewSourceMode())
-                    m_cBuffer[cBufferPos++] = curchar + ('a' - 'A');
+                    appendToName(cBufferPos, curchar + ('a' - 'A'));
                 else
-                    m_cBuffer[cBufferPos++] = curchar;
+                    appendToName(cBufferPos, curchar);
                 src.advancePastNonNewline();
             }
 
@@ -1254,7 +1314,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 // Now that we've shaved off any invalid / that might have followed the name), make the tag.
                 // FIXME: FireFox and WinIE turn !foo nodes into comments, we ignore comments. (fast/parser/tag-with-exclamation-point.html)
                 if (ptr[0] != '!' || inViewSourceMode()) {
-                    m_currentToken.tagName = AtomicString(ptr);
+                    m_currentToken.tagName = atomizeName(ptr, len);
                     m_currentToken.beginTag = beginTag;
                 }
                 m_dest = m_buffer;
@@ -1291,7 +1351,7 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 // cases like <input type=checkbox checked/> to work (and accommodates XML-style syntax as per HTML5).
                 if (curchar <= '>' && (curchar >= '<' || isASCIISpace(curchar) || curchar == '/')) {
                     m_cBuffer[cBufferPos] = '\0';
-                    m_attrName = AtomicString(m_cBuffer);
+                    m_attrName = atomizeName(m_cBuffer, cBufferPos);
                     m_dest = m_buffer;
                     *m_dest++ = 0;
                     state.setTagState(SearchEqual);
@@ -1302,16 +1362,16 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                 
                 // tolower() shows up on profiles. This is faster!
                 if (curchar >= 'A' && curchar <= 'Z' && !inViewSourceMode())
-                    m_cBuffer[cBufferPos++] = curchar + ('a' - 'A');
+                    appendToName(cBufferPos, curchar + ('a' - 'A'));
                 else
-                    m_cBuffer[cBufferPos++] = curchar;
+                    appendToName(cBufferPos, curchar);
                     
                 m_rawAttributeBeforeValue.append(curchar);
                 src.advance(m_lineNumber);
             }
             if (cBufferPos == CBUFLEN) {
                 m_cBuffer[cBufferPos] = '\0';
-                m_attrName = AtomicString(m_cBuffer);
+                m_attrName = atomizeName(m_cBuffer, cBufferPos);
                 m_dest = m_buffer;
                 *m_dest++ = 0;
                 state.setTagState(SearchEqual);
@@ -1645,6 +1705,18 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
     if (m_parserStopped)
         return;
 
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    // Only data from the network is appended. document.write() content that
+    // has to wait for a pending script is scanned on the main thread, see
+    // scriptHandler() and scriptExecution().
+    if (appendData && !str.isEmpty()) {
+        if (!m_backgroundPreloadScanner && !m_fragment && !inViewSourceMode() && m_doc->settings() && m_doc->settings()->backgroundPreloadScanningEnabled())
+            m_backgroundPreloadScanner = BackgroundPreloadScanner::create(m_doc);
+        if (m_backgroundPreloadScanner)
+            m_backgroundPreloadScanner->write(str);
+    }
+#endif
+
     SegmentedString source(str);
     if (m_executingScript)
         source.setExcludeLineNumbers();
@@ -1842,6 +1914,10 @@ void HTMLTokenizer::stopParsing()
 {
     Tokenizer::stopParsing();
     m_timer.stop();
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner)
+        m_backgroundPreloadScanner->detach();
+#endif
 
     // The part needs to know that the tokenizer has finished with its data,
     // regardless of whether it happened naturally or due to manual intervention.
@@ -1881,6 +1957,11 @@ void HTMLTokenizer::end()
     ASSERT(!m_timer.isActive());
     m_timer.stop(); // Only helps if assertion above fires, but do it anyway.
 
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner)
+        m_backgroundPreloadScanner->detach();
+#endif
+
     if (m_buffer) {
         // parseTag is using the buffer for different matters
         if (!m_state.hasTagState())
@@ -1902,6 +1983,12 @@ void HTMLTokenizer::end()
 
 void HTMLTokenizer::finish()
 {
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    // No more data will arrive from the network.
+    if (m_backgroundPreloadScanner)
+        m_backgroundPreloadScanner->finish();
+#endif
+
     // do this as long as we don't find matching comment ends
     while ((m_state.inComment() || m_state.inServer()) && m_scriptCode && m_scriptCodeSize) {
         // we've found an unmatched comment start
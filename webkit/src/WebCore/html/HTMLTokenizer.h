@@ -32,11 +32,13 @@
 #include "Tokenizer.h"
 #include <wtf/Deque.h>
 #include <wtf/OwnPtr.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
 
 class CachedScript;
+class BackgroundPreloadScanner;
 class DocumentFragment;
 class Document;
 class HTMLDocument;
@@ -175,6 +177,8 @@ private:
     State parseText(SegmentedString&, State);
     State parseNonHTMLText(SegmentedString&, State);
     State parseTag(SegmentedString&, State);
+    void appendToName(unsigned& cBufferPos, UChar);
+    AtomicString atomizeName(const UChar* name, unsigned length);
     State parseEntity(SegmentedString&, UChar*& dest, State, unsigned& cBufferPos, bool start, bool parsingTag);
     State parseProcessingInstruction(SegmentedString&, State);
     State scriptHandler(State);
@@ -408,6 +412,13 @@ private:
     UChar m_cBuffer[CBUFLEN + 2];
     unsigned int m_cBufferPos;
 
+    // Hash of the tag or attribute name being scanned into m_cBuffer, so
+    // that atomizing the name does not hash it again. m_nameHashLength is
+    // the number of characters hashed, or UINT_MAX if the name has to be
+    // hashed from scratch.
+    StringHasher m_nameHasher;
+    unsigned m_nameHashLength;
+
     SegmentedString m_src;
     Document* m_doc;
     OwnPtr<HTMLParser> m_parser;
@@ -415,6 +426,9 @@ private:
     bool m_fragment;
 
     OwnPtr<PreloadScanner> m_preloadScanner;
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    RefPtr<BackgroundPreloadScanner> m_backgroundPreloadScanner;
+#endif
 };
 
 void parseHTMLDocumentFragment(const String&, DocumentFragment*);
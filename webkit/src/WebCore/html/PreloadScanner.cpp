@@ -27,7 +27,6 @@
 #include "config.h"
 #include "PreloadScanner.h"
 
-#include "AtomicString.h"
 #include "CachedCSSStyleSheet.h"
 #include "CachedImage.h"
 #include "CachedResource.h"
@@ -70,16 +69,27 @@ PreloadScanner::PreloadScanner(Document* doc)
     , m_timeUsed(0)
     , m_bodySeen(false)
     , m_document(doc)
+    , m_client(0)
 {
 #if PRELOAD_DEBUG
     printf("CREATING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
 #endif
 }
+
+PreloadScanner::PreloadScanner(Client* client)
+    : m_inProgress(false)
+    , m_timeUsed(0)
+    , m_bodySeen(false)
+    , m_document(0)
+    , m_client(client)
+{
+}
     
 PreloadScanner::~PreloadScanner()
 {
 #if PRELOAD_DEBUG
-    printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
+    if (m_document)
+        printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
     printf("TOTAL TIME USED %.4fs\n", m_timeUsed);
 #endif
 }
@@ -110,7 +120,8 @@ void PreloadScanner::reset()
     m_tagName.clear();
     m_attributeName.clear();
     m_attributeValue.clear();
-    m_lastStartTag = AtomicString();
+    m_lastStartTag = String();
+    m_lastStartTagIsStyle = false;
     
     m_urlToLoad = String();
     m_charset = String();
@@ -125,7 +136,7 @@ void PreloadScanner::reset()
     
 bool PreloadScanner::scanningBody() const
 {
-    return m_document->body() || m_bodySeen;
+    return (m_document && m_document->body()) || m_bodySeen;
 }
     
 void PreloadScanner::write(const SegmentedString& source)
@@ -690,19 +701,19 @@ void PreloadScanner::tokenize(const SegmentedString& source)
     
 void PreloadScanner::processAttribute()
 {
-    AtomicString tag = AtomicString(m_tagName.data(), m_tagName.size());
-    AtomicString attribute = AtomicString(m_attributeName.data(), m_attributeName.size());
+    String tag(m_tagName.data(), m_tagName.size());
+    String attribute(m_attributeName.data(), m_attributeName.size());
     
     String value(m_attributeValue.data(), m_attributeValue.size());
-    if (tag == scriptTag || tag == imgTag) {
-        if (attribute == srcAttr && m_urlToLoad.isEmpty())
+    if (tag == scriptTag.localName() || tag == imgTag.localName()) {
+        if (attribute == srcAttr.localName() && m_urlToLoad.isEmpty())
             m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == charsetAttr)
+        else if (attribute == charsetAttr.localName())
             m_charset = value;
-    } else if (tag == linkTag) {
-        if (attribute == hrefAttr && m_urlToLoad.isEmpty())
+    } else if (tag == linkTag.localName()) {
+        if (attribute == hrefAttr.localName() && m_urlToLoad.isEmpty())
             m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == relAttr) {
+        else if (attribute == relAttr.localName()) {
             bool styleSheet = false;
             bool alternate = false;
             bool icon = false;
@@ -716,14 +727,14 @@ void PreloadScanner::processAttribute()
             HTMLLinkElement::tokenizeRelAttribute(value, styleSheet, alternate, icon, dnsPrefetch);
             m_linkIsStyleSheet = styleSheet && !alternate && !icon && !dnsPrefetch;
 #endif
-        } else if (attribute == charsetAttr)
+        } else if (attribute == charsetAttr.localName())
             m_charset = value;
     }
 }
     
 inline void PreloadScanner::emitCharacter(UChar c)
 {
-    if (m_contentModel == CDATA && m_lastStartTag == styleTag) 
+    if (m_contentModel == CDATA && m_lastStartTagIsStyle)
         tokenizeCSS(c);
 }
     
@@ -815,22 +826,23 @@ void PreloadScanner::emitTag()
         return;
     }
     
-    AtomicString tag(m_tagName.data(), m_tagName.size());
+    String tag(m_tagName.data(), m_tagName.size());
     m_lastStartTag = tag;
+    m_lastStartTagIsStyle = tag == styleTag.localName();
     
-    if (tag == textareaTag || tag == titleTag)
+    if (tag == textareaTag.localName() || tag == titleTag.localName())
         m_contentModel = RCDATA;
-    else if (tag == styleTag || tag == xmpTag || tag == scriptTag || tag == iframeTag || tag == noembedTag || tag == noframesTag)
+    else if (m_lastStartTagIsStyle || tag == xmpTag.localName() || tag == scriptTag.localName() || tag == iframeTag.localName() || tag == noembedTag.localName() || tag == noframesTag.localName())
         m_contentModel = CDATA;
-    else if (tag == noscriptTag)
+    else if (tag == noscriptTag.localName())
         // we wouldn't be here if scripts were disabled
         m_contentModel = CDATA;
-    else if (tag == plaintextTag)
+    else if (tag == plaintextTag.localName())
         m_contentModel = PLAINTEXT;
     else
         m_contentModel = PCDATA;
     
-    if (tag == bodyTag)
+    if (tag == bodyTag.localName())
         m_bodySeen = true;
     
     if (m_urlToLoad.isEmpty()) {
@@ -838,12 +850,12 @@ void PreloadScanner::emitTag()
         return;
     }
     
-    if (tag == scriptTag)
-        m_document->docLoader()->preload(CachedResource::Script, m_urlToLoad, m_charset, scanningBody());
-    else if (tag == imgTag) 
-        m_document->docLoader()->preload(CachedResource::ImageResource, m_urlToLoad, String(), scanningBody());
-    else if (tag == linkTag && m_linkIsStyleSheet) 
-        m_document->docLoader()->preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset, scanningBody());
+    if (tag == scriptTag.localName())
+        preload(CachedResource::Script, m_urlToLoad, m_charset);
+    else if (tag == imgTag.localName())
+        preload(CachedResource::ImageResource, m_urlToLoad, String());
+    else if (tag == linkTag.localName() && m_linkIsStyleSheet)
+        preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset);
 
     m_urlToLoad = String();
     m_charset = String();
@@ -857,10 +869,18 @@ void PreloadScanner::emitCSSRule()
         String value(m_cssRuleValue.data(), m_cssRuleValue.size());
         String url = deprecatedParseURL(value);
         if (!url.isEmpty())
-            m_document->docLoader()->preload(CachedResource::CSSStyleSheet, url, String(), scanningBody());
+            preload(CachedResource::CSSStyleSheet, url, String());
     }
     m_cssRule.clear();
     m_cssRuleValue.clear();
 }
+
+void PreloadScanner::preload(CachedResource::Type type, const String& url, const String& charset)
+{
+    if (m_client)
+        m_client->preload(type, url, charset, scanningBody());
+    else
+        m_document->docLoader()->preload(type, url, charset, scanningBody());
+}
                 
 }
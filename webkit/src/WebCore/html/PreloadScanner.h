@@ -26,20 +26,31 @@
 #ifndef PreloadScanner_h
 #define PreloadScanner_h
 
-#include "AtomicString.h"
+#include "CachedResource.h"
+#include "PlatformString.h"
 #include "SegmentedString.h"
 #include <wtf/Noncopyable.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
     
-    class CachedResource;
     class CachedResourceClient;
     class Document;
     
     class PreloadScanner : public Noncopyable {
     public:
+        // Receives the preloads found by a scanner that is not attached to a
+        // document, e.g. one running off the main thread. Tag and attribute
+        // names are compared by their characters, so the scanner can run on a
+        // thread with its own AtomicString table.
+        class Client {
+        public:
+            virtual ~Client() { }
+            virtual void preload(CachedResource::Type, const String& url, const String& charset, bool inBody) = 0;
+        };
+
         PreloadScanner(Document*);
+        PreloadScanner(Client*);
         ~PreloadScanner();
         void begin();
         void write(const SegmentedString&);
@@ -61,7 +72,7 @@ namespace WebCore {
         void emitCSSRule();
         
         void processAttribute();
-
+        void preload(CachedResource::Type, const String& url, const String& charset);
         
         void clearLastCharacters();
         void rememberCharacter(UChar);
@@ -112,7 +123,8 @@ namespace WebCore {
         Vector<UChar, 32> m_tagName;
         Vector<UChar, 32> m_attributeName;
         Vector<UChar> m_attributeValue;
-        AtomicString m_lastStartTag;
+        String m_lastStartTag;
+        bool m_lastStartTagIsStyle;
         
         String m_urlToLoad;
         String m_charset;
@@ -137,6 +149,7 @@ namespace WebCore {
         
         bool m_bodySeen;
         Document* m_document;
+        Client* m_client;
     };
 
 }
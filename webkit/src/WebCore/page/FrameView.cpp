@@ -662,6 +662,12 @@ void FrameView::layout(bool allowSubtree)
     if (!subtree && !toRenderView(root)->printing())
         adjustViewSize();
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // Renderers do not repaint themselves during a full repaint.
+    if (m_doFullRepaint)
+        root->view()->invalidateLayerPictures();
+#endif
+
     // Now update the positions of all layers.
     beginDeferredRepaints();
     layer->updateLayerPositions((m_doFullRepaint ? RenderLayer::DoFullRepaint : 0)
@@ -32,6 +32,7 @@
 #include "HistoryItem.h"
 #include "Page.h"
 #include "PageCache.h"
+#include "WidthCache.h"
 #include <limits>
 
 using namespace std;
@@ -40,6 +41,10 @@ namespace WebCore {
 
 static void setNeedsReapplyStylesInAllFrames(Page* page)
 {
+#if ENABLE(TEXT_WIDTH_CACHE)
+    // Generic font families may now map to other fonts.
+    WidthCache::shared().clear();
+#endif
     for (Frame* frame = page->mainFrame(); frame; frame = frame->tree()->traverseNext())
         frame->setNeedsReapplyStyles();
 }
@@ -132,6 +137,7 @@ Settings::Settings(Page* page)
     , m_acceleratedCompositingEnabled(true)
     , m_experimentalNotificationsEnabled(false)
     , m_webGLEnabled(false)
+    , m_backgroundPreloadScanningEnabled(true)
 {
     // A Frame may not have been created yet, so we initialize the AtomicString 
     // hash before trying to use it.
@@ -726,6 +732,11 @@ void Settings::setWebGLEnabled(bool enabled)
     m_webGLEnabled = enabled;
 }
 
+void Settings::setBackgroundPreloadScanningEnabled(bool enabled)
+{
+    m_backgroundPreloadScanningEnabled = enabled;
+}
+
 void Settings::setPrintingMinimumShrinkFactor(float printingMinimumShrinkFactor)
 {
     m_printingMinimumShrinkFactor = printingMinimumShrinkFactor;
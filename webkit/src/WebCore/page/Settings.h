@@ -331,6 +331,11 @@ namespace WebCore {
         void setWebGLEnabled(bool);
         bool webGLEnabled() const { return m_webGLEnabled; }
 
+        // Scan incoming document data for subresources on a background
+        // thread; only used when BACKGROUND_PRELOAD_SCANNER is enabled.
+        void setBackgroundPreloadScanningEnabled(bool);
+        bool backgroundPreloadScanningEnabled() const { return m_backgroundPreloadScanningEnabled; }
+
         void setPrintingMinimumShrinkFactor(float);
         float printingMinimumShrinkFactor() const { return m_printingMinimumShrinkFactor; }
 
@@ -444,6 +449,7 @@ namespace WebCore {
         bool m_acceleratedCompositingEnabled : 1;
         bool m_experimentalNotificationsEnabled : 1;
         bool m_webGLEnabled : 1;
+        bool m_backgroundPreloadScanningEnabled : 1;
 
 #if USE(SAFARI_THEME)
         static bool gShouldPaintNativeControls;
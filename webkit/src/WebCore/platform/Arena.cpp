@@ -61,9 +61,12 @@ namespace WebCore {
 static int i = 0;
 #endif
 
-#define FREELIST_MAX 30
+// Enough 4KB arenas to hold the render tree of a large page, so that
+// loading the next page takes them from the freelist instead of the heap.
+#define FREELIST_MAX 256
 static Arena *arena_freelist;
 static int freelist_count = 0;
+static ArenaStatistics arena_statistics;
 
 #define ARENA_DEFAULT_ALIGN  sizeof(double)
 #define BIT(n)                          ((unsigned int)1 << (n))
@@ -165,6 +168,7 @@ void* ArenaAllocate(ArenaPool *pool, unsigned int nb)
                 if ( 0 == pool->first.next )
                     pool->first.next = a;
                 freelist_count--;
+                arena_statistics.reusedArenas++;
                 return(rp);
             }
         }
@@ -179,6 +183,7 @@ void* ArenaAllocate(ArenaPool *pool, unsigned int nb)
         printf("Malloc: %d\n", i);
 #endif
         a = (Arena*)fastMalloc(sz);
+        arena_statistics.heapArenas++;
         // fastMalloc will abort() if it fails, so we are guaranteed that a is not 0.
         a->limit = (uword)a + sz;
         a->base = a->avail = (uword)ARENA_ALIGN(pool, a + 1);
@@ -217,9 +222,6 @@ static void FreeArenaList(ArenaPool *pool, Arena *head, bool reallyFree)
     a = *ap;
 #endif
 
-    if (freelist_count >= FREELIST_MAX)
-        reallyFree = true;
-        
     if (reallyFree) {
         do {
             *ap = a->next;
@@ -233,14 +235,19 @@ static void FreeArenaList(ArenaPool *pool, Arena *head, bool reallyFree)
             fastFree(a); a = 0;
         } while ((a = *ap) != 0);
     } else {
-        /* Insert the whole arena chain at the front of the freelist. */
+        /* Move the arenas to the front of the freelist until it is full,
+         * and free the rest. */
         do {
-            ap = &(*ap)->next;
-            freelist_count++;
-        } while (*ap);
-        *ap = arena_freelist;
-        arena_freelist = a;
-        head->next = 0;
+            *ap = a->next;
+            if (freelist_count < FREELIST_MAX) {
+                a->next = arena_freelist;
+                arena_freelist = a;
+                freelist_count++;
+            } else {
+                CLEAR_ARENA(a);
+                fastFree(a);
+            }
+        } while ((a = *ap) != 0);
     }
     pool->current = head;
 }
@@ -255,6 +262,23 @@ void FinishArenaPool(ArenaPool *pool)
     FreeArenaList(pool, &pool->first, true);
 }
 
+const ArenaStatistics& GetArenaStatistics()
+{
+    arena_statistics.freeArenas = freelist_count;
+    return arena_statistics;
+}
+
+void ReleaseFreeArenas()
+{
+    while (arena_freelist) {
+        Arena* a = arena_freelist;
+        arena_freelist = a->next;
+        CLEAR_ARENA(a);
+        fastFree(a);
+    }
+    freelist_count = 0;
+}
+
 #ifdef ANDROID_INSTRUMENT
 size_t ReportPoolSize(const ArenaPool* pool)
 {
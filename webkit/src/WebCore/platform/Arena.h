@@ -66,6 +66,18 @@ void FinishArenaPool(ArenaPool *pool);
 void FreeArenaPool(ArenaPool *pool);
 void* ArenaAllocate(ArenaPool *pool, unsigned int nb);
 
+// Counts of arenas taken from the heap and from the freelist since startup,
+// and of the arenas currently on the freelist.
+struct ArenaStatistics {
+    unsigned heapArenas;
+    unsigned reusedArenas;
+    unsigned freeArenas;
+};
+const ArenaStatistics& GetArenaStatistics();
+
+// Returns the arenas on the freelist to the heap.
+void ReleaseFreeArenas();
+
 #define ARENA_ALIGN(pool, n) (((uword)(n) + ARENA_ALIGN_MASK) & ~ARENA_ALIGN_MASK)
 #define INIT_ARENA_POOL(pool, name, size) \
         InitArenaPool(pool, name, size, ARENA_ALIGN_MASK + 1)
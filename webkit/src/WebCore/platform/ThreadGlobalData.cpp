@@ -70,6 +70,7 @@ ThreadGlobalData& threadGlobalData()
 ThreadGlobalData::ThreadGlobalData()
     : m_emptyString(new StringImpl)
     , m_atomicStringTable(new HashSet<StringImpl*>)
+    , m_atomicStringStatistics()
     , m_eventNames(new EventNames)
     , m_threadTimers(new ThreadTimers)
 #ifndef NDEBUG
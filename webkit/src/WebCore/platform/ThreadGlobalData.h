@@ -46,6 +46,7 @@ namespace WebCore {
         EventNames& eventNames() { return *m_eventNames; }
         StringImpl* emptyString() { return m_emptyString; }
         HashSet<StringImpl*>& atomicStringTable() { return *m_atomicStringTable; }
+        AtomicString::Statistics& atomicStringStatistics() { return m_atomicStringStatistics; }
         ThreadTimers& threadTimers() { return *m_threadTimers; }
 
 #if USE(ICU_UNICODE) || USE(GLIB_ICU_UNICODE_HYBRID)
@@ -59,6 +60,7 @@ namespace WebCore {
     private:
         StringImpl* m_emptyString;
         HashSet<StringImpl*>* m_atomicStringTable;
+        AtomicString::Statistics m_atomicStringStatistics;
         EventNames* m_eventNames;
         ThreadTimers* m_threadTimers;
 
@@ -30,6 +30,8 @@
 #include "FontFallbackList.h"
 #include "IntPoint.h"
 #include "GlyphBuffer.h"
+#include "FontSelector.h"
+#include "WidthCache.h"
 #include "WidthIterator.h"
 #include <wtf/MathExtras.h>
 #include <wtf/UnusedParam.h>
@@ -190,16 +192,32 @@ float Font::floatWidth(const TextRun& run, HashSet<const SimpleFontData*>* fallb
         return floatWidthUsingSVGFont(run);
 #endif
 
+    // If the complex text implementation cannot return fallback fonts, avoid
+    // returning them for simple text as well.
+    static bool returnFallbackFonts = canReturnFallbackFontsForComplexText();
+
+#if ENABLE(TEXT_WIDTH_CACHE)
+    // Cached widths do not record the fallback fonts used, and fonts from
+    // @font-face rules differ between documents with the same description.
+    bool useWidthCache = (!fallbackFonts || !returnFallbackFonts) && !m_isPlatformFont && !(fontSelector() && fontSelector()->hasCustomFonts());
+    float cachedWidth;
+    if (useWidthCache && WidthCache::shared().lookup(m_fontDescription, m_letterSpacing, m_wordSpacing, run, cachedWidth))
+        return cachedWidth;
+#endif
+
+    float width;
 #if USE(FONT_FAST_PATH)
-    if (canUseGlyphCache(run)) {
-        // If the complex text implementation cannot return fallback fonts, avoid
-        // returning them for simple text as well.
-        static bool returnFallbackFonts = canReturnFallbackFontsForComplexText();
-        return floatWidthForSimpleText(run, 0, returnFallbackFonts ? fallbackFonts : 0);
-    }
+    if (canUseGlyphCache(run))
+        width = floatWidthForSimpleText(run, 0, returnFallbackFonts ? fallbackFonts : 0);
+    else
 #endif
+        width = floatWidthForComplexText(run, fallbackFonts);
 
-    return floatWidthForComplexText(run, fallbackFonts);
+#if ENABLE(TEXT_WIDTH_CACHE)
+    if (useWidthCache)
+        WidthCache::shared().add(m_fontDescription, m_letterSpacing, m_wordSpacing, run, width);
+#endif
+    return width;
 }
 
 float Font::floatWidth(const TextRun& run, int extraCharsAvailable, int& charsConsumed, String& glyphName) const
@@ -35,6 +35,7 @@
 #include "FontPlatformData.h"
 #include "FontSelector.h"
 #include "StringHash.h"
+#include "WidthCache.h"
 #include <wtf/HashMap.h>
 #include <wtf/ListHashSet.h>
 #include <wtf/StdLibExtras.h>
@@ -449,6 +450,10 @@ void FontCache::invalidate()
 
     gGeneration++;
 
+#if ENABLE(TEXT_WIDTH_CACHE)
+    WidthCache::shared().clear();
+#endif
+
     Vector<RefPtr<FontSelector> > clients;
     size_t numClients = gClients->size();
     clients.reserveInitialCapacity(numClients);
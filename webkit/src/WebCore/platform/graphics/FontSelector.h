@@ -40,6 +40,10 @@ public:
     virtual FontData* getFontData(const FontDescription&, const AtomicString& familyName) = 0;
 
     virtual void fontCacheInvalidated() { }
+
+    // Whether getFontData() may return fonts the font description and the
+    // settings alone do not determine, e.g. ones loaded via @font-face.
+    virtual bool hasCustomFonts() const { return true; }
 };
 
 } // namespace WebCore
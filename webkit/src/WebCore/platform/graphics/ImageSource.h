@@ -59,6 +59,7 @@ class BBitmap;
 
 namespace WebCore {
 
+class Image;
 class IntSize;
 class SharedBuffer;
 class String;
@@ -169,6 +170,13 @@ public:
 #if PLATFORM(SGL)
     void clearURL();
     void setURL(const String& url);
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    // Whether the frame can be painted now. If not, its pixels are still
+    // being decoded and the image is told when they are ready.
+    bool frameIsReadyToPaintAtIndex(size_t, Image*);
+#endif
+    // Drops the decoded pixels of all images that are not being drawn.
+    static void purgeDecodedFrames();
 #endif
 #endif
 private:
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "WidthCache.h"
+
+#if ENABLE(TEXT_WIDTH_CACHE)
+
+#include "TextRun.h"
+#include <string.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+// Golden ratio - arbitrary start value to avoid mapping all 0's to all 0's,
+// as in StringImpl::computeHash().
+static const unsigned stringHashingStartValue = 0x9e3779b9U;
+
+static inline unsigned addToHash(unsigned hash, unsigned value)
+{
+    hash += value;
+    hash ^= hash << 11;
+    hash += hash >> 17;
+    return hash;
+}
+
+static unsigned hashFont(const FontDescription& description, short letterSpacing, short wordSpacing)
+{
+    unsigned hash = stringHashingStartValue;
+    for (const FontFamily* family = &description.family(); family; family = family->next())
+        hash = addToHash(hash, family->family().impl() ? family->family().impl()->hash() : 0);
+    union {
+        float size;
+        unsigned bits;
+    } size;
+    size.size = description.computedSize();
+    hash = addToHash(hash, size.bits);
+    hash = addToHash(hash, description.weight() | description.italic() << 16 | description.smallCaps() << 17 | description.genericFamily() << 18);
+    hash = addToHash(hash, static_cast<unsigned short>(letterSpacing) | static_cast<unsigned short>(wordSpacing) << 16);
+    return hash;
+}
+
+WidthCache& WidthCache::shared()
+{
+    DEFINE_STATIC_LOCAL(WidthCache, cache, ());
+    return cache;
+}
+
+WidthCache::WidthCache()
+    : m_lastFont(0)
+{
+    m_slots.grow(tableSize);
+    memset(m_slots.data(), 0, tableSize * sizeof(Slot));
+    memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+void WidthCache::clear()
+{
+    m_fonts.clear();
+    m_lastFont = 0;
+    memset(m_slots.data(), 0, tableSize * sizeof(Slot));
+    ++m_statistics.clears;
+}
+
+unsigned WidthCache::fontIndex(const FontDescription& description, short letterSpacing, short wordSpacing)
+{
+    unsigned hash = hashFont(description, letterSpacing, wordSpacing);
+
+    // Consecutive measurements are nearly always done with the same font.
+    if (m_lastFont < m_fonts.size()) {
+        const FontKey& key = m_fonts[m_lastFont];
+        if (key.hash == hash && key.letterSpacing == letterSpacing && key.wordSpacing == wordSpacing && key.description == description)
+            return m_lastFont;
+    }
+
+    size_t size = m_fonts.size();
+    for (size_t i = 0; i < size; ++i) {
+        const FontKey& key = m_fonts[i];
+        if (key.hash == hash && key.letterSpacing == letterSpacing && key.wordSpacing == wordSpacing && key.description == description) {
+            m_lastFont = i;
+            return i;
+        }
+    }
+
+    if (size == maximumFonts) {
+        clear();
+        size = 0;
+    }
+
+    FontKey key;
+    key.description = description;
+    key.letterSpacing = letterSpacing;
+    key.wordSpacing = wordSpacing;
+    key.hash = hash;
+    m_fonts.append(key);
+    m_lastFont = size;
+    return size;
+}
+
+WidthCache::Slot* WidthCache::slotFor(const FontDescription& description, short letterSpacing, short wordSpacing, const TextRun& run, unsigned& font, unsigned& hash)
+{
+    int length = run.length();
+    if (!length || length > static_cast<int>(maximumLength) || run.padding())
+        return 0;
+
+    // The run flags change the width of the same characters, so they are
+    // part of the key.
+    unsigned flags = run.rtl() | run.directionalOverride() << 1 | run.applyRunRounding() << 2 | run.applyWordRounding() << 3 | run.spacingDisabled() << 4;
+
+    hash = stringHashingStartValue + flags;
+    const UChar* characters = run.characters();
+    for (int i = 0; i < length; ++i) {
+        // A tab's width depends on where the run starts.
+        if (characters[i] == '\t')
+            return 0;
+        hash = addToHash(hash, characters[i]);
+    }
+
+    font = fontIndex(description, letterSpacing, wordSpacing) + 1;
+    hash = addToHash(hash, font);
+    hash = addToHash(hash, flags);
+    return &m_slots[hash & (tableSize - 1)];
+}
+
+bool WidthCache::lookup(const FontDescription& description, short letterSpacing, short wordSpacing, const TextRun& run, float& width)
+{
+    unsigned font;
+    unsigned hash;
+    Slot* slot = slotFor(description, letterSpacing, wordSpacing, run, font, hash);
+    if (!slot)
+        return false;
+
+    if (slot->font == font && slot->hash == hash && slot->length == run.length()
+        && !memcmp(slot->characters, run.characters(), run.length() * sizeof(UChar))) {
+        ++m_statistics.hits;
+        width = slot->width;
+        return true;
+    }
+
+    ++m_statistics.misses;
+    return false;
+}
+
+void WidthCache::add(const FontDescription& description, short letterSpacing, short wordSpacing, const TextRun& run, float width)
+{
+    unsigned font;
+    unsigned hash;
+    Slot* slot = slotFor(description, letterSpacing, wordSpacing, run, font, hash);
+    if (!slot)
+        return;
+
+    if (slot->font)
+        ++m_statistics.replacements;
+    slot->hash = hash;
+    slot->font = font;
+    slot->length = run.length();
+    slot->width = width;
+    memcpy(slot->characters, run.characters(), run.length() * sizeof(UChar));
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(TEXT_WIDTH_CACHE)
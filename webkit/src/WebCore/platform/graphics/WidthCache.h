@@ -0,0 +1,104 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WidthCache_h
+#define WidthCache_h
+
+#if ENABLE(TEXT_WIDTH_CACHE)
+
+#include "FontDescription.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace WebCore {
+
+    class TextRun;
+
+    // Remembers the measured width of short text runs, mostly the words line
+    // layout measures while looking for line breaks. Fonts are identified by
+    // their description and spacing rather than by their font data, so the
+    // widths stay valid across page loads. The table has a fixed number of
+    // slots and a new word simply replaces the one in its slot, which bounds
+    // the memory used.
+    //
+    // Only fonts whose description fully determines the glyphs can be cached;
+    // Font::floatWidth() checks that before using the cache.
+    class WidthCache : public Noncopyable {
+    public:
+        struct Statistics {
+            size_t hits;
+            size_t misses;
+            size_t replacements;
+            size_t clears;
+        };
+
+        static WidthCache& shared();
+
+        bool lookup(const FontDescription&, short letterSpacing, short wordSpacing, const TextRun&, float& width);
+        void add(const FontDescription&, short letterSpacing, short wordSpacing, const TextRun&, float width);
+
+        // Called when the fonts a description maps to may have changed.
+        void clear();
+
+        const Statistics& statistics() const { return m_statistics; }
+
+    private:
+        WidthCache();
+
+        static const unsigned tableSizeBits = 11;
+        static const unsigned tableSize = 1 << tableSizeBits;
+        static const unsigned maximumFonts = 256;
+        static const unsigned maximumLength = 20;
+
+        struct FontKey {
+            FontDescription description;
+            short letterSpacing;
+            short wordSpacing;
+            unsigned hash;
+        };
+
+        struct Slot {
+            unsigned hash;
+            unsigned short font; // index into m_fonts plus one, zero if unused
+            unsigned short length;
+            float width;
+            UChar characters[maximumLength];
+        };
+
+        unsigned fontIndex(const FontDescription&, short letterSpacing, short wordSpacing);
+        Slot* slotFor(const FontDescription&, short letterSpacing, short wordSpacing, const TextRun&, unsigned& font, unsigned& hash);
+
+        Vector<FontKey> m_fonts;
+        unsigned m_lastFont;
+        Vector<Slot> m_slots;
+        Statistics m_statistics;
+    };
+
+} // namespace WebCore
+
+#endif // ENABLE(TEXT_WIDTH_CACHE)
+
+#endif // WidthCache_h
@@ -195,6 +195,13 @@ void BitmapImage::draw(GraphicsContext* ctxt, const FloatRect& dstRect,
         return;
     }
 
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    // Leave the area empty while the decoding thread works on the pixels;
+    // our observer repaints it when they are ready.
+    if (!m_source.frameIsReadyToPaintAtIndex(m_currentFrame, this))
+        return;
+#endif
+
     // in case we get called with an incomplete bitmap
     const SkBitmap& bitmap = image->bitmap();
     if (bitmap.getPixels() == NULL && bitmap.pixelRef() == NULL) {
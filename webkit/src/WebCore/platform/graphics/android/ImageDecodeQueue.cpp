@@ -0,0 +1,161 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ImageDecodeQueue.h"
+
+#if ENABLE(ASYNC_IMAGE_DECODING)
+
+#include "Image.h"
+#include "ImageObserver.h"
+#include "IntRect.h"
+#include "SkPixelRef.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
+#include <wtf/MessageQueue.h>
+#include <wtf/RefPtr.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+bool ImageDecodeQueue::s_waitsForDecodes = false;
+ImageDecodeQueue::Statistics ImageDecodeQueue::s_statistics;
+
+static MessageQueue<RefPtr<ImageDecodeQueue::Request> >& decodeQueue()
+{
+    DEFINE_STATIC_LOCAL(MessageQueue<RefPtr<ImageDecodeQueue::Request> >, queue, ());
+    return queue;
+}
+
+ImageDecodeQueue::Request::Request(SkPixelRef* pixelRef)
+    : m_pixelRef(pixelRef)
+    , m_image(0)
+    , m_done(false)
+    , m_cancelled(false)
+{
+    // SkRefCnt is threadsafe, so the last reference may go on either thread.
+    m_pixelRef->ref();
+}
+
+ImageDecodeQueue::Request::~Request()
+{
+    m_pixelRef->unref();
+}
+
+bool ImageDecodeQueue::Request::readyToPaint(Image* image)
+{
+    ASSERT(isMainThread());
+    MutexLocker lock(m_mutex);
+    if (m_done)
+        return true;
+
+    if (s_waitsForDecodes) {
+        ++s_statistics.paintsWaited;
+        while (!m_done)
+            m_condition.wait(m_mutex);
+        return true;
+    }
+
+    ++s_statistics.paintsDeferred;
+    m_image = image;
+    return false;
+}
+
+void ImageDecodeQueue::Request::cancel()
+{
+    ASSERT(isMainThread());
+    m_image = 0;
+    MutexLocker lock(m_mutex);
+    m_cancelled = true;
+}
+
+void ImageDecodeQueue::Request::decode()
+{
+    {
+        MutexLocker lock(m_mutex);
+        if (m_cancelled) {
+            m_done = true;
+            m_condition.broadcast();
+            return;
+        }
+    }
+
+    double startTime = currentTime();
+    // The pixel ref keeps the pixels once they are decoded; unlocking only
+    // allows its pool to purge them again.
+    m_pixelRef->lockPixels();
+    m_pixelRef->unlockPixels();
+    s_statistics.decodeTime += currentTime() - startTime;
+    ++s_statistics.decodesCompleted;
+
+    {
+        MutexLocker lock(m_mutex);
+        m_done = true;
+        m_condition.broadcast();
+    }
+
+    ref();
+    callOnMainThread(didDecode, this);
+}
+
+void ImageDecodeQueue::Request::didDecode(void* context)
+{
+    Request* request = static_cast<Request*>(context);
+    Image* image = request->m_image;
+    if (image && image->imageObserver())
+        image->imageObserver()->changedInRect(image, IntRect(IntPoint(), image->size()));
+    request->deref();
+}
+
+PassRefPtr<ImageDecodeQueue::Request> ImageDecodeQueue::decode(SkPixelRef* pixelRef)
+{
+    ASSERT(isMainThread());
+    static ThreadIdentifier decodeThread = 0;
+    if (!decodeThread) {
+        decodeThread = createThread(ImageDecodeQueue::decodeThreadStart, 0, "WebCore: ImageDecoder");
+        if (!decodeThread)
+            return 0;
+        detachThread(decodeThread);
+    }
+
+    RefPtr<Request> request = adoptRef(new Request(pixelRef));
+    decodeQueue().append(request);
+    ++s_statistics.decodesQueued;
+    return request.release();
+}
+
+void* ImageDecodeQueue::decodeThreadStart(void*)
+{
+    RefPtr<Request> request;
+    while (decodeQueue().waitForMessage(request)) {
+        request->decode();
+        request = 0;
+    }
+    return 0;
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(ASYNC_IMAGE_DECODING)
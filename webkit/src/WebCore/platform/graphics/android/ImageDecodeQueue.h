@@ -0,0 +1,106 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ImageDecodeQueue_h
+#define ImageDecodeQueue_h
+
+#if ENABLE(ASYNC_IMAGE_DECODING)
+
+#include <wtf/Noncopyable.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+
+class SkPixelRef;
+
+namespace WebCore {
+
+    class Image;
+
+    // Decodes the pixels of complete images on a background thread, so that
+    // painting finds them ready instead of decoding on the WebCore thread.
+    // Skia serializes all SkImageRef decodes on one mutex, so a single thread
+    // is used. The decoded pixels stay in the pixel ref, where the image ref
+    // pool or ashmem may purge them again; painting then decodes as before.
+    class ImageDecodeQueue : public Noncopyable {
+    public:
+        struct Statistics {
+            size_t decodesQueued;
+            size_t decodesCompleted;
+            size_t paintsDeferred; // painted as a placeholder
+            size_t paintsWaited; // waited for the decode to finish
+            double decodeTime; // in seconds, spent on the decoding thread
+        };
+
+        class Request : public ThreadSafeShared<Request> {
+        public:
+            ~Request();
+
+            // Main thread. Returns true if painting can use the pixels now,
+            // after waiting for the decode if waitsForDecodes() is set.
+            // Otherwise the image's observer is told once the pixels are
+            // decoded, so the placeholder painted meanwhile gets repainted.
+            bool readyToPaint(Image*);
+            // The image is going away; the decode is skipped if it has not
+            // started yet.
+            void cancel();
+
+        private:
+            friend class ImageDecodeQueue;
+            Request(SkPixelRef*);
+
+            void decode();
+            static void didDecode(void*);
+
+            SkPixelRef* m_pixelRef;
+            Image* m_image; // main thread only
+            Mutex m_mutex;
+            ThreadCondition m_condition;
+            bool m_done;
+            bool m_cancelled;
+        };
+
+        // Main thread only.
+        static PassRefPtr<Request> decode(SkPixelRef*);
+
+        // When set, painting waits for pending decodes instead of painting a
+        // placeholder, which keeps the painted result deterministic.
+        static void setWaitsForDecodes(bool waits) { s_waitsForDecodes = waits; }
+        static bool waitsForDecodes() { return s_waitsForDecodes; }
+
+        static const Statistics& statistics() { return s_statistics; }
+
+    private:
+        static void* decodeThreadStart(void*);
+
+        static bool s_waitsForDecodes;
+        static Statistics s_statistics;
+    };
+
+} // namespace WebCore
+
+#endif // ENABLE(ASYNC_IMAGE_DECODING)
+
+#endif // ImageDecodeQueue_h
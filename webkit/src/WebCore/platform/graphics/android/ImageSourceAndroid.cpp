@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "BitmapAllocatorAndroid.h"
+#include "ImageDecodeQueue.h"
 #include "ImageSource.h"
 #include "IntSize.h"
 #include "NotImplemented.h"
@@ -34,6 +35,7 @@
 #include "SkBitmapRef.h"
 #include "SkImageDecoder.h"
 #include "SkImageRef.h"
+#include "SkImageRef_GlobalPool.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
 
@@ -65,9 +67,14 @@ SkPixelRef* SkCreateRLEPixelRef(const SkBitmap& src);
 
     // see dox for computeMaxBitmapSizeForCache()
     #define MAX_SIZE_BEFORE_SUBSAMPLE   (8*1024*1024)
+
+    // bytes of decoded pixels the global image ref pool keeps before it
+    // purges the least recently used ones (ashmem images are not counted)
+    #define DECODED_POOL_BUDGET         (8*1024*1024)
 #else
     #define MIN_RLE_ALLOC_SIZE          (2*1024*1024)
     #define MAX_SIZE_BEFORE_SUBSAMPLE   (2*1024*1024)
+    #define DECODED_POOL_BUDGET         (2*1024*1024)
 #endif
 
 /*  Images larger than this should be subsampled. Using ashmem, the decoded
@@ -111,6 +118,9 @@ public:
 
     int  fSampleSize;
     bool fAllDataReceived;
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    RefPtr<WebCore::ImageDecodeQueue::Request> fDecodeRequest;
+#endif
 };
 
 namespace WebCore {
@@ -120,9 +130,20 @@ ImageSource::ImageSource() {
 #ifdef ANDROID_ANIMATED_GIF
     m_decoder.m_gifDecoder = 0;
 #endif
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    static bool poolBudgetSet;
+    if (!poolBudgetSet) {
+        SkImageRef_GlobalPool::SetRAMBudget(DECODED_POOL_BUDGET);
+        poolBudgetSet = true;
+    }
+#endif
 }
 
 ImageSource::~ImageSource() {
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    if (m_decoder.m_image && m_decoder.m_image->fDecodeRequest)
+        m_decoder.m_image->fDecodeRequest->cancel();
+#endif
     delete m_decoder.m_image;
 #ifdef ANDROID_ANIMATED_GIF
     delete m_decoder.m_gifDecoder;
@@ -289,9 +310,38 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
         ref->setImmutable();
         // give it the URL if we have one
         ref->setURI(m_decoder.m_url);
+
+#if ENABLE(ASYNC_IMAGE_DECODING)
+        // RLE pixels are already decoded; the others are decoded on first
+        // lock, which we start now on the decoding thread.
+        if (decoder->fDecodeRequest)
+            decoder->fDecodeRequest->cancel();
+        if (bm->config() != SkBitmap::kRLE_Index8_Config)
+            decoder->fDecodeRequest = ImageDecodeQueue::decode(ref);
+        else
+            decoder->fDecodeRequest = 0;
+#endif
     }
 }
 
+#if ENABLE(ASYNC_IMAGE_DECODING)
+bool ImageSource::frameIsReadyToPaintAtIndex(size_t index, Image* image)
+{
+#ifdef ANDROID_ANIMATED_GIF
+    if (m_decoder.m_gifDecoder)
+        return true;
+#endif
+    if (!m_decoder.m_image || !m_decoder.m_image->fDecodeRequest)
+        return true;
+    return m_decoder.m_image->fDecodeRequest->readyToPaint(image);
+}
+#endif
+
+void ImageSource::purgeDecodedFrames()
+{
+    SkImageRef_GlobalPool::SetRAMUsed(0);
+}
+
 bool ImageSource::isSizeAvailable()
 {
     return
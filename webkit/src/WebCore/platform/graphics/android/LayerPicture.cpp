@@ -0,0 +1,88 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "LayerPicture.h"
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+
+#include "GraphicsContext.h"
+#include "PlatformGraphicsContext.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+
+namespace WebCore {
+
+LayerPicture::LayerPicture()
+    : m_picture(0)
+{
+}
+
+LayerPicture::~LayerPicture()
+{
+    ASSERT(!m_context);
+    m_picture->safeUnref();
+}
+
+GraphicsContext* LayerPicture::beginRecording(const IntRect& rect)
+{
+    ASSERT(!m_context);
+    m_picture->safeUnref();
+    m_picture = new SkPicture;
+    m_rect = rect;
+    SkCanvas* canvas = m_picture->beginRecording(rect.width(), rect.height(),
+        SkPicture::kUsePathBoundsForClip_RecordingFlag);
+    canvas->translate(SkIntToScalar(-rect.x()), SkIntToScalar(-rect.y()));
+    // No button list: layers that paint form controls are never recorded.
+    m_platformContext.set(new PlatformGraphicsContext(canvas, 0));
+    m_context.set(new GraphicsContext(m_platformContext.get()));
+    return m_context.get();
+}
+
+void LayerPicture::endRecording()
+{
+    ASSERT(m_context);
+    m_context.clear();
+    m_platformContext.clear();
+    m_picture->endRecording();
+}
+
+void LayerPicture::draw(GraphicsContext* context, const IntSize& offset, const IntRect& clip) const
+{
+    ASSERT(!m_context);
+    if (!m_picture || m_rect.isEmpty() || clip.isEmpty())
+        return;
+    SkCanvas* canvas = context->platformContext()->mCanvas;
+    canvas->save();
+    canvas->clipRect(clip);
+    canvas->translate(SkIntToScalar(m_rect.x() + offset.width()),
+        SkIntToScalar(m_rect.y() + offset.height()));
+    canvas->drawPicture(*m_picture);
+    canvas->restore();
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(LAYER_PICTURE_CACHE)
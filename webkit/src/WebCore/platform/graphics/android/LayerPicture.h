@@ -0,0 +1,73 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LayerPicture_h
+#define LayerPicture_h
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+
+#include "IntRect.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/OwnPtr.h>
+
+class SkPicture;
+
+namespace WebCore {
+
+    class GraphicsContext;
+    class IntSize;
+    class PlatformGraphicsContext;
+
+    // The recorded painting of one phase of a RenderLayer. Replaying it
+    // instead of painting the renderers again makes the page picture refer
+    // to it, the same way button pictures are shared with the page picture.
+    class LayerPicture : public Noncopyable {
+    public:
+        LayerPicture();
+        ~LayerPicture();
+
+        // Returns a context that records everything painted inside rect until
+        // endRecording(). The rect is in the coordinates the layer paints in.
+        GraphicsContext* beginRecording(const IntRect&);
+        void endRecording();
+
+        // The rect given to beginRecording().
+        const IntRect& rect() const { return m_rect; }
+
+        // Plays the recording back moved by offset, clipped to clip.
+        void draw(GraphicsContext*, const IntSize& offset, const IntRect& clip) const;
+
+    private:
+        SkPicture* m_picture;
+        IntRect m_rect;
+        OwnPtr<PlatformGraphicsContext> m_platformContext;
+        OwnPtr<GraphicsContext> m_context;
+    };
+
+} // namespace WebCore
+
+#endif // ENABLE(LAYER_PICTURE_CACHE)
+
+#endif // LayerPicture_h
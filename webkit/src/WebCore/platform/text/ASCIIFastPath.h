@@ -0,0 +1,98 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ASCIIFastPath_h
+#define ASCIIFastPath_h
+
+#include <stdint.h>
+#include <string.h>
+#include <wtf/unicode/Unicode.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace WebCore {
+
+    // Text decoders widen bytes to UTF-16 in blocks of this many bytes as
+    // long as every byte of the block is ASCII.
+    const size_t asciiBlockSize = 16;
+
+    // Widens the leading blocks of the source to UTF-16 as long as they are
+    // all ASCII, and returns the number of bytes converted: a multiple of
+    // asciiBlockSize, and 0 if the first block already contains a non-ASCII
+    // byte or less than a block is left. The caller converts the rest.
+    inline size_t copyASCIIBlocks(const uint8_t* source, UChar* destination, size_t length)
+    {
+        size_t converted = 0;
+#if defined(__ARM_NEON__)
+        for (; length - converted >= asciiBlockSize; converted += asciiBlockSize) {
+            uint8x16_t bytes = vld1q_u8(source + converted);
+            uint8x8_t ored = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+            if (vget_lane_u64(vreinterpret_u64_u8(ored), 0) & 0x8080808080808080ULL)
+                break;
+            vst1q_u16(reinterpret_cast<uint16_t*>(destination + converted), vmovl_u8(vget_low_u8(bytes)));
+            vst1q_u16(reinterpret_cast<uint16_t*>(destination + converted + 8), vmovl_u8(vget_high_u8(bytes)));
+        }
+#elif defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; length - converted >= asciiBlockSize; converted += asciiBlockSize) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + converted));
+            if (_mm_movemask_epi8(bytes))
+                break;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + converted), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + converted + 8), _mm_unpackhi_epi8(bytes, zero));
+        }
+#else
+        // No vector unit (ARMv5): test the block a machine word at a time
+        // and widen it with an unrolled loop.
+        typedef uintptr_t MachineWord;
+        const MachineWord nonASCIIMask = static_cast<MachineWord>(0x8080808080808080ULL);
+        for (; length - converted >= asciiBlockSize; converted += asciiBlockSize) {
+            MachineWord words[asciiBlockSize / sizeof(MachineWord)];
+            memcpy(words, source + converted, asciiBlockSize);
+            MachineWord ored = 0;
+            for (size_t i = 0; i < asciiBlockSize / sizeof(MachineWord); ++i)
+                ored |= words[i];
+            if (ored & nonASCIIMask)
+                break;
+            const uint8_t* block = source + converted;
+            UChar* characters = destination + converted;
+            for (size_t i = 0; i < asciiBlockSize; i += 4) {
+                characters[i] = block[i];
+                characters[i + 1] = block[i + 1];
+                characters[i + 2] = block[i + 2];
+                characters[i + 3] = block[i + 3];
+            }
+        }
+#endif
+        return converted;
+    }
+
+} // namespace WebCore
+
+#endif // ASCIIFastPath_h
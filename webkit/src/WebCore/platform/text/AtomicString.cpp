@@ -45,6 +45,27 @@ static inline HashSet<StringImpl*>& stringTable()
     return threadGlobalData().atomicStringTable();
 }
 
+static inline void recordAdd(const HashSet<StringImpl*>& table, int previousCapacity, bool isNewEntry)
+{
+    AtomicString::Statistics& statistics = threadGlobalData().atomicStringStatistics();
+    ++statistics.lookups;
+    if (isNewEntry) {
+        ++statistics.inserts;
+        if (table.capacity() != previousCapacity)
+            ++statistics.rehashes;
+    }
+}
+
+template<typename T, typename HashTranslator>
+static inline pair<HashSet<StringImpl*>::iterator, bool> addToStringTable(const T& value)
+{
+    HashSet<StringImpl*>& table = stringTable();
+    int capacity = table.capacity();
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = table.add<T, HashTranslator>(value);
+    recordAdd(table, capacity, addResult.second);
+    return addResult;
+}
+
 struct CStringTranslator {
     static unsigned hash(const char* c)
     {
@@ -87,7 +108,7 @@ PassRefPtr<StringImpl> AtomicString::add(const char* c)
         return 0;
     if (!*c)
         return StringImpl::empty();    
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<const char*, CStringTranslator>(c);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<const char*, CStringTranslator>(c);
     if (!addResult.second)
         return *addResult.first;
     return adoptRef(*addResult.first);
@@ -183,7 +204,7 @@ PassRefPtr<StringImpl> AtomicString::add(const UChar* s, int length)
         return StringImpl::empty();
     
     UCharBuffer buf = { s, length }; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<UCharBuffer, UCharBufferTranslator>(buf);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<UCharBuffer, UCharBufferTranslator>(buf);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
@@ -203,13 +224,27 @@ PassRefPtr<StringImpl> AtomicString::add(const UChar* s)
         return StringImpl::empty();
 
     UCharBuffer buf = {s, length}; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<UCharBuffer, UCharBufferTranslator>(buf);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<UCharBuffer, UCharBufferTranslator>(buf);
 
     // If the string is newly-translated, then we need to adopt it.
     // The boolean in the pair tells us if that is so.
     return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
 }
 
+PassRefPtr<StringImpl> AtomicString::add(const UChar* s, unsigned length, unsigned existingHash)
+{
+    if (!s)
+        return 0;
+
+    if (length == 0)
+        return StringImpl::empty();
+
+    ++threadGlobalData().atomicStringStatistics().precomputedHashLookups;
+    HashAndCharacters buffer = { existingHash, s, length };
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
+}
+
 PassRefPtr<StringImpl> AtomicString::add(StringImpl* r)
 {
     if (!r || r->inTable())
@@ -218,7 +253,10 @@ PassRefPtr<StringImpl> AtomicString::add(StringImpl* r)
     if (r->length() == 0)
         return StringImpl::empty();
     
-    StringImpl* result = *stringTable().add(r).first;
+    HashSet<StringImpl*>& table = stringTable();
+    int capacity = table.capacity();
+    StringImpl* result = *table.add(r).first;
+    recordAdd(table, capacity, result == r);
     if (result == r)
         r->setInTable();
     return result;
@@ -226,7 +264,16 @@ PassRefPtr<StringImpl> AtomicString::add(StringImpl* r)
 
 void AtomicString::remove(StringImpl* r)
 {
-    stringTable().remove(r);
+    HashSet<StringImpl*>& table = stringTable();
+    int capacity = table.capacity();
+    table.remove(r);
+    if (table.capacity() != capacity)
+        ++threadGlobalData().atomicStringStatistics().rehashes;
+}
+
+const AtomicString::Statistics& AtomicString::statistics()
+{
+    return threadGlobalData().atomicStringStatistics();
 }
     
 AtomicString AtomicString::lower() const
@@ -251,7 +298,7 @@ PassRefPtr<StringImpl> AtomicString::add(const JSC::Identifier& identifier)
         return StringImpl::empty();
 
     HashAndCharacters buffer = { string->computedHash(), string->data(), length }; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<HashAndCharacters, HashAndCharactersTranslator>(buffer);
     if (!addResult.second)
         return *addResult.first;
     return adoptRef(*addResult.first);
@@ -268,7 +315,7 @@ PassRefPtr<StringImpl> AtomicString::add(const JSC::UString& ustring)
         return StringImpl::empty();
 
     HashAndCharacters buffer = { string->hash(), string->data(), length }; 
-    pair<HashSet<StringImpl*>::iterator, bool> addResult = stringTable().add<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = addToStringTable<HashAndCharacters, HashAndCharactersTranslator>(buffer);
     if (!addResult.second)
         return *addResult.first;
     return adoptRef(*addResult.first);
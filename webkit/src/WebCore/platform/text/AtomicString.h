@@ -30,12 +30,22 @@ struct AtomicStringHash;
 
 class AtomicString {
 public:
+    // Counts for the calling thread's table.
+    struct Statistics {
+        size_t lookups;
+        size_t inserts;
+        size_t rehashes;
+        size_t precomputedHashLookups; // lookups that were given the hash of the characters
+    };
+
     static void init();
 
     AtomicString() { }
     AtomicString(const char* s) : m_string(add(s)) { }
     AtomicString(const UChar* s, int length) : m_string(add(s, length)) { }
     AtomicString(const UChar* s) : m_string(add(s)) { }
+    // existingHash must be StringImpl::computeHash(s, length).
+    AtomicString(const UChar* s, unsigned length, unsigned existingHash) : m_string(add(s, length, existingHash)) { }
 #if USE(JSC)
     AtomicString(const JSC::UString& s) : m_string(add(s)) { }
     AtomicString(const JSC::Identifier& s) : m_string(add(s)) { }
@@ -95,6 +105,8 @@ public:
     bool isEmpty() const { return m_string.isEmpty(); }
 
     static void remove(StringImpl*);
+
+    static const Statistics& statistics();
     
 #if PLATFORM(CF) || (PLATFORM(QT) && PLATFORM(DARWIN))
     AtomicString(CFStringRef s) :  m_string(add(String(s).impl())) { }
@@ -115,6 +127,7 @@ private:
     static PassRefPtr<StringImpl> add(const char*);
     static PassRefPtr<StringImpl> add(const UChar*, int length);
     static PassRefPtr<StringImpl> add(const UChar*);
+    static PassRefPtr<StringImpl> add(const UChar*, unsigned length, unsigned existingHash);
     static PassRefPtr<StringImpl> add(StringImpl*);
 #if USE(JSC)
     static PassRefPtr<StringImpl> add(const JSC::UString&);
@@ -255,6 +255,58 @@ inline unsigned StringImpl::computeHash(const UChar* data, unsigned length)
     return hash;
 }
 
+// Computes the same hash as StringImpl::computeHash(const UChar*, unsigned)
+// one character at a time, for callers that see a string's characters before
+// they know where it ends.
+class StringHasher {
+public:
+    StringHasher()
+        : m_hash(phi)
+        , m_hasPendingCharacter(false)
+        , m_pendingCharacter(0)
+    {
+    }
+
+    void addCharacter(UChar character)
+    {
+        if (!m_hasPendingCharacter) {
+            m_pendingCharacter = character;
+            m_hasPendingCharacter = true;
+            return;
+        }
+        m_hash += m_pendingCharacter;
+        unsigned tmp = (character << 11) ^ m_hash;
+        m_hash = (m_hash << 16) ^ tmp;
+        m_hash += m_hash >> 11;
+        m_hasPendingCharacter = false;
+    }
+
+    unsigned hash() const
+    {
+        unsigned hash = m_hash;
+
+        if (m_hasPendingCharacter) {
+            hash += m_pendingCharacter;
+            hash ^= hash << 11;
+            hash += hash >> 17;
+        }
+
+        hash ^= hash << 3;
+        hash += hash >> 5;
+        hash ^= hash << 2;
+        hash += hash >> 15;
+        hash ^= hash << 10;
+        hash |= !hash << 31;
+
+        return hash;
+    }
+
+private:
+    unsigned m_hash;
+    bool m_hasPendingCharacter;
+    UChar m_pendingCharacter;
+};
+
 // Paul Hsieh's SuperFastHash
 // http://www.azillionmonkeys.com/qed/hash.html
 inline unsigned StringImpl::computeHash(const char* data)
@@ -26,6 +26,7 @@
 #include "config.h"
 #include "TextCodecLatin1.h"
 
+#include "ASCIIFastPath.h"
 #include "CString.h"
 #include "PlatformString.h"
 #include "StringBuffer.h"
@@ -122,21 +123,15 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
     UChar* characters;
     String result = String::createUninitialized(length, characters);
 
-    // Convert the string a fast way and simultaneously do an efficient check to see if it's all ASCII.
-    unsigned char ored = 0;
-    for (size_t i = 0; i < length; ++i) {
-        unsigned char c = bytes[i];
-        characters[i] = c;
-        ored |= c;
-    }
-
-    if (!(ored & 0x80))
-        return result;
-
-    // Convert the slightly slower way when there are non-ASCII characters.
-    for (size_t i = 0; i < length; ++i) {
-        unsigned char c = bytes[i];
-        characters[i] = table[c];
+    // Widen runs of ASCII a block at a time and fall back to the table for
+    // blocks that contain other bytes.
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
+    size_t i = 0;
+    while (i < length) {
+        i += copyASCIIBlocks(source + i, characters + i, length - i);
+        size_t blockEnd = std::min(length, i + asciiBlockSize);
+        for (; i < blockEnd; ++i)
+            characters[i] = table[source[i]];
     }
 
     return result;
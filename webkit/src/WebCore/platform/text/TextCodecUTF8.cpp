@@ -0,0 +1,234 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TextCodecUTF8.h"
+
+#include "ASCIIFastPath.h"
+#include "CString.h"
+#include "CharacterNames.h"
+#include "StringBuffer.h"
+#include <wtf/PassOwnPtr.h>
+
+namespace WebCore {
+
+const int maxSequenceLength = 4;
+const UChar32 sequenceInvalid = -1;
+const UChar32 sequenceIncomplete = -2;
+
+void TextCodecUTF8::registerEncodingNames(EncodingNameRegistrar registrar)
+{
+    registrar("UTF-8", "UTF-8");
+}
+
+static PassOwnPtr<TextCodec> newStreamingTextDecoderUTF8(const TextEncoding&, const void*)
+{
+    return new TextCodecUTF8;
+}
+
+void TextCodecUTF8::registerCodecs(TextCodecRegistrar registrar)
+{
+    registrar("UTF-8", newStreamingTextDecoderUTF8, 0);
+}
+
+static inline int nonASCIISequenceLength(uint8_t firstByte)
+{
+    // C0 and C1 would only start overlong forms, and F5 and up code points
+    // above U+10FFFF.
+    if (firstByte < 0xC2)
+        return 0;
+    if (firstByte < 0xE0)
+        return 2;
+    if (firstByte < 0xF0)
+        return 3;
+    if (firstByte < 0xF5)
+        return 4;
+    return 0;
+}
+
+// Decodes the sequence starting with a non-ASCII byte. Returns the code
+// point, sequenceIncomplete if the available bytes are a valid but
+// unfinished prefix, or sequenceInvalid. In every case length is set to the
+// number of bytes to consume; for invalid input that is the maximal
+// subsequence that was still a valid prefix, so decoding resumes at the
+// byte that broke it.
+static inline UChar32 decodeNonASCIISequence(const uint8_t* sequence, size_t available, int& length)
+{
+    uint8_t firstByte = sequence[0];
+    int needed = nonASCIISequenceLength(firstByte);
+    if (!needed) {
+        length = 1;
+        return sequenceInvalid;
+    }
+
+    // The second byte range excludes overlong forms, surrogates and code
+    // points above U+10FFFF.
+    uint8_t lower = 0x80;
+    uint8_t upper = 0xBF;
+    if (firstByte == 0xE0)
+        lower = 0xA0;
+    else if (firstByte == 0xED)
+        upper = 0x9F;
+    else if (firstByte == 0xF0)
+        lower = 0x90;
+    else if (firstByte == 0xF4)
+        upper = 0x8F;
+
+    UChar32 character = firstByte & (0xFF >> (needed + 1));
+    for (int i = 1; i < needed; ++i) {
+        if (static_cast<size_t>(i) == available) {
+            length = i;
+            return sequenceIncomplete;
+        }
+        uint8_t byte = sequence[i];
+        if (byte < lower || byte > upper) {
+            length = i;
+            return sequenceInvalid;
+        }
+        lower = 0x80;
+        upper = 0xBF;
+        character = (character << 6) | (byte & 0x3F);
+    }
+    length = needed;
+    return character;
+}
+
+static inline void appendCharacter(UChar*& destination, UChar32 character)
+{
+    if (character <= 0xFFFF)
+        *destination++ = character;
+    else {
+        *destination++ = U16_LEAD(character);
+        *destination++ = U16_TRAIL(character);
+    }
+}
+
+String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool stopOnError, bool& sawError)
+{
+    // A byte never produces more than one UTF-16 code unit: four byte
+    // sequences become surrogate pairs, and each invalid subsequence a
+    // single replacement character.
+    StringBuffer buffer(m_partialSequenceSize + length);
+    UChar* destination = buffer.characters();
+
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
+    const uint8_t* end = source + length;
+
+    if (m_partialSequenceSize) {
+        uint8_t sequence[maxSequenceLength];
+        size_t fromSource = std::min<size_t>(maxSequenceLength - m_partialSequenceSize, length);
+        memcpy(sequence, m_partialSequence, m_partialSequenceSize);
+        memcpy(sequence + m_partialSequenceSize, source, fromSource);
+        int sequenceLength;
+        UChar32 character = decodeNonASCIISequence(sequence, m_partialSequenceSize + fromSource, sequenceLength);
+        if (character == sequenceIncomplete && !flush) {
+            memcpy(m_partialSequence, sequence, sequenceLength);
+            m_partialSequenceSize = sequenceLength;
+            buffer.shrink(0);
+            return String::adopt(buffer);
+        }
+        // The saved bytes were a valid prefix, so the sequence always ends
+        // at or after them.
+        ASSERT(sequenceLength >= m_partialSequenceSize);
+        source += sequenceLength - m_partialSequenceSize;
+        m_partialSequenceSize = 0;
+        if (character < 0) {
+            sawError = true;
+            if (stopOnError) {
+                buffer.shrink(0);
+                return String::adopt(buffer);
+            }
+            *destination++ = replacementCharacter;
+        } else
+            appendCharacter(destination, character);
+    }
+
+    while (source < end) {
+        if (*source < 0x80) {
+            size_t converted = copyASCIIBlocks(source, destination, end - source);
+            if (converted) {
+                source += converted;
+                destination += converted;
+            } else
+                *destination++ = *source++;
+            continue;
+        }
+
+        int sequenceLength;
+        UChar32 character = decodeNonASCIISequence(source, end - source, sequenceLength);
+        if (character == sequenceIncomplete && !flush) {
+            memcpy(m_partialSequence, source, sequenceLength);
+            m_partialSequenceSize = sequenceLength;
+            break;
+        }
+        source += sequenceLength;
+        if (character < 0) {
+            sawError = true;
+            if (stopOnError)
+                break;
+            *destination++ = replacementCharacter;
+            continue;
+        }
+        appendCharacter(destination, character);
+    }
+
+    buffer.shrink(destination - buffer.characters());
+    return String::adopt(buffer);
+}
+
+CString TextCodecUTF8::encode(const UChar* characters, size_t length, UnencodableHandling)
+{
+    // Every code unit takes at most three bytes; a surrogate pair takes
+    // four for two units. Unpaired surrogates are encoded as U+FFFD.
+    Vector<char> result(length * 3);
+    char* bytes = result.data();
+
+    size_t resultLength = 0;
+    for (size_t i = 0; i < length; ) {
+        UChar32 c;
+        U16_NEXT(characters, i, length, c);
+        if (U16_IS_SURROGATE(c))
+            c = replacementCharacter;
+        if (c < 0x80)
+            bytes[resultLength++] = c;
+        else if (c < 0x800) {
+            bytes[resultLength++] = 0xC0 | (c >> 6);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        } else if (c < 0x10000) {
+            bytes[resultLength++] = 0xE0 | (c >> 12);
+            bytes[resultLength++] = 0x80 | ((c >> 6) & 0x3F);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        } else {
+            bytes[resultLength++] = 0xF0 | (c >> 18);
+            bytes[resultLength++] = 0x80 | ((c >> 12) & 0x3F);
+            bytes[resultLength++] = 0x80 | ((c >> 6) & 0x3F);
+            bytes[resultLength++] = 0x80 | (c & 0x3F);
+        }
+    }
+
+    return CString(bytes, resultLength);
+}
+
+} // namespace WebCore
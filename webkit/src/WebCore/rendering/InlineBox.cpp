@@ -66,7 +66,7 @@ void InlineBox::destroy(RenderArena* renderArena)
 
 void* InlineBox::operator new(size_t sz, RenderArena* renderArena) throw()
 {
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::InlineBoxAllocation);
 }
 
 void InlineBox::operator delete(void* ptr, size_t sz)
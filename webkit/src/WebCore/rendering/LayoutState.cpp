@@ -113,7 +113,7 @@ void LayoutState::destroy(RenderArena* renderArena)
 
 void* LayoutState::operator new(size_t sz, RenderArena* renderArena) throw()
 {
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::LayoutAllocation);
 }
 
 void LayoutState::operator delete(void* ptr, size_t sz)
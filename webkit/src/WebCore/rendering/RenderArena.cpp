@@ -56,6 +56,8 @@ typedef struct {
 
 #endif
 
+static RenderArena::Statistics renderArenaStatistics;
+
 RenderArena::RenderArena(unsigned arenaSize)
 {
     // Initialize the arena pool
@@ -67,11 +69,14 @@ RenderArena::RenderArena(unsigned arenaSize)
 
 RenderArena::~RenderArena()
 {
-    FinishArenaPool(&m_pool);
+    // Keep the arenas on the freelist so that the render tree of the next
+    // document does not have to get them from the heap again.
+    FreeArenaPool(&m_pool);
 }
 
-void* RenderArena::allocate(size_t size)
+void* RenderArena::allocate(size_t size, AllocationType type)
 {
+    ++renderArenaStatistics.allocations[type];
 #ifndef NDEBUG
     // Use standard malloc so that memory debugging tools work.
     ASSERT(this);
@@ -96,6 +101,7 @@ void* RenderArena::allocate(size_t size)
             // Need to move to the next object
             void* next = *((void**)result);
             m_recyclers[index] = next;
+            ++renderArenaStatistics.recycled;
         }
     }
 
@@ -110,6 +116,7 @@ void* RenderArena::allocate(size_t size)
 
 void RenderArena::free(size_t size, void* ptr)
 {
+    ++renderArenaStatistics.frees;
 #ifndef NDEBUG
     // Use standard free so that memory debugging tools work.
     RenderArenaDebugHeader* header = static_cast<RenderArenaDebugHeader*>(ptr) - 1;
@@ -132,6 +139,20 @@ void RenderArena::free(size_t size, void* ptr)
 #endif
 }
 
+const RenderArena::Statistics& RenderArena::statistics()
+{
+    const ArenaStatistics& arenaStatistics = GetArenaStatistics();
+    renderArenaStatistics.heapArenas = arenaStatistics.heapArenas;
+    renderArenaStatistics.reusedArenas = arenaStatistics.reusedArenas;
+    renderArenaStatistics.freeArenas = arenaStatistics.freeArenas;
+    return renderArenaStatistics;
+}
+
+void RenderArena::releaseFreeArenas()
+{
+    ReleaseFreeArenas();
+}
+
 #ifdef ANDROID_INSTRUMENT
 size_t RenderArena::reportPoolSize() const
 {
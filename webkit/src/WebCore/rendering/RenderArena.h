@@ -43,13 +43,36 @@ static const size_t gMaxRecycledSize = 400;
 
 class RenderArena {
 public:
+    enum AllocationType {
+        RenderObjectAllocation,
+        InlineBoxAllocation,
+        LayerAllocation,
+        LayoutAllocation, // BidiRuns and LayoutStates
+        AllocationTypeCount
+    };
+
+    // Counts for all render arenas since startup.
+    struct Statistics {
+        size_t allocations[AllocationTypeCount];
+        size_t recycled; // allocations served from the free lists
+        size_t frees;
+        size_t heapArenas; // 4KB arenas taken from the heap
+        size_t reusedArenas; // arenas taken back from an earlier document
+        size_t freeArenas; // arenas kept for the next document
+    };
+
     RenderArena(unsigned arenaSize = 4096);
     ~RenderArena();
 
     // Memory management functions
-    void* allocate(size_t);
+    void* allocate(size_t, AllocationType);
     void free(size_t, void*);
 
+    static const Statistics& statistics();
+
+    // Returns the arenas kept for the next document to the heap.
+    static void releaseFreeArenas();
+
 #ifdef ANDROID_INSTRUMENT
     size_t reportPoolSize() const;
 #endif
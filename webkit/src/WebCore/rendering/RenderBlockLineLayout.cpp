@@ -158,7 +158,7 @@ void* BidiRun::operator new(size_t sz, RenderArena* renderArena) throw()
 #ifndef NDEBUG
     bidiRunCounter.increment();
 #endif
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::LayoutAllocation);
 }
 
 void BidiRun::operator delete(void* ptr, size_t sz)
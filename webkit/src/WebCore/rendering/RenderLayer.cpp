@@ -62,6 +62,9 @@
 #include "HTMLNames.h"
 #include "HitTestRequest.h"
 #include "HitTestResult.h"
+#if ENABLE(LAYER_PICTURE_CACHE)
+#include "LayerPicture.h"
+#endif
 #include "OverflowEvent.h"
 #include "OverlapTestRequestClient.h"
 #include "Page.h"
@@ -104,9 +107,21 @@ using namespace HTMLNames;
 const int MinimumWidthWhileResizing = 100;
 const int MinimumHeightWhileResizing = 40;
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+// A layer is recorded the second time it paints without having changed, so
+// that content that changes on every paint is not recorded in vain.
+const unsigned PaintsBeforeRecordingPictures = 2;
+// Larger layers, usually most of the page, change too often and replay
+// too much of themselves for small repaints.
+const int MaximumPictureArea = 1024 * 1024;
+
+bool RenderLayer::s_picturesEnabled = true;
+RenderLayer::PictureStatistics RenderLayer::s_pictureStatistics;
+#endif
+
 void* ClipRects::operator new(size_t sz, RenderArena* renderArena) throw()
 {
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::LayerAllocation);
 }
 
 void ClipRects::operator delete(void* ptr, size_t sz)
@@ -168,6 +183,12 @@ RenderLayer::RenderLayer(RenderBoxModelObject* renderer)
 #if USE(ACCELERATED_COMPOSITING)
     , m_hasCompositingDescendant(false)
     , m_mustOverlapCompositedLayers(false)
+#endif
+#if ENABLE(LAYER_PICTURE_CACHE)
+    , m_wasSelfPaintingLayer(isSelfPaintingLayer())
+    , m_keepPicturesOnRepaint(false)
+    , m_picturesNotRecordable(false)
+    , m_paintsSincePictureInvalidation(0)
 #endif
     , m_marquee(0)
     , m_staticX(0)
@@ -175,6 +196,9 @@ RenderLayer::RenderLayer(RenderBoxModelObject* renderer)
     , m_reflection(0)
     , m_scrollCorner(0)
     , m_resizer(0)
+#if ENABLE(LAYER_PICTURE_CACHE)
+    , m_pictureGeneration(0)
+#endif
 {
     if (!renderer->firstChild() && renderer->style()) {
         m_visibleContentStatusDirty = false;
@@ -290,12 +314,19 @@ void RenderLayer::updateLayerPositions(UpdateLayerPositionsFlags flags)
         IntRect newOutlineBox = renderer()->outlineBoundsForRepaint(repaintContainer);
         if (flags & CheckForRepaint) {
             if (view && !view->printing()) {
+#if ENABLE(LAYER_PICTURE_CACHE)
+                // Our pictures can be replayed at the new position if we only moved.
+                m_keepPicturesOnRepaint = !m_needsFullRepaint && newRect.size() == m_repaintRect.size() && newOutlineBox.size() == m_outlineBox.size();
+#endif
                 if (m_needsFullRepaint) {
                     renderer()->repaintUsingContainer(repaintContainer, m_repaintRect);
                     if (newRect != m_repaintRect)
                         renderer()->repaintUsingContainer(repaintContainer, newRect);
                 } else
                     renderer()->repaintAfterLayoutIfNeeded(repaintContainer, m_repaintRect, m_outlineBox);
+#if ENABLE(LAYER_PICTURE_CACHE)
+                m_keepPicturesOnRepaint = false;
+#endif
             }
         }
         m_repaintRect = newRect;
@@ -806,7 +837,7 @@ void RenderLayer::beginTransparencyLayers(GraphicsContext* p, const RenderLayer*
 
 void* RenderLayer::operator new(size_t sz, RenderArena* renderArena) throw()
 {
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::LayerAllocation);
 }
 
 void RenderLayer::operator delete(void* ptr, size_t sz)
@@ -840,6 +871,11 @@ void RenderLayer::addChild(RenderLayer* child, RenderLayer* beforeChild)
 
     child->setParent(this);
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // Our pictures may include the child's renderer.
+    invalidatePictures();
+#endif
+
     if (child->isNormalFlowOnly())
         dirtyNormalFlowList();
 
@@ -877,6 +913,10 @@ RenderLayer* RenderLayer::removeChild(RenderLayer* oldChild)
     if (m_last == oldChild)
         m_last = oldChild->previousSibling();
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    invalidatePictures();
+#endif
+
     if (oldChild->isNormalFlowOnly())
         dirtyNormalFlowList();
     if (!oldChild->isNormalFlowOnly() || oldChild->firstChild()) { 
@@ -2209,6 +2249,11 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
 
     // We want to paint our layer, but only if we intersect the damage rect.
     bool shouldPaint = intersectsDamageRect(layerBounds, damageRect, rootLayer) && m_hasVisibleContent && isSelfPaintingLayer();
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+    bool paintPictures = shouldPaint && !selectionOnly && !paintingRootForRenderer
+        && preparePictures(rootLayer, p, tx, ty, localPaintFlags & PaintLayerTemporaryClipRects);
+#endif
     if (shouldPaint && !selectionOnly && !damageRect.isEmpty()) {
         // Begin transparency layers lazily now that we know we have to paint something.
         if (haveTransparency)
@@ -2220,6 +2265,11 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
 
         // Paint the background.
         RenderObject::PaintInfo paintInfo(p, damageRect, PaintPhaseBlockBackground, false, paintingRootForRenderer, 0);
+#if ENABLE(LAYER_PICTURE_CACHE)
+        if (paintPictures)
+            m_backgroundPicture->draw(p, IntSize(tx, ty) - m_pictureOffset, damageRect);
+        else
+#endif
         renderer()->paint(paintInfo, tx, ty);
 
         // Restore the clip.
@@ -2239,19 +2289,12 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
 
         // Set up the clip used when painting our children.
         setClip(p, paintDirtyRect, clipRectToApply);
-        RenderObject::PaintInfo paintInfo(p, clipRectToApply, 
-                                          selectionOnly ? PaintPhaseSelection : PaintPhaseChildBlockBackgrounds,
-                                          forceBlackText, paintingRootForRenderer, 0);
-        renderer()->paint(paintInfo, tx, ty);
-        if (!selectionOnly) {
-            paintInfo.phase = PaintPhaseFloat;
-            renderer()->paint(paintInfo, tx, ty);
-            paintInfo.phase = PaintPhaseForeground;
-            paintInfo.overlapTestRequests = overlapTestRequests;
-            renderer()->paint(paintInfo, tx, ty);
-            paintInfo.phase = PaintPhaseChildOutlines;
-            renderer()->paint(paintInfo, tx, ty);
-        }
+#if ENABLE(LAYER_PICTURE_CACHE)
+        if (paintPictures)
+            m_foregroundPicture->draw(p, IntSize(tx, ty) - m_pictureOffset, clipRectToApply);
+        else
+#endif
+        paintForeground(p, clipRectToApply, selectionOnly, forceBlackText, paintingRootForRenderer, overlapTestRequests, tx, ty);
 
         // Now restore our clip.
         restoreClip(p, paintDirtyRect, clipRectToApply);
@@ -2294,6 +2337,151 @@ void RenderLayer::paintLayer(RenderLayer* rootLayer, GraphicsContext* p,
     }
 }
 
+void RenderLayer::paintForeground(GraphicsContext* p, const IntRect& clipRect, bool selectionOnly, bool forceBlackText,
+                                  RenderObject* paintingRoot, RenderObject::OverlapTestRequestMap* overlapTestRequests, int tx, int ty)
+{
+    RenderObject::PaintInfo paintInfo(p, clipRect, 
+                                      selectionOnly ? PaintPhaseSelection : PaintPhaseChildBlockBackgrounds,
+                                      forceBlackText, paintingRoot, 0);
+    renderer()->paint(paintInfo, tx, ty);
+    if (!selectionOnly) {
+        paintInfo.phase = PaintPhaseFloat;
+        renderer()->paint(paintInfo, tx, ty);
+        paintInfo.phase = PaintPhaseForeground;
+        paintInfo.overlapTestRequests = overlapTestRequests;
+        renderer()->paint(paintInfo, tx, ty);
+        paintInfo.phase = PaintPhaseChildOutlines;
+        renderer()->paint(paintInfo, tx, ty);
+    }
+}
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+static bool pictureCovers(const LayerPicture* picture, const IntSize& delta, const IntRect& rect)
+{
+    if (rect.isEmpty())
+        return true;
+    IntRect pictureRect = picture->rect();
+    pictureRect.move(delta);
+    return pictureRect.contains(rect);
+}
+
+// Returns true if the background and foreground of this paint can be drawn
+// from m_backgroundPicture and m_foregroundPicture, recording them first if
+// this layer has painted unchanged before.
+bool RenderLayer::preparePictures(RenderLayer* rootLayer, GraphicsContext* p, int tx, int ty, bool temporaryClipRects)
+{
+    if (!s_picturesEnabled || p->paintingDisabled() || p->updatingControlTints())
+        return false;
+
+    RenderView* view = renderer()->view();
+    if (view->printing())
+        return false;
+    if (m_pictureGeneration != view->layerPictureGeneration()) {
+        clearPictures();
+        m_pictureGeneration = view->layerPictureGeneration();
+    }
+    if (m_picturesNotRecordable)
+        return false;
+
+    // Everything we may paint, whatever the dirty rect of this paint is.
+    IntRect layerBounds, backgroundRect, foregroundRect, outlineRect;
+    calculateRects(rootLayer, boundingBox(rootLayer), layerBounds, backgroundRect, foregroundRect, outlineRect, temporaryClipRects);
+
+    IntSize offset(tx, ty);
+    if (m_backgroundPicture) {
+        IntSize delta = offset - m_pictureOffset;
+        if (pictureCovers(m_backgroundPicture.get(), delta, backgroundRect) && pictureCovers(m_foregroundPicture.get(), delta, foregroundRect)) {
+            ++s_pictureStatistics.picturesReplayed;
+            return true;
+        }
+        // Our clip rects changed; record again.
+        m_backgroundPicture.clear();
+        m_foregroundPicture.clear();
+    } else {
+        if (m_paintsSincePictureInvalidation < PaintsBeforeRecordingPictures)
+            ++m_paintsSincePictureInvalidation;
+        if (m_paintsSincePictureInvalidation < PaintsBeforeRecordingPictures)
+            return false;
+    }
+
+    IntRect pictureBounds = unionRect(backgroundRect, foregroundRect);
+    if (static_cast<double>(pictureBounds.width()) * pictureBounds.height() > MaximumPictureArea || hasUnrecordableContent()) {
+        m_picturesNotRecordable = true;
+        ++s_pictureStatistics.layersNotRecordable;
+        return false;
+    }
+
+    m_backgroundPicture.set(new LayerPicture);
+    GraphicsContext* context = m_backgroundPicture->beginRecording(backgroundRect);
+    RenderObject::PaintInfo paintInfo(context, backgroundRect, PaintPhaseBlockBackground, false, 0, 0);
+    renderer()->paint(paintInfo, tx, ty);
+    m_backgroundPicture->endRecording();
+
+    m_foregroundPicture.set(new LayerPicture);
+    context = m_foregroundPicture->beginRecording(foregroundRect);
+    paintForeground(context, foregroundRect, false, false, 0, 0, tx, ty);
+    m_foregroundPicture->endRecording();
+
+    m_pictureOffset = offset;
+    ++s_pictureStatistics.layersRecorded;
+    return true;
+}
+
+bool RenderLayer::hasUnrecordableContent() const
+{
+    // The view and the root paint the document background, which depends on
+    // the size of the view and of the document.
+    RenderObject* layerRenderer = renderer();
+    if (layerRenderer->isRenderView() || layerRenderer->isRoot())
+        return true;
+
+    RenderObject* o = layerRenderer;
+    while (o) {
+        if (o != layerRenderer && o->hasLayer() && toRenderBoxModelObject(o)->layer()->isSelfPaintingLayer()) {
+            // Painted by its own layer.
+            o = o->nextInPreOrderAfterChildren(layerRenderer);
+            continue;
+        }
+        // Widgets and form controls are drawn from state the render tree does
+        // not track, and Android records buttons into pictures of their own.
+        if (o->isWidget() || o->isMedia() || o->style()->hasAppearance())
+            return true;
+        // Fixed backgrounds move with the scroll position, and scrollbars are
+        // positioned as they paint.
+        if (o->style()->hasFixedBackgroundImage())
+            return true;
+        if (o->hasLayer()) {
+            RenderLayer* layer = toRenderBoxModelObject(o)->layer();
+            if (layer->horizontalScrollbar() || layer->verticalScrollbar())
+                return true;
+        }
+        o = o->nextInPreOrder(layerRenderer);
+    }
+    return false;
+}
+
+void RenderLayer::invalidatePictures()
+{
+    // Layers that do not paint themselves are painted by an ancestor.
+    RenderLayer* layer = this;
+    while (!layer->isSelfPaintingLayer() && layer->parent())
+        layer = layer->parent();
+    if (layer->m_keepPicturesOnRepaint)
+        return;
+    if (layer->m_backgroundPicture)
+        ++s_pictureStatistics.layersInvalidated;
+    layer->clearPictures();
+}
+
+void RenderLayer::clearPictures()
+{
+    m_backgroundPicture.clear();
+    m_foregroundPicture.clear();
+    m_paintsSincePictureInvalidation = 0;
+    m_picturesNotRecordable = false;
+}
+#endif // ENABLE(LAYER_PICTURE_CACHE)
+
 static inline IntRect frameVisibleRect(RenderObject* renderer)
 {
     FrameView* frameView = renderer->document()->view();
@@ -3261,6 +3449,16 @@ void RenderLayer::styleChanged(StyleDifference diff, const RenderStyle*)
         dirtyStackingContextZOrderLists();
     }
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // The parent layer paints our renderer unless we paint it ourselves.
+    bool isSelfPainting = isSelfPaintingLayer();
+    if (isSelfPainting != m_wasSelfPaintingLayer) {
+        m_wasSelfPaintingLayer = isSelfPainting;
+        if (parent())
+            parent()->invalidatePictures();
+    }
+#endif
+
     if (renderer()->style()->overflowX() == OMARQUEE && renderer()->style()->marqueeBehavior() != MNONE) {
         if (!m_marquee)
             m_marquee = new RenderMarquee(this);
@@ -56,6 +56,9 @@ class CachedResource;
 class HitTestRequest;
 class HitTestResult;
 class HitTestingTransformState;
+#if ENABLE(LAYER_PICTURE_CACHE)
+class LayerPicture;
+#endif
 class RenderFrameSet;
 class RenderMarquee;
 class RenderReplica;
@@ -183,6 +186,21 @@ public:
 
     void repaintIncludingDescendants();
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    struct PictureStatistics {
+        size_t layersRecorded;
+        size_t picturesReplayed;
+        size_t layersInvalidated;
+        size_t layersNotRecordable; // too large, or painting widgets or form controls
+    };
+
+    // Drops the pictures of the layer that paints this layer's contents.
+    void invalidatePictures();
+
+    static void setPicturesEnabled(bool enabled) { s_picturesEnabled = enabled; }
+    static const PictureStatistics& pictureStatistics() { return s_pictureStatistics; }
+#endif
+
 #if USE(ACCELERATED_COMPOSITING)
     // Indicate that the layer contents need to be repainted. Only has an effect
     // if layer compositing is being used,
@@ -467,6 +485,14 @@ private:
     void paintLayer(RenderLayer* rootLayer, GraphicsContext*, const IntRect& paintDirtyRect,
                     PaintRestriction, RenderObject* paintingRoot, RenderObject::OverlapTestRequestMap* = 0,
                     PaintLayerFlags paintFlags = 0);
+    void paintForeground(GraphicsContext*, const IntRect& clipRect, bool selectionOnly, bool forceBlackText,
+                         RenderObject* paintingRoot, RenderObject::OverlapTestRequestMap*, int tx, int ty);
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+    bool preparePictures(RenderLayer* rootLayer, GraphicsContext*, int tx, int ty, bool temporaryClipRects);
+    bool hasUnrecordableContent() const;
+    void clearPictures();
+#endif
 
     RenderLayer* hitTestLayer(RenderLayer* rootLayer, RenderLayer* containerLayer, const HitTestRequest& request, HitTestResult& result,
                             const IntRect& hitTestRect, const IntPoint& hitTestPoint, bool appliedTransform,
@@ -628,6 +654,12 @@ protected:
     bool m_hasCompositingDescendant : 1;
     bool m_mustOverlapCompositedLayers : 1;
 #endif
+#if ENABLE(LAYER_PICTURE_CACHE)
+    bool m_wasSelfPaintingLayer : 1; // as of the last style change
+    bool m_keepPicturesOnRepaint : 1; // set while a layer that only moved repaints
+    bool m_picturesNotRecordable : 1; // until the next invalidation
+    unsigned m_paintsSincePictureInvalidation : 2;
+#endif
 
     RenderMarquee* m_marquee; // Used by layers with overflow:marquee
     
@@ -644,6 +676,19 @@ protected:
     RenderScrollbarPart* m_scrollCorner;
     RenderScrollbarPart* m_resizer;
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // What renderer() and the renderers painted with it draw before and
+    // after the negative z-order children, recorded when the layer was
+    // painted at m_pictureOffset.
+    OwnPtr<LayerPicture> m_backgroundPicture;
+    OwnPtr<LayerPicture> m_foregroundPicture;
+    IntSize m_pictureOffset;
+    unsigned m_pictureGeneration;
+
+    static bool s_picturesEnabled;
+    static PictureStatistics s_pictureStatistics;
+#endif
+
 #if USE(ACCELERATED_COMPOSITING)
     OwnPtr<RenderLayerBacking> m_backing;
 #endif
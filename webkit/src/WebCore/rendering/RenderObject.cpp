@@ -78,7 +78,7 @@ bool RenderObject::s_affectsParentBlock = false;
 
 void* RenderObject::operator new(size_t sz, RenderArena* renderArena) throw()
 {
-    return renderArena->allocate(sz);
+    return renderArena->allocate(sz, RenderArena::RenderObjectAllocation);
 }
 
 void RenderObject::operator delete(void* ptr, size_t sz)
@@ -1115,6 +1115,12 @@ RenderBoxModelObject* RenderObject::containerForRepaint() const
 
 void RenderObject::repaintUsingContainer(RenderBoxModelObject* repaintContainer, const IntRect& r, bool immediate)
 {
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // Whatever changed here is part of what our layer recorded.
+    if (RenderLayer* layer = enclosingLayer())
+        layer->invalidatePictures();
+#endif
+
     if (!repaintContainer || repaintContainer->isRenderView()) {
         RenderView* v = repaintContainer ? toRenderView(repaintContainer) : view();
         v->repaintViewRectangle(r, immediate);
@@ -54,6 +54,9 @@ RenderView::RenderView(Node* node, FrameView* view)
     , m_maximalOutlineSize(0)
     , m_layoutState(0)
     , m_layoutStateDisableCount(0)
+#if ENABLE(LAYER_PICTURE_CACHE)
+    , m_layerPictureGeneration(0)
+#endif
 {
     // Clear our anonymous bit, set because RenderObject assumes
     // any renderer with document as the node is anonymous.
@@ -258,6 +261,12 @@ void RenderView::repaintRectangleInViewAndCompositedLayers(const IntRect& ur, bo
     if (!shouldRepaint(ur))
         return;
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // The caret and the selection repaint this way, without telling the
+    // renderer that paints them.
+    invalidateLayerPictures();
+#endif
+
     repaintViewRectangle(ur, immediate);
     
 #if USE(ACCELERATED_COMPOSITING)
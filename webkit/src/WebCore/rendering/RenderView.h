@@ -121,6 +121,13 @@ public:
 
     bool doingFullRepaint() const { return m_frameView->needsFullRepaint(); }
 
+#if ENABLE(LAYER_PICTURE_CACHE)
+    // Makes every layer drop the pictures it recorded so far. Needed when
+    // painting changes without the renderers repainting themselves.
+    void invalidateLayerPictures() { ++m_layerPictureGeneration; }
+    unsigned layerPictureGeneration() const { return m_layerPictureGeneration; }
+#endif
+
     void pushLayoutState(RenderBox* renderer, const IntSize& offset)
     {
         if (doingFullRepaint())
@@ -203,6 +210,9 @@ private:
     bool m_forcedPageBreak;
     LayoutState* m_layoutState;
     unsigned m_layoutStateDisableCount;
+#if ENABLE(LAYER_PICTURE_CACHE)
+    unsigned m_layerPictureGeneration;
+#endif
 #if USE(ACCELERATED_COMPOSITING)
     OwnPtr<RenderLayerCompositor> m_compositor;
 #endif
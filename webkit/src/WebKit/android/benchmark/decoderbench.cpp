@@ -0,0 +1,208 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Text decoder micro-benchmark. Decodes each input with the Latin-1 and
+// UTF-8 codecs in 4KB chunks, the way network data reaches
+// TextResourceDecoder, and prints the best throughput of each together with
+// a checksum of the decoded characters. A plain byte-widening loop is timed
+// as a reference. Besides the files given on the command line, three
+// generated inputs are decoded: pure ASCII markup, markup with Latin-1
+// accents, and markup with multi-byte UTF-8 text.
+//
+// Usage: decoder_bench [-r runs] [-n megabytes] [file...]
+
+#include "config.h"
+
+#include "CurrentTime.h"
+#include "InitializeThreading.h"
+#include "MainThread.h"
+#include "PlatformString.h"
+#include "TextCodec.h"
+#include "TextEncoding.h"
+#include "TextEncodingRegistry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/Vector.h>
+
+using namespace WebCore;
+using namespace WTF;
+
+static const size_t chunkSize = 4096;
+
+struct Input {
+    const char* name;
+    Vector<char> bytes;
+};
+
+static bool readFile(const char* fileName, Vector<char>& buffer)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (!f) {
+        fprintf(stderr, "Could not open file: %s\n", fileName);
+        return false;
+    }
+
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buffer.append(chunk, read);
+    fclose(f);
+    return true;
+}
+
+// Repeats markup until the buffer holds size bytes, putting extra every
+// period lines when it is given.
+static void generate(Vector<char>& buffer, size_t size, const char* extra, unsigned period)
+{
+    static const char* line = "<li class=\"item\"><a href=\"/news/story.html\">Read the full story</a></li>\n";
+    for (unsigned i = 0; buffer.size() < size; ++i) {
+        buffer.append(line, strlen(line));
+        if (extra && !(i % period))
+            buffer.append(extra, strlen(extra));
+    }
+    buffer.shrink(size);
+}
+
+static unsigned checksum(const UChar* characters, size_t length)
+{
+    unsigned sum = length;
+    for (size_t i = 0; i < length; ++i)
+        sum = sum * 31 + characters[i];
+    return sum;
+}
+
+static double decode(const TextEncoding& encoding, const Vector<char>& bytes, unsigned& sum)
+{
+    double start = currentTime();
+    OwnPtr<TextCodec> codec = newTextCodec(encoding);
+    sum = 0;
+    for (size_t offset = 0; offset < bytes.size(); offset += chunkSize) {
+        size_t length = std::min(chunkSize, bytes.size() - offset);
+        String text = codec->decode(bytes.data() + offset, length, offset + length == bytes.size());
+        sum += checksum(text.characters(), text.length());
+    }
+    return currentTime() - start;
+}
+
+static double widen(const Vector<char>& bytes, unsigned& sum)
+{
+    double start = currentTime();
+    sum = 0;
+    Vector<UChar> characters(chunkSize);
+    for (size_t offset = 0; offset < bytes.size(); offset += chunkSize) {
+        size_t length = std::min(chunkSize, bytes.size() - offset);
+        const unsigned char* source = reinterpret_cast<const unsigned char*>(bytes.data() + offset);
+        for (size_t i = 0; i < length; ++i)
+            characters[i] = source[i];
+        sum += checksum(characters.data(), length);
+    }
+    return currentTime() - start;
+}
+
+static void report(const char* input, const char* decoder, size_t size, double best, unsigned sum)
+{
+    double megabytes = size / (1024.0 * 1024.0);
+    printf("%-12s %-10s %10.2f %10.1f %10x\n", input, decoder, best * 1000, best ? megabytes / best : 0, sum);
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 5;
+    int megabytes = 4;
+    Vector<Input*> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            runs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            megabytes = atoi(argv[++i]);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: decoder_bench [-r runs] [-n megabytes] [file...]\n");
+            return 1;
+        } else {
+            Input* input = new Input;
+            const char* slash = strrchr(argv[i], '/');
+            input->name = slash ? slash + 1 : argv[i];
+            if (!readFile(argv[i], input->bytes))
+                return 1;
+            inputs.append(input);
+        }
+    }
+    if (runs <= 0 || megabytes <= 0) {
+        fprintf(stderr, "Usage: decoder_bench [-r runs] [-n megabytes] [file...]\n");
+        return 1;
+    }
+
+    WTF::initializeThreading();
+    WTF::initializeMainThread();
+
+    size_t size = megabytes * 1024 * 1024;
+    Input* ascii = new Input;
+    ascii->name = "ascii";
+    generate(ascii->bytes, size, 0, 0);
+    inputs.append(ascii);
+    Input* latin1 = new Input;
+    latin1->name = "latin1";
+    generate(latin1->bytes, size, "<p>Caf\xe9 cr\xe8me br\xfbl\xe9\x65, na\xefve fa\xe7\x61\x64\x65</p>\n", 4);
+    inputs.append(latin1);
+    Input* utf8 = new Input;
+    utf8->name = "utf8";
+    generate(utf8->bytes, size, "<p>Caf\xc3\xa9 \xe4\xb8\xad\xe6\x96\x87 \xd0\x9c\xd0\xbe\xd1\x81\xd0\xba\xd0\xb2\xd0\xb0</p>\n", 4);
+    inputs.append(utf8);
+
+    const TextEncoding& latin1Encoding = Latin1Encoding();
+    const TextEncoding& utf8Encoding = UTF8Encoding();
+
+    printf("decoder_bench: %d KB chunks, best of %d runs\n", static_cast<int>(chunkSize / 1024), runs);
+    printf("%-12s %-10s %10s %10s %10s\n", "input", "decoder", "ms", "MB/s", "checksum");
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const Vector<char>& bytes = inputs[i]->bytes;
+        double bestWiden = 0;
+        double bestLatin1 = 0;
+        double bestUTF8 = 0;
+        unsigned widenSum = 0;
+        unsigned latin1Sum = 0;
+        unsigned utf8Sum = 0;
+        for (int run = 0; run < runs; ++run) {
+            double elapsed = widen(bytes, widenSum);
+            if (!run || elapsed < bestWiden)
+                bestWiden = elapsed;
+            elapsed = decode(latin1Encoding, bytes, latin1Sum);
+            if (!run || elapsed < bestLatin1)
+                bestLatin1 = elapsed;
+            elapsed = decode(utf8Encoding, bytes, utf8Sum);
+            if (!run || elapsed < bestUTF8)
+                bestUTF8 = elapsed;
+        }
+        report(inputs[i]->name, "widen", bytes.size(), bestWiden, widenSum);
+        report(inputs[i]->name, "latin1", bytes.size(), bestLatin1, latin1Sum);
+        report(inputs[i]->name, "utf-8", bytes.size(), bestUTF8, utf8Sum);
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+        delete inputs[i];
+    return 0;
+}
@@ -31,15 +31,18 @@
 #include <utils/Log.h>
 
 namespace android {
-extern void benchmark(const char*, int, int ,int);
+extern void benchmark(const char*, int, int ,int, bool, int, bool);
 }
 
 int main(int argc, char** argv) {
     int width = 800;
     int height = 600;
     int reloadCount = 0;
+    bool backgroundPreloadScanning = true;
+    int repaintCount = 0;
+    bool layerPictures = true;
     while (true) {
-        int c = getopt(argc, argv, "d:r:");
+        int c = getopt(argc, argv, "d:r:sp:l");
         if (c == -1)
             break;
         else if (c == 'd') {
@@ -54,6 +57,19 @@ int main(int argc, char** argv) {
             if (reloadCount < 0)
                 reloadCount = 0;
             LOGD("Reloading %d times", reloadCount);
+        } else if (c == 's') {
+            // Compare parse times with the preload scanner on the main thread.
+            backgroundPreloadScanning = false;
+            LOGD("Scanning for preloads on the main thread");
+        } else if (c == 'p') {
+            repaintCount = atoi(optarg);
+            if (repaintCount < 0)
+                repaintCount = 0;
+            LOGD("Repainting %d times after a DOM change", repaintCount);
+        } else if (c == 'l') {
+            // Compare repaint times with every layer painted again.
+            layerPictures = false;
+            LOGD("Painting layers without recorded pictures");
         }
     }
     if (optind >= argc) {
@@ -61,5 +77,6 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    android::benchmark(argv[optind], reloadCount, width, height);
+    android::benchmark(argv[optind], reloadCount, width, height, backgroundPreloadScanning,
+            repaintCount, layerPictures);
 }
@@ -27,10 +27,14 @@
 
 #include "config.h"
 
+#include "AtomicString.h"
 #include "BackForwardList.h"
+#include "BackgroundPreloadScanner.h"
+#include "CSSStyleSelector.h"
 #include "ChromeClientAndroid.h"
 #include "ContextMenuClientAndroid.h"
 #include "CookieClient.h"
+#include "Document.h"
 #include "DragClientAndroid.h"
 #include "EditorClientAndroid.h"
 #include "Frame.h"
@@ -40,11 +44,15 @@
 #include "GraphicsContext.h"
 #include "HistoryItem.h"
 #include "InspectorClientAndroid.h"
+#include "ImageDecodeQueue.h"
 #include "IntRect.h"
+#include "JSDOMWindow.h"
 #include "JavaSharedClient.h"
 #include "jni_utility.h"
 #include "Page.h"
 #include "PlatformGraphicsContext.h"
+#include "RenderArena.h"
+#include "RenderLayer.h"
 #include "ResourceRequest.h"
 #include "ScriptController.h"
 #include "SecurityOrigin.h"
@@ -52,8 +60,10 @@
 #include "Settings.h"
 #include "SharedBuffer.h"
 #include "SubstituteData.h"
+#include "Text.h"
 #include "TimerClient.h"
 #include "TextEncoding.h"
+#include "WidthCache.h"
 #include "WebCoreViewBridge.h"
 #include "WebFrameView.h"
 #include "WebViewCore.h"
@@ -67,7 +77,11 @@
 
 #include "jni_utility.h"
 #include <jni.h>
+#include <parser/CodeCache.h>
+#include <parser/Parser.h>
 #include <utils/Log.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/FastMalloc.h>
 
 namespace android {
 
@@ -171,7 +185,8 @@ static void historyItemChanged(HistoryItem* i) {
 
 namespace android {
 
-EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+EXPORT void benchmark(const char* url, int reloadCount, int width, int height,
+        bool backgroundPreloadScanning, int repaintCount, bool layerPictures) {
     ScriptController::initializeThreading();
 
     // Setting this allows data: urls to load from a local file.
@@ -243,8 +258,18 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     s->setPluginsEnabled(false);
     s->setShrinksStandaloneImagesToFit(false);
     s->setUseWideViewport(false);
+    s->setBackgroundPreloadScanningEnabled(backgroundPreloadScanning);
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    // Images are still decoded in the background, but the final paint waits
+    // for them so the output does not depend on timing.
+    ImageDecodeQueue::setWaitsForDecodes(true);
+#endif
+#if ENABLE(LAYER_PICTURE_CACHE)
+    RenderLayer::setPicturesEnabled(layerPictures);
+#endif
 
     // Finally, load the actual data
+    double startTime = WTF::currentTime();
     ResourceRequest req(url);
     frame->loader()->load(req, false);
 
@@ -265,6 +290,127 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
         if (reloadCount)
             frame->loader()->reload(true);
     } while (reloadCount--);
+    LOGD("Loading, parsing and layout took %d ms",
+            static_cast<int>((WTF::currentTime() - startTime) * 1000));
+
+    // Report how the JavaScript collector behaved across all the loads.
+    const JSC::Heap::CollectionStatistics& gcStats =
+            WebCore::JSDOMWindow::commonJSGlobalData()->heap.collectionStatistics();
+    LOGD("JavaScript GC: %zu full and %zu young collections, %d ms total pause,"
+            " %d ms max pause, %zu bytes promoted, %zu remembered cells",
+            gcStats.fullCollections, gcStats.youngCollections,
+            static_cast<int>(gcStats.totalPauseTime * 1000),
+            static_cast<int>(gcStats.maxPauseTime * 1000),
+            gcStats.bytesPromoted, gcStats.rememberedCells);
+    const size_t buckets = JSC::Heap::CollectionStatistics::pauseHistogramSize;
+    for (size_t i = 0; i < buckets - 1; i++)
+        LOGD("JavaScript GC pauses < %d ms: %zu", 1 << i, gcStats.pauseHistogram[i]);
+    LOGD("JavaScript GC pauses >= %d ms: %zu", 1 << (buckets - 2),
+            gcStats.pauseHistogram[buckets - 1]);
+
+    const JSC::Parser::Statistics& parseStats =
+            WebCore::JSDOMWindow::commonJSGlobalData()->parser->statistics();
+    size_t parses = parseStats.programsParsed + parseStats.functionBodiesParsed;
+    LOGD("JavaScript parser: %zu scripts, %zu of %zu skipped function bodies parsed"
+            " on first call, %d ms, %zu bytes of arena per parse (%zu max)",
+            parseStats.programsParsed, parseStats.functionBodiesParsed,
+            parseStats.functionBodiesSkipped,
+            static_cast<int>(parseStats.parseTime * 1000),
+            parses ? parseStats.arenaBytes / parses : 0,
+            parseStats.maxArenaBytes);
+
+#if ENABLE(JSC_CODE_CACHE)
+    // Every reload after the first should find its scripts in the code cache.
+    const JSC::CodeCache::Statistics& codeStats =
+            WebCore::JSDOMWindow::commonJSGlobalData()->codeCache->statistics();
+    LOGD("JavaScript code cache: %zu of %zu programs and %zu of %zu functions reused,"
+            " %d ms parsing, %d ms saved, %zu bytes of source cached, %zu evictions",
+            codeStats.programHits, codeStats.programHits + codeStats.programMisses,
+            codeStats.functionHits, codeStats.functionHits + codeStats.functionMisses,
+            static_cast<int>(codeStats.parseTime * 1000),
+            static_cast<int>(codeStats.parseTimeSaved * 1000),
+            codeStats.cachedSourceBytes, codeStats.evictions);
+#endif
+
+    const WebCore::AtomicString::Statistics& atomStats =
+            WebCore::AtomicString::statistics();
+    LOGD("Atomic strings: %zu lookups (%zu with a precomputed hash), %zu"
+            " inserted, %zu rehashes", atomStats.lookups,
+            atomStats.precomputedHashLookups, atomStats.inserts,
+            atomStats.rehashes);
+
+    const WebCore::CSSStyleSelector::Statistics& styleStats =
+            WebCore::CSSStyleSelector::statistics();
+    LOGD("Style: %u elements styled, %u selectors checked, %u rejected by the"
+            " ancestor filter, shared with %u siblings, %u cousins and %u cached"
+            " elements", styleStats.elementsStyled, styleStats.selectorsChecked,
+            styleStats.selectorsFastRejected, styleStats.stylesSharedWithSiblings,
+            styleStats.stylesSharedWithCousins, styleStats.stylesSharedFromCache);
+
+#if ENABLE(TEXT_WIDTH_CACHE)
+    const WebCore::WidthCache::Statistics& widthStats =
+            WebCore::WidthCache::shared().statistics();
+    LOGD("Text width cache: %zu hits, %zu misses, %zu replaced, %zu cleared",
+            widthStats.hits, widthStats.misses, widthStats.replacements,
+            widthStats.clears);
+#endif
+
+#if ENABLE(ASYNC_IMAGE_DECODING)
+    const WebCore::ImageDecodeQueue::Statistics& decodeStats =
+            WebCore::ImageDecodeQueue::statistics();
+    LOGD("Image decoding: %zu of %zu decodes done in the background in %d ms,"
+            " %zu paints deferred, %zu paints waited",
+            decodeStats.decodesCompleted, decodeStats.decodesQueued,
+            static_cast<int>(decodeStats.decodeTime * 1000),
+            decodeStats.paintsDeferred, decodeStats.paintsWaited);
+#endif
+
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    const WebCore::BackgroundPreloadScanner::Statistics& preloadStats =
+            WebCore::BackgroundPreloadScanner::statistics();
+    LOGD("Background preload scanner: %zu documents, %zu characters scanned in"
+            " %d ms, %zu preloads issued", preloadStats.documentsScanned,
+            preloadStats.charactersScanned,
+            static_cast<int>(preloadStats.scanTime * 1000),
+            preloadStats.preloadsIssued);
+#endif
+
+    const WebCore::RenderArena::Statistics& arenaStats =
+            WebCore::RenderArena::statistics();
+    LOGD("Render arena: %zu render objects, %zu inline boxes, %zu layers, %zu"
+            " layout allocations, %zu recycled, %zu freed; arenas: %zu from the"
+            " heap, %zu reused, %zu kept",
+            arenaStats.allocations[WebCore::RenderArena::RenderObjectAllocation],
+            arenaStats.allocations[WebCore::RenderArena::InlineBoxAllocation],
+            arenaStats.allocations[WebCore::RenderArena::LayerAllocation],
+            arenaStats.allocations[WebCore::RenderArena::LayoutAllocation],
+            arenaStats.recycled, arenaStats.frees, arenaStats.heapArenas,
+            arenaStats.reusedArenas, arenaStats.freeArenas);
+
+    // Only the thread-caching allocator keeps these; see WEBKIT_SYSTEM_MALLOC.
+    WTF::FastMallocAllocationStatistics mallocStats;
+    WTF::fastMallocAllocationStatistics(mallocStats);
+    if (mallocStats.peakHeapSize) {
+        size_t allocations = mallocStats.largeAllocations;
+        for (size_t i = 0; i < mallocStats.sizeClassCount; ++i)
+            allocations += mallocStats.sizeClasses[i].allocations;
+        size_t committed = mallocStats.committedBytes;
+        size_t unused = committed > mallocStats.liveBytes ?
+                committed - mallocStats.liveBytes : 0;
+        LOGD("FastMalloc: %zu allocations, %zu KB live, %zu KB committed (%d%%"
+                " unused), %zu KB peak heap", allocations,
+                mallocStats.liveBytes >> 10, committed >> 10,
+                committed ? static_cast<int>(unused * 100 / committed) : 0,
+                mallocStats.peakHeapSize >> 10);
+        for (size_t i = 0; i < mallocStats.sizeClassCount; ++i) {
+            const WTF::FastMallocSizeClassStatistics& sizeClass =
+                    mallocStats.sizeClasses[i];
+            if (sizeClass.allocations)
+                LOGD("FastMalloc: %5zu bytes: %zu allocations, %zu live",
+                        sizeClass.size, sizeClass.allocations,
+                        sizeClass.liveObjects);
+        }
+    }
 
     // Draw into an offscreen bitmap
     SkBitmap bmp;
@@ -280,6 +426,36 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     enc->encodeFile("/sdcard/webcore_test.png", bmp, 100);
     delete enc;
 
+    // Change the first text on the page and paint again, the way pages
+    // update a clock or a counter. Everything but the layers painting the
+    // text is unchanged.
+    Node* text = frame->document();
+    while (text && !(text->isTextNode() && text->renderer()))
+        text = text->traverseNextNode();
+    if (repaintCount && text) {
+        String original = static_cast<Text*>(text)->data();
+        ExceptionCode ec;
+        double repaintTime = 0;
+        for (int i = 0; i < repaintCount; i++) {
+            static_cast<Text*>(text)->setData(i & 1 ? original : original + "*", ec);
+            frame->document()->updateLayout();
+            startTime = WTF::currentTime();
+            frame->view()->paintContents(&gc, IntRect(0, 0, width, height));
+            repaintTime += WTF::currentTime() - startTime;
+        }
+        LOGD("Repainting after a DOM change took %d ms for %d repaints",
+                static_cast<int>(repaintTime * 1000), repaintCount);
+    }
+
+#if ENABLE(LAYER_PICTURE_CACHE)
+    const WebCore::RenderLayer::PictureStatistics& pictureStats =
+            WebCore::RenderLayer::pictureStatistics();
+    LOGD("Layer pictures: %zu layers recorded, %zu replayed, %zu invalidated,"
+            " %zu not recordable", pictureStats.layersRecorded,
+            pictureStats.picturesReplayed, pictureStats.layersInvalidated,
+            pictureStats.layersNotRecordable);
+#endif
+
     // Tear down the world.
     frame->loader()->detachFromParent();
     delete page;
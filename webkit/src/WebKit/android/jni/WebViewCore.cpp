@@ -63,6 +63,7 @@
 #include "HTMLOptionElement.h"
 #include "HTMLSelectElement.h"
 #include "HTMLTextAreaElement.h"
+#include "ImageSource.h"
 #include "InlineTextBox.h"
 #include <JNIHelp.h>
 #include "KeyboardCodes.h"
@@ -76,6 +77,7 @@
 #include "PluginView.h"
 #include "Position.h"
 #include "ProgressTracker.h"
+#include "RenderArena.h"
 #include "RenderBox.h"
 #include "RenderLayer.h"
 #include "RenderPart.h"
@@ -3205,6 +3207,11 @@ static void FreeMemory(JNIEnv* env, jobject obj)
     SkANP::InitEvent(&event, kLifecycle_ANPEventType);
     event.data.lifecycle.action = kFreeMemory_ANPLifecycleAction;
     GET_NATIVE_VIEW(env, obj)->sendPluginEvent(event);
+
+    // Decoded images that are not on screen can be decoded again later.
+    WebCore::ImageSource::purgeDecodedFrames();
+    // So can the arenas kept for the render tree of the next page.
+    WebCore::RenderArena::releaseFreeArenas();
 }
 
 static void ProvideVisitedHistory(JNIEnv *env, jobject obj, jobject hist)